@@ -58,6 +58,18 @@
 #include "utils_arg_parser.h"
 #include "wakeon_le.h"
 #include "wiced_exp.h"
+#include "app_opts.h"
+#include "app_event_ring.h"
+#include "app_event_json.h"
+#include "app_btsnoop.h"
+#include "app_metrics.h"
+#include "app_trace.h"
+#include "app_time.h"
+#include "app_startup.h"
+#include "wakeon_le_scan.h"
+#include "wakeon_le_replay.h"
+#include "wakeon_le_radio.h"
+#include "wakeon_le_sched.h"
 #include "log.h"
 
 /*******************************************************************************
@@ -65,15 +77,6 @@
 *******************************************************************************/
 #define MAX_PATH                         ( 256 )
 
-/******************************************************************************
- *                                EXTERNS
- *****************************************************************************/
-extern wiced_bt_device_address_t bt_device_address;
-extern BOOL32 inSleep;
-extern tBT_UUID uuid;
-extern uint8_t pattern[LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX];
-extern uint32_t data_len;
-
 /*******************************************************************************
 *                               STRUCTURES AND ENUMERATIONS
 *******************************************************************************/
@@ -116,15 +119,9 @@ static const char app_menu[] = "\n\
     3.  Enable WakeOnLE with 16bit UUID \n\
     4.  Enable WakeOnLE with 32bit UUID \n\
     5.  Enable WakeOnLE with 32bit UUID AND MANUFACTURE DATA \n\
+    6.  Replay advertising capture (--replay) \n\
 Choose option -> ";
 
-wiced_bt_device_address_t bt_device_address;
-/* Platform GPIO configuration 
-     * Audobaud configuration GPIO bank and pin 
-     * Dev-Wake and Host-Wake
-*/
-cybt_controller_gpio_config_t gpio_cfg;
-
 /****************************************************************************
  *                              FUNCTION DECLARATIONS
  ***************************************************************************/
@@ -220,69 +217,54 @@ static BOOL32 error_check(int result)
 }
 
 /******************************************************************************
-* Function Name: main()
+* Function Name: app_json_metrics_collector()
 *******************************************************************************
 * Summary:
-*   Application entry function
+*   Export the JSON event lines dropped on a full output
 *
 * Parameters:
-*   int argc            : argument count
-*   char *argv[]        : list of arguments
+*   app_metrics_buf_t* p_out: metrics output
 *
 * Return:
-*     int : main function exit success 
+*   None;
 *
 ******************************************************************************/
-int main( int argc, char* argv[] )
+static void app_json_metrics_collector(app_metrics_buf_t* p_out)
+{
+    app_metrics_printf(p_out, "# HELP wakeonle_json_dropped_total JSON event lines dropped on a full output\n"
+                              "# TYPE wakeonle_json_dropped_total counter\n"
+                              "wakeonle_json_dropped_total %llu\n",
+                       (unsigned long long)app_event_json_dropped());
+}
+
+/******************************************************************************
+* Function Name: app_run_menu()
+*******************************************************************************
+* Summary:
+*   Serve the interactive menu until option 0
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+******************************************************************************/
+static void app_run_menu(void)
 {
-    int filename_len = 0; /* Length of application name */
-    char fw_patch_file[MAX_PATH]; /* Firmware patch file */
-    char hci_port[MAX_PATH]; /* Interface Device */ 
-    char peer_ip_addr[16] = "000.000.000.000"; /* Peer IP Address */
-    uint32_t hci_baudrate = 0; /* HCI baud rate */ 
-    uint32_t patch_baudrate = 0; /* Patch downloading baud rate */
-    int btspy_inst = 0; /* BTSPY instance */
-    uint8_t btspy_is_tcp_socket = 0; /* BTSPY communication socket */
     uint32_t uuid32 = 0;
     uint16_t uuid16 = 0;
     int ret = 0;
     int input = 0;
     int i = 0;
 
-    /* Parse the arguments */
-    memset( fw_patch_file,0,MAX_PATH );
-    memset( hci_port,0,MAX_PATH );
-    if ( PARSE_ERROR == arg_parser_get_args(argc,
-                                            argv,
-                                            hci_port,
-                                            bt_device_address,
-                                            &hci_baudrate,
-                                            &btspy_inst,
-                                            peer_ip_addr, 
-                                            &btspy_is_tcp_socket,
-                                            fw_patch_file, 
-                                            &patch_baudrate,
-                                            &gpio_cfg))
-    {
-        return EXIT_FAILURE;
-    }
-
-    /* Extract the application name */
-    memset( g_app_name, 0, sizeof( g_app_name ) );
-    strncpy(g_app_name, argv[0], MAX_PATH - 1);
-
-    cy_platform_bluetooth_init( fw_patch_file, hci_port, hci_baudrate, patch_baudrate, &gpio_cfg.autobaud_cfg);
-
-    wait_controller_reset_ready();
-    TRACE_MSG(" Linux CE Wake On LE initialization complete...\n" );
-
     do 
     {
         TRACE_MSG("%s", app_menu);
-        memset(&uuid, 0, sizeof(uuid));
+        memset(&wakeon_le_ctrl.uuid, 0, sizeof(wakeon_le_ctrl.uuid));
         uuid32 = 0;
         uuid16 = 0;
-        data_len = 0;
+        wakeon_le_ctrl.data_len = 0;
         ret = scanf ("%d", &input);
         if(error_check(ret) == WICED_FALSE)
         {
@@ -302,7 +284,7 @@ int main( int argc, char* argv[] )
             case 3:
             {
                 unsigned int read;
-                if (inSleep == TRUE)
+                if (wakeon_le_ctrl.in_sleep == TRUE)
                 {
                     TRACE_MSG("In Sleep MODE\n");
                     break;
@@ -319,15 +301,15 @@ int main( int argc, char* argv[] )
 		    uuid16 |= read;
                 }
 		TRACE_MSG("INPUT UUID is:%x\n", uuid16);
-                uuid.uu.uuid16 = uuid16;
-                uuid.len = LEN_UUID_16;
+                wakeon_le_ctrl.uuid.uu.uuid16 = uuid16;
+                wakeon_le_ctrl.uuid.len = LEN_UUID_16;
 		app_enable_wake_on_le_uuid();
             }
                 break;
             case 4:
             {
                 unsigned int read;
-                if (inSleep == TRUE)
+                if (wakeon_le_ctrl.in_sleep == TRUE)
                 {
                     TRACE_MSG("In Sleep MODE\n");
                     break;
@@ -344,15 +326,15 @@ int main( int argc, char* argv[] )
 		    uuid32 |= read;
                 }
                 TRACE_MSG("INPUT UUID is:%x\n", uuid32);
-                uuid.uu.uuid32 = uuid32;
-                uuid.len = LEN_UUID_32;
+                wakeon_le_ctrl.uuid.uu.uuid32 = uuid32;
+                wakeon_le_ctrl.uuid.len = LEN_UUID_32;
 		app_enable_wake_on_le_uuid();
 	    }
 	        break;
 	    case 5:
             {
                 unsigned int read;
-                if (inSleep == TRUE)
+                if (wakeon_le_ctrl.in_sleep == TRUE)
                 {
                     TRACE_MSG("In Sleep MODE\n");
                     break;
@@ -369,20 +351,20 @@ int main( int argc, char* argv[] )
 		    uuid32 |= read;
                 }
                 TRACE_MSG("Enter Manufacture Data Pattern length limited 27 bytes:\n");
-                ret = scanf("%d", &data_len);
+                ret = scanf("%d", &wakeon_le_ctrl.data_len);
                 if(error_check(ret) == WICED_FALSE)
                 {
                     goto INPUT_ERROR;
                 }
-                if (data_len > LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX)
+                if (wakeon_le_ctrl.data_len > LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX)
                 {
                     TRACE_MSG("ERROR:Data Pattern length Over 27 bytes:\n");
                     break;
                 }
                 TRACE_MSG("Enter Manufacture Data Pattern in Hex. XX XX ... XX \n");
-                for(i = 0; i < data_len; i++)
+                for(i = 0; i < wakeon_le_ctrl.data_len; i++)
                 {
-                    ret = scanf("%x", (uint32_t*)&pattern[i]);
+                    ret = scanf("%x", (uint32_t*)&wakeon_le_ctrl.pattern[i]);
                     if(error_check(ret) == WICED_FALSE)
                     {
                         goto INPUT_ERROR;
@@ -391,22 +373,201 @@ int main( int argc, char* argv[] )
 
                 TRACE_MSG("INPUT UUID is:0x%x\n", uuid32);
                 TRACE_MSG("INPUT DATA PATTERN is 0x:");
-                for (i = 0; i < data_len; i++)
+                for (i = 0; i < wakeon_le_ctrl.data_len; i++)
                 {
-                    TRACE_MSG("%x", pattern[i]);
+                    TRACE_MSG("%x", wakeon_le_ctrl.pattern[i]);
                 }
                 TRACE_MSG("\n");
-                uuid.uu.uuid32 = uuid32;
-                uuid.len = LEN_UUID_32;
+                wakeon_le_ctrl.uuid.uu.uuid32 = uuid32;
+                wakeon_le_ctrl.uuid.len = LEN_UUID_32;
                 app_enable_wake_on_le_uuid_manu();
             }
 		break;
+            case 6:
+                app_start_replay();
+                break;
             default:
 INPUT_ERROR:
                 TRACE_ERR("Input error!!\n");
                 break;
         }
     } while (input != 0);
-    
-    return EXIT_SUCCESS;
+}
+
+/******************************************************************************
+* Function Name: main()
+*******************************************************************************
+* Summary:
+*   Application entry function
+*
+* Parameters:
+*   int argc            : argument count
+*   char *argv[]        : list of arguments
+*
+* Return:
+*     int : main function exit success 
+*
+******************************************************************************/
+int main( int argc, char* argv[] )
+{
+    int filename_len = 0; /* Length of application name */
+    char fw_patch_file[MAX_PATH]; /* Firmware patch file */
+    char hci_port[MAX_PATH]; /* Interface Device */ 
+    char peer_ip_addr[16] = "000.000.000.000"; /* Peer IP Address */
+    uint32_t hci_baudrate = 0; /* HCI baud rate */ 
+    uint32_t patch_baudrate = 0; /* Patch downloading baud rate */
+    int btspy_inst = 0; /* BTSPY instance */
+    uint8_t btspy_is_tcp_socket = 0; /* BTSPY communication socket */
+    int ret = 0;
+    /* the supervisor passes its own options on to the radios */
+    char* orig_argv[argc + 1];
+    int orig_argc = argc;
+
+    /* Startup timeline, from the exec of the process */
+    app_startup_init();
+    app_startup_begin( APP_STARTUP_ARGS );
+
+    /* Parse the application options, the rest goes to the platform parser */
+    memcpy( orig_argv, argv, sizeof( orig_argv ) );
+    if ( APP_OPTS_ERROR == app_opts_parse( &argc, argv ) )
+    {
+        return EXIT_FAILURE;
+    }
+
+    /* One process per radio, this one only starts and watches them */
+    if ( app_opts.radios_path[0] != '\0' )
+    {
+        if ( argc > 1 )
+        {
+            TRACE_ERR("with --radios, %s and the other porting layer arguments go in the radio list\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+        app_trace_level = (int)app_opts.log_level;
+        app_time_init();
+        return wakeon_le_radio_supervise( app_opts.radios_path, orig_argc, orig_argv );
+    }
+
+    /* Parse the arguments */
+    memset( fw_patch_file,0,MAX_PATH );
+    memset( hci_port,0,MAX_PATH );
+    if ( PARSE_ERROR == arg_parser_get_args(argc,
+                                            argv,
+                                            hci_port,
+                                            wakeon_le_ctrl.bd_addr,
+                                            &hci_baudrate,
+                                            &btspy_inst,
+                                            peer_ip_addr, 
+                                            &btspy_is_tcp_socket,
+                                            fw_patch_file, 
+                                            &patch_baudrate,
+                                            &wakeon_le_ctrl.gpio_cfg))
+    {
+        return EXIT_FAILURE;
+    }
+    app_startup_end( APP_STARTUP_ARGS );
+
+    app_trace_level = (int)app_opts.log_level;
+
+    /* Calibrate the trace and scan timestamp counter before any thread starts */
+    app_time_init();
+
+    /* With --mlock, small thread stacks and one malloc arena, also before any thread starts */
+    if ( WICED_FALSE == wakeon_le_sched_mlock_prepare() )
+    {
+        return EXIT_FAILURE;
+    }
+
+#if defined(APP_TRACE_ASYNC) && APP_TRACE_ASYNC
+    /* Move trace formatting off the stack and GPIO threads, flushed at exit */
+    if ( APP_TRACE_SUCCESS == app_trace_start() )
+    {
+        atexit( app_trace_stop );
+    }
+#endif
+
+    /* Extract the application name */
+    memset( g_app_name, 0, sizeof( g_app_name ) );
+    strncpy(g_app_name, argv[0], MAX_PATH - 1);
+
+    if ( app_opts.event_ring_name[0] != '\0' )
+    {
+        if ( APP_EVENT_RING_ERROR == app_event_ring_create( app_opts.event_ring_name, app_opts.event_ring_slots ) )
+        {
+            TRACE_ERR("create event ring %s failed\n", app_opts.event_ring_name);
+            return EXIT_FAILURE;
+        }
+        TRACE_MSG("Publishing events to shared memory ring %s\n", app_opts.event_ring_name);
+    }
+
+    if ( app_opts.json_path[0] != '\0' )
+    {
+        if ( APP_EVENT_JSON_ERROR == app_event_json_open( app_opts.json_path ) )
+        {
+            TRACE_ERR("open JSON event output %s failed\n", app_opts.json_path);
+            return EXIT_FAILURE;
+        }
+        TRACE_MSG("Writing JSON events to %s\n", app_opts.json_path);
+    }
+
+    if ( app_opts.btsnoop_path[0] != '\0' )
+    {
+        if ( APP_BTSNOOP_ERROR == app_btsnoop_open( app_opts.btsnoop_path, app_opts.btsnoop_size ) )
+        {
+            TRACE_ERR("open btsnoop capture %s failed\n", app_opts.btsnoop_path);
+            return EXIT_FAILURE;
+        }
+        TRACE_MSG("Capturing HCI traffic to %s\n", app_opts.btsnoop_path);
+    }
+
+    if ( app_opts.metrics_path[0] != '\0' )
+    {
+        app_metrics_register_collector( app_startup_metrics_collector );
+        if ( app_opts.json_path[0] != '\0' )
+        {
+            app_metrics_register_collector( app_json_metrics_collector );
+        }
+        if ( APP_METRICS_ERROR == app_metrics_server_start( app_opts.metrics_path ) )
+        {
+            TRACE_ERR("start metrics server on %s failed\n", app_opts.metrics_path);
+            return EXIT_FAILURE;
+        }
+        TRACE_MSG("Serving metrics on %s\n", app_opts.metrics_path);
+    }
+
+    app_startup_begin( APP_STARTUP_PLATFORM_INIT );
+    cy_platform_bluetooth_init( fw_patch_file, hci_port, hci_baudrate, patch_baudrate, &wakeon_le_ctrl.gpio_cfg.autobaud_cfg);
+    app_startup_end( APP_STARTUP_PLATFORM_INIT );
+
+    app_startup_begin( APP_STARTUP_CONTROLLER_RESET );
+    wait_controller_reset_ready();
+    if ( APP_STARTUP_COMPLETE == app_startup_end( APP_STARTUP_CONTROLLER_RESET ) )
+    {
+        app_print_startup();
+    }
+    TRACE_MSG(" Linux CE Wake On LE initialization complete...\n" );
+
+    if ( app_opts.radio_name[0] != '\0' )
+    {
+        /* supervised radio: no menu */
+        ret = wakeon_le_radio_run();
+    }
+    else
+    {
+        if ( app_opts.arm_rule[0] != '\0' )
+        {
+            app_enable_wake_on_le_rule( app_opts.arm_rule );
+        }
+        app_run_menu();
+        ret = EXIT_SUCCESS;
+    }
+
+
+    wakeon_le_replay_stop();
+    wakeon_le_sched_stop();
+    wakeon_le_scan_capture_close();
+    app_metrics_server_stop();
+    app_event_ring_destroy();
+    app_event_json_close();
+    app_btsnoop_close();
+    return ret;
 }
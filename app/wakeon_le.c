@@ -45,8 +45,11 @@
 *******************************************************************************/
 #include "wiced_bt_stack.h"
 #include <string.h>
+#include <ctype.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
 #include "wiced_memory.h"
 #include "stdio.h"
 #include "wiced_bt_dev.h"
@@ -57,6 +60,19 @@
 #include "wiced_exp.h"
 #include "platform_linux.h"
 #include "linux/gpio.h"
+#include "app_event_ring.h"
+#include "app_event_json.h"
+#include "app_btsnoop.h"
+#include "app_metrics.h"
+#include "app_time.h"
+#include "app_slab.h"
+#include "app_startup.h"
+#include "app_opts.h"
+#include "app_scan_stagger.h"
+#include "wakeon_le_scan.h"
+#include "wakeon_le_replay.h"
+#include "wakeon_le_heap.h"
+#include "wakeon_le_sched.h"
 #include "log.h"
 
 #ifdef TAG
@@ -64,44 +80,56 @@
 #endif
 #define TAG "[WAKEONLE]"
 
-#define debug 0
 
 /*******************************************************************************
 *       MACROS
 *******************************************************************************/
 #define BT_STACK_HEAP_SIZE          (0xF000)
-
-/*******************************************************************************
-*       STRUCTURES AND ENUMERATIONS
-*******************************************************************************/
-wiced_bt_device_address_t bt_device_address = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+/* scan report payload buffers: legacy advertising data and extended reports */
+#define APP_BUFFER_LEGACY_SIZE      (31U)
+#define APP_BUFFER_EXTENDED_SIZE    (255U)
+#define APP_BUFFER_EXTENDED_MIN     (64U)
+/* Scanning_PHYs bits of LE Set Extended Scan Parameters, as --scan-phy sets them */
+#define APP_SCAN_PHY_1M             (0x01U)
+#define APP_SCAN_PHY_CODED          (0x04U)
 
 /*******************************************************************************
 *       VARIABLE DEFINITIONS
 *******************************************************************************/
 wiced_bt_heap_t *p_default_heap   = NULL;
-extern cybt_controller_gpio_config_t gpio_cfg;
-BOOL32 inSleep = WICED_FALSE;
-tBT_UUID uuid = {0};
-uint16_t company_id = COMPANY_ID;
-uint16_t company_id_mask = 0xFFFF;
-uint32_t data_len = 0;
-uint8_t pattern[LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX] = {0};
-uint8_t pattern_mask[LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX] = {0};
-uint8_t apcf_filter_idx =  WICED_LE_ADV_PCF_FILTER_INDEX_START;
+wakeon_le_ctrl_t wakeon_le_ctrl =
+{
+    .bd_addr            = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 },
+    .in_sleep           = WICED_FALSE,
+    .company_id         = COMPANY_ID,
+    .company_id_mask    = 0xFFFF,
+    .apcf_filter_idx    = WICED_LE_ADV_PCF_FILTER_INDEX_START,
+};
+/* payload buffers of the scan path, see app_alloc_buffer() */
+static app_slab_pool_t app_buffer_pool;
+/* scan phase of this radio among --stagger radios, see app_wait_scan_phase() */
+static uint32_t scan_stagger_index = 0;
+static uint32_t scan_stagger_count = 1;
+/* --scan-phy, 0 for legacy scanning */
+static uint8_t scan_phys = 0;
 
 /*******************************************************************************
 *       FUNCTION DECLARATIONS
 *******************************************************************************/
 static void  app_init(void);
-static void* app_alloc_buffer(int len);
-static void  app_free_buffer(uint8_t *p_event_data);
+static BOOL32 app_buffer_pool_init(uint32_t queue_depth, BOOL32 extended);
+static BOOL32 app_scan_setup(void);
+static BOOL32 app_scan_parse_phys(const char* p_text);
+static void  app_scan_set_phys(void);
+static uint64_t app_wait_scan_phase(void);
 static void  app_scan_result_cback(wiced_bt_ble_scan_results_t* p_scan_result, uint8_t* p_adv_data);
 
 /* Callback function for Bluetooth stack management type events */
 static wiced_bt_dev_status_t    app_bt_management_callback(wiced_bt_management_evt_t event, wiced_bt_management_evt_data_t *p_event_data);
 static void bt_host_wake_assert_cback();
 static void bt_sleep_cmpl_cback(tBTM_VSC_CMPL *p_params); 
+static void app_publish_state_event(app_event_type_t type, uint64_t latency_ns);
+static void app_hci_trace_cback(wiced_bt_hci_trace_type_t type, uint16_t length, uint8_t* p_data);
 
 /*******************************************************************************
 *       FUNCTION DEFINITION
@@ -122,23 +150,75 @@ static void bt_sleep_cmpl_cback(tBTM_VSC_CMPL *p_params);
 void application_start(void)
 {
     wiced_result_t wiced_result;
+    uint32_t heap_size;
+    BOOL32 extended;
 
     TRACE_LOG("************* WakeOn_LE Application Start ************************\n");
     wiced_exp_version();
+    app_metrics_set_asleep(WICED_FALSE);
+
+    if (app_scan_setup() == WICED_FALSE)
+    {
+        exit(EXIT_FAILURE);
+    }
+    /* before the pools and rings below, so --mlock faults them in as they are made;
+     * thread stacks were made small in main() for it */
+    if (wakeon_le_sched_setup() == WICED_FALSE)
+    {
+        exit(EXIT_FAILURE);
+    }
+    /* extended reports, live or replayed, keep up to 255 bytes of AD data */
+    extended = (scan_phys != 0) || (app_opts.replay_path[0] != '\0');
+    if (app_buffer_pool_init(app_opts.scan_queue_depth, extended) == WICED_FALSE)
+    {
+        TRACE_ERR("create buffer pool failed\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((app_opts.capture_path[0] != '\0') && (wakeon_le_scan_capture_open(app_opts.capture_path) == WICED_FALSE))
+    {
+        TRACE_ERR("open capture %s failed\n", app_opts.capture_path);
+        exit(EXIT_FAILURE);
+    }
+    if (wakeon_le_scan_start(app_opts.scan_queue_depth, app_opts.max_devices,
+                             extended ? WAKEON_LE_SCAN_EXT_ADV_DATA_MAX : WAKEON_LE_SCAN_ADV_DATA_MAX) == WICED_FALSE)
+    {
+        TRACE_ERR("start scan worker failed\n");
+        exit(EXIT_FAILURE);
+    }
     /* Register call back and configuration with stack */
+    app_startup_begin(APP_STARTUP_BT_ENABLED);
+    app_startup_begin(APP_STARTUP_STACK_INIT);
     wiced_result = wiced_bt_stack_init (app_bt_management_callback, &wiced_bt_cfg_settings);
+    app_startup_end(APP_STARTUP_STACK_INIT);
+
+    /* Capture from the controller reset on, APCF and sleep mode VSCs included */
+    if (app_opts.btsnoop_path[0] != '\0')
+    {
+        wiced_bt_dev_register_hci_trace(app_hci_trace_cback);
+    }
 
     /* Check if stack initialization was successful */
     if( WICED_BT_SUCCESS == wiced_result)
     {
         TRACE_LOG("Bluetooth Stack Initialization Successful \n");
         /* Create default heap */
-        p_default_heap = wiced_bt_create_heap("default_heap", NULL, BT_STACK_HEAP_SIZE, NULL, WICED_TRUE);
+        heap_size = (app_opts.heap_size != 0) ? app_opts.heap_size : BT_STACK_HEAP_SIZE;
+        if ((app_opts.heap_calibrate_s != 0) && (heap_size < WAKEON_LE_HEAP_CALIBRATE_SIZE))
+        {
+            heap_size = WAKEON_LE_HEAP_CALIBRATE_SIZE;
+        }
+        app_startup_begin(APP_STARTUP_HEAP_CREATE);
+        p_default_heap = wakeon_le_heap_create("default_heap", heap_size, WICED_TRUE);
+        app_startup_end(APP_STARTUP_HEAP_CREATE);
         if (p_default_heap == NULL)
         {
-            TRACE_ERR("create default heap error: size %d\n", BT_STACK_HEAP_SIZE);
+            TRACE_ERR("create default heap error: size %u\n", (unsigned)heap_size);
             exit(EXIT_FAILURE);
         }
+        if (app_opts.heap_calibrate_s != 0)
+        {
+            wakeon_le_heap_calibrate_start(p_default_heap, app_opts.heap_calibrate_s);
+        }
     }
     else
     {
@@ -147,6 +227,373 @@ void application_start(void)
     }
 }
 
+/*******************************************************************************
+* Function Name: app_print_startup
+********************************************************************************
+* Summary:
+*   Print the startup timeline; called once, from whichever thread closes
+*   its last phase
+*
+* Parameters: NONE
+*
+* Return: NONE
+*
+*******************************************************************************/
+void app_print_startup(void)
+{
+    char summary[APP_STARTUP_SUMMARY_MAX];
+
+    app_startup_format(summary, sizeof(summary));
+    TRACE_MSG("%s", summary);
+}
+
+/*******************************************************************************
+* Function Name: app_start_replay
+********************************************************************************
+* Summary:
+*   Replay the --replay capture into the scan path, with the host rules
+*   currently armed. Each report is submitted with the length replay read
+*   from the capture. A summary is printed when it ends.
+*
+* Parameters: NONE
+*
+* Return: NONE
+*
+*******************************************************************************/
+void app_start_replay(void)
+{
+    if (app_opts.replay_path[0] == '\0')
+    {
+        TRACE_MSG("No capture to replay, start with --replay <path>");
+        return;
+    }
+    if (wakeon_le_replay_start(app_opts.replay_path, app_opts.replay_speed, app_opts.replay_loops,
+                               wakeon_le_scan_submit) == WICED_TRUE)
+    {
+        TRACE_MSG("Replaying %s, %u host rules armed", app_opts.replay_path, wakeon_le_scan_rule_count());
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_hci_trace_cback
+********************************************************************************
+* Summary:
+*   HCI trace callback, appends every HCI packet to the btsnoop capture
+*
+* Parameters:
+*   wiced_bt_hci_trace_type_t type: packet type and direction
+*   uint16_t length:                packet length
+*   uint8_t* p_data:                packet, without the HCI UART indicator
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void app_hci_trace_cback(wiced_bt_hci_trace_type_t type, uint16_t length, uint8_t* p_data)
+{
+    switch (type)
+    {
+    case HCI_TRACE_EVENT:
+        app_btsnoop_write(APP_BTSNOOP_H4_EVT, 1, p_data, length);
+        break;
+    case HCI_TRACE_COMMAND:
+        app_btsnoop_write(APP_BTSNOOP_H4_CMD, 0, p_data, length);
+        break;
+    case HCI_TRACE_INCOMING_ACL_DATA:
+        app_btsnoop_write(APP_BTSNOOP_H4_ACL, 1, p_data, length);
+        break;
+    case HCI_TRACE_OUTGOING_ACL_DATA:
+        app_btsnoop_write(APP_BTSNOOP_H4_ACL, 0, p_data, length);
+        break;
+    default:
+        break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_scan_setup
+********************************************************************************
+* Summary:
+*   Apply --scan-interval, --scan-window and --stagger to the low duty scan
+*   used while armed; called before the stack starts
+*
+* Parameters: NONE
+*
+* Return:
+*   BOOL32: WICED_FALSE if an option is out of range
+*
+*******************************************************************************/
+static BOOL32 app_scan_setup(void)
+{
+    wiced_bt_cfg_ble_scan_settings_t* p_scan = &cy_bt_cfg_scan_settings;
+    uint32_t interval = (app_opts.scan_interval != 0) ? app_opts.scan_interval : p_scan->low_duty_scan_interval;
+    uint32_t window = (app_opts.scan_window != 0) ? app_opts.scan_window : p_scan->low_duty_scan_window;
+
+    if ((interval < APP_SCAN_STAGGER_SLOTS_MIN) || (interval > APP_SCAN_STAGGER_SLOTS_MAX) ||
+        (window < APP_SCAN_STAGGER_SLOTS_MIN) || (window > interval))
+    {
+        TRACE_ERR("scan window %u and interval %u out of range, 4 <= window <= interval <= 16384 slots\n",
+                  (unsigned)window, (unsigned)interval);
+        return WICED_FALSE;
+    }
+    if ((app_opts.stagger[0] != '\0') &&
+        (app_scan_stagger_parse(app_opts.stagger, &scan_stagger_index, &scan_stagger_count) != APP_SCAN_STAGGER_SUCCESS))
+    {
+        TRACE_ERR("bad --stagger %s, expected <index>/<count> with index < count <= %u\n", app_opts.stagger,
+                  APP_SCAN_STAGGER_RADIOS_MAX);
+        return WICED_FALSE;
+    }
+    if (app_scan_parse_phys(app_opts.scan_phy) == WICED_FALSE)
+    {
+        return WICED_FALSE;
+    }
+    p_scan->low_duty_scan_interval = (uint16_t)interval;
+    p_scan->low_duty_scan_window = (uint16_t)window;
+    TRACE_LOG("armed scan: window %u of %u slots, phase %u/%u, %s\n", (unsigned)window, (unsigned)interval,
+              scan_stagger_index, scan_stagger_count,
+              (scan_phys == 0) ? "legacy" : (scan_phys == APP_SCAN_PHY_1M) ? "extended on LE 1M" :
+              (scan_phys == APP_SCAN_PHY_CODED) ? "extended on LE Coded" : "extended on LE 1M and LE Coded");
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: app_scan_parse_phys
+********************************************************************************
+* Summary:
+*   Parse --scan-phy, a comma separated list of "1m" and "coded"
+*
+* Parameters:
+*   const char* p_text: option value, empty for legacy scanning
+*
+* Return:
+*   BOOL32: WICED_FALSE if the list is malformed or extended scanning is
+*           not built in
+*
+*******************************************************************************/
+static BOOL32 app_scan_parse_phys(const char* p_text)
+{
+    const char* p_end;
+    size_t len;
+
+    scan_phys = 0;
+    while (*p_text != '\0')
+    {
+        p_end = strchr(p_text, ',');
+        len = (p_end != NULL) ? (size_t)(p_end - p_text) : strlen(p_text);
+        if ((len == 2) && (strncmp(p_text, "1m", len) == 0))
+        {
+            scan_phys |= APP_SCAN_PHY_1M;
+        }
+        else if ((len == 5) && (strncmp(p_text, "coded", len) == 0))
+        {
+            scan_phys |= APP_SCAN_PHY_CODED;
+        }
+        else
+        {
+            TRACE_ERR("bad --scan-phy %s, expected 1m, coded or 1m,coded\n", app_opts.scan_phy);
+            return WICED_FALSE;
+        }
+        p_text += len + ((p_end != NULL) ? 1U : 0U);
+    }
+#if !defined(WAKEONLE_EXT_SCAN) || !WAKEONLE_EXT_SCAN
+    if (scan_phys != 0)
+    {
+        TRACE_ERR("--scan-phy needs a build with -DWAKEONLE_EXT_SCAN=ON\n");
+        return WICED_FALSE;
+    }
+#endif
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: app_scan_set_phys
+********************************************************************************
+* Summary:
+*   Hand the --scan-phy setting to the stack, which then scans with the
+*   extended scan commands whenever wiced_bt_ble_scan() starts a scan. The
+*   LE Coded PHY gets the same interval and window as LE 1M; with both, the
+*   controller scans them one after the other. Called once the stack is up.
+*
+* Parameters: NONE
+*
+* Return: NONE
+*
+*******************************************************************************/
+static void app_scan_set_phys(void)
+{
+#if defined(WAKEONLE_EXT_SCAN) && WAKEONLE_EXT_SCAN
+    wiced_bt_ble_ext_scan_config_t ext_cfg;
+
+    if (scan_phys == 0)
+    {
+        return;
+    }
+    memset(&ext_cfg, 0, sizeof(ext_cfg));
+    ext_cfg.scanning_phys = scan_phys;
+    ext_cfg.enc_phy_scan_int = cy_bt_cfg_scan_settings.low_duty_scan_interval;
+    ext_cfg.enc_phy_scan_win = cy_bt_cfg_scan_settings.low_duty_scan_window;
+    /* scan until disabled */
+    ext_cfg.duration = 0;
+    ext_cfg.period = 0;
+    if (wiced_bt_ble_cache_ext_scan_config(&ext_cfg) != WICED_BT_SUCCESS)
+    {
+        TRACE_ERR("extended scan config failed, the controller may not support the PHYs\n");
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: app_wait_scan_phase
+********************************************************************************
+* Summary:
+*   Hold the scan enable until this radio's phase of the interval, so the
+*   windows of staggered radios follow each other; at most one interval.
+*   Called from the menu or radio thread, never from a stack callback.
+*
+* Parameters: NONE
+*
+* Return:
+*   uint64_t : time waited in ns, left out of the arm latency
+*
+*******************************************************************************/
+static uint64_t app_wait_scan_phase(void)
+{
+    uint64_t now_ns = app_time_now_ns();
+    uint64_t delay_ns = app_scan_stagger_delay_ns(now_ns, cy_bt_cfg_scan_settings.low_duty_scan_interval,
+                                                  scan_stagger_index, scan_stagger_count);
+    struct timespec until;
+
+    if (delay_ns == 0)
+    {
+        return 0;
+    }
+    TRACE_DBG("scan phase %u/%u in %u us\n", scan_stagger_index, scan_stagger_count, (unsigned)(delay_ns / 1000U));
+    until.tv_sec = (time_t)((now_ns + delay_ns) / APP_TIME_NS_PER_SEC);
+    until.tv_nsec = (long)((now_ns + delay_ns) % APP_TIME_NS_PER_SEC);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+    {
+    }
+    return app_time_now_ns() - now_ns;
+}
+
+/*******************************************************************************
+* Function Name: app_buffer_metrics_collector
+********************************************************************************
+* Summary:
+*   Export the buffer pool statistics with the application metrics
+*
+*******************************************************************************/
+static void app_buffer_metrics_collector(app_metrics_buf_t* p_out)
+{
+    const app_slab_class_t *p_class;
+    uint32_t c;
+
+#define BUFFER_METRIC(name_, type_, help_, value_)                                              \
+    app_metrics_printf(p_out, "# HELP " name_ " " help_ "\n# TYPE " name_ " " type_ "\n");     \
+    for (c = 0; c < app_buffer_pool.num_classes; c++)                                           \
+    {                                                                                           \
+        p_class = &app_buffer_pool.classes[c];                                                  \
+        app_metrics_printf(p_out, name_ "{class=\"%u\"} %llu\n", (unsigned)p_class->block_size,  \
+                           (unsigned long long)(value_));                                       \
+    }
+
+    BUFFER_METRIC("wakeonle_buffer_capacity", "gauge", "Buffers in the class", p_class->count)
+    BUFFER_METRIC("wakeonle_buffer_in_use", "gauge", "Buffers currently allocated", app_slab_in_use(p_class))
+    BUFFER_METRIC("wakeonle_buffer_high_water", "gauge", "Most buffers allocated at once",
+                  __atomic_load_n(&p_class->high_water, __ATOMIC_RELAXED))
+    BUFFER_METRIC("wakeonle_buffer_exhausted_total", "counter", "Allocations that found the class empty",
+                  __atomic_load_n(&p_class->exhausted, __ATOMIC_RELAXED))
+
+#undef BUFFER_METRIC
+}
+
+/*******************************************************************************
+* Function Name: app_buffer_pool_init
+********************************************************************************
+* Summary:
+*   Create the scan payload buffer pool. Every queued scan report holds one
+*   buffer, so the legacy class has one per queue slot. With extended
+*   reports an extended class is added; a legacy request that finds its
+*   class empty takes an extended buffer instead, and only then fails.
+*
+* Parameters:
+*   uint32_t queue_depth: scan report queue depth
+*   BOOL32 extended:      reports may carry more than 31 bytes of AD data
+*
+* Return:
+*   BOOL32: WICED_TRUE on success
+*
+*******************************************************************************/
+static BOOL32 app_buffer_pool_init(uint32_t queue_depth, BOOL32 extended)
+{
+    const uint32_t sizes[] = { APP_BUFFER_LEGACY_SIZE, APP_BUFFER_EXTENDED_SIZE };
+    uint32_t counts[] = { queue_depth, queue_depth / 4U };
+
+    if (counts[1] < APP_BUFFER_EXTENDED_MIN)
+    {
+        counts[1] = APP_BUFFER_EXTENDED_MIN;
+    }
+    if (app_slab_init(&app_buffer_pool, sizes, counts, extended ? 2U : 1U, APP_SLAB_EXHAUST_NEXT_CLASS) != APP_SLAB_SUCCESS)
+    {
+        return WICED_FALSE;
+    }
+    if (extended)
+    {
+        TRACE_LOG("buffer pool: %u x %u + %u x %u bytes\n", (unsigned)counts[0], (unsigned)APP_BUFFER_LEGACY_SIZE,
+                  (unsigned)counts[1], (unsigned)APP_BUFFER_EXTENDED_SIZE);
+    }
+    else
+    {
+        TRACE_LOG("buffer pool: %u x %u bytes\n", (unsigned)counts[0], (unsigned)APP_BUFFER_LEGACY_SIZE);
+    }
+    app_metrics_register_collector(app_buffer_metrics_collector);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: app_alloc_buffer
+********************************************************************************
+* Summary:
+*   Allocate a scan payload buffer from the buffer pool; lock-free, safe from
+*   the stack callbacks and the scan worker
+*
+* Parameters:
+*   int len: bytes needed, up to APP_BUFFER_EXTENDED_SIZE
+*
+* Return:
+*   void*: buffer, NULL if len is too large or the pool is exhausted
+*
+*******************************************************************************/
+void* app_alloc_buffer(int len)
+{
+    if (len < 0)
+    {
+        return NULL;
+    }
+    return app_slab_alloc(&app_buffer_pool, (size_t)len);
+}
+
+/*******************************************************************************
+* Function Name: app_free_buffer
+********************************************************************************
+* Summary:
+*   Return a buffer from app_alloc_buffer() to the buffer pool
+*
+* Parameters:
+*   uint8_t *p_event_data: buffer, NULL is ignored
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+void app_free_buffer(uint8_t *p_event_data)
+{
+    if (app_slab_free(&app_buffer_pool, p_event_data) != APP_SLAB_SUCCESS)
+    {
+        TRACE_ERR("free of foreign or free buffer %p\n", (void*)p_event_data);
+    }
+}
+
 /*******************************************************************************
 * Function Name: app_bt_management_callback
 ********************************************************************************
@@ -171,21 +618,29 @@ static wiced_result_t app_bt_management_callback(wiced_bt_management_evt_t event
     wiced_bt_device_address_t bda = { 0 };
     const uint8_t *link_key;
 
-    TRACE_LOG( "event 0x%x \n", event );
+    TRACE_DBG( "event 0x%x \n", event );
     switch (event)
     {
     case BTM_ENABLED_EVT:
         /* Bluetooth Controller and Host Stack Enabled */
         if (WICED_BT_SUCCESS == p_event_data->enabled.status)
         {
-            wiced_bt_set_local_bdaddr((uint8_t *)bt_device_address, BLE_ADDR_PUBLIC);
+            /* every stack callback runs on this thread */
+            wakeon_le_sched_hci_thread();
+            wiced_bt_set_local_bdaddr(wakeon_le_ctrl.bd_addr, BLE_ADDR_PUBLIC);
             /* Bluetooth is enabled */               
             wiced_bt_dev_read_local_addr(bda);
-            TRACE_LOG("Local Bluetooth Address:");
-            print_bd_address(bda);
+            TRACE_LOG("Local Bluetooth Address:%02X:%02X:%02X:%02X:%02X:%02X",
+                      bda[0], bda[1], bda[2], bda[3], bda[4], bda[5]);
 
             /* Perform application-specific initialization */
+            app_startup_end(APP_STARTUP_BT_ENABLED);
+            app_startup_begin(APP_STARTUP_APP_INIT);
             app_init();
+            if (app_startup_end(APP_STARTUP_APP_INIT) == APP_STARTUP_COMPLETE)
+            {
+                app_print_startup();
+            }
 
         }
         else
@@ -226,7 +681,9 @@ static wiced_result_t app_bt_management_callback(wiced_bt_management_evt_t event
 static void app_init(void)
 {
     wiced_result_t wiced_result = WICED_BT_SUCCESS;
-    if(platform_gpio_write(gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
+
+    app_scan_set_phys();
+    if(platform_gpio_write(wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
     {
         TRACE_ERR("DEV-WAKE ASSERT Failed\n");
     }
@@ -250,7 +707,7 @@ static BOOL32 app_set_sleep_mode(void)
 {
     TRACE_LOG("DEV-WAKE ASSERT FIRST\n");
     /* dev wake assert first */
-    if(platform_gpio_write(gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
+    if(platform_gpio_write(wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
     {
         TRACE_ERR("DEV-WAKE ASSERT Failed\n");
         return WICED_FALSE;
@@ -258,6 +715,7 @@ static BOOL32 app_set_sleep_mode(void)
     /* set sleep mode with param */
     if(wiced_set_sleep_mode_with_param(BTM_SLEEP_MODE_UART, WICED_SLEEP_MODE_BT_WAKE_ACT_LOW, WICED_SLEEP_MODE_HOST_WAKE_ACT_LOW, WICED_TRUE, bt_sleep_cmpl_cback) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_SLEEP_MODE]);
         TRACE_ERR("set sleep mode with param Failed");
         return WICED_FALSE;
     }
@@ -281,19 +739,21 @@ static BOOL32 app_set_sleep_mode(void)
 *******************************************************************************/
 static BOOL32 app_clear_apcf_setting(void)
 {
-    TRACE_LOG("\n");
+    TRACE_DBG("\n");
 
     /* disable apcf first */
     if (wiced_set_apcf_enable(WICED_FALSE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_ENABLE]);
         TRACE_ERR("set apcf disable Failed\n");
         return WICED_FALSE;
     }
     
     /* clear apcf filter setting */
-    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_CLEAR, apcf_filter_idx, WICED_LE_ADV_PCF_FEA_NONE,
+    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_CLEAR, wakeon_le_ctrl.apcf_filter_idx, WICED_LE_ADV_PCF_FEA_NONE,
                           WICED_LE_ADV_PCF_FEA_NONE, WICED_LE_ADV_PCF_LOGIC_AND, WICED_LE_ADV_PCF_RSSI_HIGH_THRESHOLD, WICED_LE_ADV_PCF_DELIVERY_MODE_IMMEDIATE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_FILTER_PARAM]);
         TRACE_ERR("set_apcf_filter_param Failed\n");
         return WICED_FALSE;
     }
@@ -319,18 +779,20 @@ static BOOL32 app_clear_apcf_setting(void)
 *******************************************************************************/
 BOOL32 app_set_apcf_setting()
 {
-    TRACE_LOG("\n");
+    TRACE_DBG("\n");
     /* set apcf data uuid */
-    if (wiced_set_apcf_data_uuid(uuid, WICED_LE_ADV_PCF_ACT_ADD, apcf_filter_idx) == WICED_FALSE)
+    if (wiced_set_apcf_data_uuid(wakeon_le_ctrl.uuid, WICED_LE_ADV_PCF_ACT_ADD, wakeon_le_ctrl.apcf_filter_idx) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_SRVC_UUID]);
         TRACE_ERR("set_apcf_data Failed\n");
         return WICED_FALSE;
     }
 
     /* set apcf filter param */
-    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_ADD, apcf_filter_idx, WICED_LE_ADV_PCF_FEA_SRVC_UUID,
+    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_ADD, wakeon_le_ctrl.apcf_filter_idx, WICED_LE_ADV_PCF_FEA_SRVC_UUID,
                           WICED_LE_ADV_PCF_FEA_SRVC_UUID, WICED_LE_ADV_PCF_LOGIC_AND, WICED_LE_ADV_PCF_RSSI_HIGH_THRESHOLD, WICED_LE_ADV_PCF_DELIVERY_MODE_IMMEDIATE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_FILTER_PARAM]);
         TRACE_ERR("set_apcf_filter_param Failed\n");
         return WICED_FALSE;
     }
@@ -338,6 +800,7 @@ BOOL32 app_set_apcf_setting()
     /* enable apcf */
     if(wiced_set_apcf_enable(WICED_TRUE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_ENABLE]);
         TRACE_ERR("set apcf enable Failed\n");
         return WICED_FALSE;
     }
@@ -361,20 +824,20 @@ BOOL32 app_set_apcf_setting()
 *******************************************************************************/
 void app_disable_wake_on_le()
 {
-    TRACE_LOG("\n");
-    if (inSleep == WICED_FALSE)
+    TRACE_DBG("\n");
+    if (wakeon_le_ctrl.in_sleep == WICED_FALSE)
     {
         TRACE_LOG("[%s]:Not in Sleep.\n", __FUNCTION__);
         return;
     }
 
     /* assert gpio DEV-WAKE */
-    if (platform_gpio_write(gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
+    if (platform_gpio_write(wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
     {
         TRACE_ERR("Assert DEV WAKE Failed\n");
         return;
     }
-    TRACE_LOG("Disable Le Scan\n");
+    TRACE_DBG("Disable Le Scan\n");
     /* disable le scan */
     /* wiced bt stack api */
     if (wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_NONE, WICED_TRUE, app_scan_result_cback) != 0)
@@ -382,9 +845,62 @@ void app_disable_wake_on_le()
         TRACE_ERR("Disable Le Scan Failed\n");
         return;
     }
+    APP_METRICS_INC(app_metrics.disarm_total);
+    app_metrics_set_asleep(WICED_FALSE);
+    app_publish_state_event(APP_EVENT_DISARMED, 0);
     TRACE_LOG("success\n");
 }
 
+/*******************************************************************************
+* Function Name: app_set_host_rule
+********************************************************************************
+* Summary:
+*   Mirror the APCF filter being armed into the scan worker, so reports can
+*   be tagged with the rule they match on the host side too
+*
+* Parameters:
+*   BOOL32 with_manu: the filter also carries a manufacturer data pattern
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void app_set_host_rule(BOOL32 with_manu)
+{
+    app_adv_rule_t rule;
+
+    memset(&rule, 0, sizeof(rule));
+    rule.filter_idx = wakeon_le_ctrl.apcf_filter_idx;
+    rule.uuid_len = (uint8_t)wakeon_le_ctrl.uuid.len;
+    if (wakeon_le_ctrl.uuid.len == LEN_UUID_16)
+    {
+        rule.uuid[0] = (uint8_t)wakeon_le_ctrl.uuid.uu.uuid16;
+        rule.uuid[1] = (uint8_t)(wakeon_le_ctrl.uuid.uu.uuid16 >> 8);
+    }
+    else if (wakeon_le_ctrl.uuid.len == LEN_UUID_32)
+    {
+        rule.uuid[0] = (uint8_t)wakeon_le_ctrl.uuid.uu.uuid32;
+        rule.uuid[1] = (uint8_t)(wakeon_le_ctrl.uuid.uu.uuid32 >> 8);
+        rule.uuid[2] = (uint8_t)(wakeon_le_ctrl.uuid.uu.uuid32 >> 16);
+        rule.uuid[3] = (uint8_t)(wakeon_le_ctrl.uuid.uu.uuid32 >> 24);
+    }
+    else
+    {
+        memcpy(rule.uuid, wakeon_le_ctrl.uuid.uu.uuid128, sizeof(rule.uuid));
+    }
+
+    if (with_manu)
+    {
+        rule.has_manu = 1;
+        rule.company_id = wakeon_le_ctrl.company_id;
+        rule.company_id_mask = wakeon_le_ctrl.company_id_mask;
+        rule.pattern_len = (uint8_t)((wakeon_le_ctrl.data_len < APP_ADV_MATCH_PATTERN_MAX) ? wakeon_le_ctrl.data_len : APP_ADV_MATCH_PATTERN_MAX);
+        memcpy(rule.pattern, wakeon_le_ctrl.pattern, rule.pattern_len);
+        memcpy(rule.pattern_mask, wakeon_le_ctrl.pattern_mask, rule.pattern_len);
+    }
+    wakeon_le_scan_set_rules(&rule, 1);
+}
+
 /*******************************************************************************
 * Function Name: app_enable_wake_on_ble_with_manu
 ********************************************************************************
@@ -400,8 +916,10 @@ void app_disable_wake_on_le()
 *******************************************************************************/
 void app_enable_wake_on_le_uuid_manu()
 {
-    TRACE_LOG("\n");
+    TRACE_DBG("\n");
     wiced_result_t status = WICED_BT_SUCCESS;
+    uint32_t apcf_len;
+    wakeon_le_ctrl.arm_start_ns = app_time_now_ns();
     
     /* clear apcf setting first */
     if(app_clear_apcf_setting() == WICED_FALSE)
@@ -411,23 +929,29 @@ void app_enable_wake_on_le_uuid_manu()
     }
 
     /* set apcf data uuid */
-    if (wiced_set_apcf_data_uuid(uuid, WICED_LE_ADV_PCF_ACT_ADD, apcf_filter_idx) == WICED_FALSE)
+    if (wiced_set_apcf_data_uuid(wakeon_le_ctrl.uuid, WICED_LE_ADV_PCF_ACT_ADD, wakeon_le_ctrl.apcf_filter_idx) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_SRVC_UUID]);
         TRACE_ERR("set_apcf_data Failed\n");
         return;
     }
-    memset(pattern_mask, 0xFF, sizeof(pattern_mask));
-    /* set apcf data manufacture */
-    if (wiced_set_apcf_data_manufacture(company_id, data_len, pattern, company_id_mask, pattern_mask, WICED_LE_ADV_PCF_ACT_ADD, apcf_filter_idx) == WICED_FALSE)
+    memset(wakeon_le_ctrl.pattern_mask, 0xFF, sizeof(wakeon_le_ctrl.pattern_mask));
+    /* set apcf data manufacture; a longer extended pattern is checked in
+     * full by the host, the controller filters on its first bytes */
+    apcf_len = (wakeon_le_ctrl.data_len < LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX) ? wakeon_le_ctrl.data_len
+                                                                                 : LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX;
+    if (wiced_set_apcf_data_manufacture(wakeon_le_ctrl.company_id, apcf_len, wakeon_le_ctrl.pattern, wakeon_le_ctrl.company_id_mask, wakeon_le_ctrl.pattern_mask, WICED_LE_ADV_PCF_ACT_ADD, wakeon_le_ctrl.apcf_filter_idx) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_MANU_DATA]);
         TRACE_ERR("set_apcf_data Failed\n");
         return;
     }
 
     /* set apcf filter param */
-    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_ADD, apcf_filter_idx, WICED_LE_ADV_PCF_FEA_SRVC_UUID | WICED_LE_ADV_PCF_FEA_MANU_DATA,
+    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_ADD, wakeon_le_ctrl.apcf_filter_idx, WICED_LE_ADV_PCF_FEA_SRVC_UUID | WICED_LE_ADV_PCF_FEA_MANU_DATA,
                           WICED_LE_ADV_PCF_FEA_SRVC_UUID | WICED_LE_ADV_PCF_FEA_MANU_DATA, WICED_LE_ADV_PCF_LOGIC_AND, WICED_LE_ADV_PCF_RSSI_HIGH_THRESHOLD, WICED_LE_ADV_PCF_DELIVERY_MODE_IMMEDIATE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_FILTER_PARAM]);
         TRACE_ERR("set_apcf_filter_param Failed\n");
         return;
     }
@@ -435,11 +959,15 @@ void app_enable_wake_on_le_uuid_manu()
     /* enable apcf */
     if(wiced_set_apcf_enable(WICED_TRUE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_ENABLE]);
         TRACE_ERR("set apcf enable Failed\n");
         return;
     }
 
-    /* enable ble scan */
+    app_set_host_rule(WICED_TRUE);
+
+    /* enable ble scan, at this radio's phase; the wait is not arm latency */
+    wakeon_le_ctrl.arm_start_ns += app_wait_scan_phase();
     /* wiced bt stack api */
     status = wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_LOW_DUTY, WICED_TRUE, app_scan_result_cback);
     if ((WICED_BT_PENDING != status ) && ( WICED_BT_BUSY != status))
@@ -472,8 +1000,9 @@ void app_enable_wake_on_le_uuid_manu()
 *******************************************************************************/
 void app_enable_wake_on_le_uuid()
 {
-    TRACE_LOG("\n");
+    TRACE_DBG("\n");
     wiced_result_t status = WICED_BT_SUCCESS;
+    wakeon_le_ctrl.arm_start_ns = app_time_now_ns();
 
     /* clear apcf first */
     if(app_clear_apcf_setting() == WICED_FALSE)
@@ -483,16 +1012,18 @@ void app_enable_wake_on_le_uuid()
     }
 
     /* set apcf data uuid */
-    if (wiced_set_apcf_data_uuid(uuid, WICED_LE_ADV_PCF_ACT_ADD, apcf_filter_idx) == WICED_FALSE)
+    if (wiced_set_apcf_data_uuid(wakeon_le_ctrl.uuid, WICED_LE_ADV_PCF_ACT_ADD, wakeon_le_ctrl.apcf_filter_idx) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_SRVC_UUID]);
         TRACE_ERR("set_apcf_data Failed\n");
         return;
     }
 
     /* set apcf filter param */
-    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_ADD, apcf_filter_idx, WICED_LE_ADV_PCF_FEA_SRVC_UUID,
+    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_ADD, wakeon_le_ctrl.apcf_filter_idx, WICED_LE_ADV_PCF_FEA_SRVC_UUID,
                           WICED_LE_ADV_PCF_FEA_SRVC_UUID, WICED_LE_ADV_PCF_LOGIC_AND, WICED_LE_ADV_PCF_RSSI_HIGH_THRESHOLD, WICED_LE_ADV_PCF_DELIVERY_MODE_IMMEDIATE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_FILTER_PARAM]);
         TRACE_ERR("set_apcf_filter_param Failed\n");
         return;
     }
@@ -500,11 +1031,15 @@ void app_enable_wake_on_le_uuid()
     /* enable apcf */
     if (wiced_set_apcf_enable(WICED_TRUE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_ENABLE]);
         TRACE_ERR("set apcf enable Failed\n");
         return;
     }
 
-    /* enable ble scan */
+    app_set_host_rule(WICED_FALSE);
+
+    /* enable ble scan, at this radio's phase; the wait is not arm latency */
+    wakeon_le_ctrl.arm_start_ns += app_wait_scan_phase();
     /* wiced bt stack api */
     status = wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_LOW_DUTY, WICED_TRUE, app_scan_result_cback);
     if ((WICED_BT_PENDING != status ) && ( WICED_BT_BUSY != status))
@@ -522,6 +1057,133 @@ void app_enable_wake_on_le_uuid()
     TRACE_LOG("success\n");
 }
 
+/*******************************************************************************
+* Function Name: app_hex_to_bytes
+********************************************************************************
+* Summary:
+*   Parse a hex string, with optional spaces between the bytes
+*
+* Return:
+*   int: bytes written, -1 if the text is not hex or longer than max
+*
+*******************************************************************************/
+static int app_hex_to_bytes(const char* p_text, const char* p_end, uint8_t* p_out, uint32_t max)
+{
+    uint32_t len = 0;
+    unsigned int byte;
+
+    while (p_text < p_end)
+    {
+        if (*p_text == ' ')
+        {
+            p_text++;
+            continue;
+        }
+        if ((p_end - p_text < 2) || (len >= max) || (sscanf(p_text, "%2x", &byte) != 1) ||
+            !isxdigit((unsigned char)p_text[0]) || !isxdigit((unsigned char)p_text[1]))
+        {
+            return -1;
+        }
+        p_out[len++] = (uint8_t)byte;
+        p_text += 2;
+    }
+    return (int)len;
+}
+
+/*******************************************************************************
+* Function Name: app_enable_wake_on_le_rule
+********************************************************************************
+* Summary:
+*   Arm the rule of an --arm option, "<uuid>[:<pattern>]" in hex: a 16 or
+*   32 bit UUID as typed for menu options 3 and 4, and optionally the
+*   manufacturer data pattern of menu option 5
+*
+* Parameters:
+*   const char* p_rule: rule text
+*
+* Return:
+*   BOOL32: WICED_FALSE if the rule is malformed or the controller is
+*           already armed
+*
+*******************************************************************************/
+BOOL32 app_enable_wake_on_le_rule(const char* p_rule)
+{
+    const char* p_sep = strchr(p_rule, ':');
+    const char* p_uuid_end = (p_sep != NULL) ? p_sep : p_rule + strlen(p_rule);
+    uint8_t bytes[LEN_UUID_32];
+    int uuid_len, pattern_len = 0;
+
+    if (wakeon_le_ctrl.in_sleep == WICED_TRUE)
+    {
+        TRACE_ERR("already armed\n");
+        return WICED_FALSE;
+    }
+    uuid_len = app_hex_to_bytes(p_rule, p_uuid_end, bytes, sizeof(bytes));
+    if (p_sep != NULL)
+    {
+        /* only extended advertisements carry more than the controller filter checks */
+        pattern_len = app_hex_to_bytes(p_sep + 1, p_sep + strlen(p_sep), wakeon_le_ctrl.pattern,
+                                       (scan_phys != 0) ? LE_EXT_MANUFACTURE_DATA_PATTERN_LEN_MAX
+                                                        : LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX);
+    }
+    if (((uuid_len != LEN_UUID_16) && (uuid_len != LEN_UUID_32)) || (pattern_len < 0))
+    {
+        TRACE_ERR("bad rule %s, expected <16 or 32 bit uuid>[:<pattern up to %u bytes>] in hex\n", p_rule,
+                  (scan_phys != 0) ? LE_EXT_MANUFACTURE_DATA_PATTERN_LEN_MAX : LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX);
+        return WICED_FALSE;
+    }
+
+    memset(&wakeon_le_ctrl.uuid, 0, sizeof(wakeon_le_ctrl.uuid));
+    wakeon_le_ctrl.uuid.len = (uint16_t)uuid_len;
+    if (uuid_len == LEN_UUID_16)
+    {
+        wakeon_le_ctrl.uuid.uu.uuid16 = (uint16_t)((bytes[0] << 8) | bytes[1]);
+    }
+    else
+    {
+        wakeon_le_ctrl.uuid.uu.uuid32 = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) |
+                                        ((uint32_t)bytes[2] << 8) | bytes[3];
+    }
+    wakeon_le_ctrl.data_len = (uint32_t)pattern_len;
+    TRACE_LOG("arming %s\n", p_rule);
+    if (p_sep != NULL)
+    {
+        app_enable_wake_on_le_uuid_manu();
+    }
+    else
+    {
+        app_enable_wake_on_le_uuid();
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: app_publish_state_event
+********************************************************************************
+* Summary:
+*   Publish an arm/disarm/wake record to the shared memory event ring and
+*   the JSON lines output
+*
+* Parameters:
+*   app_event_type_t type: event type
+*   uint64_t latency_ns:   arm or wake path duration, 0 if n/a
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void app_publish_state_event(app_event_type_t type, uint64_t latency_ns)
+{
+    app_event_t event;
+
+    memset(&event, 0, offsetof(app_event_t, adv_data));
+    event.type = type;
+    event.filter_idx = wakeon_le_ctrl.apcf_filter_idx;
+    event.latency_ns = latency_ns;
+    app_event_ring_publish(&event);
+    app_event_json_write(&event);
+}
+
 /*******************************************************************************
 * Function Name: app_scan_result_cback
 ********************************************************************************
@@ -542,10 +1204,19 @@ void app_enable_wake_on_le_uuid()
 *******************************************************************************/
 static void app_scan_result_cback(wiced_bt_ble_scan_results_t* p_scan_result, uint8_t* p_adv_data)
 {
+    uint16_t adv_len;
+
     if (p_scan_result)
     {
-        TRACE_LOG("Got ADV from: %s\n", p_scan_result->remote_bd_addr);
-	print_bd_address(p_scan_result->remote_bd_addr);
+#if defined(WAKEONLE_EXT_SCAN) && WAKEONLE_EXT_SCAN
+        /* extended reports come with the length of the data the stack reassembled */
+        adv_len = (scan_phys != 0) ? p_scan_result->adv_data_len : WAKEON_LE_SCAN_ADV_DATA_MAX;
+#else
+        /* legacy reports: the stack's buffer holds the 31 bytes of the PDU */
+        adv_len = WAKEON_LE_SCAN_ADV_DATA_MAX;
+#endif
+        /* runs on the stack thread: queue it, the scan worker does the rest */
+        wakeon_le_scan_submit(p_scan_result, p_adv_data, adv_len);
     } else {
         TRACE_LOG("Scan completed:\n");
     }
@@ -574,33 +1245,44 @@ static void bt_sleep_cmpl_cback(tBTM_VSC_CMPL *p_params)
         TRACE_ERR("p_params is NULL\n");
         return;
     }
-    TRACE_LOG("opcode: %x, param_len:%d\n", p_params->opcode, p_params->param_len);
+    TRACE_DBG("opcode: %x, param_len:%d\n", p_params->opcode, p_params->param_len);
     uint8_t  status = 0;
     uint8_t  *p = p_params->p_param_buf, op_subcode, action = 0xff;
+    uint64_t latency_ns;
     STREAM_TO_UINT8(status, p);
     
     if (status == HCI_SUCCESS) 
     {
 	TRACE_LOG("set sleep mode success \n");
  	TRACE_LOG("Ready Enter UART Sleep Mode\n");
-        if (platform_gpio_write(gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_DEASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
+        if (platform_gpio_write(wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_DEASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
         {
 	    TRACE_ERR("Deassert DEV WAKE Failed\n");
             return;
         }
-	gpio_cfg.wake_on_ble_cfg.host_wake_args.gpio_event_cb = &bt_host_wake_assert_cback;
-        gpio_cfg.wake_on_ble_cfg.host_wake_args.gpio_event_flag = GPIOEVENT_REQUEST_FALLING_EDGE;
-	if (platform_gpio_poll(&(gpio_cfg.wake_on_ble_cfg.host_wake_args)) == WICED_FALSE)
+	wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.host_wake_args.gpio_event_cb = &bt_host_wake_assert_cback;
+        wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.host_wake_args.gpio_event_flag = GPIOEVENT_REQUEST_FALLING_EDGE;
+        /* the host-wake thread inherits the --rt-gpio scheduling */
+        wakeon_le_sched_gpio_begin();
+	if (platform_gpio_poll(&(wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.host_wake_args)) == WICED_FALSE)
         {
+            wakeon_le_sched_gpio_end();
             TRACE_ERR("Monitor host-wake Failed\n");
             return;
         }
+        wakeon_le_sched_gpio_end();
     } else {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_SLEEP_MODE]);
         TRACE_ERR("Set Sleep Mode Param Failed, status:%d\n", status);
         return;
     }
     
-    inSleep = WICED_TRUE;
+    latency_ns = app_time_now_ns() - wakeon_le_ctrl.arm_start_ns;
+    wakeon_le_ctrl.in_sleep = WICED_TRUE;
+    APP_METRICS_INC(app_metrics.arm_total);
+    app_metrics_hist_observe(&app_metrics.arm_latency, latency_ns);
+    app_metrics_set_asleep(WICED_TRUE);
+    app_publish_state_event(APP_EVENT_ARMED, latency_ns);
 }
 
 /*******************************************************************************
@@ -608,7 +1290,8 @@ static void bt_sleep_cmpl_cback(tBTM_VSC_CMPL *p_params)
 ********************************************************************************
 * Summary:
 *   Callback function when host-wake assert, assert Dev-Wake, let Controller 
-*   leave sleep mode, and stop le-scan
+*   leave sleep mode, and stop le-scan. The wake event is published after
+*   the scan stop.
 *
 * Parameters:
 *   None
@@ -619,32 +1302,59 @@ static void bt_sleep_cmpl_cback(tBTM_VSC_CMPL *p_params)
 *******************************************************************************/
 static void bt_host_wake_assert_cback()
 {
+    uint64_t wake_start_ns = app_time_now_ns();
+    BOOL32 scan_disabled = WICED_FALSE;
+
+    wakeon_le_ctrl.wake_ns = wake_start_ns;
+    if (wakeon_le_ctrl.in_sleep == WICED_TRUE)
+    {
+        APP_METRICS_INC(app_metrics.wake_total);
+        APP_METRICS_INC(app_metrics.filter_hits[wakeon_le_ctrl.apcf_filter_idx % APP_METRICS_FILTER_MAX]);
+    }
+    else
+    {
+        APP_METRICS_INC(app_metrics.spurious_wake_total);
+    }
     TRACE_LOG("HOST WAKE ASSERT\n");
-    if (platform_gpio_write(gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
+    if (platform_gpio_write(wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.p_gpiochip, wakeon_le_ctrl.gpio_cfg.wake_on_ble_cfg.dev_wake.line_num, GPIO_ASSERT(WICED_SLEEP_MODE_BT_WAKE_ACT_LOW), "DEV-WAKE") == WICED_FALSE)
     {
 	TRACE_ERR("assert DEV WAKE Failed\n");
-        return;
     }
-    TRACE_LOG("Disable Le scan\n");
-    /* disable le scan */
-    /* wiced bt stack api */
-    if (wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_NONE, WICED_TRUE, app_scan_result_cback) != 0)
+    else
+    {
+        TRACE_LOG("Disable Le scan\n");
+        /* disable le scan */
+        /* wiced bt stack api */
+        if (wiced_bt_ble_scan(BTM_BLE_SCAN_TYPE_NONE, WICED_TRUE, app_scan_result_cback) != 0)
+        {
+            TRACE_ERR("disable ble scan Failed\n");
+        }
+        else
+        {
+            scan_disabled = WICED_TRUE;
+        }
+    }
+    /* only once DEV-WAKE is asserted and the scan stopped, so the event
+     * outputs never delay them */
+    app_publish_state_event(APP_EVENT_WAKE, 0);
+    if (scan_disabled == WICED_FALSE)
     {
-        TRACE_ERR("disable ble scan Failed\n");
         return;
     }
 
     /* disable apcf first */
     if (wiced_set_apcf_enable(WICED_FALSE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_ENABLE]);
         TRACE_ERR("set apcf disable Failed\n");
         return;
     }
 
     /* clear apcf filter setting */
-    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_CLEAR, apcf_filter_idx, WICED_LE_ADV_PCF_FEA_NONE,
+    if (wiced_set_apcf_filter_param(WICED_LE_ADV_PCF_ACT_CLEAR, wakeon_le_ctrl.apcf_filter_idx, WICED_LE_ADV_PCF_FEA_NONE,
                           WICED_LE_ADV_PCF_FEA_NONE, WICED_LE_ADV_PCF_LOGIC_AND, WICED_LE_ADV_PCF_RSSI_HIGH_THRESHOLD, WICED_LE_ADV_PCF_DELIVERY_MODE_IMMEDIATE) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_APCF_FILTER_PARAM]);
         TRACE_ERR("set_apcf_filter_param Failed\n");
         return;
     }
@@ -652,11 +1362,15 @@ static void bt_host_wake_assert_cback()
     /* disable sleep mode */
     if(wiced_set_sleep_mode_with_param(BTM_SLEEP_MODE_NONE, WICED_SLEEP_MODE_BT_WAKE_ACT_LOW, WICED_SLEEP_MODE_HOST_WAKE_ACT_LOW, WICED_FALSE, NULL) == WICED_FALSE)
     {
+        APP_METRICS_INC(app_metrics.vsc_failures[APP_METRICS_VSC_SLEEP_MODE]);
         TRACE_ERR("set sleep mode with param Failed");
         return;
     }
 
-    inSleep = WICED_FALSE;
+    wakeon_le_ctrl.in_sleep = WICED_FALSE;
+    app_metrics_set_asleep(WICED_FALSE);
+    app_metrics_hist_observe(&app_metrics.wake_latency, app_time_now_ns() - wake_start_ns);
+    wakeon_le_sched_gpio_check();
 }
 
 /* END OF FILE [] */
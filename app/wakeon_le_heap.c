@@ -0,0 +1,271 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: wakeon_le_heap.c
+ *
+ * Description: This is the source file for the BT stack heap accounting.
+ *              The stack keeps per heap statistics (current use, high-water
+ *              mark, failed allocations); this module exports them as
+ *              metrics for every heap it created. In calibration mode the
+ *              default heap is made large and a thread periodically prints
+ *              the high-water mark with the rule count and scan rate it was
+ *              reached under, and the --heap-size that would have sufficed.
+ *
+ * Related Document: See README.md
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+*******************************************************************************
+*      INCLUDES
+*******************************************************************************/
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "wiced_memory.h"
+#include "data_types.h"
+#include "app_metrics.h"
+#include "app_time.h"
+#include "wakeon_le_scan.h"
+#include "wakeon_le_heap.h"
+#include "log.h"
+
+#ifdef TAG
+#undef TAG
+#endif
+#define TAG "[WAKEONLE_HEAP]"
+
+/*******************************************************************************
+*       MACROS
+*******************************************************************************/
+/* recommended size granularity */
+#define HEAP_RECOMMEND_ALIGN        (1024U)
+
+/*******************************************************************************
+*       STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    const char*         name;
+    wiced_bt_heap_t*    p_heap;
+} heap_entry_t;
+
+/*******************************************************************************
+*       VARIABLE DEFINITIONS
+*******************************************************************************/
+static heap_entry_t     heaps[WAKEON_LE_HEAP_MAX];
+static uint32_t         num_heaps = 0;
+static wiced_bt_heap_t* p_calibrate_heap = NULL;
+static uint32_t         calibrate_interval_s = 0;
+static pthread_t        calibrate_thread;
+
+/*******************************************************************************
+*       FUNCTION DEFINITION
+*******************************************************************************/
+/*******************************************************************************
+* Function Name: wakeon_le_heap_recommend
+********************************************************************************
+* Summary:
+*   Heap size that covers the observed high-water mark with headroom for
+*   fragmentation: a quarter more, and at least two of the largest single
+*   allocation seen
+*
+* Parameters:
+*   const wiced_bt_heap_statistics_t* p_stats: heap statistics
+*
+* Return:
+*   uint32_t: recommended size in bytes
+*
+*******************************************************************************/
+uint32_t wakeon_le_heap_recommend(const wiced_bt_heap_statistics_t* p_stats)
+{
+    uint32_t headroom = p_stats->max_heap_size_used / 4U;
+    uint32_t size;
+
+    if (headroom < 2U * p_stats->max_single_allocation)
+    {
+        headroom = 2U * p_stats->max_single_allocation;
+    }
+    size = p_stats->max_heap_size_used + headroom;
+    return (size + HEAP_RECOMMEND_ALIGN - 1U) & ~(HEAP_RECOMMEND_ALIGN - 1U);
+}
+
+/*******************************************************************************
+* Function Name: heap_metrics_collector
+********************************************************************************
+* Summary:
+*   Export the statistics of every tracked heap with the application metrics
+*
+*******************************************************************************/
+static void heap_metrics_collector(app_metrics_buf_t* p_out)
+{
+    uint32_t n = __atomic_load_n(&num_heaps, __ATOMIC_ACQUIRE);
+    wiced_bt_heap_statistics_t stats[WAKEON_LE_HEAP_MAX];
+    BOOL32 valid[WAKEON_LE_HEAP_MAX];
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        memset(&stats[i], 0, sizeof(stats[i]));
+        valid[i] = (wiced_bt_get_heap_statistics(heaps[i].p_heap, &stats[i]) == WICED_TRUE);
+    }
+
+#define HEAP_METRIC(name_, type_, help_, field_)                                                \
+    app_metrics_printf(p_out, "# HELP " name_ " " help_ "\n# TYPE " name_ " " type_ "\n");     \
+    for (i = 0; i < n; i++)                                                                     \
+    {                                                                                           \
+        if (valid[i])                                                                           \
+        {                                                                                       \
+            app_metrics_printf(p_out, name_ "{heap=\"%s\"} %u\n", heaps[i].name, (unsigned)(field_)); \
+        }                                                                                       \
+    }
+
+    HEAP_METRIC("wakeonle_heap_size_bytes", "gauge", "Heap size", stats[i].heap_size)
+    HEAP_METRIC("wakeonle_heap_used_bytes", "gauge", "Bytes currently allocated", stats[i].current_size_allocated)
+    HEAP_METRIC("wakeonle_heap_high_water_bytes", "gauge", "Most bytes allocated at once", stats[i].max_heap_size_used)
+    HEAP_METRIC("wakeonle_heap_allocations", "gauge", "Buffers currently allocated", stats[i].current_num_allocations)
+    HEAP_METRIC("wakeonle_heap_largest_free_bytes", "gauge", "Largest free block", stats[i].current_largest_free_size)
+    HEAP_METRIC("wakeonle_heap_alloc_failures_total", "counter", "Allocations that found no free block", stats[i].allocation_failure_count)
+    HEAP_METRIC("wakeonle_heap_recommended_bytes", "gauge", "Heap size covering the high-water mark with headroom", wakeon_le_heap_recommend(&stats[i]))
+
+#undef HEAP_METRIC
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_heap_create
+********************************************************************************
+* Summary:
+*   wiced_bt_create_heap() and track the heap in the metrics
+*
+* Parameters:
+*   const char* name:          heap name, also the metrics label; must stay valid
+*   uint32_t size:             heap size in bytes
+*   wiced_bool_t make_default: make it the default heap of the stack
+*
+* Return:
+*   wiced_bt_heap_t*: heap, NULL on failure
+*
+*******************************************************************************/
+wiced_bt_heap_t* wakeon_le_heap_create(const char* name, uint32_t size, wiced_bool_t make_default)
+{
+    wiced_bt_heap_t* p_heap = wiced_bt_create_heap(name, NULL, (int)size, NULL, make_default);
+
+    if ((p_heap == NULL) || (num_heaps >= WAKEON_LE_HEAP_MAX))
+    {
+        return p_heap;
+    }
+
+    heaps[num_heaps].name = name;
+    heaps[num_heaps].p_heap = p_heap;
+    __atomic_store_n(&num_heaps, num_heaps + 1, __ATOMIC_RELEASE);
+    if (num_heaps == 1)
+    {
+        app_metrics_register_collector(heap_metrics_collector);
+    }
+    return p_heap;
+}
+
+/*******************************************************************************
+* Function Name: heap_calibrate_main
+********************************************************************************
+* Summary:
+*   Calibration thread: report the heap use every interval while it grows
+*
+*******************************************************************************/
+static void* heap_calibrate_main(void* p_arg)
+{
+    struct timespec interval = { (time_t)calibrate_interval_s, 0 };
+    wiced_bt_heap_statistics_t stats;
+    uint32_t last_high_water = UINT32_MAX;
+    uint64_t reports, last_reports = __atomic_load_n(&app_metrics.scan_reports_total, __ATOMIC_RELAXED);
+    uint64_t now, last_ns = app_time_now_ns();
+
+    (void)p_arg;
+    for (;;)
+    {
+        nanosleep(&interval, NULL);
+        memset(&stats, 0, sizeof(stats));
+        if (wiced_bt_get_heap_statistics(p_calibrate_heap, &stats) != WICED_TRUE)
+        {
+            continue;
+        }
+        now = app_time_now_ns();
+        reports = __atomic_load_n(&app_metrics.scan_reports_total, __ATOMIC_RELAXED);
+        if (stats.max_heap_size_used != last_high_water)
+        {
+            TRACE_MSG("heap calibration: high water %u of %u bytes, largest allocation %u, %u failures, "
+                      "%u host rules, %llu reports/s -> --heap-size %u\n",
+                      (unsigned)stats.max_heap_size_used, (unsigned)stats.heap_size,
+                      (unsigned)stats.max_single_allocation, (unsigned)stats.allocation_failure_count,
+                      (unsigned)wakeon_le_scan_rule_count(),
+                      (unsigned long long)((reports - last_reports) * APP_TIME_NS_PER_SEC / (now - last_ns + 1)),
+                      (unsigned)wakeon_le_heap_recommend(&stats));
+            last_high_water = stats.max_heap_size_used;
+        }
+        last_reports = reports;
+        last_ns = now;
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_heap_calibrate_start
+********************************************************************************
+* Summary:
+*   Start reporting the high-water mark of a heap every interval_s seconds.
+*   Exercise the scenario to size for (rules armed, expected scan load)
+*   and use the last recommendation.
+*
+* Parameters:
+*   wiced_bt_heap_t* p_heap: heap to watch
+*   uint32_t interval_s:     report interval
+*
+* Return:
+*   BOOL32: WICED_TRUE on success
+*
+*******************************************************************************/
+BOOL32 wakeon_le_heap_calibrate_start(wiced_bt_heap_t* p_heap, uint32_t interval_s)
+{
+    p_calibrate_heap = p_heap;
+    calibrate_interval_s = (interval_s == 0) ? 1U : interval_s;
+    if (pthread_create(&calibrate_thread, NULL, heap_calibrate_main, NULL) != 0)
+    {
+        TRACE_ERR("heap calibration thread create failed\n");
+        return WICED_FALSE;
+    }
+    pthread_detach(calibrate_thread);
+    return WICED_TRUE;
+}
+
+/* END OF FILE [] */
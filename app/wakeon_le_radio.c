@@ -0,0 +1,608 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: wakeon_le_radio.c
+ *
+ * Description: This is the source file for the multi-radio supervisor.
+ *
+ *              The radio list (--radios) has one radio per line: a name,
+ *              then the porting layer arguments and application options of
+ *              that radio, eg:
+ *
+ *                left  -c /dev/ttyS1 -p fw.hcd -w gpiochip0 5 -h gpiochip0 6 --arm AABB
+ *
+ *              Each radio runs as a child process of this executable with
+ *              the supervisor's own options, its line and --radio-name. The
+ *              outputs a process owns, the event ring, metrics socket, JSON
+ *              file, btsnoop and report capture, get ".<name>" appended, so
+ *              the radios do not share them. With several radios, each also
+ *              gets --stagger <index>/<count>, so their scan windows take
+ *              turns (app_scan_stagger.c). A child that exits on its own
+ *              is restarted after a delay that doubles, up to a limit, while
+ *              it keeps failing.
+ *
+ *              A child started with --radio-name has no menu: it arms --arm
+ *              once the controller is up, re-arms it --rearm seconds after
+ *              each wake and runs until SIGINT or SIGTERM.
+ *
+ * Related Document: See README.md
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+*******************************************************************************
+*      INCLUDES
+*******************************************************************************/
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "app_opts.h"
+#include "app_scan_stagger.h"
+#include "app_time.h"
+#include "wakeon_le.h"
+#include "wakeon_le_radio.h"
+#include "log.h"
+
+#ifdef TAG
+#undef TAG
+#endif
+#define TAG "[WAKEONLE_RADIO]"
+
+/*******************************************************************************
+*       MACROS
+*******************************************************************************/
+#define RADIO_LINE_MAX              (1024U)
+#define RADIO_ARGS_MAX              (128U)
+/* restart delay of a failing radio, doubled per failure */
+#define RADIO_BACKOFF_MIN_S         (1U)
+#define RADIO_BACKOFF_MAX_S         (30U)
+/* a radio that ran this long starts over at the minimum delay */
+#define RADIO_STABLE_S              (60U)
+/* SIGTERM to SIGKILL at shutdown */
+#define RADIO_STOP_TIMEOUT_S        (5U)
+#define RADIO_POLL_NS               (200000000L)
+#define RADIO_NS_PER_S              (1000000000ULL)
+#define RADIO_STAGGER_MAX           (16U)
+
+/* advertising intervals the scan schedule is modelled for */
+#define RADIO_MODEL_ADV_MS          { 100U, 1000U }
+
+/*******************************************************************************
+*       STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    char*       p_name;
+    char*       p_line;                     /* arguments from the radio list */
+    char*       p_args[RADIO_ARGS_MAX];     /* child argv, NULL terminated */
+    pid_t       pid;                        /* 0 when not running */
+    uint64_t    start_ns;
+    uint64_t    restart_ns;                 /* restart due, 0 for none */
+    uint32_t    backoff_s;
+    uint32_t    restarts;
+} radio_t;
+
+/*******************************************************************************
+*       VARIABLE DEFINITIONS
+*******************************************************************************/
+static radio_t                  radios[WAKEON_LE_RADIO_MAX];
+static uint32_t                 num_radios = 0;
+static volatile sig_atomic_t    radio_stop = 0;
+
+/* options whose value names something one process owns */
+static const char* const radio_owned_opts[] =
+{
+    "--event-ring", "--metrics", "--json", "--btsnoop", "--capture"
+};
+
+/*******************************************************************************
+*       FUNCTION DEFINITION
+*******************************************************************************/
+static void radio_signal_handler(int sig)
+{
+    (void)sig;
+    radio_stop = 1;
+}
+
+static void radio_catch_signals(void)
+{
+    struct sigaction action;
+
+    /* no SA_RESTART: the waits return at once */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = radio_signal_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+static void radio_sleep_ns(long ns)
+{
+    struct timespec ts = { 0, ns };
+
+    nanosleep(&ts, NULL);
+}
+
+/*******************************************************************************
+* Function Name: radio_add_arg
+********************************************************************************
+* Summary:
+*   Append one argument to a radio's command line
+*
+*******************************************************************************/
+static BOOL32 radio_add_arg(radio_t* p_radio, uint32_t* p_count, char* p_arg)
+{
+    if ((p_arg == NULL) || (*p_count + 1U >= RADIO_ARGS_MAX))
+    {
+        TRACE_ERR("radio %s: too many arguments\n", p_radio->p_name);
+        return WICED_FALSE;
+    }
+    p_radio->p_args[(*p_count)++] = p_arg;
+    p_radio->p_args[*p_count] = NULL;
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: radio_forward_opt
+********************************************************************************
+* Summary:
+*   Copy one supervisor option to a radio, with ".<name>" appended to the
+*   value if it names an output the process owns
+*
+*******************************************************************************/
+static BOOL32 radio_forward_opt(radio_t* p_radio, uint32_t* p_count, char* p_opt, char* p_value)
+{
+    char* p_owned;
+    size_t len;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(radio_owned_opts) / sizeof(radio_owned_opts[0]); i++)
+    {
+        /* JSON lines on stdout can be shared, each is one write() */
+        if ((strcmp(p_opt, radio_owned_opts[i]) != 0) || (strcmp(p_value, "-") == 0))
+        {
+            continue;
+        }
+        len = strlen(p_value) + strlen(p_radio->p_name) + 2U;
+        p_owned = malloc(len);
+        if (p_owned != NULL)
+        {
+            snprintf(p_owned, len, "%s.%s", p_value, p_radio->p_name);
+        }
+        p_value = p_owned;
+        break;
+    }
+    return (radio_add_arg(p_radio, p_count, p_opt) && radio_add_arg(p_radio, p_count, p_value)) ? WICED_TRUE
+                                                                                                  : WICED_FALSE;
+}
+
+/*******************************************************************************
+* Function Name: radio_build_args
+********************************************************************************
+* Summary:
+*   Build the command line of a radio: the supervisor's options, its name,
+*   its scan phase if there are several radios, then its line
+*
+* Parameters:
+*   radio_t* p_radio: radio
+*   uint32_t index:   position in the radio list
+*   int argc:         supervisor arguments, before the option parser
+*   char* argv[]:
+*
+* Return:
+*   BOOL32: WICED_FALSE if the command line is too long
+*
+*******************************************************************************/
+static BOOL32 radio_build_args(radio_t* p_radio, uint32_t index, int argc, char* argv[])
+{
+    char stagger[RADIO_STAGGER_MAX];
+    char *p_tok, *p_save = NULL;
+    uint32_t count = 0;
+    int i;
+
+    radio_add_arg(p_radio, &count, argv[0]);
+    /* every application option takes a value */
+    for (i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--radios") == 0)
+        {
+            continue;
+        }
+        if (radio_forward_opt(p_radio, &count, argv[i], argv[i + 1]) == WICED_FALSE)
+        {
+            return WICED_FALSE;
+        }
+    }
+    radio_add_arg(p_radio, &count, "--radio-name");
+    radio_add_arg(p_radio, &count, p_radio->p_name);
+    if (num_radios > 1)
+    {
+        snprintf(stagger, sizeof(stagger), "%u/%u", index, num_radios);
+        radio_add_arg(p_radio, &count, "--stagger");
+        radio_add_arg(p_radio, &count, strdup(stagger));
+    }
+    /* the radio's own options come last and win */
+    for (p_tok = strtok_r(p_radio->p_line, " \t", &p_save); p_tok != NULL; p_tok = strtok_r(NULL, " \t", &p_save))
+    {
+        if (radio_add_arg(p_radio, &count, p_tok) == WICED_FALSE)
+        {
+            return WICED_FALSE;
+        }
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: radio_load
+********************************************************************************
+* Summary:
+*   Read the radio list and build the command line of every radio
+*
+* Parameters:
+*   const char* path: radio list
+*   int argc:         supervisor arguments, before the option parser
+*   char* argv[]:
+*
+* Return:
+*   BOOL32: WICED_TRUE if at least one radio was read and all are valid
+*
+*******************************************************************************/
+static BOOL32 radio_load(const char* path, int argc, char* argv[])
+{
+    char line[RADIO_LINE_MAX];
+    char *p_copy, *p_name, *p_save;
+    uint32_t line_num = 0, r;
+    FILE* fp;
+
+    fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        TRACE_ERR("open radio list %s failed\n", path);
+        return WICED_FALSE;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        line_num++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        p_copy = strdup(line);
+        p_name = (p_copy != NULL) ? strtok_r(p_copy, " \t", &p_save) : NULL;
+        if (p_name == NULL)
+        {
+            free(p_copy);
+            continue;
+        }
+        if (num_radios == WAKEON_LE_RADIO_MAX)
+        {
+            TRACE_ERR("%s:%u: more than %u radios\n", path, line_num, WAKEON_LE_RADIO_MAX);
+            fclose(fp);
+            return WICED_FALSE;
+        }
+        for (r = 0; r < num_radios; r++)
+        {
+            if (strcmp(radios[r].p_name, p_name) == 0)
+            {
+                TRACE_ERR("%s:%u: radio %s listed twice\n", path, line_num, p_name);
+                fclose(fp);
+                return WICED_FALSE;
+            }
+        }
+        memset(&radios[num_radios], 0, sizeof(radios[num_radios]));
+        radios[num_radios].p_name = p_name;
+        radios[num_radios].p_line = p_save;
+        radios[num_radios].backoff_s = RADIO_BACKOFF_MIN_S;
+        num_radios++;
+    }
+    fclose(fp);
+    if (num_radios == 0)
+    {
+        TRACE_ERR("no radios in %s\n", path);
+        return WICED_FALSE;
+    }
+    for (r = 0; r < num_radios; r++)
+    {
+        if (radio_build_args(&radios[r], r, argc, argv) == WICED_FALSE)
+        {
+            return WICED_FALSE;
+        }
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: radio_print_schedule
+********************************************************************************
+* Summary:
+*   Print the duty cycles of the staggered scan schedule and the detection
+*   latency it models, next to one radio alone, for the supervisor's
+*   --scan-interval and --scan-window
+*
+*******************************************************************************/
+static void radio_print_schedule(void)
+{
+    const uint32_t adv_ms[] = RADIO_MODEL_ADV_MS;
+    uint32_t interval = (app_opts.scan_interval != 0) ? app_opts.scan_interval
+                                                      : cy_bt_cfg_scan_settings.low_duty_scan_interval;
+    uint32_t window = (app_opts.scan_window != 0) ? app_opts.scan_window : cy_bt_cfg_scan_settings.low_duty_scan_window;
+    app_scan_stagger_model_t all, one;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(adv_ms) / sizeof(adv_ms[0]); i++)
+    {
+        if ((app_scan_stagger_model(interval, window, num_radios, adv_ms[i], &all) != APP_SCAN_STAGGER_SUCCESS) ||
+            (app_scan_stagger_model(interval, window, 1, adv_ms[i], &one) != APP_SCAN_STAGGER_SUCCESS))
+        {
+            return;
+        }
+        if (i == 0)
+        {
+            TRACE_MSG("Scan schedule: %u radios, window %.1f of %.1f ms, %.1f%% duty each, %.1f%% combined",
+                      num_radios, window * 0.625, interval * 0.625, 100.0 * all.radio_duty, 100.0 * all.combined_duty);
+        }
+        TRACE_MSG("  %4u ms advertiser: detected in %.0f ms mean, %.0f ms p99 (one radio: %.0f ms mean, %.0f ms p99)",
+                  adv_ms[i], all.mean_ms, all.p99_ms, one.mean_ms, one.p99_ms);
+    }
+}
+
+/*******************************************************************************
+* Function Name: radio_spawn
+********************************************************************************
+* Summary:
+*   Start the process of one radio
+*
+*******************************************************************************/
+static void radio_spawn(radio_t* p_radio)
+{
+    pid_t supervisor = getpid();
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        /* the radios go down with the supervisor */
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (getppid() != supervisor)
+        {
+            _exit(EXIT_FAILURE);
+        }
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        execv("/proc/self/exe", p_radio->p_args);
+        _exit(EXIT_FAILURE);
+    }
+    if (pid < 0)
+    {
+        TRACE_ERR("radio %s: fork failed, errno %d\n", p_radio->p_name, errno);
+        p_radio->restart_ns = app_time_now_ns() + (uint64_t)p_radio->backoff_s * RADIO_NS_PER_S;
+        return;
+    }
+    p_radio->pid = pid;
+    p_radio->start_ns = app_time_now_ns();
+    p_radio->restart_ns = 0;
+    TRACE_LOG("radio %s started, pid %d\n", p_radio->p_name, (int)pid);
+}
+
+/*******************************************************************************
+* Function Name: radio_exited
+********************************************************************************
+* Summary:
+*   Account for a radio process that exited and schedule its restart
+*
+*******************************************************************************/
+static void radio_exited(radio_t* p_radio, int status)
+{
+    uint64_t now_ns = app_time_now_ns();
+
+    p_radio->pid = 0;
+    if (WIFSIGNALED(status))
+    {
+        TRACE_ERR("radio %s killed by signal %d\n", p_radio->p_name, WTERMSIG(status));
+    }
+    else if (WEXITSTATUS(status) != EXIT_SUCCESS)
+    {
+        TRACE_ERR("radio %s exited with status %d\n", p_radio->p_name, WEXITSTATUS(status));
+    }
+    else
+    {
+        TRACE_LOG("radio %s stopped\n", p_radio->p_name);
+    }
+    if (radio_stop)
+    {
+        return;
+    }
+    if (now_ns - p_radio->start_ns >= RADIO_STABLE_S * RADIO_NS_PER_S)
+    {
+        p_radio->backoff_s = RADIO_BACKOFF_MIN_S;
+    }
+    p_radio->restart_ns = now_ns + (uint64_t)p_radio->backoff_s * RADIO_NS_PER_S;
+    p_radio->restarts++;
+    TRACE_LOG("radio %s restarts in %u s (restart %u)\n", p_radio->p_name, p_radio->backoff_s, p_radio->restarts);
+    p_radio->backoff_s = (p_radio->backoff_s * 2U < RADIO_BACKOFF_MAX_S) ? p_radio->backoff_s * 2U
+                                                                         : RADIO_BACKOFF_MAX_S;
+}
+
+/*******************************************************************************
+* Function Name: radio_reap
+********************************************************************************
+* Summary:
+*   Collect the radio processes that exited
+*
+* Return:
+*   uint32_t: radios still running
+*
+*******************************************************************************/
+static uint32_t radio_reap(void)
+{
+    uint32_t r, running = 0;
+    int status;
+    pid_t pid;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        for (r = 0; r < num_radios; r++)
+        {
+            if (radios[r].pid == pid)
+            {
+                radio_exited(&radios[r], status);
+            }
+        }
+    }
+    for (r = 0; r < num_radios; r++)
+    {
+        running += (radios[r].pid != 0);
+    }
+    return running;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_radio_supervise
+********************************************************************************
+* Summary:
+*   Run the radios of a radio list until SIGINT or SIGTERM, then stop them
+*
+* Parameters:
+*   const char* path: radio list
+*   int argc:         supervisor arguments, before the option parser
+*   char* argv[]:
+*
+* Return:
+*   int: process exit status
+*
+*******************************************************************************/
+int wakeon_le_radio_supervise(const char* path, int argc, char* argv[])
+{
+    uint64_t now_ns, deadline_ns;
+    uint32_t r;
+
+    if (radio_load(path, argc, argv) == WICED_FALSE)
+    {
+        return EXIT_FAILURE;
+    }
+    radio_catch_signals();
+    TRACE_MSG("Supervising %u radios from %s", num_radios, path);
+    radio_print_schedule();
+    for (r = 0; r < num_radios; r++)
+    {
+        radio_spawn(&radios[r]);
+    }
+
+    while (!radio_stop)
+    {
+        radio_reap();
+        now_ns = app_time_now_ns();
+        for (r = 0; r < num_radios; r++)
+        {
+            if ((radios[r].pid == 0) && (radios[r].restart_ns != 0) && (now_ns >= radios[r].restart_ns))
+            {
+                radio_spawn(&radios[r]);
+            }
+        }
+        radio_sleep_ns(RADIO_POLL_NS);
+    }
+
+    TRACE_MSG("Stopping %u radios", num_radios);
+    for (r = 0; r < num_radios; r++)
+    {
+        if (radios[r].pid != 0)
+        {
+            kill(radios[r].pid, SIGTERM);
+        }
+    }
+    deadline_ns = app_time_now_ns() + RADIO_STOP_TIMEOUT_S * RADIO_NS_PER_S;
+    while ((radio_reap() > 0) && (app_time_now_ns() < deadline_ns))
+    {
+        radio_sleep_ns(RADIO_POLL_NS);
+    }
+    for (r = 0; r < num_radios; r++)
+    {
+        if (radios[r].pid != 0)
+        {
+            TRACE_ERR("radio %s did not stop, killing it\n", radios[r].p_name);
+            kill(radios[r].pid, SIGKILL);
+            waitpid(radios[r].pid, NULL, 0);
+            radios[r].pid = 0;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_radio_run
+********************************************************************************
+* Summary:
+*   Serve a supervised radio in place of the menu: arm --arm, re-arm it
+*   --rearm seconds after each wake, return on SIGINT or SIGTERM
+*
+* Parameters: NONE
+*
+* Return:
+*   int: process exit status
+*
+*******************************************************************************/
+int wakeon_le_radio_run(void)
+{
+    uint64_t rearmed_wake_ns = 0, wake_ns;
+
+    radio_catch_signals();
+    TRACE_MSG("Radio %s ready", app_opts.radio_name);
+    if (app_opts.arm_rule[0] != '\0')
+    {
+        app_enable_wake_on_le_rule(app_opts.arm_rule);
+    }
+    while (!radio_stop)
+    {
+        radio_sleep_ns(RADIO_POLL_NS);
+        wake_ns = wakeon_le_ctrl.wake_ns;
+        if ((app_opts.rearm_s == 0) || (app_opts.arm_rule[0] == '\0') || (wake_ns == 0) ||
+            (wake_ns == rearmed_wake_ns) || (wakeon_le_ctrl.in_sleep == WICED_TRUE))
+        {
+            continue;
+        }
+        if (app_time_now_ns() - wake_ns >= (uint64_t)app_opts.rearm_s * RADIO_NS_PER_S)
+        {
+            rearmed_wake_ns = wake_ns;
+            app_enable_wake_on_le_rule(app_opts.arm_rule);
+        }
+    }
+    TRACE_MSG("Radio %s stopping", app_opts.radio_name);
+    return EXIT_SUCCESS;
+}
+
+/* END OF FILE [] */
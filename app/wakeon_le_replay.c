@@ -0,0 +1,635 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: wakeon_le_replay.c
+ *
+ * Description: This is the source file for the advertising trace replay.
+ *              It reads the LE advertising reports, legacy and extended,
+ *              from a btsnoop capture such as one written by --btsnoop, or
+ *              the records of a --capture file (app_adv_capture.c), and
+ *              calls the report callback with each of them and its data
+ *              length from its own thread. Every report is first copied to
+ *              a private buffer and zero terminated, so neither the file
+ *              mapping nor an earlier, longer report can be read past it. Reports are paced by their capture timestamps
+ *              divided by the speed, or sent back to back at speed 0.
+ *
+ *              While it runs, the replay thread is the only producer of the
+ *              scan worker's ring and live reports are ignored. At the end
+ *              it waits for the worker to drain and prints the offered and
+ *              sustained report rates, the drops and the latency from the
+ *              callback to the end of the worker's processing.
+ *
+ * Related Document: See README.md
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+*******************************************************************************
+*      INCLUDES
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "data_types.h"
+#include "app_btsnoop.h"
+#include "app_adv_capture.h"
+#include "app_time.h"
+#include "wakeon_le_scan.h"
+#include "wakeon_le_replay.h"
+#include "log.h"
+
+#ifdef TAG
+#undef TAG
+#endif
+#define TAG "[WAKEONLE_REPLAY]"
+
+/*******************************************************************************
+*       MACROS
+*******************************************************************************/
+#define REPLAY_FILE_HEADER_LEN      (16U)
+#define REPLAY_RECORD_HEADER_LEN    (24U)
+#define REPLAY_DATALINK_H4          (1002U)
+
+#define REPLAY_EVT_LE_META          (0x3EU)
+#define REPLAY_LE_ADV_REPORT        (0x02U)
+#define REPLAY_LE_EXT_ADV_REPORT    (0x0DU)
+#define REPLAY_EXT_REPORT_LEN       (24U)
+/* extended report event type: legacy PDU bit and data status field */
+#define REPLAY_EXT_EVT_LEGACY       (0x0010U)
+#define REPLAY_EXT_EVT_STATUS(t)    (((t) >> 5) & 3U)
+#define REPLAY_EXT_STATUS_MORE      (1U)
+/* legacy event type of a non-connectable undirected advertisement */
+#define REPLAY_EVT_NONCONN          (3U)
+/* largest extended advertising data the stack reassembles */
+#define REPLAY_EXT_DATA_MAX         (1650U)
+
+/* do not sleep for less than this, the wake-up overshoots anyway */
+#define REPLAY_SLEEP_MIN_NS         (20000U)
+/* time to wait for the worker to drain at the end */
+#define REPLAY_DRAIN_TIMEOUT_NS     (2000000000ULL)
+
+/*******************************************************************************
+*       STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    BOOL32                              is_capture;
+    app_adv_capture_reader_t            reader;     /* --capture files */
+    const uint8_t*                      p_file;     /* btsnoop files */
+    size_t                              file_len;
+    uint32_t                            speed;
+    uint32_t                            loops;
+    wakeon_le_replay_cback_t*           p_cback;
+    char                                path[256];
+    /* extended report reassembly */
+    wiced_bt_ble_scan_results_t         ext_result;
+    uint16_t                            ext_len;
+    uint8_t                             ext_data[REPLAY_EXT_DATA_MAX];
+    /* the report handed to the callback, zero terminated; separate from
+     * ext_data, a legacy report may arrive between extended fragments */
+    uint8_t                             adv_data[REPLAY_EXT_DATA_MAX + 1];
+    /* pacing */
+    BOOL32                              paced;
+    uint64_t                            first_ns;
+    uint64_t                            start_ns;
+    /* results */
+    uint64_t                            submitted;
+    uint64_t                            max_lag_ns;
+} replay_ctx_t;
+
+/*******************************************************************************
+*       VARIABLE DEFINITIONS
+*******************************************************************************/
+static replay_ctx_t     replay;
+static pthread_t        replay_thread;
+static BOOL32           replay_joinable = WICED_FALSE;
+static uint32_t         replay_running = 0;
+static uint32_t         replay_stop_req = 0;
+
+/*******************************************************************************
+*       FUNCTION DEFINITION
+*******************************************************************************/
+static uint32_t replay_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t replay_be64(const uint8_t* p)
+{
+    return ((uint64_t)replay_be32(p) << 32) | replay_be32(p + 4);
+}
+
+/*******************************************************************************
+* Function Name: replay_deliver
+********************************************************************************
+* Summary:
+*   Hand one report to the callback, copied and zero terminated
+*
+*******************************************************************************/
+static void replay_deliver(const wiced_bt_ble_scan_results_t* p_result, const uint8_t* p_data, uint16_t len)
+{
+    if (len > REPLAY_EXT_DATA_MAX)
+    {
+        len = REPLAY_EXT_DATA_MAX;
+    }
+    memcpy(replay.adv_data, p_data, len);
+    replay.adv_data[len] = 0;
+    replay.p_cback(p_result, replay.adv_data, len);
+    replay.submitted++;
+}
+
+/*******************************************************************************
+* Function Name: replay_adv_reports
+********************************************************************************
+* Summary:
+*   Deliver the advertising reports of an LE Meta event
+*
+* Parameters:
+*   uint8_t* p:   event parameters, starting at the subevent code
+*   uint32_t len: parameter length
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void replay_adv_reports(uint8_t* p, uint32_t len)
+{
+    wiced_bt_ble_scan_results_t result;
+    uint8_t* p_end = p + len;
+    uint8_t subevent, num, data_len;
+    uint16_t evt_type;
+    uint32_t i, j;
+
+    if (len < 2)
+    {
+        return;
+    }
+    subevent = p[0];
+    num = p[1];
+    p += 2;
+
+    if (subevent == REPLAY_LE_ADV_REPORT)
+    {
+        /* evt_type, addr_type, addr[6], data_len, data, rssi */
+        for (i = 0; (i < num) && (p + 10 <= p_end); i++)
+        {
+            data_len = p[8];
+            if (p + 10 + data_len > p_end)
+            {
+                return;
+            }
+            memset(&result, 0, sizeof(result));
+            result.ble_evt_type = p[0];
+            result.ble_addr_type = p[1];
+            for (j = 0; j < sizeof(wiced_bt_device_address_t); j++)
+            {
+                result.remote_bd_addr[j] = p[7 - j];
+            }
+            result.rssi = (int8_t)p[9 + data_len];
+            replay_deliver(&result, &p[9], data_len);
+            p += 10 + data_len;
+        }
+        return;
+    }
+
+    /* extended: evt_type(2), addr_type, addr[6], phys(2), sid, tx_power, rssi,
+     * interval(2), direct addr_type, direct addr[6], data_len, data */
+    for (i = 0; (i < num) && (p + REPLAY_EXT_REPORT_LEN <= p_end); i++)
+    {
+        data_len = p[23];
+        if (p + REPLAY_EXT_REPORT_LEN + data_len > p_end)
+        {
+            return;
+        }
+        evt_type = (uint16_t)(p[0] | (p[1] << 8));
+        if (replay.ext_len == 0)
+        {
+            memset(&replay.ext_result, 0, sizeof(replay.ext_result));
+            replay.ext_result.ble_evt_type = (evt_type & REPLAY_EXT_EVT_LEGACY) ? (uint8_t)(evt_type & 0x0FU) : REPLAY_EVT_NONCONN;
+            replay.ext_result.ble_addr_type = p[2];
+            for (j = 0; j < sizeof(wiced_bt_device_address_t); j++)
+            {
+                replay.ext_result.remote_bd_addr[j] = p[8 - j];
+            }
+        }
+        replay.ext_result.rssi = (int8_t)p[13];
+        if (replay.ext_len + data_len <= REPLAY_EXT_DATA_MAX)
+        {
+            memcpy(&replay.ext_data[replay.ext_len], &p[24], data_len);
+            replay.ext_len = (uint16_t)(replay.ext_len + data_len);
+        }
+        /* the fragments of one advertisement follow each other */
+        if (REPLAY_EXT_EVT_STATUS(evt_type) != REPLAY_EXT_STATUS_MORE)
+        {
+            replay_deliver(&replay.ext_result, replay.ext_data, replay.ext_len);
+            replay.ext_len = 0;
+        }
+        p += REPLAY_EXT_REPORT_LEN + data_len;
+    }
+}
+
+/*******************************************************************************
+* Function Name: replay_pace
+********************************************************************************
+* Summary:
+*   Wait until a report captured at ts_ns is due, relative to the first
+*   report of the pass
+*
+*******************************************************************************/
+static void replay_pace(uint64_t ts_ns)
+{
+    struct timespec due;
+    uint64_t due_ns, now_ns;
+
+    if (!replay.paced)
+    {
+        replay.paced = WICED_TRUE;
+        replay.first_ns = ts_ns;
+        replay.start_ns = app_time_now_ns();
+        return;
+    }
+    if ((replay.speed == WAKEON_LE_REPLAY_SPEED_MAX) || (ts_ns <= replay.first_ns))
+    {
+        return;
+    }
+    due_ns = replay.start_ns + (ts_ns - replay.first_ns) / replay.speed;
+    now_ns = app_time_now_ns();
+    if (due_ns > now_ns + REPLAY_SLEEP_MIN_NS)
+    {
+        due.tv_sec = (time_t)(due_ns / APP_TIME_NS_PER_SEC);
+        due.tv_nsec = (long)(due_ns % APP_TIME_NS_PER_SEC);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+    }
+    else if ((now_ns > due_ns) && (now_ns - due_ns > replay.max_lag_ns))
+    {
+        replay.max_lag_ns = now_ns - due_ns;
+    }
+}
+
+/*******************************************************************************
+* Function Name: replay_capture_pass
+********************************************************************************
+* Summary:
+*   Replay a --capture file once
+*
+* Return:
+*   BOOL32: WICED_FALSE when stopped
+*
+*******************************************************************************/
+static BOOL32 replay_capture_pass(void)
+{
+    wiced_bt_ble_scan_results_t result;
+    app_adv_capture_record_t record;
+
+    if (app_adv_capture_seek(&replay.reader, 0) != APP_ADV_CAPTURE_SUCCESS)
+    {
+        return WICED_TRUE;
+    }
+    while (app_adv_capture_next(&replay.reader, &record) == APP_ADV_CAPTURE_SUCCESS)
+    {
+        if (__atomic_load_n(&replay_stop_req, __ATOMIC_RELAXED))
+        {
+            return WICED_FALSE;
+        }
+        replay_pace(record.ts_ns);
+        memset(&result, 0, sizeof(result));
+        memcpy(result.remote_bd_addr, record.p_addr, sizeof(result.remote_bd_addr));
+        result.ble_addr_type = record.addr_type;
+        result.ble_evt_type = record.evt_type;
+        result.rssi = record.rssi;
+        replay_deliver(&result, record.p_adv, record.adv_len);
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: replay_pass
+********************************************************************************
+* Summary:
+*   Replay the capture once
+*
+* Return:
+*   BOOL32: WICED_FALSE when stopped
+*
+*******************************************************************************/
+static BOOL32 replay_pass(void)
+{
+    size_t off = REPLAY_FILE_HEADER_LEN;
+    const uint8_t* p_rec;
+    uint32_t incl_len;
+    uint8_t* p;
+
+    replay.paced = WICED_FALSE;
+    replay.ext_len = 0;
+    if (replay.is_capture)
+    {
+        return replay_capture_pass();
+    }
+    while (off + REPLAY_RECORD_HEADER_LEN <= replay.file_len)
+    {
+        if (__atomic_load_n(&replay_stop_req, __ATOMIC_RELAXED))
+        {
+            return WICED_FALSE;
+        }
+        p_rec = replay.p_file + off;
+        incl_len = replay_be32(p_rec + 4);
+        /* a capture cut short by a crash ends in zero-filled space */
+        if ((incl_len == 0) || (off + REPLAY_RECORD_HEADER_LEN + incl_len > replay.file_len))
+        {
+            break;
+        }
+        off += REPLAY_RECORD_HEADER_LEN + incl_len;
+        p = (uint8_t*)p_rec + REPLAY_RECORD_HEADER_LEN;
+        if ((incl_len < 5) || (p[0] != APP_BTSNOOP_H4_EVT) || (p[1] != REPLAY_EVT_LE_META) ||
+            ((p[3] != REPLAY_LE_ADV_REPORT) && (p[3] != REPLAY_LE_EXT_ADV_REPORT)))
+        {
+            continue;
+        }
+        /* btsnoop timestamps are in us */
+        replay_pace(replay_be64(p_rec + 16) * 1000U);
+        replay_adv_reports(&p[3], (p[2] < incl_len - 3U) ? p[2] : incl_len - 3U);
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: replay_percentile_us
+********************************************************************************
+* Summary:
+*   Latency percentile, in us, of a histogram interval
+*
+*******************************************************************************/
+static double replay_percentile_us(const uint64_t* p_hist, uint64_t count, double fraction)
+{
+    uint64_t rank = (uint64_t)(fraction * (double)count), seen = 0;
+    uint32_t i;
+
+    for (i = 0; i < WAKEON_LE_SCAN_LATENCY_BUCKETS; i++)
+    {
+        seen += p_hist[i];
+        if ((seen > rank) || ((seen == count) && (count > 0)))
+        {
+            return (double)wakeon_le_scan_latency_bucket_ns(i) / 1000.0;
+        }
+    }
+    return 0.0;
+}
+
+/*******************************************************************************
+* Function Name: replay_main
+********************************************************************************
+* Summary:
+*   Replay thread
+*
+*******************************************************************************/
+static void* replay_main(void* p_arg)
+{
+    wakeon_le_scan_stats_t before, after;
+    uint64_t start_ns, sent_ns, end_ns, processed, dropped, drain_ns;
+    uint32_t loop;
+    uint32_t i;
+
+    (void)p_arg;
+    replay.submitted = 0;
+    replay.max_lag_ns = 0;
+    wakeon_le_scan_replay_claim(WICED_TRUE);
+    wakeon_le_scan_get_stats(&before);
+    start_ns = app_time_now_ns();
+
+    for (loop = 0; (loop < replay.loops) && replay_pass(); loop++)
+    {
+    }
+    sent_ns = app_time_now_ns();
+
+    /* wait for the worker to finish what was submitted */
+    drain_ns = sent_ns + REPLAY_DRAIN_TIMEOUT_NS;
+    do
+    {
+        wakeon_le_scan_get_stats(&after);
+        processed = after.processed - before.processed;
+        dropped = after.dropped - before.dropped;
+        if (processed + dropped >= replay.submitted)
+        {
+            break;
+        }
+        sched_yield();
+    } while (app_time_now_ns() < drain_ns);
+    end_ns = app_time_now_ns();
+    wakeon_le_scan_replay_claim(WICED_FALSE);
+
+    for (i = 0; i < WAKEON_LE_SCAN_LATENCY_BUCKETS; i++)
+    {
+        after.latency[i] -= before.latency[i];
+    }
+    TRACE_MSG("replay %s: %u of %u loops, %llu reports in %.3f s at speed %u%s",
+              replay.path, loop, replay.loops, (unsigned long long)replay.submitted,
+              (double)(sent_ns - start_ns) / 1e9, replay.speed,
+              (replay.speed == WAKEON_LE_REPLAY_SPEED_MAX) ? " (unpaced)" : "");
+    TRACE_MSG("replay: offered %.0f reports/s, processed %.0f reports/s, %llu processed, %llu dropped (%.2f%%), "
+              "%llu live reports ignored",
+              (double)replay.submitted * 1e9 / (double)(sent_ns - start_ns + 1U),
+              (double)processed * 1e9 / (double)(end_ns - start_ns + 1U),
+              (unsigned long long)processed, (unsigned long long)dropped,
+              (replay.submitted > 0) ? 100.0 * (double)dropped / (double)replay.submitted : 0.0,
+              (unsigned long long)(after.ignored - before.ignored));
+    TRACE_MSG("replay: latency p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us; "
+              "up to %.3f ms behind schedule",
+              replay_percentile_us(after.latency, processed, 0.50),
+              replay_percentile_us(after.latency, processed, 0.90),
+              replay_percentile_us(after.latency, processed, 0.99),
+              replay_percentile_us(after.latency, processed, 0.999),
+              replay_percentile_us(after.latency, processed, 1.0),
+              (double)replay.max_lag_ns / 1e6);
+
+    if (replay.is_capture)
+    {
+        app_adv_capture_reader_close(&replay.reader);
+    }
+    else
+    {
+        munmap((void*)replay.p_file, replay.file_len);
+    }
+    __atomic_store_n(&replay_running, 0, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: replay_map_btsnoop
+********************************************************************************
+* Summary:
+*   Map a btsnoop HCI UART capture for replay
+*
+* Parameters:
+*   const char* path: capture file
+*
+* Return:
+*   BOOL32: WICED_TRUE if mapped
+*
+*******************************************************************************/
+static BOOL32 replay_map_btsnoop(const char* path)
+{
+    struct stat st;
+    void* p_map;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        TRACE_ERR("open %s failed\n", path);
+        return WICED_FALSE;
+    }
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < REPLAY_FILE_HEADER_LEN))
+    {
+        TRACE_ERR("%s is not a btsnoop file\n", path);
+        close(fd);
+        return WICED_FALSE;
+    }
+    p_map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        TRACE_ERR("mmap %s failed\n", path);
+        return WICED_FALSE;
+    }
+    if ((memcmp(p_map, "btsnoop\0", 8) != 0) || (replay_be32((const uint8_t*)p_map + 12) != REPLAY_DATALINK_H4))
+    {
+        TRACE_ERR("%s is not a btsnoop HCI UART capture\n", path);
+        munmap(p_map, (size_t)st.st_size);
+        return WICED_FALSE;
+    }
+    madvise(p_map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    replay.p_file = p_map;
+    replay.file_len = (size_t)st.st_size;
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_replay_start
+********************************************************************************
+* Summary:
+*   Map a btsnoop or --capture file and start replaying its advertising
+*   reports
+*
+* Parameters:
+*   const char* path:                           btsnoop file (datalink 1002) or
+*                                               --capture file
+*   uint32_t speed:                             pace multiplier, 0 for no pacing
+*   uint32_t loops:                             number of passes, at least 1
+*   wakeon_le_replay_cback_t* p_cback:          report callback
+*
+* Return:
+*   BOOL32: WICED_TRUE when the replay started
+*
+*******************************************************************************/
+BOOL32 wakeon_le_replay_start(const char* path, uint32_t speed, uint32_t loops,
+                              wakeon_le_replay_cback_t* p_cback)
+{
+    if (__atomic_load_n(&replay_running, __ATOMIC_ACQUIRE))
+    {
+        TRACE_ERR("a replay is already running\n");
+        return WICED_FALSE;
+    }
+    if (replay_joinable)
+    {
+        pthread_join(replay_thread, NULL);
+        replay_joinable = WICED_FALSE;
+    }
+
+    replay.is_capture = (app_adv_capture_reader_open(&replay.reader, path) == APP_ADV_CAPTURE_SUCCESS);
+    if (!replay.is_capture && !replay_map_btsnoop(path))
+    {
+        return WICED_FALSE;
+    }
+    replay.speed = speed;
+    replay.loops = (loops == 0) ? 1U : loops;
+    replay.p_cback = p_cback;
+    snprintf(replay.path, sizeof(replay.path), "%s", path);
+    __atomic_store_n(&replay_stop_req, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&replay_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&replay_thread, NULL, replay_main, NULL) != 0)
+    {
+        TRACE_ERR("replay thread create failed\n");
+        __atomic_store_n(&replay_running, 0, __ATOMIC_RELEASE);
+        if (replay.is_capture)
+        {
+            app_adv_capture_reader_close(&replay.reader);
+        }
+        else
+        {
+            munmap((void*)replay.p_file, replay.file_len);
+        }
+        return WICED_FALSE;
+    }
+    replay_joinable = WICED_TRUE;
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_replay_running
+********************************************************************************
+* Summary:
+*   Whether a replay is in progress
+*
+*******************************************************************************/
+BOOL32 wakeon_le_replay_running(void)
+{
+    return __atomic_load_n(&replay_running, __ATOMIC_ACQUIRE) ? WICED_TRUE : WICED_FALSE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_replay_stop
+********************************************************************************
+* Summary:
+*   Stop a running replay after the report in progress; its summary is
+*   still printed
+*
+*******************************************************************************/
+void wakeon_le_replay_stop(void)
+{
+    if (!replay_joinable)
+    {
+        return;
+    }
+    __atomic_store_n(&replay_stop_req, 1, __ATOMIC_RELAXED);
+    pthread_join(replay_thread, NULL);
+    replay_joinable = WICED_FALSE;
+}
+
+/* END OF FILE [] */
@@ -0,0 +1,771 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: wakeon_le_scan.c
+ *
+ * Description: This is the source file for the advertising report pipeline.
+ *              app_scan_result_cback() runs on the BT stack thread; any time
+ *              spent there delays HCI event processing. It now only calls
+ *              wakeon_le_scan_submit(), which copies the report into a
+ *              preallocated SPSC ring slot and its AD bytes into a buffer
+ *              of the application buffer pool (app_alloc_buffer()). The
+ *              worker thread drains the ring, does everything else and
+ *              returns the buffer. When the ring or the pool is exhausted
+ *              the report is dropped and counted, the stack thread never
+ *              waits and nothing is allocated from the heap.
+ *
+ *              The worker spins briefly when the ring runs empty and then
+ *              parks on a futex; the producer only makes the wake-up system
+ *              call when the worker is actually parked.
+ *
+ *              With --capture, the worker also appends every report to a
+ *              compact capture file (app_adv_capture.c). The writer belongs
+ *              to the worker; closing it is a request the worker serves.
+ *
+ *              A trace replay (wakeon_le_replay.c) feeds the same ring from
+ *              its own thread. The ring has a single producer, so while a
+ *              replay holds it, live reports from the stack are ignored.
+ *
+ * Related Document: See README.md
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+*******************************************************************************
+*      INCLUDES
+*******************************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "wiced_bt_dev.h"
+#include "data_types.h"
+#include "app_bt_utils.h"
+#include "app_spsc_ring.h"
+#include "app_event_ring.h"
+#include "app_event_json.h"
+#include "app_metrics.h"
+#include "app_time.h"
+#include "app_adv_parser.h"
+#include "app_device_table.h"
+#include "app_adv_capture.h"
+#include "wakeon_le.h"
+#include "wakeon_le_scan.h"
+#include "log.h"
+
+#ifdef TAG
+#undef TAG
+#endif
+#define TAG "[WAKEONLE_SCAN]"
+
+/*******************************************************************************
+*       MACROS
+*******************************************************************************/
+/* empty polls before the worker parks */
+#define SCAN_WORKER_SPIN_COUNT      (2000U)
+/* park timeout, bounds the shutdown latency */
+#define SCAN_WORKER_PARK_NS         (100000000L)
+/* poll period while a rule update waits for the worker */
+#define SCAN_RULES_WAIT_NS          (100000L)
+/* how long closing the capture waits for the worker */
+#define SCAN_CAPTURE_CLOSE_WAIT_MS  (1000U)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax()                 __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax()                 __asm__ __volatile__("yield" ::: "memory")
+#else
+#define cpu_relax()                 __asm__ __volatile__("" ::: "memory")
+#endif
+
+/*******************************************************************************
+*       VARIABLE DEFINITIONS
+*******************************************************************************/
+static app_spsc_ring_t  scan_ring;
+/* AD bytes kept per report, legacy or extended */
+static uint16_t         scan_adv_data_max = WAKEON_LE_SCAN_ADV_DATA_MAX;
+static pthread_t        scan_worker;
+static uint32_t         scan_running = 0;
+static uint32_t         scan_worker_parked = 0;
+/* double buffered host rules, the worker only follows p_scan_rules */
+static app_adv_rule_set_t  scan_rules[2];
+static app_adv_rule_set_t* p_scan_rules = NULL;
+/* bumped after each p_scan_rules store; the worker copies it to
+ * scan_worker_rules_gen between reports, when it holds no rule set */
+static uint32_t         scan_rules_gen = 0;
+static uint32_t         scan_worker_rules_gen = 0;
+static uint32_t         scan_worker_alive = 0;
+/* every advertiser seen, updated by the worker only */
+static app_device_table_t  scan_devices;
+/* report path totals; processed and latency are written by the worker only */
+static wakeon_le_scan_stats_t scan_stats;
+/* set while a replay thread is the ring producer */
+static uint32_t         scan_replay_owner = 0;
+/* the stack thread is inside wakeon_le_scan_submit() */
+static uint32_t         scan_live_inflight = 0;
+static __thread BOOL32  scan_is_replay = WICED_FALSE;
+/* report capture, written by the worker while scan_capture_open is set */
+static app_adv_capture_writer_t scan_capture;
+static uint32_t         scan_capture_open = 0;
+static uint32_t         scan_capture_close_req = 0;
+
+/*******************************************************************************
+*       FUNCTION DEFINITION
+*******************************************************************************/
+/*******************************************************************************
+* Function Name: scan_futex
+********************************************************************************
+* Summary:
+*   Thin futex(2) wrapper, private to this process
+*
+*******************************************************************************/
+static long scan_futex(uint32_t *p_addr, int op, uint32_t val, const struct timespec *p_timeout)
+{
+    return syscall(SYS_futex, p_addr, op | FUTEX_PRIVATE_FLAG, val, p_timeout, NULL, 0);
+}
+
+/*******************************************************************************
+* Function Name: scan_metrics_collector
+********************************************************************************
+* Summary:
+*   Export the device table occupancy with the application metrics
+*
+*******************************************************************************/
+static void scan_metrics_collector(app_metrics_buf_t* p_out)
+{
+    app_metrics_printf(p_out, "# HELP wakeonle_devices Advertisers currently tracked\n"
+                              "# TYPE wakeonle_devices gauge\n"
+                              "wakeonle_devices %u\n"
+                              "# HELP wakeonle_device_table_bytes Memory reserved for the device table\n"
+                              "# TYPE wakeonle_device_table_bytes gauge\n"
+                              "wakeonle_device_table_bytes %zu\n"
+                              "# HELP wakeonle_device_evictions_total Devices evicted to make room, least recently seen first\n"
+                              "# TYPE wakeonle_device_evictions_total counter\n"
+                              "wakeonle_device_evictions_total %llu\n",
+                       app_device_table_count(&scan_devices),
+                       app_device_table_footprint(scan_devices.max_devices),
+                       (unsigned long long)__atomic_load_n(&scan_devices.evictions, __ATOMIC_RELAXED));
+    if (__atomic_load_n(&scan_capture_open, __ATOMIC_ACQUIRE))
+    {
+        app_metrics_printf(p_out, "# HELP wakeonle_capture_records_total Reports written to the capture\n"
+                                  "# TYPE wakeonle_capture_records_total counter\n"
+                                  "wakeonle_capture_records_total %llu\n"
+                                  "# HELP wakeonle_capture_bytes_total Record bytes written to the capture\n"
+                                  "# TYPE wakeonle_capture_bytes_total counter\n"
+                                  "wakeonle_capture_bytes_total %llu\n"
+                                  "# HELP wakeonle_capture_write_errors_total Failed capture writes\n"
+                                  "# TYPE wakeonle_capture_write_errors_total counter\n"
+                                  "wakeonle_capture_write_errors_total %llu\n",
+                           (unsigned long long)__atomic_load_n(&scan_capture.records_total, __ATOMIC_RELAXED),
+                           (unsigned long long)__atomic_load_n(&scan_capture.bytes_total, __ATOMIC_RELAXED),
+                           (unsigned long long)__atomic_load_n(&scan_capture.write_errors, __ATOMIC_RELAXED));
+    }
+}
+
+/*******************************************************************************
+* Function Name: scan_process_report
+********************************************************************************
+* Summary:
+*   Worker side handling of one advertising report
+*
+* Parameters:
+*   const wakeon_le_scan_report_t* p_report: queued report
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void scan_process_report(const wakeon_le_scan_report_t* p_report)
+{
+    const app_adv_rule_set_t* p_rules = __atomic_load_n(&p_scan_rules, __ATOMIC_ACQUIRE);
+    app_event_t event;
+    int rule = APP_ADV_MATCH_NONE;
+
+    APP_METRICS_INC(app_metrics.scan_reports_total);
+    if (p_rules != NULL)
+    {
+        rule = app_adv_rule_set_match(p_rules, p_report->p_adv_data, p_report->adv_len);
+    }
+
+    memset(&event, 0, offsetof(app_event_t, adv_data));
+    event.type = APP_EVENT_SCAN_REPORT;
+    event.timestamp_ns = app_time_ticks_to_ns(p_report->rx_ticks);
+    event.filter_idx = APP_EVENT_FILTER_IDX_NONE;
+    if (rule != APP_ADV_MATCH_NONE)
+    {
+        APP_METRICS_INC(app_metrics.scan_reports_matched_total);
+        event.filter_idx = p_rules->rules[rule].filter_idx;
+    }
+    app_device_table_update(&scan_devices, p_report->result.remote_bd_addr, p_report->result.ble_addr_type,
+                            p_report->result.rssi, event.filter_idx, event.timestamp_ns);
+    event.addr_type = p_report->result.ble_addr_type;
+    memcpy(event.addr, p_report->result.remote_bd_addr, sizeof(event.addr));
+    event.rssi = p_report->result.rssi;
+    event.evt_type = p_report->result.ble_evt_type;
+    event.adv_len = p_report->adv_len;
+    memcpy(event.adv_data, p_report->p_adv_data, p_report->adv_len);
+    app_event_ring_publish(&event);
+    app_event_json_write(&event);
+    if (__atomic_load_n(&scan_capture_open, __ATOMIC_RELAXED))
+    {
+        app_adv_capture_append(&scan_capture, event.timestamp_ns, event.addr, event.addr_type, event.evt_type,
+                               event.rssi, event.adv_data, event.adv_len);
+    }
+
+    TRACE_DBG("Got ADV from:%02X:%02X:%02X:%02X:%02X:%02X",
+              p_report->result.remote_bd_addr[0], p_report->result.remote_bd_addr[1],
+              p_report->result.remote_bd_addr[2], p_report->result.remote_bd_addr[3],
+              p_report->result.remote_bd_addr[4], p_report->result.remote_bd_addr[5]);
+}
+
+/*******************************************************************************
+* Function Name: scan_latency_bucket
+********************************************************************************
+* Summary:
+*   Histogram bucket of a latency: the value itself below 4 ns, then the
+*   power of 2 and the next two bits below it
+*
+*******************************************************************************/
+static inline uint32_t scan_latency_bucket(uint64_t ns)
+{
+    uint32_t octave, bucket;
+
+    if (ns < 4U)
+    {
+        return (uint32_t)ns;
+    }
+    octave = 63U - (uint32_t)__builtin_clzll(ns);
+    bucket = (octave - 1U) * 4U + (uint32_t)((ns >> (octave - 2U)) & 3U);
+    return (bucket < WAKEON_LE_SCAN_LATENCY_BUCKETS) ? bucket : WAKEON_LE_SCAN_LATENCY_BUCKETS - 1U;
+}
+
+/*******************************************************************************
+* Function Name: scan_account
+********************************************************************************
+* Summary:
+*   Count a processed report and its latency since the stack callback
+*
+*******************************************************************************/
+static void scan_account(uint64_t rx_ticks)
+{
+    uint64_t latency_ns = app_time_ticks_to_ns(app_time_ticks()) - app_time_ticks_to_ns(rx_ticks);
+    uint32_t bucket = scan_latency_bucket(latency_ns);
+
+    /* single writer: plain read-modify-write, atomic stores for the readers */
+    __atomic_store_n(&scan_stats.latency[bucket], scan_stats.latency[bucket] + 1U, __ATOMIC_RELAXED);
+    __atomic_store_n(&scan_stats.processed, scan_stats.processed + 1U, __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+* Function Name: scan_capture_finish
+********************************************************************************
+* Summary:
+*   Flush and close the capture; on the worker, or once it has stopped
+*
+*******************************************************************************/
+static void scan_capture_finish(void)
+{
+    if (__atomic_load_n(&scan_capture_open, __ATOMIC_ACQUIRE))
+    {
+        __atomic_store_n(&scan_capture_open, 0, __ATOMIC_RELEASE);
+        app_adv_capture_writer_close(&scan_capture);
+    }
+    __atomic_store_n(&scan_capture_close_req, 0, __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+* Function Name: scan_rules_quiescent
+********************************************************************************
+* Summary:
+*   Worker side: announce that no rule set loaded before the current
+*   generation is still in use. Called between reports only.
+*
+*******************************************************************************/
+static inline void scan_rules_quiescent(void)
+{
+    __atomic_store_n(&scan_worker_rules_gen, __atomic_load_n(&scan_rules_gen, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+* Function Name: scan_rules_wait_quiescent
+********************************************************************************
+* Summary:
+*   Wait until the worker has passed a quiescent point since the last rule
+*   publication, so the buffer that publication replaced can be reused. A
+*   parked worker is woken to get there.
+*
+*******************************************************************************/
+static void scan_rules_wait_quiescent(void)
+{
+    struct timespec tick = { 0, SCAN_RULES_WAIT_NS };
+    uint32_t gen = __atomic_load_n(&scan_rules_gen, __ATOMIC_ACQUIRE);
+
+    while (__atomic_load_n(&scan_worker_alive, __ATOMIC_ACQUIRE) &&
+           (__atomic_load_n(&scan_worker_rules_gen, __ATOMIC_ACQUIRE) != gen))
+    {
+        scan_futex(&scan_worker_parked, FUTEX_WAKE, 1, NULL);
+        nanosleep(&tick, NULL);
+    }
+}
+
+/*******************************************************************************
+* Function Name: scan_worker_main
+********************************************************************************
+* Summary:
+*   Worker thread, drains the report ring
+*
+*******************************************************************************/
+static void* scan_worker_main(void* p_arg)
+{
+    struct timespec timeout = { 0, SCAN_WORKER_PARK_NS };
+    const wakeon_le_scan_report_t* p_report;
+    uint32_t idle = 0;
+
+    (void)p_arg;
+    while (__atomic_load_n(&scan_running, __ATOMIC_ACQUIRE))
+    {
+        scan_rules_quiescent();
+        if (__atomic_load_n(&scan_capture_close_req, __ATOMIC_ACQUIRE))
+        {
+            scan_capture_finish();
+        }
+        p_report = app_spsc_ring_peek(&scan_ring);
+        if (p_report != NULL)
+        {
+            scan_process_report(p_report);
+            scan_account(p_report->rx_ticks);
+            app_free_buffer(p_report->p_adv_data);
+            app_spsc_ring_release(&scan_ring);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < SCAN_WORKER_SPIN_COUNT)
+        {
+            cpu_relax();
+            continue;
+        }
+
+        /* announce parking, then re-check so a concurrent submit is not missed */
+        __atomic_store_n(&scan_worker_parked, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if ((app_spsc_ring_peek(&scan_ring) == NULL) && __atomic_load_n(&scan_running, __ATOMIC_ACQUIRE) &&
+            !__atomic_load_n(&scan_capture_close_req, __ATOMIC_ACQUIRE))
+        {
+            scan_futex(&scan_worker_parked, FUTEX_WAIT, 1, &timeout);
+        }
+        __atomic_store_n(&scan_worker_parked, 0, __ATOMIC_RELAXED);
+        idle = 0;
+    }
+
+    /* drain what is left */
+    while ((p_report = app_spsc_ring_peek(&scan_ring)) != NULL)
+    {
+        scan_process_report(p_report);
+        scan_account(p_report->rx_ticks);
+        app_free_buffer(p_report->p_adv_data);
+        app_spsc_ring_release(&scan_ring);
+    }
+    __atomic_store_n(&scan_worker_alive, 0, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_start
+********************************************************************************
+* Summary:
+*   Allocate the report ring and the device table and start the worker
+*   thread. The AD bytes of queued reports live in the application buffer
+*   pool, which must exist already.
+*
+* Parameters:
+*   uint32_t queue_depth:   ring slots, rounded up to a power of 2
+*   uint32_t max_devices:   device table capacity
+*   uint16_t adv_data_max:  AD bytes kept per report, 31 for legacy
+*                           scanning, up to 255 for extended; longer data
+*                           is cut at the last AD structure that fits
+*
+* Return:
+*   BOOL32: WICED_TRUE on success
+*
+*******************************************************************************/
+BOOL32 wakeon_le_scan_start(uint32_t queue_depth, uint32_t max_devices, uint16_t adv_data_max)
+{
+    static BOOL32 collector_registered = WICED_FALSE;
+
+    if (__atomic_load_n(&scan_running, __ATOMIC_ACQUIRE))
+    {
+        return WICED_TRUE;
+    }
+    scan_adv_data_max = (adv_data_max < WAKEON_LE_SCAN_EXT_ADV_DATA_MAX) ? adv_data_max : WAKEON_LE_SCAN_EXT_ADV_DATA_MAX;
+    if (app_spsc_ring_init(&scan_ring, (uint32_t)sizeof(wakeon_le_scan_report_t), queue_depth) != APP_SPSC_RING_SUCCESS)
+    {
+        TRACE_ERR("scan ring init failed, depth %u\n", queue_depth);
+        return WICED_FALSE;
+    }
+    if (app_device_table_init(&scan_devices, max_devices) != APP_DEVICE_TABLE_SUCCESS)
+    {
+        TRACE_ERR("device table init failed, %u devices\n", max_devices);
+        app_spsc_ring_deinit(&scan_ring);
+        return WICED_FALSE;
+    }
+    if (!collector_registered)
+    {
+        collector_registered = (app_metrics_register_collector(scan_metrics_collector) == 0);
+    }
+
+    __atomic_store_n(&scan_running, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&scan_worker_alive, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&scan_worker, NULL, scan_worker_main, NULL) != 0)
+    {
+        TRACE_ERR("scan worker create failed\n");
+        __atomic_store_n(&scan_worker_alive, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&scan_running, 0, __ATOMIC_RELEASE);
+        app_device_table_deinit(&scan_devices);
+        app_spsc_ring_deinit(&scan_ring);
+        return WICED_FALSE;
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_stop
+********************************************************************************
+* Summary:
+*   Stop the worker after it drained the ring. Scanning must be off.
+*
+*******************************************************************************/
+void wakeon_le_scan_stop(void)
+{
+    if (!__atomic_exchange_n(&scan_running, 0, __ATOMIC_ACQ_REL))
+    {
+        return;
+    }
+    scan_futex(&scan_worker_parked, FUTEX_WAKE, 1, NULL);
+    pthread_join(scan_worker, NULL);
+    scan_capture_finish();
+    app_spsc_ring_deinit(&scan_ring);
+    app_device_table_deinit(&scan_devices);
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_submit
+********************************************************************************
+* Summary:
+*   Called on the BT stack thread for every advertising report, or on the
+*   replay thread. Copies the report into the ring and a pool buffer and
+*   returns; drops it if the worker is behind or the pool is exhausted.
+*   Nothing past adv_len is read: data longer than the scan path keeps is
+*   cut at the last AD structure that fits.
+*
+* Parameters:
+*   const wiced_bt_ble_scan_results_t* p_scan_result: report from the stack
+*   const uint8_t* p_adv_data:                        AD payload
+*   uint16_t adv_len:                                 bytes at p_adv_data
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+void wakeon_le_scan_submit(const wiced_bt_ble_scan_results_t *p_scan_result, const uint8_t *p_adv_data, uint16_t adv_len)
+{
+    wakeon_le_scan_report_t* p_report;
+
+    if (!__atomic_load_n(&scan_running, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+    if (!scan_is_replay)
+    {
+        /* pairs with wakeon_le_scan_replay_claim(): announce, then check the owner */
+        __atomic_store_n(&scan_live_inflight, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&scan_replay_owner, __ATOMIC_SEQ_CST))
+        {
+            __atomic_store_n(&scan_live_inflight, 0, __ATOMIC_RELEASE);
+            APP_METRICS_INC(scan_stats.ignored);
+            return;
+        }
+    }
+
+    /* a reserved slot that is not committed stays free */
+    p_report = app_spsc_ring_reserve(&scan_ring);
+    if (p_report != NULL)
+    {
+        p_report->adv_len = app_ad_total_len(p_adv_data, (adv_len < scan_adv_data_max) ? adv_len : scan_adv_data_max);
+        p_report->p_adv_data = app_alloc_buffer(p_report->adv_len);
+    }
+    if ((p_report == NULL) || (p_report->p_adv_data == NULL))
+    {
+        APP_METRICS_INC(app_metrics.scan_reports_dropped_total);
+        APP_METRICS_INC(scan_stats.dropped);
+        if (!scan_is_replay)
+        {
+            __atomic_store_n(&scan_live_inflight, 0, __ATOMIC_RELEASE);
+        }
+        return;
+    }
+
+    p_report->rx_ticks = app_time_ticks();
+    p_report->result = *p_scan_result;
+    memcpy(p_report->p_adv_data, p_adv_data, p_report->adv_len);
+    app_spsc_ring_commit(&scan_ring);
+    if (!scan_is_replay)
+    {
+        __atomic_store_n(&scan_live_inflight, 0, __ATOMIC_RELEASE);
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&scan_worker_parked, __ATOMIC_RELAXED))
+    {
+        scan_futex(&scan_worker_parked, FUTEX_WAKE, 1, NULL);
+    }
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_set_rules
+********************************************************************************
+* Summary:
+*   Replace the host side copy of the armed wake rules. The new set is built
+*   in the buffer that is not published and made visible with one pointer
+*   store. Before that buffer is rewritten the worker must have acknowledged
+*   the publication that retired it (scan_rules_wait_quiescent); rules only
+*   change on arm, so in practice it has long done so and nothing waits.
+*   Callers are serialized, there is one arm path per process.
+*
+* Parameters:
+*   const app_adv_rule_t* p_rules: rules, NULL or count 0 to clear
+*   uint32_t count:                number of rules
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+void wakeon_le_scan_set_rules(const app_adv_rule_t* p_rules, uint32_t count)
+{
+    app_adv_rule_set_t* p_set;
+    uint32_t i;
+
+    if ((p_rules == NULL) || (count == 0))
+    {
+        __atomic_store_n(&p_scan_rules, NULL, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&scan_rules_gen, 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    scan_rules_wait_quiescent();
+    p_set = (__atomic_load_n(&p_scan_rules, __ATOMIC_RELAXED) == &scan_rules[0]) ? &scan_rules[1] : &scan_rules[0];
+    app_adv_rule_set_init(p_set);
+    for (i = 0; i < count; i++)
+    {
+        if (app_adv_rule_set_add(p_set, &p_rules[i]) != APP_ADV_MATCH_SUCCESS)
+        {
+            TRACE_ERR("host rule %u rejected\n", i);
+        }
+    }
+    __atomic_store_n(&p_scan_rules, p_set, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&scan_rules_gen, 1, __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_devices
+********************************************************************************
+* Summary:
+*   Device table filled by the scan worker. Lookups are safe from any thread.
+*
+*******************************************************************************/
+app_device_table_t* wakeon_le_scan_devices(void)
+{
+    return &scan_devices;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_rule_count
+********************************************************************************
+* Summary:
+*   Number of host matching rules currently installed
+*
+*******************************************************************************/
+uint32_t wakeon_le_scan_rule_count(void)
+{
+    const app_adv_rule_set_t* p_rules = __atomic_load_n(&p_scan_rules, __ATOMIC_ACQUIRE);
+
+    return (p_rules != NULL) ? p_rules->num_rules : 0U;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_capture_open
+********************************************************************************
+* Summary:
+*   Start writing every report to a capture file. Call before
+*   wakeon_le_scan_start().
+*
+* Parameters:
+*   const char* path: capture file, appended to if it exists
+*
+* Return:
+*   BOOL32: WICED_TRUE on success
+*
+*******************************************************************************/
+BOOL32 wakeon_le_scan_capture_open(const char* path)
+{
+    if (__atomic_load_n(&scan_running, __ATOMIC_ACQUIRE) || __atomic_load_n(&scan_capture_open, __ATOMIC_ACQUIRE))
+    {
+        return WICED_FALSE;
+    }
+    if (app_adv_capture_writer_open(&scan_capture, path) != APP_ADV_CAPTURE_SUCCESS)
+    {
+        return WICED_FALSE;
+    }
+    __atomic_store_n(&scan_capture_open, 1, __ATOMIC_RELEASE);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_capture_close
+********************************************************************************
+* Summary:
+*   Have the worker write the last block and close the capture. Waits up
+*   to SCAN_CAPTURE_CLOSE_WAIT_MS for it.
+*
+*******************************************************************************/
+void wakeon_le_scan_capture_close(void)
+{
+    struct timespec tick = { 0, 1000000L };
+    uint32_t waited;
+
+    if (!__atomic_load_n(&scan_capture_open, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+    if (!__atomic_load_n(&scan_running, __ATOMIC_ACQUIRE))
+    {
+        scan_capture_finish();
+        return;
+    }
+    __atomic_store_n(&scan_capture_close_req, 1, __ATOMIC_SEQ_CST);
+    scan_futex(&scan_worker_parked, FUTEX_WAKE, 1, NULL);
+    for (waited = 0; (waited < SCAN_CAPTURE_CLOSE_WAIT_MS) && __atomic_load_n(&scan_capture_close_req, __ATOMIC_ACQUIRE); waited++)
+    {
+        nanosleep(&tick, NULL);
+    }
+    if (__atomic_load_n(&scan_capture_close_req, __ATOMIC_ACQUIRE))
+    {
+        TRACE_ERR("scan worker did not close the capture\n");
+    }
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_get_stats
+********************************************************************************
+* Summary:
+*   Snapshot of the report path totals. Counters only grow; take two
+*   snapshots and subtract them to measure an interval.
+*
+* Parameters:
+*   wakeon_le_scan_stats_t* p_stats: filled with the totals
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+void wakeon_le_scan_get_stats(wakeon_le_scan_stats_t* p_stats)
+{
+    uint32_t i;
+
+    p_stats->processed = __atomic_load_n(&scan_stats.processed, __ATOMIC_ACQUIRE);
+    p_stats->dropped = __atomic_load_n(&scan_stats.dropped, __ATOMIC_RELAXED);
+    p_stats->ignored = __atomic_load_n(&scan_stats.ignored, __ATOMIC_RELAXED);
+    for (i = 0; i < WAKEON_LE_SCAN_LATENCY_BUCKETS; i++)
+    {
+        p_stats->latency[i] = __atomic_load_n(&scan_stats.latency[i], __ATOMIC_RELAXED);
+    }
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_latency_bucket_ns
+********************************************************************************
+* Summary:
+*   Largest latency counted in a histogram bucket
+*
+*******************************************************************************/
+uint64_t wakeon_le_scan_latency_bucket_ns(uint32_t bucket)
+{
+    uint32_t octave;
+
+    if (bucket < 4U)
+    {
+        return bucket;
+    }
+    octave = bucket / 4U + 1U;
+    return ((uint64_t)(4U + bucket % 4U) << (octave - 2U)) + (1ULL << (octave - 2U)) - 1U;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_scan_replay_claim
+********************************************************************************
+* Summary:
+*   Make the calling thread the only producer of the report ring, or give
+*   the ring back to the stack thread. While claimed, reports submitted by
+*   other threads are ignored and counted. Claiming waits for a submit
+*   already running on the stack thread to finish.
+*
+* Parameters:
+*   BOOL32 claim: WICED_TRUE to claim, WICED_FALSE to release
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+void wakeon_le_scan_replay_claim(BOOL32 claim)
+{
+    if (claim)
+    {
+        __atomic_store_n(&scan_replay_owner, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&scan_live_inflight, __ATOMIC_SEQ_CST))
+        {
+            sched_yield();
+        }
+        scan_is_replay = WICED_TRUE;
+    }
+    else
+    {
+        scan_is_replay = WICED_FALSE;
+        __atomic_store_n(&scan_replay_owner, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/* END OF FILE [] */
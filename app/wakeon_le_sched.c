@@ -0,0 +1,352 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: wakeon_le_sched.c
+ *
+ * Description: This is the source file for the wake path scheduling.
+ *              Both threads on the wake path belong to the porting layer:
+ *              the HCI RX thread runs every stack callback, and the GPIO
+ *              thread that runs bt_host_wake_assert_cback() is created by
+ *              platform_gpio_poll() on the HCI RX thread. So the HCI RX
+ *              thread sets itself up from the first management callback,
+ *              and takes the --rt-gpio setting for the duration of
+ *              platform_gpio_poll(), for the GPIO thread to inherit it.
+ *              The first wake on a GPIO thread checks that it did.
+ *
+ *              The probe runs with the GPIO thread setting and reports the
+ *              delay between a timer expiring and the thread running, which
+ *              is the part of the wake latency this module can improve.
+ *
+ * Related Document: See README.md
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+*******************************************************************************
+*      INCLUDES
+*******************************************************************************/
+#include <string.h>
+#include <errno.h>
+#include <malloc.h>
+#include "data_types.h"
+#include "app_metrics.h"
+#include "app_opts.h"
+#include "app_rt.h"
+#include "wakeon_le_sched.h"
+#include "log.h"
+
+#ifdef TAG
+#undef TAG
+#endif
+#define TAG "[WAKEONLE_SCHED]"
+
+/*******************************************************************************
+*       MACROS
+*******************************************************************************/
+#define SCHED_DESC_MAX              (128U)
+/* --mlock-stack range in KiB */
+#define SCHED_STACK_MIN_KB          (64U)
+#define SCHED_STACK_MAX_KB          (8192U)
+
+/*******************************************************************************
+*       VARIABLE DEFINITIONS
+*******************************************************************************/
+static app_rt_thread_cfg_t sched_hci;
+static app_rt_thread_cfg_t sched_gpio;
+static BOOL32 sched_hci_set = WICED_FALSE;
+static BOOL32 sched_gpio_set = WICED_FALSE;
+/* HCI RX thread setting while it holds the GPIO one */
+static app_rt_thread_cfg_t sched_gpio_saved;
+static BOOL32 sched_gpio_swapped = WICED_FALSE;
+static __thread BOOL32 sched_gpio_checked = WICED_FALSE;
+
+/*******************************************************************************
+*       FUNCTION DEFINITION
+*******************************************************************************/
+/*******************************************************************************
+* Function Name: sched_parse
+********************************************************************************
+* Summary:
+*   Parse one thread option and check it can be applied, on the calling
+*   thread, which is then restored
+*
+*******************************************************************************/
+static BOOL32 sched_parse(const char* p_opt, const char* p_text, app_rt_thread_cfg_t* p_cfg, BOOL32* p_set)
+{
+    app_rt_thread_cfg_t saved;
+    char desc[SCHED_DESC_MAX];
+
+    if (p_text[0] == '\0')
+    {
+        return WICED_TRUE;
+    }
+    if (app_rt_parse_thread(p_text, p_cfg) != APP_RT_SUCCESS)
+    {
+        TRACE_ERR("bad %s %s, expected <priority>[@<cpus>], eg: 80@2\n", p_opt, p_text);
+        return WICED_FALSE;
+    }
+    if ((app_rt_get_thread(&saved) != APP_RT_SUCCESS) || (app_rt_set_thread(p_cfg) != APP_RT_SUCCESS))
+    {
+        TRACE_ERR("%s %s: %s%s\n", p_opt, p_text, strerror(errno),
+                  (errno == EPERM) ? ", SCHED_FIFO needs CAP_SYS_NICE or RLIMIT_RTPRIO" : "");
+        return WICED_FALSE;
+    }
+    app_rt_set_thread(&saved);
+    app_rt_format_thread(p_cfg, desc, sizeof(desc));
+    TRACE_LOG("%s: %s\n", p_opt, desc);
+    *p_set = WICED_TRUE;
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: sched_probe_observe
+********************************************************************************
+* Summary:
+*   Export each probe delay with the application metrics
+*
+*******************************************************************************/
+static void sched_probe_observe(uint64_t latency_ns)
+{
+    app_metrics_hist_observe(&app_metrics.sched_latency, latency_ns);
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_sched_mlock_prepare
+********************************************************************************
+* Summary:
+*   With --mlock, set the stack size of the threads created afterwards, the
+*   porting layer's included, since mlockall() locks and faults in whole
+*   stacks, and keep glibc to one malloc arena, since each further arena
+*   reserves 64 MiB that MCL_FUTURE locks; called before the first thread
+*   is created
+*
+* Parameters: NONE
+*
+* Return:
+*   BOOL32: WICED_FALSE if --mlock-stack is out of range or not accepted
+*
+*******************************************************************************/
+BOOL32 wakeon_le_sched_mlock_prepare(void)
+{
+    if (app_opts.mlock == 0)
+    {
+        return WICED_TRUE;
+    }
+    if ((app_opts.mlock_stack_kb < SCHED_STACK_MIN_KB) || (app_opts.mlock_stack_kb > SCHED_STACK_MAX_KB) ||
+        (app_rt_set_stack_size((size_t)app_opts.mlock_stack_kb * 1024U) != APP_RT_SUCCESS))
+    {
+        TRACE_ERR("--mlock-stack %u failed, %u..%u KiB\n", (unsigned)app_opts.mlock_stack_kb,
+                  SCHED_STACK_MIN_KB, SCHED_STACK_MAX_KB);
+        return WICED_FALSE;
+    }
+#ifdef M_ARENA_MAX
+    /* scan reports come from the buffer pool, so one arena is seldom contended */
+    mallopt(M_ARENA_MAX, 1);
+#endif
+    TRACE_LOG("thread stacks: %u KiB\n", (unsigned)app_opts.mlock_stack_kb);
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_sched_setup
+********************************************************************************
+* Summary:
+*   Check the thread settings, lock memory and start the probe, before
+*   the stack is initialized
+*
+* Parameters: NONE
+*
+* Return:
+*   BOOL32: WICED_FALSE if an option is wrong or not permitted
+*
+*******************************************************************************/
+BOOL32 wakeon_le_sched_setup(void)
+{
+    app_rt_thread_cfg_t probe;
+
+    if ((sched_parse("--rt-hci", app_opts.rt_hci, &sched_hci, &sched_hci_set) == WICED_FALSE) ||
+        (sched_parse("--rt-gpio", app_opts.rt_gpio, &sched_gpio, &sched_gpio_set) == WICED_FALSE))
+    {
+        return WICED_FALSE;
+    }
+
+    if (app_opts.mlock != 0)
+    {
+        if (app_rt_lock_memory() != APP_RT_SUCCESS)
+        {
+            TRACE_ERR("mlockall failed: %s, RLIMIT_MEMLOCK (ulimit -l) may be too low\n", strerror(errno));
+            return WICED_FALSE;
+        }
+        TRACE_LOG("memory locked: %u KiB\n", (unsigned)app_rt_locked_kb());
+    }
+
+    if (app_opts.rt_probe_us != 0)
+    {
+        if (sched_gpio_set == WICED_TRUE)
+        {
+            probe = sched_gpio;
+        }
+        else if (app_rt_get_thread(&probe) != APP_RT_SUCCESS)
+        {
+            return WICED_FALSE;
+        }
+        if (app_rt_probe_start(&probe, app_opts.rt_probe_us, sched_probe_observe) != APP_RT_SUCCESS)
+        {
+            TRACE_ERR("start --rt-probe %u failed: %s, period %u..%u us\n", (unsigned)app_opts.rt_probe_us,
+                      strerror(errno), APP_RT_PROBE_PERIOD_MIN_US, APP_RT_PROBE_PERIOD_MAX_US);
+            return WICED_FALSE;
+        }
+    }
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_sched_hci_thread
+********************************************************************************
+* Summary:
+*   Apply --rt-hci to the calling thread; called from BTM_ENABLED_EVT, on
+*   the HCI RX thread
+*
+*******************************************************************************/
+void wakeon_le_sched_hci_thread(void)
+{
+    if ((sched_hci_set == WICED_TRUE) && (app_rt_set_thread(&sched_hci) != APP_RT_SUCCESS))
+    {
+        TRACE_ERR("set HCI RX thread scheduling failed: %s\n", strerror(errno));
+    }
+    if (app_opts.mlock != 0)
+    {
+        TRACE_LOG("memory locked with the stack up: %u KiB\n", (unsigned)app_rt_locked_kb());
+    }
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_sched_gpio_begin
+********************************************************************************
+* Summary:
+*   Take --rt-gpio on the calling thread, before platform_gpio_poll()
+*   creates the HOST-WAKE thread; wakeon_le_sched_gpio_end() restores it
+*
+*******************************************************************************/
+void wakeon_le_sched_gpio_begin(void)
+{
+    if (sched_gpio_set == WICED_FALSE)
+    {
+        return;
+    }
+    if (app_rt_get_thread(&sched_gpio_saved) != APP_RT_SUCCESS)
+    {
+        return;
+    }
+    if (app_rt_set_thread(&sched_gpio) != APP_RT_SUCCESS)
+    {
+        TRACE_ERR("set GPIO thread scheduling failed: %s\n", strerror(errno));
+        app_rt_set_thread(&sched_gpio_saved);
+        return;
+    }
+    sched_gpio_swapped = WICED_TRUE;
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_sched_gpio_end
+********************************************************************************
+* Summary:
+*   Restore the calling thread after wakeon_le_sched_gpio_begin()
+*
+*******************************************************************************/
+void wakeon_le_sched_gpio_end(void)
+{
+    if (sched_gpio_swapped == WICED_TRUE)
+    {
+        app_rt_set_thread(&sched_gpio_saved);
+        sched_gpio_swapped = WICED_FALSE;
+    }
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_sched_gpio_check
+********************************************************************************
+* Summary:
+*   Called on the HOST-WAKE thread after a wake is handled: the first time
+*   on a thread, apply --rt-gpio if the thread did not inherit it, eg:
+*   because the porting layer creates it with its own attributes
+*
+*******************************************************************************/
+void wakeon_le_sched_gpio_check(void)
+{
+    app_rt_thread_cfg_t cur;
+
+    if ((sched_gpio_set == WICED_FALSE) || (sched_gpio_checked == WICED_TRUE))
+    {
+        return;
+    }
+    sched_gpio_checked = WICED_TRUE;
+    if ((app_rt_get_thread(&cur) == APP_RT_SUCCESS) && (cur.policy == sched_gpio.policy) &&
+        (cur.priority == sched_gpio.priority) &&
+        ((sched_gpio.pinned == 0) || (memcmp(cur.cpus, sched_gpio.cpus, sizeof(cur.cpus)) == 0)))
+    {
+        return;
+    }
+    TRACE_LOG("HOST-WAKE thread did not inherit --rt-gpio, setting it now\n");
+    if (app_rt_set_thread(&sched_gpio) != APP_RT_SUCCESS)
+    {
+        TRACE_ERR("set GPIO thread scheduling failed: %s\n", strerror(errno));
+    }
+}
+
+/*******************************************************************************
+* Function Name: wakeon_le_sched_stop
+********************************************************************************
+* Summary:
+*   Stop the probe and print the scheduling latency it measured
+*
+*******************************************************************************/
+void wakeon_le_sched_stop(void)
+{
+    app_rt_latency_t latency;
+
+    if (app_opts.rt_probe_us == 0)
+    {
+        return;
+    }
+    app_rt_probe_stop(&latency);
+    TRACE_MSG("scheduling latency: %llu wake-ups every %u us, p50 %llu us, p99 %llu us, p99.9 %llu us, max %llu us",
+              (unsigned long long)latency.samples, (unsigned)app_opts.rt_probe_us,
+              (unsigned long long)app_rt_latency_percentile_us(&latency, 0.50),
+              (unsigned long long)app_rt_latency_percentile_us(&latency, 0.99),
+              (unsigned long long)app_rt_latency_percentile_us(&latency, 0.999),
+              (unsigned long long)latency.max_us);
+}
+
+/* END OF FILE [] */
@@ -61,6 +61,21 @@
 /* Interval of random address refreshing */
 #define CY_BT_RPA_TIMEOUT                                     ( 0 )
 
+/*
+ * Scanner-only profile (WAKEONLE_CFG_PROFILE=SCANNER): the application only
+ * scans, so it needs no connection, no L2CAP channel and no GATT MTU above
+ * the minimum. The stack sizes its per-link and per-channel pools from these.
+ */
+#ifdef WAKEONLE_CFG_SCANNER_ONLY
+/* Maximum attribute length */
+#define CY_BT_MAX_ATTR_LEN                                    ( 23 )
+/* Maximum attribute MTU size */
+#define CY_BT_MTU_SIZE                                        ( 23 )
+
+/* Maximum connections */
+#define CY_BT_SERVER_MAX_LINKS                                ( 0 )
+#define CY_BT_CLIENT_MAX_LINKS                                ( 0 )
+#else
 /* Maximum attribute length */
 #define CY_BT_MAX_ATTR_LEN                                    ( 512 )
 /* Maximum attribute MTU size */
@@ -69,14 +84,26 @@
 /* Maximum connections */
 #define CY_BT_SERVER_MAX_LINKS                                ( 1 )
 #define CY_BT_CLIENT_MAX_LINKS                                ( 0 )
+#endif
 
 /* BLE white list size */
 #define CY_BT_WHITE_LIST_SIZE                                 ( 0 )
 
 /* L2CAP configuration */
+#ifdef WAKEONLE_CFG_SCANNER_ONLY
+#define CY_BT_L2CAP_MAX_LE_PSM                                ( 0 )
+#define CY_BT_L2CAP_MAX_LE_CHANNELS                           ( 0 )
+/* 65 is the lowest value the stack accepts, see ble_max_rx_pdu_size */
+#define CY_BT_L2CAP_MTU_SIZE                                  ( 65 )
+/* LE address resolution DB entries */
+#define CY_BT_ADDR_RESOLUTION_DB_SIZE                         ( 0 )
+#else
 #define CY_BT_L2CAP_MAX_LE_PSM                                ( 1 )
 #define CY_BT_L2CAP_MAX_LE_CHANNELS                           ( 1 )
 #define CY_BT_L2CAP_MTU_SIZE                                  ( 512 )
+/* LE address resolution DB entries */
+#define CY_BT_ADDR_RESOLUTION_DB_SIZE                         ( 5 )
+#endif
 
 /* Security level */
 #define CY_BT_SECURITY_LEVEL                                  BTM_SEC_BEST_EFFORT
@@ -137,8 +164,9 @@
 ******************************************************************************/
 /* Advertisement and scan response packets defines */
 #define CY_BT_ADV_PACKET_DATA_SIZE                            1
-/* BLE scan settings */
-const wiced_bt_cfg_ble_scan_settings_t cy_bt_cfg_scan_settings =
+/* BLE scan settings, --scan-interval and --scan-window adjust the low duty
+ * scan before the stack starts */
+wiced_bt_cfg_ble_scan_settings_t cy_bt_cfg_scan_settings =
 {
     .scan_mode                       = CY_BT_SCAN_MODE,                                               /* BLE scan mode (BTM_BLE_SCAN_MODE_PASSIVE, BTM_BLE_SCAN_MODE_ACTIVE, or BTM_BLE_SCAN_MODE_NONE) */
 
@@ -205,7 +233,7 @@ const wiced_bt_cfg_ble_t cy_bt_cfg_ble = {
                                                                                                         * Maximum MPS for EATT channels shall be set to <= this value */
     .appearance                      = CY_BT_APPEARANCE,                                              /* GATT appearance (see gatt_appearance_e) */
     .rpa_refresh_timeout             = CY_BT_RPA_TIMEOUT,                                             /* Interval of  random address refreshing - secs */
-    .host_addr_resolution_db_size    = 5,                                                             /* LE Address Resolution DB settings - effective only for pre 4.2 controller */
+    .host_addr_resolution_db_size    = CY_BT_ADDR_RESOLUTION_DB_SIZE,                                 /* LE Address Resolution DB settings - effective only for pre 4.2 controller */
     .p_ble_scan_cfg                  = &cy_bt_cfg_scan_settings,                                      /* BLE scan settings */
     .p_ble_advert_cfg                = &cy_bt_cfg_adv_settings,                                       /* BLE advertisement settings */
     .default_ble_power_level         = CY_BT_TX_POWER,                                                /* Default LE power level, Refer lm_TxPwrTable table for the power range */
@@ -0,0 +1,720 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_adv_capture.c
+ *
+ * Description: This is the source file for the advertising report capture
+ *              format (see app_adv_capture.h for the layout).
+ *
+ *              The writer fills the open block in memory and writes it with
+ *              pwrite() when it is full, when its dictionary is full, and at
+ *              most once per APP_ADV_CAPTURE_FLUSH_NS of record time, so the
+ *              file on disk is never more than that behind. The file is
+ *              extended to the end of the open block first, so it is always
+ *              a whole number of blocks and a partly written one reads as an
+ *              empty or short block.
+ *
+ *              The reader maps the file read-only. Records are decoded in
+ *              place and the returned address and AD pointers point into the
+ *              mapping.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "app_adv_capture.h"
+
+#if defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__ )
+#error "app_adv_capture stores headers in host byte order, which must be little endian"
+#endif
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+/* twice APP_ADV_CAPTURE_DICT_MAX, so the table stays at most half full */
+#define APP_ADV_CAPTURE_DICT_SLOTS          ( 8192U )
+/* head byte, 10 byte varint delta, address, RSSI, 3 byte varint length */
+#define APP_ADV_CAPTURE_RECORD_OVERHEAD     ( 1U + 10U + 6U + 1U + 3U )
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint64_t app_adv_capture_clock_ns( clockid_t clock )
+{
+    struct timespec ts;
+
+    clock_gettime( clock, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint8_t *app_adv_capture_put_varint( uint8_t *p, uint64_t value )
+{
+    while ( value >= 0x80U )
+    {
+        *p++ = (uint8_t)( value | 0x80U );
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static inline const uint8_t *app_adv_capture_get_varint( const uint8_t *p, const uint8_t *p_end, uint64_t *p_value )
+{
+    uint64_t value = 0;
+    uint32_t shift = 0;
+
+    while ( ( p < p_end ) && ( shift < 64U ) )
+    {
+        value |= (uint64_t)( *p & 0x7FU ) << shift;
+        if ( ( *p++ & 0x80U ) == 0 )
+        {
+            *p_value = value;
+            return p;
+        }
+        shift += 7U;
+    }
+    return NULL;
+}
+
+static inline uint32_t app_adv_capture_hash( const uint8_t *p_addr )
+{
+    uint64_t k = (uint64_t)p_addr[0] | ( (uint64_t)p_addr[1] << 8 ) | ( (uint64_t)p_addr[2] << 16 ) |
+                 ( (uint64_t)p_addr[3] << 24 ) | ( (uint64_t)p_addr[4] << 32 ) | ( (uint64_t)p_addr[5] << 40 );
+
+    k *= 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)( k >> 32 );
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_block_start()
+ ******************************************************************************
+ * Summary:
+ *   Start an empty block at the given file offset and extend the file over
+ *   it
+ *
+ *****************************************************************************/
+static int app_adv_capture_block_start( app_adv_capture_writer_t *p_writer, uint64_t offset )
+{
+    memset( p_writer->p_block, 0, APP_ADV_CAPTURE_BLOCK_SIZE );
+    p_writer->block_off = offset;
+    p_writer->p_header->magic = APP_ADV_CAPTURE_BLOCK_MAGIC;
+    p_writer->p_header->used = APP_ADV_CAPTURE_BLOCK_HEADER_LEN;
+    p_writer->prev_us = 0;
+    p_writer->dirty = 0;
+    /* a new generation empties the dictionary without touching it */
+    p_writer->dict_gen++;
+    if ( ftruncate( p_writer->fd, (off_t)( offset + APP_ADV_CAPTURE_BLOCK_SIZE ) ) != 0 )
+    {
+        p_writer->write_errors++;
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    return APP_ADV_CAPTURE_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_writer_open()
+ ******************************************************************************
+ * Summary:
+ *   Create a capture, or append to an existing one in new blocks
+ *
+ * Parameters:
+ *   app_adv_capture_writer_t *p_writer : writer
+ *   const char *path                   : capture file
+ *
+ * Return:
+ *  APP_ADV_CAPTURE_SUCCESS, or APP_ADV_CAPTURE_ERROR if the file cannot be
+ *  opened or is not a capture
+ *
+ *****************************************************************************/
+int app_adv_capture_writer_open( app_adv_capture_writer_t *p_writer, const char *path )
+{
+    app_adv_capture_file_header_t header;
+    struct stat st;
+    uint64_t blocks;
+
+    memset( p_writer, 0, sizeof( *p_writer ) );
+    p_writer->fd = open( path, O_RDWR | O_CREAT | O_CLOEXEC, 0644 );
+    if ( p_writer->fd < 0 )
+    {
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    p_writer->p_block = malloc( APP_ADV_CAPTURE_BLOCK_SIZE );
+    p_writer->p_dict = calloc( APP_ADV_CAPTURE_DICT_SLOTS, sizeof( *p_writer->p_dict ) );
+    if ( ( p_writer->p_block == NULL ) || ( p_writer->p_dict == NULL ) || ( fstat( p_writer->fd, &st ) != 0 ) )
+    {
+        goto fail;
+    }
+    p_writer->p_header = (app_adv_capture_block_header_t *)p_writer->p_block;
+
+    if ( st.st_size == 0 )
+    {
+        memset( &header, 0, sizeof( header ) );
+        memcpy( header.magic, APP_ADV_CAPTURE_MAGIC, sizeof( APP_ADV_CAPTURE_MAGIC ) );
+        header.version = APP_ADV_CAPTURE_VERSION;
+        header.header_len = APP_ADV_CAPTURE_FILE_HEADER_LEN;
+        header.block_size = APP_ADV_CAPTURE_BLOCK_SIZE;
+        header.created_ns = app_adv_capture_clock_ns( CLOCK_REALTIME );
+        if ( pwrite( p_writer->fd, &header, sizeof( header ), 0 ) != (ssize_t)sizeof( header ) )
+        {
+            goto fail;
+        }
+        blocks = 0;
+    }
+    else
+    {
+        if ( ( pread( p_writer->fd, &header, sizeof( header ), 0 ) != (ssize_t)sizeof( header ) ) ||
+             ( memcmp( header.magic, APP_ADV_CAPTURE_MAGIC, sizeof( APP_ADV_CAPTURE_MAGIC ) ) != 0 ) ||
+             ( header.version != APP_ADV_CAPTURE_VERSION ) || ( header.block_size != APP_ADV_CAPTURE_BLOCK_SIZE ) )
+        {
+            goto fail;
+        }
+        /* a partial block at the end, from a crash during its extension, is overwritten */
+        blocks = ( (uint64_t)st.st_size - APP_ADV_CAPTURE_FILE_HEADER_LEN ) / APP_ADV_CAPTURE_BLOCK_SIZE;
+    }
+
+    p_writer->realtime_offset_ns = (int64_t)( app_adv_capture_clock_ns( CLOCK_REALTIME ) -
+                                              app_adv_capture_clock_ns( CLOCK_MONOTONIC ) );
+    if ( app_adv_capture_block_start( p_writer, APP_ADV_CAPTURE_FILE_HEADER_LEN +
+                                                blocks * APP_ADV_CAPTURE_BLOCK_SIZE ) != APP_ADV_CAPTURE_SUCCESS )
+    {
+        goto fail;
+    }
+    return APP_ADV_CAPTURE_SUCCESS;
+
+fail:
+    close( p_writer->fd );
+    free( p_writer->p_block );
+    free( p_writer->p_dict );
+    memset( p_writer, 0, sizeof( *p_writer ) );
+    p_writer->fd = -1;
+    return APP_ADV_CAPTURE_ERROR;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_flush()
+ ******************************************************************************
+ * Summary:
+ *   Write the used part of the open block
+ *
+ *****************************************************************************/
+int app_adv_capture_flush( app_adv_capture_writer_t *p_writer )
+{
+    size_t len = p_writer->p_header->used;
+
+    if ( !p_writer->dirty )
+    {
+        return APP_ADV_CAPTURE_SUCCESS;
+    }
+    p_writer->dirty = 0;
+    if ( pwrite( p_writer->fd, p_writer->p_block, len, (off_t)p_writer->block_off ) != (ssize_t)len )
+    {
+        p_writer->write_errors++;
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    return APP_ADV_CAPTURE_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_writer_close()
+ ******************************************************************************
+ * Summary:
+ *   Write the open block and close the capture
+ *
+ *****************************************************************************/
+void app_adv_capture_writer_close( app_adv_capture_writer_t *p_writer )
+{
+    if ( p_writer->p_block == NULL )
+    {
+        return;
+    }
+    app_adv_capture_flush( p_writer );
+    /* drop the reserved block if nothing went into it */
+    if ( p_writer->p_header->records == 0 )
+    {
+        if ( ftruncate( p_writer->fd, (off_t)p_writer->block_off ) != 0 )
+        {
+            p_writer->write_errors++;
+        }
+    }
+    close( p_writer->fd );
+    free( p_writer->p_block );
+    free( p_writer->p_dict );
+    p_writer->p_block = NULL;
+    p_writer->p_dict = NULL;
+    p_writer->fd = -1;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_append()
+ ******************************************************************************
+ * Summary:
+ *   Append one advertising report. Not thread safe: use one writer per
+ *   thread, or serialise the calls.
+ *
+ * Parameters:
+ *   app_adv_capture_writer_t *p_writer : writer
+ *   uint64_t mono_ns                   : CLOCK_MONOTONIC time of the report
+ *   const uint8_t *p_addr              : BD address, 6 bytes
+ *   uint8_t addr_type                  : address type, 0 - 3
+ *   uint8_t evt_type                   : event type, 0 - 7
+ *   int8_t rssi                        : RSSI
+ *   const uint8_t *p_adv               : AD bytes
+ *   uint16_t adv_len                   : AD length, up to APP_ADV_CAPTURE_ADV_MAX
+ *
+ * Return:
+ *  APP_ADV_CAPTURE_SUCCESS, or APP_ADV_CAPTURE_ERROR when a block could not
+ *  be written; the report is dropped then
+ *
+ *****************************************************************************/
+int app_adv_capture_append( app_adv_capture_writer_t *p_writer, uint64_t mono_ns, const uint8_t *p_addr,
+                            uint8_t addr_type, uint8_t evt_type, int8_t rssi, const uint8_t *p_adv, uint16_t adv_len )
+{
+    app_adv_capture_block_header_t *p_header = p_writer->p_header;
+    app_adv_capture_dict_slot_t *p_slot;
+    uint64_t ts_ns = mono_ns + (uint64_t)p_writer->realtime_offset_ns;
+    uint64_t ts_us = ts_ns / 1000U;
+    uint32_t pos, new_addr = 0;
+    uint8_t *p;
+    int result = APP_ADV_CAPTURE_SUCCESS;
+
+    if ( adv_len > APP_ADV_CAPTURE_ADV_MAX )
+    {
+        adv_len = APP_ADV_CAPTURE_ADV_MAX;
+    }
+
+    pos = app_adv_capture_hash( p_addr ) & ( APP_ADV_CAPTURE_DICT_SLOTS - 1U );
+    for ( ;; )
+    {
+        p_slot = &p_writer->p_dict[pos];
+        if ( p_slot->gen != p_writer->dict_gen )
+        {
+            new_addr = 1;
+            break;
+        }
+        if ( memcmp( p_slot->addr, p_addr, 6 ) == 0 )
+        {
+            break;
+        }
+        pos = ( pos + 1U ) & ( APP_ADV_CAPTURE_DICT_SLOTS - 1U );
+    }
+
+    /* close the block when the record or the address does not fit */
+    if ( ( p_header->used + APP_ADV_CAPTURE_RECORD_OVERHEAD + adv_len > APP_ADV_CAPTURE_BLOCK_SIZE ) ||
+         ( new_addr && ( p_header->addrs >= APP_ADV_CAPTURE_DICT_MAX ) ) )
+    {
+        p_writer->dirty = 1;
+        if ( app_adv_capture_flush( p_writer ) != APP_ADV_CAPTURE_SUCCESS )
+        {
+            result = APP_ADV_CAPTURE_ERROR;
+        }
+        if ( app_adv_capture_block_start( p_writer, p_writer->block_off + APP_ADV_CAPTURE_BLOCK_SIZE ) != APP_ADV_CAPTURE_SUCCESS )
+        {
+            return APP_ADV_CAPTURE_ERROR;
+        }
+        /* the dictionary was emptied */
+        pos = app_adv_capture_hash( p_addr ) & ( APP_ADV_CAPTURE_DICT_SLOTS - 1U );
+        p_slot = &p_writer->p_dict[pos];
+        new_addr = 1;
+    }
+
+    if ( p_header->records == 0 )
+    {
+        p_header->first_ns = ts_ns;
+        p_writer->prev_us = ts_us;
+        p_writer->flushed_ns = mono_ns;
+    }
+    /* the clock is monotonic, a delta never goes negative */
+    if ( ts_us < p_writer->prev_us )
+    {
+        ts_us = p_writer->prev_us;
+    }
+
+    p = p_writer->p_block + p_header->used;
+    *p++ = (uint8_t)( ( evt_type & APP_ADV_CAPTURE_HEAD_EVT_MASK ) |
+                      ( ( addr_type & APP_ADV_CAPTURE_HEAD_TYPE_MASK ) << APP_ADV_CAPTURE_HEAD_TYPE_SHIFT ) |
+                      ( new_addr ? APP_ADV_CAPTURE_HEAD_NEW_ADDR : 0U ) );
+    p = app_adv_capture_put_varint( p, ts_us - p_writer->prev_us );
+    if ( new_addr )
+    {
+        memcpy( p, p_addr, 6 );
+        p += 6;
+        memcpy( p_slot->addr, p_addr, 6 );
+        p_slot->index = (uint16_t)p_header->addrs++;
+        p_slot->gen = p_writer->dict_gen;
+    }
+    else
+    {
+        p = app_adv_capture_put_varint( p, p_slot->index );
+    }
+    *p++ = (uint8_t)rssi;
+    p = app_adv_capture_put_varint( p, adv_len );
+    memcpy( p, p_adv, adv_len );
+    p += adv_len;
+
+    p_writer->bytes_total += (uint64_t)( p - ( p_writer->p_block + p_header->used ) );
+    p_header->used = (uint32_t)( p - p_writer->p_block );
+    p_header->records++;
+    p_header->last_ns = ts_ns;
+    p_writer->prev_us = ts_us;
+    p_writer->records_total++;
+    p_writer->dirty = 1;
+
+    if ( mono_ns - p_writer->flushed_ns >= APP_ADV_CAPTURE_FLUSH_NS )
+    {
+        p_writer->flushed_ns = mono_ns;
+        if ( app_adv_capture_flush( p_writer ) != APP_ADV_CAPTURE_SUCCESS )
+        {
+            result = APP_ADV_CAPTURE_ERROR;
+        }
+    }
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_block()
+ ******************************************************************************
+ * Summary:
+ *   Header of a block, NULL if the block was never written
+ *
+ *****************************************************************************/
+static const app_adv_capture_block_header_t *app_adv_capture_block( const app_adv_capture_reader_t *p_reader,
+                                                                     uint32_t block )
+{
+    const app_adv_capture_block_header_t *p_header = (const app_adv_capture_block_header_t *)
+        ( p_reader->p_map + APP_ADV_CAPTURE_FILE_HEADER_LEN + (size_t)block * p_reader->block_size );
+
+    if ( ( p_header->magic != APP_ADV_CAPTURE_BLOCK_MAGIC ) || ( p_header->records == 0 ) ||
+         ( p_header->used > p_reader->block_size ) || ( p_header->used < APP_ADV_CAPTURE_BLOCK_HEADER_LEN ) )
+    {
+        return NULL;
+    }
+    return p_header;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_enter()
+ ******************************************************************************
+ * Summary:
+ *   Position the reader at the first record of a block
+ *
+ *****************************************************************************/
+static void app_adv_capture_enter( app_adv_capture_reader_t *p_reader, uint32_t block )
+{
+    const app_adv_capture_block_header_t *p_header;
+
+    p_reader->block = block;
+    p_reader->p_cur = NULL;
+    p_reader->p_end = NULL;
+    if ( block >= p_reader->num_blocks )
+    {
+        return;
+    }
+    p_header = app_adv_capture_block( p_reader, block );
+    if ( p_header == NULL )
+    {
+        return;
+    }
+    p_reader->p_cur = (const uint8_t *)p_header + APP_ADV_CAPTURE_BLOCK_HEADER_LEN;
+    p_reader->p_end = (const uint8_t *)p_header + p_header->used;
+    p_reader->first_ns = p_header->first_ns;
+    p_reader->first = 1;
+    p_reader->dict_count = 0;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_reader_open()
+ ******************************************************************************
+ * Summary:
+ *   Map a capture for reading, positioned at its first record
+ *
+ * Return:
+ *  APP_ADV_CAPTURE_SUCCESS, or APP_ADV_CAPTURE_ERROR if the file cannot be
+ *  mapped or is not a capture
+ *
+ *****************************************************************************/
+int app_adv_capture_reader_open( app_adv_capture_reader_t *p_reader, const char *path )
+{
+    const app_adv_capture_file_header_t *p_header;
+    struct stat st;
+    void *p_map;
+    int fd;
+
+    memset( p_reader, 0, sizeof( *p_reader ) );
+    fd = open( path, O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    if ( ( fstat( fd, &st ) != 0 ) || ( (size_t)st.st_size < APP_ADV_CAPTURE_FILE_HEADER_LEN ) )
+    {
+        close( fd );
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    p_map = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( p_map == MAP_FAILED )
+    {
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    p_header = p_map;
+    if ( ( memcmp( p_header->magic, APP_ADV_CAPTURE_MAGIC, sizeof( APP_ADV_CAPTURE_MAGIC ) ) != 0 ) ||
+         ( p_header->version != APP_ADV_CAPTURE_VERSION ) || ( p_header->block_size < APP_ADV_CAPTURE_BLOCK_HEADER_LEN ) )
+    {
+        munmap( p_map, (size_t)st.st_size );
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    p_reader->pp_dict = malloc( APP_ADV_CAPTURE_DICT_MAX * sizeof( *p_reader->pp_dict ) );
+    if ( p_reader->pp_dict == NULL )
+    {
+        munmap( p_map, (size_t)st.st_size );
+        return APP_ADV_CAPTURE_ERROR;
+    }
+    p_reader->p_map = p_map;
+    p_reader->map_len = (size_t)st.st_size;
+    p_reader->block_size = p_header->block_size;
+    p_reader->num_blocks = (uint32_t)( ( p_reader->map_len - APP_ADV_CAPTURE_FILE_HEADER_LEN ) / p_reader->block_size );
+    app_adv_capture_enter( p_reader, 0 );
+    return APP_ADV_CAPTURE_SUCCESS;
+}
+
+void app_adv_capture_reader_close( app_adv_capture_reader_t *p_reader )
+{
+    if ( p_reader->p_map != NULL )
+    {
+        munmap( (void *)p_reader->p_map, p_reader->map_len );
+    }
+    free( p_reader->pp_dict );
+    memset( p_reader, 0, sizeof( *p_reader ) );
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_next()
+ ******************************************************************************
+ * Summary:
+ *   Decode the next record
+ *
+ * Return:
+ *  APP_ADV_CAPTURE_SUCCESS, or APP_ADV_CAPTURE_END after the last record.
+ *  A corrupt block is skipped.
+ *
+ *****************************************************************************/
+int app_adv_capture_next( app_adv_capture_reader_t *p_reader, app_adv_capture_record_t *p_record )
+{
+    const uint8_t *p, *p_end;
+    uint64_t delta_us, value;
+    uint8_t head;
+
+    for ( ;; )
+    {
+        while ( ( p_reader->p_cur == NULL ) || ( p_reader->p_cur >= p_reader->p_end ) )
+        {
+            if ( p_reader->block + 1U >= p_reader->num_blocks )
+            {
+                p_reader->p_cur = p_reader->p_end = NULL;
+                return APP_ADV_CAPTURE_END;
+            }
+            app_adv_capture_enter( p_reader, p_reader->block + 1U );
+        }
+
+        p = p_reader->p_cur;
+        p_end = p_reader->p_end;
+        head = *p++;
+        p = app_adv_capture_get_varint( p, p_end, &delta_us );
+        if ( p == NULL )
+        {
+            goto corrupt;
+        }
+        if ( head & APP_ADV_CAPTURE_HEAD_NEW_ADDR )
+        {
+            if ( ( p + 6 > p_end ) || ( p_reader->dict_count >= APP_ADV_CAPTURE_DICT_MAX ) )
+            {
+                goto corrupt;
+            }
+            p_reader->pp_dict[p_reader->dict_count++] = p;
+            p_record->p_addr = p;
+            p += 6;
+        }
+        else
+        {
+            p = app_adv_capture_get_varint( p, p_end, &value );
+            if ( ( p == NULL ) || ( value >= p_reader->dict_count ) )
+            {
+                goto corrupt;
+            }
+            p_record->p_addr = p_reader->pp_dict[value];
+        }
+        if ( p >= p_end )
+        {
+            goto corrupt;
+        }
+        p_record->rssi = (int8_t)*p++;
+        p = app_adv_capture_get_varint( p, p_end, &value );
+        if ( ( p == NULL ) || ( value > APP_ADV_CAPTURE_ADV_MAX ) || ( p + value > p_end ) )
+        {
+            goto corrupt;
+        }
+        p_record->adv_len = (uint16_t)value;
+        p_record->p_adv = p;
+        p_record->evt_type = head & APP_ADV_CAPTURE_HEAD_EVT_MASK;
+        p_record->addr_type = ( head >> APP_ADV_CAPTURE_HEAD_TYPE_SHIFT ) & APP_ADV_CAPTURE_HEAD_TYPE_MASK;
+
+        if ( p_reader->first )
+        {
+            p_reader->first = 0;
+            p_reader->prev_us = p_reader->first_ns / 1000U;
+            p_record->ts_ns = p_reader->first_ns;
+        }
+        else
+        {
+            p_reader->prev_us += delta_us;
+            p_record->ts_ns = p_reader->prev_us * 1000U;
+        }
+        p_reader->p_cur = p + value;
+        return APP_ADV_CAPTURE_SUCCESS;
+
+corrupt:
+        p_reader->p_cur = p_reader->p_end;
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_seek()
+ ******************************************************************************
+ * Summary:
+ *   Position the reader at the first record at or after a time, by binary
+ *   search over the block headers and a scan of one block
+ *
+ * Parameters:
+ *   app_adv_capture_reader_t *p_reader : reader
+ *   uint64_t ts_ns                     : CLOCK_REALTIME time
+ *
+ * Return:
+ *  APP_ADV_CAPTURE_SUCCESS, or APP_ADV_CAPTURE_END if no record is that late
+ *
+ *****************************************************************************/
+int app_adv_capture_seek( app_adv_capture_reader_t *p_reader, uint64_t ts_ns )
+{
+    const app_adv_capture_block_header_t *p_header;
+    app_adv_capture_record_t record;
+    app_adv_capture_reader_t saved;
+    uint32_t lo = 0, hi = p_reader->num_blocks, mid, probe;
+
+    /* last block starting at or before ts_ns; unwritten blocks take the
+     * time of the next written one */
+    while ( lo < hi )
+    {
+        mid = lo + ( hi - lo ) / 2U;
+        for ( probe = mid; probe < hi; probe++ )
+        {
+            if ( app_adv_capture_block( p_reader, probe ) != NULL )
+            {
+                break;
+            }
+        }
+        p_header = ( probe < hi ) ? app_adv_capture_block( p_reader, probe ) : NULL;
+        if ( ( p_header != NULL ) && ( p_header->first_ns <= ts_ns ) )
+        {
+            lo = probe + 1U;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    app_adv_capture_enter( p_reader, ( lo > 0 ) ? lo - 1U : 0U );
+
+    for ( ;; )
+    {
+        saved = *p_reader;
+        if ( app_adv_capture_next( p_reader, &record ) != APP_ADV_CAPTURE_SUCCESS )
+        {
+            return APP_ADV_CAPTURE_END;
+        }
+        if ( record.ts_ns >= ts_ns )
+        {
+            /* unread it, reading it again re-adds its dictionary entry */
+            *p_reader = saved;
+            return APP_ADV_CAPTURE_SUCCESS;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_adv_capture_span()
+ ******************************************************************************
+ * Summary:
+ *   Time of the first and last record of the capture
+ *
+ * Return:
+ *  APP_ADV_CAPTURE_SUCCESS, or APP_ADV_CAPTURE_END if it has no records
+ *
+ *****************************************************************************/
+int app_adv_capture_span( const app_adv_capture_reader_t *p_reader, uint64_t *p_first_ns, uint64_t *p_last_ns )
+{
+    const app_adv_capture_block_header_t *p_header = NULL;
+    uint32_t i;
+
+    for ( i = 0; ( i < p_reader->num_blocks ) && ( p_header == NULL ); i++ )
+    {
+        p_header = app_adv_capture_block( p_reader, i );
+    }
+    if ( p_header == NULL )
+    {
+        return APP_ADV_CAPTURE_END;
+    }
+    *p_first_ns = p_header->first_ns;
+    for ( i = p_reader->num_blocks; i > 0; i-- )
+    {
+        p_header = app_adv_capture_block( p_reader, i - 1U );
+        if ( p_header != NULL )
+        {
+            *p_last_ns = p_header->last_ns;
+            break;
+        }
+    }
+    return APP_ADV_CAPTURE_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,198 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_adv_capture.h
+ *
+ * Description: This is the header file for the advertising report capture
+ *              format. A capture is a 64 byte file header followed by fixed
+ *              size blocks. Each block is self-contained: a header with the
+ *              wall clock time of its first and last record, then records
+ *              with the time as a delta in us from the previous one, the BD
+ *              address as an index into the block's address dictionary (or
+ *              the address itself on first use) and the raw AD bytes.
+ *
+ *              Blocks being fixed size and self-contained, a reader maps
+ *              the file and finds a time by binary search over the block
+ *              headers, and a capture cut short by a crash loses at most
+ *              the block being written.
+ *
+ *              All integers are little endian. Record layout:
+ *                uint8   evt_type (bits 0-2), addr_type (bits 3-4),
+ *                        new address (bit 5)
+ *                varint  time delta in us
+ *                6 bytes address if new, else varint dictionary index
+ *                int8    RSSI
+ *                varint  AD length, then the AD bytes
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_ADV_CAPTURE_H__
+#define __APP_ADV_CAPTURE_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_ADV_CAPTURE_SUCCESS             ( 0 )
+#define APP_ADV_CAPTURE_ERROR               ( -1 )
+#define APP_ADV_CAPTURE_END                 ( 1 )
+
+#define APP_ADV_CAPTURE_MAGIC               "WLEADVC"
+#define APP_ADV_CAPTURE_VERSION             ( 1U )
+#define APP_ADV_CAPTURE_FILE_HEADER_LEN     ( 64U )
+#define APP_ADV_CAPTURE_BLOCK_MAGIC         ( 0x424C4557U )     /* "WELB" */
+#define APP_ADV_CAPTURE_BLOCK_HEADER_LEN    ( 32U )
+#define APP_ADV_CAPTURE_BLOCK_SIZE          ( 64U * 1024U )
+
+/* largest extended advertising data */
+#define APP_ADV_CAPTURE_ADV_MAX             ( 1650U )
+/* distinct addresses per block; a block is closed early when reached */
+#define APP_ADV_CAPTURE_DICT_MAX            ( 4096U )
+/* the writer rewrites its open block at most this often */
+#define APP_ADV_CAPTURE_FLUSH_NS            ( 1000000000ULL )
+
+#define APP_ADV_CAPTURE_HEAD_EVT_MASK       ( 0x07U )
+#define APP_ADV_CAPTURE_HEAD_TYPE_SHIFT     ( 3U )
+#define APP_ADV_CAPTURE_HEAD_TYPE_MASK      ( 0x03U )
+#define APP_ADV_CAPTURE_HEAD_NEW_ADDR       ( 0x20U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    char        magic[8];                   /* APP_ADV_CAPTURE_MAGIC */
+    uint16_t    version;
+    uint16_t    header_len;
+    uint32_t    block_size;
+    uint64_t    created_ns;                 /* CLOCK_REALTIME */
+    uint8_t     reserved[40];
+} app_adv_capture_file_header_t;
+
+typedef struct
+{
+    uint32_t    magic;                      /* APP_ADV_CAPTURE_BLOCK_MAGIC */
+    uint32_t    used;                       /* bytes, header included */
+    uint32_t    records;
+    uint32_t    addrs;                      /* dictionary entries */
+    uint64_t    first_ns;                   /* CLOCK_REALTIME of the first record */
+    uint64_t    last_ns;
+} app_adv_capture_block_header_t;
+
+/* writer address dictionary slot */
+typedef struct
+{
+    uint8_t     addr[6];
+    uint16_t    index;
+    uint32_t    gen;                        /* block generation, stale slots are empty */
+} app_adv_capture_dict_slot_t;
+
+typedef struct
+{
+    int                             fd;
+    uint8_t                         *p_block;
+    uint64_t                        block_off;      /* file offset of the open block */
+    app_adv_capture_block_header_t  *p_header;
+    uint64_t                        prev_us;
+    int64_t                         realtime_offset_ns;
+    uint64_t                        flushed_ns;
+    uint32_t                        dirty;
+    app_adv_capture_dict_slot_t     *p_dict;
+    uint32_t                        dict_gen;
+    /* statistics */
+    uint64_t                        records_total;
+    uint64_t                        bytes_total;
+    uint64_t                        write_errors;
+} app_adv_capture_writer_t;
+
+/* one decoded record; the pointers point into the mapped file */
+typedef struct
+{
+    uint64_t        ts_ns;                  /* CLOCK_REALTIME, us resolution after the first of a block */
+    const uint8_t   *p_addr;
+    uint8_t         addr_type;
+    uint8_t         evt_type;
+    int8_t          rssi;
+    uint16_t        adv_len;
+    const uint8_t   *p_adv;
+} app_adv_capture_record_t;
+
+typedef struct
+{
+    const uint8_t   *p_map;
+    size_t          map_len;
+    uint32_t        block_size;
+    uint32_t        num_blocks;
+    uint32_t        block;                  /* block being read */
+    const uint8_t   *p_cur;
+    const uint8_t   *p_end;
+    uint64_t        prev_us;
+    uint64_t        first_ns;
+    uint32_t        first;                  /* the next record is the first of its block */
+    const uint8_t   **pp_dict;
+    uint32_t        dict_count;
+} app_adv_capture_reader_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int app_adv_capture_writer_open( app_adv_capture_writer_t *p_writer, const char *path );
+
+void app_adv_capture_writer_close( app_adv_capture_writer_t *p_writer );
+
+int app_adv_capture_append( app_adv_capture_writer_t *p_writer, uint64_t mono_ns, const uint8_t *p_addr,
+                            uint8_t addr_type, uint8_t evt_type, int8_t rssi, const uint8_t *p_adv, uint16_t adv_len );
+
+int app_adv_capture_flush( app_adv_capture_writer_t *p_writer );
+
+int app_adv_capture_reader_open( app_adv_capture_reader_t *p_reader, const char *path );
+
+void app_adv_capture_reader_close( app_adv_capture_reader_t *p_reader );
+
+int app_adv_capture_seek( app_adv_capture_reader_t *p_reader, uint64_t ts_ns );
+
+int app_adv_capture_next( app_adv_capture_reader_t *p_reader, app_adv_capture_record_t *p_record );
+
+int app_adv_capture_span( const app_adv_capture_reader_t *p_reader, uint64_t *p_first_ns, uint64_t *p_last_ns );
+
+#endif /* __APP_ADV_CAPTURE_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,468 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_adv_match.c
+ *
+ * Description: This is the source file for host side wake rule matching.
+ *              The UUID table lookups use SSE2 on x86 and NEON on AArch64,
+ *              with a portable scalar fallback.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <string.h>
+#include "app_adv_parser.h"
+#include "app_adv_match.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define APP_ADV_MATCH_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define APP_ADV_MATCH_NEON
+#endif
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_adv_match_uuid16_scalar()
+ ******************************************************************************
+ * Summary:
+ *   Scalar lookups, return the mask of rules whose UUID equals the key. The
+ *   32 and 128 bit variants below follow the same pattern.
+ *
+ *****************************************************************************/
+static uint64_t app_adv_match_uuid16_scalar( const app_adv_rule_set_t *p_set, uint16_t key )
+{
+    uint64_t cand = 0;
+    uint32_t i;
+
+    for ( i = 0; i < p_set->num_uuid16; i++ )
+    {
+        if ( p_set->uuid16[i] == key )
+        {
+            cand |= 1ULL << p_set->uuid16_rule[i];
+        }
+    }
+    return cand;
+}
+
+static uint64_t app_adv_match_uuid32_scalar( const app_adv_rule_set_t *p_set, uint32_t key )
+{
+    uint64_t cand = 0;
+    uint32_t i;
+
+    for ( i = 0; i < p_set->num_uuid32; i++ )
+    {
+        if ( p_set->uuid32[i] == key )
+        {
+            cand |= 1ULL << p_set->uuid32_rule[i];
+        }
+    }
+    return cand;
+}
+
+static uint64_t app_adv_match_uuid128_scalar( const app_adv_rule_set_t *p_set, const uint8_t *p_key )
+{
+    uint64_t cand = 0;
+    uint32_t i;
+
+    for ( i = 0; i < p_set->num_uuid128; i++ )
+    {
+        if ( memcmp( p_set->uuid128[i], p_key, 16 ) == 0 )
+        {
+            cand |= 1ULL << p_set->uuid128_rule[i];
+        }
+    }
+    return cand;
+}
+
+#if defined(APP_ADV_MATCH_SSE2)
+/******************************************************************************
+ * Function Name: app_adv_match_uuid16()
+ ******************************************************************************
+ * Summary:
+ *   SSE2 lookups, 8 UUID16 or 4 UUID32 per compare and one compare per
+ *   UUID128. Tables are zero padded to the vector width; lanes past the
+ *   table end are masked off by index.
+ *
+ *****************************************************************************/
+static uint64_t app_adv_match_uuid16( const app_adv_rule_set_t *p_set, uint16_t key )
+{
+    const __m128i k = _mm_set1_epi16( (short)key );
+    uint64_t cand = 0;
+    uint32_t i, lane;
+    int bits;
+
+    for ( i = 0; i < p_set->num_uuid16; i += 8 )
+    {
+        bits = _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_load_si128( (const __m128i *)&p_set->uuid16[i] ), k ) );
+        while ( bits != 0 )
+        {
+            lane = (uint32_t)__builtin_ctz( (unsigned)bits ) >> 1;
+            bits &= ~( 3 << ( lane * 2 ) );
+            if ( i + lane < p_set->num_uuid16 )
+            {
+                cand |= 1ULL << p_set->uuid16_rule[i + lane];
+            }
+        }
+    }
+    return cand;
+}
+
+static uint64_t app_adv_match_uuid32( const app_adv_rule_set_t *p_set, uint32_t key )
+{
+    const __m128i k = _mm_set1_epi32( (int)key );
+    uint64_t cand = 0;
+    uint32_t i, lane;
+    int bits;
+
+    for ( i = 0; i < p_set->num_uuid32; i += 4 )
+    {
+        bits = _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_load_si128( (const __m128i *)&p_set->uuid32[i] ), k ) ) );
+        while ( bits != 0 )
+        {
+            lane = (uint32_t)__builtin_ctz( (unsigned)bits );
+            bits &= bits - 1;
+            if ( i + lane < p_set->num_uuid32 )
+            {
+                cand |= 1ULL << p_set->uuid32_rule[i + lane];
+            }
+        }
+    }
+    return cand;
+}
+
+static uint64_t app_adv_match_uuid128( const app_adv_rule_set_t *p_set, const uint8_t *p_key )
+{
+    const __m128i k = _mm_loadu_si128( (const __m128i *)p_key );
+    uint64_t cand = 0;
+    uint32_t i;
+
+    for ( i = 0; i < p_set->num_uuid128; i++ )
+    {
+        if ( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_load_si128( (const __m128i *)p_set->uuid128[i] ), k ) ) == 0xFFFF )
+        {
+            cand |= 1ULL << p_set->uuid128_rule[i];
+        }
+    }
+    return cand;
+}
+
+#elif defined(APP_ADV_MATCH_NEON)
+/******************************************************************************
+ * Function Name: app_adv_match_uuid16()
+ ******************************************************************************
+ * Summary:
+ *   NEON lookups. A horizontal max rejects a block of 8 UUID16 or 4 UUID32
+ *   with no hit; blocks with a hit, which are rare, are resolved lane by
+ *   lane.
+ *
+ *****************************************************************************/
+static uint64_t app_adv_match_uuid16( const app_adv_rule_set_t *p_set, uint16_t key )
+{
+    const uint16x8_t k = vdupq_n_u16( key );
+    uint64_t cand = 0;
+    uint32_t i, lane;
+
+    for ( i = 0; i < p_set->num_uuid16; i += 8 )
+    {
+        if ( vmaxvq_u16( vceqq_u16( vld1q_u16( &p_set->uuid16[i] ), k ) ) == 0 )
+        {
+            continue;
+        }
+        for ( lane = 0; ( lane < 8 ) && ( i + lane < p_set->num_uuid16 ); lane++ )
+        {
+            if ( p_set->uuid16[i + lane] == key )
+            {
+                cand |= 1ULL << p_set->uuid16_rule[i + lane];
+            }
+        }
+    }
+    return cand;
+}
+
+static uint64_t app_adv_match_uuid32( const app_adv_rule_set_t *p_set, uint32_t key )
+{
+    const uint32x4_t k = vdupq_n_u32( key );
+    uint64_t cand = 0;
+    uint32_t i, lane;
+
+    for ( i = 0; i < p_set->num_uuid32; i += 4 )
+    {
+        if ( vmaxvq_u32( vceqq_u32( vld1q_u32( &p_set->uuid32[i] ), k ) ) == 0 )
+        {
+            continue;
+        }
+        for ( lane = 0; ( lane < 4 ) && ( i + lane < p_set->num_uuid32 ); lane++ )
+        {
+            if ( p_set->uuid32[i + lane] == key )
+            {
+                cand |= 1ULL << p_set->uuid32_rule[i + lane];
+            }
+        }
+    }
+    return cand;
+}
+
+static uint64_t app_adv_match_uuid128( const app_adv_rule_set_t *p_set, const uint8_t *p_key )
+{
+    const uint8x16_t k = vld1q_u8( p_key );
+    uint64_t cand = 0;
+    uint32_t i;
+
+    for ( i = 0; i < p_set->num_uuid128; i++ )
+    {
+        if ( vminvq_u8( vceqq_u8( vld1q_u8( p_set->uuid128[i] ), k ) ) == 0xFF )
+        {
+            cand |= 1ULL << p_set->uuid128_rule[i];
+        }
+    }
+    return cand;
+}
+
+#else
+#define app_adv_match_uuid16    app_adv_match_uuid16_scalar
+#define app_adv_match_uuid32    app_adv_match_uuid32_scalar
+#define app_adv_match_uuid128   app_adv_match_uuid128_scalar
+#endif
+
+/******************************************************************************
+ * Function Name: app_adv_match_manu()
+ ******************************************************************************
+ * Summary:
+ *   Masked compare of a manufacturer specific data field, same semantics as
+ *   the controller APCF manufacturer filter.
+ *
+ *****************************************************************************/
+static int app_adv_match_manu( const app_adv_rule_t *p_rule, const app_ad_field_t *p_field )
+{
+    uint16_t cid;
+    uint32_t i;
+
+    if ( p_field->len < 2U + p_rule->pattern_len )
+    {
+        return 0;
+    }
+    cid = (uint16_t)( p_field->p_value[0] | ( p_field->p_value[1] << 8 ) );
+    if ( ( cid & p_rule->company_id_mask ) != ( p_rule->company_id & p_rule->company_id_mask ) )
+    {
+        return 0;
+    }
+    for ( i = 0; i < p_rule->pattern_len; i++ )
+    {
+        if ( ( p_field->p_value[2 + i] ^ p_rule->pattern[i] ) & p_rule->pattern_mask[i] )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_rule_set_init()
+ ******************************************************************************
+ * Summary:
+ *   Empty a rule set
+ *
+ *****************************************************************************/
+void app_adv_rule_set_init( app_adv_rule_set_t *p_set )
+{
+    memset( p_set, 0, sizeof( *p_set ) );
+}
+
+/******************************************************************************
+ * Function Name: app_adv_rule_set_add()
+ ******************************************************************************
+ * Summary:
+ *   Append a rule. Rule index is the insertion order and is what
+ *   app_adv_rule_set_match returns.
+ *
+ * Parameters:
+ *   app_adv_rule_set_t *p_set    : rule set
+ *   const app_adv_rule_t *p_rule : rule, copied
+ *
+ * Return:
+ *  APP_ADV_MATCH_SUCCESS or APP_ADV_MATCH_ERROR if full or invalid
+ *
+ *****************************************************************************/
+int app_adv_rule_set_add( app_adv_rule_set_t *p_set, const app_adv_rule_t *p_rule )
+{
+    uint32_t idx = p_set->num_rules;
+
+    if ( ( idx >= APP_ADV_MATCH_RULES_MAX ) || ( p_rule->pattern_len > APP_ADV_MATCH_PATTERN_MAX ) )
+    {
+        return APP_ADV_MATCH_ERROR;
+    }
+
+    switch ( p_rule->uuid_len )
+    {
+        case 0:
+            p_set->no_uuid_rules |= 1ULL << idx;
+            break;
+        case 2:
+            p_set->uuid16_rule[p_set->num_uuid16] = (uint8_t)idx;
+            p_set->uuid16[p_set->num_uuid16++] = (uint16_t)( p_rule->uuid[0] | ( p_rule->uuid[1] << 8 ) );
+            break;
+        case 4:
+            p_set->uuid32_rule[p_set->num_uuid32] = (uint8_t)idx;
+            p_set->uuid32[p_set->num_uuid32++] = (uint32_t)p_rule->uuid[0] | ( (uint32_t)p_rule->uuid[1] << 8 ) |
+                                                 ( (uint32_t)p_rule->uuid[2] << 16 ) | ( (uint32_t)p_rule->uuid[3] << 24 );
+            break;
+        case 16:
+            p_set->uuid128_rule[p_set->num_uuid128] = (uint8_t)idx;
+            memcpy( p_set->uuid128[p_set->num_uuid128++], p_rule->uuid, 16 );
+            break;
+        default:
+            return APP_ADV_MATCH_ERROR;
+    }
+
+    p_set->rules[idx] = *p_rule;
+    p_set->num_rules++;
+    return APP_ADV_MATCH_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_rule_set_match()
+ ******************************************************************************
+ * Summary:
+ *   Test one advertising payload against every rule. The payload is walked
+ *   once: each UUID found in a service UUID list is looked up in the table
+ *   of its width, and the first manufacturer data field is remembered for
+ *   the rules that also carry a pattern.
+ *
+ * Parameters:
+ *   const app_adv_rule_set_t *p_set : rule set
+ *   const uint8_t *p_data           : advertising payload
+ *   uint16_t len                    : payload length
+ *
+ * Return:
+ *  index of the lowest matching rule, APP_ADV_MATCH_NONE if none
+ *
+ *****************************************************************************/
+int app_adv_rule_set_match( const app_adv_rule_set_t *p_set, const uint8_t *p_data, uint16_t len )
+{
+    const int scalar = ( p_set->scalar_only != 0 );
+    app_ad_iter_t iter;
+    app_ad_field_t field;
+    app_ad_field_t manu = { 0, 0, NULL };
+    uint64_t cand = p_set->no_uuid_rules;
+    const app_adv_rule_t *p_rule;
+    uint32_t i;
+    uint32_t r;
+
+    if ( p_set->num_rules == 0 )
+    {
+        return APP_ADV_MATCH_NONE;
+    }
+
+    app_ad_iter_init( &iter, p_data, len );
+    while ( app_ad_iter_next( &iter, &field ) )
+    {
+        switch ( field.type )
+        {
+            case APP_AD_TYPE_UUID16_PARTIAL:
+            case APP_AD_TYPE_UUID16_COMPLETE:
+                for ( i = 0; ( p_set->num_uuid16 != 0 ) && ( i + 2 <= field.len ); i += 2 )
+                {
+                    uint16_t key = (uint16_t)( field.p_value[i] | ( field.p_value[i + 1] << 8 ) );
+                    cand |= scalar ? app_adv_match_uuid16_scalar( p_set, key ) : app_adv_match_uuid16( p_set, key );
+                }
+                break;
+            case APP_AD_TYPE_UUID32_PARTIAL:
+            case APP_AD_TYPE_UUID32_COMPLETE:
+                for ( i = 0; ( p_set->num_uuid32 != 0 ) && ( i + 4 <= field.len ); i += 4 )
+                {
+                    uint32_t key = (uint32_t)field.p_value[i] | ( (uint32_t)field.p_value[i + 1] << 8 ) |
+                                   ( (uint32_t)field.p_value[i + 2] << 16 ) | ( (uint32_t)field.p_value[i + 3] << 24 );
+                    cand |= scalar ? app_adv_match_uuid32_scalar( p_set, key ) : app_adv_match_uuid32( p_set, key );
+                }
+                break;
+            case APP_AD_TYPE_UUID128_PARTIAL:
+            case APP_AD_TYPE_UUID128_COMPLETE:
+                for ( i = 0; ( p_set->num_uuid128 != 0 ) && ( i + 16 <= field.len ); i += 16 )
+                {
+                    cand |= scalar ? app_adv_match_uuid128_scalar( p_set, &field.p_value[i] ) :
+                                     app_adv_match_uuid128( p_set, &field.p_value[i] );
+                }
+                break;
+            case APP_AD_TYPE_MANUFACTURER:
+                if ( manu.p_value == NULL )
+                {
+                    manu = field;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    while ( cand != 0 )
+    {
+        r = (uint32_t)__builtin_ctzll( cand );
+        cand &= cand - 1;
+        p_rule = &p_set->rules[r];
+        if ( !p_rule->has_manu || ( ( manu.p_value != NULL ) && app_adv_match_manu( p_rule, &manu ) ) )
+        {
+            return (int)r;
+        }
+    }
+    return APP_ADV_MATCH_NONE;
+}
+
+/******************************************************************************
+ * Function Name: app_adv_match_impl()
+ ******************************************************************************
+ * Summary:
+ *   Name of the UUID lookup implementation compiled in
+ *
+ *****************************************************************************/
+const char *app_adv_match_impl( void )
+{
+#if defined(APP_ADV_MATCH_SSE2)
+    return "sse2";
+#elif defined(APP_ADV_MATCH_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+/* [] END OF FILE */
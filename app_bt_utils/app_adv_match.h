@@ -0,0 +1,115 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_adv_match.h
+ *
+ * Description: This is the header file for host side matching of
+ *              advertising payloads against a set of wake rules (service
+ *              UUID and/or manufacturer data pattern). All UUIDs of one
+ *              width are kept in a packed table so one report is tested
+ *              against every rule with a few vector compares.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_ADV_MATCH_H__
+#define __APP_ADV_MATCH_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_ADV_MATCH_SUCCESS               ( 0 )
+#define APP_ADV_MATCH_ERROR                 ( -1 )
+#define APP_ADV_MATCH_NONE                  ( -1 )
+
+/* rule candidates are tracked in a 64 bit mask */
+#define APP_ADV_MATCH_RULES_MAX             ( 64U )
+/* manufacturer data of a 255 byte extended advertisement, after the AD
+ * header and company ID; the controller APCF filter takes 27 of them */
+#define APP_ADV_MATCH_PATTERN_MAX           ( 251U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    uint8_t     uuid_len;                       /* 0 (any), 2, 4 or 16 */
+    uint8_t     uuid[16];                       /* little endian, as on air */
+    uint8_t     has_manu;
+    uint16_t    company_id;
+    uint16_t    company_id_mask;
+    uint8_t     pattern_len;
+    uint8_t     pattern[APP_ADV_MATCH_PATTERN_MAX];
+    uint8_t     pattern_mask[APP_ADV_MATCH_PATTERN_MAX];
+    uint8_t     filter_idx;                     /* APCF filter this rule mirrors */
+} app_adv_rule_t;
+
+typedef struct
+{
+    /* packed per width UUID tables, entry i belongs to rule uuidN_rule[i] */
+    uint16_t        uuid16[APP_ADV_MATCH_RULES_MAX] __attribute__((aligned(16)));
+    uint32_t        uuid32[APP_ADV_MATCH_RULES_MAX] __attribute__((aligned(16)));
+    uint8_t         uuid128[APP_ADV_MATCH_RULES_MAX][16] __attribute__((aligned(16)));
+    uint8_t         uuid16_rule[APP_ADV_MATCH_RULES_MAX];
+    uint8_t         uuid32_rule[APP_ADV_MATCH_RULES_MAX];
+    uint8_t         uuid128_rule[APP_ADV_MATCH_RULES_MAX];
+    uint32_t        num_uuid16;
+    uint32_t        num_uuid32;
+    uint32_t        num_uuid128;
+    uint64_t        no_uuid_rules;              /* rules that do not need a UUID */
+    uint32_t        num_rules;
+    uint32_t        scalar_only;                /* bypass the vector path, for benchmarking */
+    app_adv_rule_t  rules[APP_ADV_MATCH_RULES_MAX];
+} app_adv_rule_set_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void app_adv_rule_set_init( app_adv_rule_set_t *p_set );
+
+int app_adv_rule_set_add( app_adv_rule_set_t *p_set, const app_adv_rule_t *p_rule );
+
+int app_adv_rule_set_match( const app_adv_rule_set_t *p_set, const uint8_t *p_data, uint16_t len );
+
+const char *app_adv_match_impl( void );
+
+#endif /* __APP_ADV_MATCH_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,113 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_adv_parser.c
+ *
+ * Description: This is the source file for the advertising data parser.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include "app_adv_parser.h"
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_ad_total_len()
+ ******************************************************************************
+ * Summary:
+ *   Length of the significant part of an advertising payload, ie: the bytes
+ *   covered by complete AD structures. Padding after them and a structure
+ *   cut short by max_len are left out; nothing past max_len is read.
+ *
+ * Parameters:
+ *   const uint8_t *p_data    : advertising payload
+ *   uint16_t max_len         : payload length
+ *
+ * Return:
+ *  number of bytes
+ *
+ *****************************************************************************/
+uint16_t app_ad_total_len( const uint8_t *p_data, uint16_t max_len )
+{
+    app_ad_iter_t iter;
+    app_ad_field_t field;
+    uint16_t len = 0;
+
+    app_ad_iter_init( &iter, p_data, max_len );
+    while ( app_ad_iter_next( &iter, &field ) )
+    {
+        len = (uint16_t)( field.p_value + field.len - p_data );
+    }
+    return len;
+}
+
+/******************************************************************************
+ * Function Name: app_ad_find()
+ ******************************************************************************
+ * Summary:
+ *   Find the first AD structure of a given type.
+ *
+ * Parameters:
+ *   const uint8_t *p_data    : advertising payload
+ *   uint16_t len             : payload length
+ *   uint8_t type             : AD type
+ *   app_ad_field_t *p_field  : output, points into p_data
+ *
+ * Return:
+ *  1 if found, 0 otherwise
+ *
+ *****************************************************************************/
+int app_ad_find( const uint8_t *p_data, uint16_t len, uint8_t type, app_ad_field_t *p_field )
+{
+    app_ad_iter_t iter;
+
+    app_ad_iter_init( &iter, p_data, len );
+    while ( app_ad_iter_next( &iter, p_field ) )
+    {
+        if ( p_field->type == type )
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* [] END OF FILE */
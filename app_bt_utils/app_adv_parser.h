@@ -0,0 +1,147 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_adv_parser.h
+ *
+ * Description: This is the header file for the advertising data parser. It
+ *              walks the length/type/value AD structures of an advertising
+ *              payload in place; fields point into the caller's buffer and
+ *              nothing is copied.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_ADV_PARSER_H__
+#define __APP_ADV_PARSER_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+/* AD types, Bluetooth Assigned Numbers 2.3 */
+#define APP_AD_TYPE_FLAGS                   ( 0x01 )
+#define APP_AD_TYPE_UUID16_PARTIAL          ( 0x02 )
+#define APP_AD_TYPE_UUID16_COMPLETE         ( 0x03 )
+#define APP_AD_TYPE_UUID32_PARTIAL          ( 0x04 )
+#define APP_AD_TYPE_UUID32_COMPLETE         ( 0x05 )
+#define APP_AD_TYPE_UUID128_PARTIAL         ( 0x06 )
+#define APP_AD_TYPE_UUID128_COMPLETE        ( 0x07 )
+#define APP_AD_TYPE_NAME_SHORT              ( 0x08 )
+#define APP_AD_TYPE_NAME_COMPLETE           ( 0x09 )
+#define APP_AD_TYPE_TX_POWER                ( 0x0A )
+#define APP_AD_TYPE_SERVICE_DATA16          ( 0x16 )
+#define APP_AD_TYPE_SERVICE_DATA32          ( 0x20 )
+#define APP_AD_TYPE_SERVICE_DATA128         ( 0x21 )
+#define APP_AD_TYPE_MANUFACTURER            ( 0xFF )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* one AD structure, p_value points into the advertising payload */
+typedef struct
+{
+    uint8_t         type;
+    uint8_t         len;        /* value length, excludes the type byte */
+    const uint8_t   *p_value;
+} app_ad_field_t;
+
+typedef struct
+{
+    const uint8_t   *p;
+    const uint8_t   *p_end;
+} app_ad_iter_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+/*******************************************************************************
+* Function Name: app_ad_iter_init
+********************************************************************************
+* Summary:
+*   Start iterating over len bytes of advertising data.
+*
+*******************************************************************************/
+static inline void app_ad_iter_init( app_ad_iter_t *p_iter, const uint8_t *p_data, uint16_t len )
+{
+    p_iter->p = p_data;
+    p_iter->p_end = ( p_data != NULL ) ? p_data + len : NULL;
+}
+
+/*******************************************************************************
+* Function Name: app_ad_iter_next
+********************************************************************************
+* Summary:
+*   Return the next AD structure. Iteration stops at the end of the data, at
+*   a zero length byte (significant part ended) or at a structure that would
+*   run past the end.
+*
+* Return:
+*   1 if p_field was filled in, 0 when done
+*
+*******************************************************************************/
+static inline int app_ad_iter_next( app_ad_iter_t *p_iter, app_ad_field_t *p_field )
+{
+    const uint8_t *p = p_iter->p;
+    uint8_t len;
+
+    if ( ( p == NULL ) || ( p >= p_iter->p_end ) || ( p[0] == 0 ) )
+    {
+        return 0;
+    }
+    len = p[0];
+    if ( len > (size_t)( p_iter->p_end - p ) - 1 )
+    {
+        p_iter->p = p_iter->p_end;
+        return 0;
+    }
+    p_field->type    = p[1];
+    p_field->len     = (uint8_t)( len - 1 );
+    p_field->p_value = p + 2;
+    p_iter->p        = p + 1 + len;
+    return 1;
+}
+
+uint16_t app_ad_total_len( const uint8_t *p_data, uint16_t max_len );
+
+int app_ad_find( const uint8_t *p_data, uint16_t len, uint8_t type, app_ad_field_t *p_field );
+
+#endif /* __APP_ADV_PARSER_H__ */
+
+/* [] END OF FILE */
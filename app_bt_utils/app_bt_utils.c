@@ -13,17 +13,187 @@
  *      INCLUDES
  ******************************************************************************/
 #include "app_bt_utils.h"
+#include "app_fmt.h"
 #include "wiced_bt_dev.h"
 
 /******************************************************************************
 *       MACRO DEFINITIONS
 ******************************************************************************/
-#define CASE_DEFAULT_STR default: printf("%s: defalut case\n", __FUNCTION__); break;
+/* bytes formatted per write by print_array(), a multiple of 16 */
+#define PRINT_ARRAY_CHUNK   (256U)
+
+/******************************************************************************
+ *      GLOBAL VARIABLES
+ *****************************************************************************/
+/* Dense name tables indexed by value, a missing entry is NULL */
+static const char *const bt_event_names[] =
+{
+    APP_FMT_NAME(BTM_ENABLED_EVT)
+    APP_FMT_NAME(BTM_DISABLED_EVT)
+    APP_FMT_NAME(BTM_POWER_MANAGEMENT_STATUS_EVT)
+    APP_FMT_NAME(BTM_PIN_REQUEST_EVT)
+    APP_FMT_NAME(BTM_USER_CONFIRMATION_REQUEST_EVT)
+    APP_FMT_NAME(BTM_PASSKEY_NOTIFICATION_EVT)
+    APP_FMT_NAME(BTM_PASSKEY_REQUEST_EVT)
+    APP_FMT_NAME(BTM_KEYPRESS_NOTIFICATION_EVT)
+    APP_FMT_NAME(BTM_PAIRING_IO_CAPABILITIES_BR_EDR_REQUEST_EVT)
+    APP_FMT_NAME(BTM_PAIRING_IO_CAPABILITIES_BR_EDR_RESPONSE_EVT)
+    APP_FMT_NAME(BTM_PAIRING_IO_CAPABILITIES_BLE_REQUEST_EVT)
+    APP_FMT_NAME(BTM_PAIRING_COMPLETE_EVT)
+    APP_FMT_NAME(BTM_ENCRYPTION_STATUS_EVT)
+    APP_FMT_NAME(BTM_SECURITY_REQUEST_EVT)
+    APP_FMT_NAME(BTM_SECURITY_FAILED_EVT)
+    APP_FMT_NAME(BTM_SECURITY_ABORTED_EVT)
+    APP_FMT_NAME(BTM_READ_LOCAL_OOB_DATA_COMPLETE_EVT)
+    APP_FMT_NAME(BTM_REMOTE_OOB_DATA_REQUEST_EVT)
+    APP_FMT_NAME(BTM_PAIRED_DEVICE_LINK_KEYS_UPDATE_EVT)
+    APP_FMT_NAME(BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT)
+    APP_FMT_NAME(BTM_LOCAL_IDENTITY_KEYS_UPDATE_EVT)
+    APP_FMT_NAME(BTM_LOCAL_IDENTITY_KEYS_REQUEST_EVT)
+    APP_FMT_NAME(BTM_BLE_SCAN_STATE_CHANGED_EVT)
+    APP_FMT_NAME(BTM_BLE_ADVERT_STATE_CHANGED_EVT)
+    APP_FMT_NAME(BTM_SMP_REMOTE_OOB_DATA_REQUEST_EVT)
+    APP_FMT_NAME(BTM_SMP_SC_REMOTE_OOB_DATA_REQUEST_EVT)
+    APP_FMT_NAME(BTM_SMP_SC_LOCAL_OOB_DATA_NOTIFICATION_EVT)
+    APP_FMT_NAME(BTM_SCO_CONNECTED_EVT)
+    APP_FMT_NAME(BTM_SCO_DISCONNECTED_EVT)
+    APP_FMT_NAME(BTM_SCO_CONNECTION_REQUEST_EVT)
+    APP_FMT_NAME(BTM_SCO_CONNECTION_CHANGE_EVT)
+    APP_FMT_NAME(BTM_BLE_CONNECTION_PARAM_UPDATE)
+    APP_FMT_NAME(BTM_BLE_PHY_UPDATE_EVT)
+};
+
+static const char *const bt_advert_mode_names[] =
+{
+    APP_FMT_NAME(BTM_BLE_ADVERT_OFF)
+    APP_FMT_NAME(BTM_BLE_ADVERT_DIRECTED_HIGH)
+    APP_FMT_NAME(BTM_BLE_ADVERT_DIRECTED_LOW)
+    APP_FMT_NAME(BTM_BLE_ADVERT_UNDIRECTED_HIGH)
+    APP_FMT_NAME(BTM_BLE_ADVERT_UNDIRECTED_LOW)
+    APP_FMT_NAME(BTM_BLE_ADVERT_NONCONN_HIGH)
+    APP_FMT_NAME(BTM_BLE_ADVERT_NONCONN_LOW)
+    APP_FMT_NAME(BTM_BLE_ADVERT_DISCOVERABLE_HIGH)
+    APP_FMT_NAME(BTM_BLE_ADVERT_DISCOVERABLE_LOW)
+};
+
+static const char *const bt_gatt_disconn_reason_names[] =
+{
+    APP_FMT_NAME(GATT_CONN_UNKNOWN)
+    APP_FMT_NAME(GATT_CONN_L2C_FAILURE)
+    APP_FMT_NAME(GATT_CONN_TIMEOUT)
+    APP_FMT_NAME(GATT_CONN_TERMINATE_PEER_USER)
+    APP_FMT_NAME(GATT_CONN_TERMINATE_LOCAL_HOST)
+    APP_FMT_NAME(GATT_CONN_FAIL_ESTABLISH)
+    APP_FMT_NAME(GATT_CONN_LMP_TIMEOUT)
+    APP_FMT_NAME(GATT_CONN_CANCEL)
+};
+
+static const char *const bt_gatt_status_names[] =
+{
+    APP_FMT_NAME(WICED_BT_GATT_SUCCESS || WICED_BT_GATT_ENCRYPTED_MITM)
+    APP_FMT_NAME(WICED_BT_GATT_INVALID_HANDLE)
+    APP_FMT_NAME(WICED_BT_GATT_READ_NOT_PERMIT)
+    APP_FMT_NAME(WICED_BT_GATT_WRITE_NOT_PERMIT)
+    APP_FMT_NAME(WICED_BT_GATT_INVALID_PDU)
+    APP_FMT_NAME(WICED_BT_GATT_INSUF_AUTHENTICATION)
+    APP_FMT_NAME(WICED_BT_GATT_REQ_NOT_SUPPORTED)
+    APP_FMT_NAME(WICED_BT_GATT_INVALID_OFFSET)
+    APP_FMT_NAME(WICED_BT_GATT_INSUF_AUTHORIZATION)
+    APP_FMT_NAME(WICED_BT_GATT_PREPARE_Q_FULL)
+    APP_FMT_NAME(WICED_BT_GATT_ATTRIBUTE_NOT_FOUND)
+    APP_FMT_NAME(WICED_BT_GATT_NOT_LONG)
+    APP_FMT_NAME(WICED_BT_GATT_INSUF_KEY_SIZE)
+    APP_FMT_NAME(WICED_BT_GATT_INVALID_ATTR_LEN)
+    APP_FMT_NAME(WICED_BT_GATT_ERR_UNLIKELY)
+    APP_FMT_NAME(WICED_BT_GATT_INSUF_ENCRYPTION)
+    APP_FMT_NAME(WICED_BT_GATT_UNSUPPORT_GRP_TYPE)
+    APP_FMT_NAME(WICED_BT_GATT_INSUF_RESOURCE)
+    APP_FMT_NAME(WICED_BT_GATT_ILLEGAL_PARAMETER)
+    APP_FMT_NAME(WICED_BT_GATT_NO_RESOURCES)
+    APP_FMT_NAME(WICED_BT_GATT_INTERNAL_ERROR)
+    APP_FMT_NAME(WICED_BT_GATT_WRONG_STATE)
+    APP_FMT_NAME(WICED_BT_GATT_DB_FULL)
+    APP_FMT_NAME(WICED_BT_GATT_BUSY)
+    APP_FMT_NAME(WICED_BT_GATT_ERROR)
+    APP_FMT_NAME(WICED_BT_GATT_CMD_STARTED)
+    APP_FMT_NAME(WICED_BT_GATT_PENDING)
+    APP_FMT_NAME(WICED_BT_GATT_AUTH_FAIL)
+    APP_FMT_NAME(WICED_BT_GATT_MORE)
+    APP_FMT_NAME(WICED_BT_GATT_INVALID_CFG)
+    APP_FMT_NAME(WICED_BT_GATT_SERVICE_STARTED)
+    APP_FMT_NAME(WICED_BT_GATT_ENCRYPTED_NO_MITM)
+    APP_FMT_NAME(WICED_BT_GATT_NOT_ENCRYPTED)
+    APP_FMT_NAME(WICED_BT_GATT_CONGESTED)
+    APP_FMT_NAME(WICED_BT_GATT_WRITE_REQ_REJECTED)
+    APP_FMT_NAME(WICED_BT_GATT_CCC_CFG_ERR)
+    APP_FMT_NAME(WICED_BT_GATT_PRC_IN_PROGRESS)
+    APP_FMT_NAME(WICED_BT_GATT_OUT_OF_RANGE)
+};
+
+static const char *const bt_smp_status_names[] =
+{
+    APP_FMT_NAME(SMP_SUCCESS)                 /**< Success */
+    APP_FMT_NAME(SMP_PASSKEY_ENTRY_FAIL)      /**< Passkey entry failed */
+    APP_FMT_NAME(SMP_OOB_FAIL)                /**< OOB failed */
+    APP_FMT_NAME(SMP_PAIR_AUTH_FAIL)          /**< Authentication failed */
+    APP_FMT_NAME(SMP_CONFIRM_VALUE_ERR)       /**< Value confirmation failed */
+    APP_FMT_NAME(SMP_PAIR_NOT_SUPPORT)        /**< Not supported */
+    APP_FMT_NAME(SMP_ENC_KEY_SIZE)            /**< Encryption key size failure */
+    APP_FMT_NAME(SMP_INVALID_CMD)             /**< Invalid command */
+    APP_FMT_NAME(SMP_PAIR_FAIL_UNKNOWN)       /**< Unknown failure */
+    APP_FMT_NAME(SMP_REPEATED_ATTEMPTS)       /**< Repeated attempts */
+    APP_FMT_NAME(SMP_INVALID_PARAMETERS)      /**< Invalid parameters  */
+    APP_FMT_NAME(SMP_DHKEY_CHK_FAIL)          /**< DH Key check failed */
+    APP_FMT_NAME(SMP_NUMERIC_COMPAR_FAIL)     /**< Numeric comparison failed */
+    APP_FMT_NAME(SMP_BR_PAIRING_IN_PROGR)     /**< BR paIring in progress */
+    APP_FMT_NAME(SMP_XTRANS_DERIVE_NOT_ALLOW) /**< Cross transport key derivation not allowed */
+    /* bte smp status codes */
+    APP_FMT_NAME(SMP_PAIR_INTERNAL_ERR) /**< Internal error */
+    APP_FMT_NAME(SMP_UNKNOWN_IO_CAP)    /**< unknown IO capability, unable to decide associatino model */
+    APP_FMT_NAME(SMP_INIT_FAIL)         /**< Initialization failed */
+    APP_FMT_NAME(SMP_CONFIRM_FAIL)      /**< Confirmation failed */
+    APP_FMT_NAME(SMP_BUSY)              /**< Busy */
+    APP_FMT_NAME(SMP_ENC_FAIL)          /**< Encryption failed */
+    APP_FMT_NAME(SMP_STARTED)           /**< Started */
+    APP_FMT_NAME(SMP_RSP_TIMEOUT)       /**< Response timeout */
+    APP_FMT_NAME(SMP_FAIL)              /**< Generic failure */
+    APP_FMT_NAME(SMP_CONN_TOUT)         /**< Connection timeout */
+};
 
 /******************************************************************************
  *      FUNCTION DEFINITIONS
  *****************************************************************************/
 
+/******************************************************************************
+* Function Name: app_bt_utils_name()
+*******************************************************************************
+* Summary:
+*   Look up a name table, reporting values without an entry
+*
+* Parameters:
+*   const char *const *p_names    : name table
+*   size_t count                  : table entries
+*   unsigned int value            : value to name
+*   const char *p_unknown         : returned when there is no entry
+*   const char *p_func            : caller, for the report
+*
+* Return:
+*  name
+*
+*******************************************************************************/
+static const char *app_bt_utils_name(const char *const *p_names, size_t count, unsigned int value,
+                                     const char *p_unknown, const char *p_func)
+{
+    const char *p_name = app_fmt_name(p_names, count, value);
+
+    if (p_name == NULL)
+    {
+        printf("%s: defalut case\n", p_func);
+        return p_unknown;
+    }
+    return p_name;
+}
+
 /******************************************************************************
 * Function Name: print_bd_address()
 *******************************************************************************
@@ -40,8 +210,11 @@
 *******************************************************************************/
 void print_bd_address(wiced_bt_device_address_t bdadr)
 {
-    printf("%02X:%02X:%02X:%02X:%02X:%02X\n",
-            bdadr[0], bdadr[1], bdadr[2], bdadr[3], bdadr[4], bdadr[5]);
+    char line[APP_FMT_BDADDR_LEN];
+
+    app_fmt_bdaddr(line, bdadr);
+    line[APP_FMT_BDADDR_LEN - 1] = '\n';
+    fwrite(line, 1, sizeof(line), stdout);
 }
 
 /*******************************************************************************
@@ -61,18 +234,25 @@ void print_bd_address(wiced_bt_device_address_t bdadr)
 ********************************************************************************/
 void print_array(void * to_print, uint16_t len)
 {
+    char line[APP_FMT_HEX_DUMP_LEN(PRINT_ARRAY_CHUNK) + 1];
     uint16_t counter;
+    uint16_t n;
+    size_t line_len;
 
-    for (counter = 0; counter < len; counter++)
+    for (counter = 0; counter < len; counter += n)
     {
-        if (0 == counter % 16)
+        n = (len - counter < PRINT_ARRAY_CHUNK) ? (uint16_t)(len - counter) : PRINT_ARRAY_CHUNK;
+        line_len = app_fmt_hex_dump(line, (const uint8_t *)to_print + counter, n, counter);
+        if (counter + n == len)
         {
-           printf("\n");
+            line[line_len++] = '\n';
         }
-        printf("%02X ", *(((uint8_t *)(to_print)) + counter));
+        fwrite(line, 1, line_len, stdout);
+    }
+    if (len == 0)
+    {
+        fwrite("\n", 1, 1, stdout);
     }
-    printf("\n");
-
 }
 
 /*******************************************************************************
@@ -92,45 +272,7 @@ void print_array(void * to_print, uint16_t len)
 *******************************************************************************/
 const char *get_bt_event_name(wiced_bt_management_evt_t event)
 {
-    switch ((int)event)
-    {
-    CASE_RETURN_STR(BTM_ENABLED_EVT)
-    CASE_RETURN_STR(BTM_DISABLED_EVT)
-    CASE_RETURN_STR(BTM_POWER_MANAGEMENT_STATUS_EVT)
-    CASE_RETURN_STR(BTM_PIN_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_USER_CONFIRMATION_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_PASSKEY_NOTIFICATION_EVT)
-    CASE_RETURN_STR(BTM_PASSKEY_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_KEYPRESS_NOTIFICATION_EVT)
-    CASE_RETURN_STR(BTM_PAIRING_IO_CAPABILITIES_BR_EDR_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_PAIRING_IO_CAPABILITIES_BR_EDR_RESPONSE_EVT)
-    CASE_RETURN_STR(BTM_PAIRING_IO_CAPABILITIES_BLE_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_PAIRING_COMPLETE_EVT)
-    CASE_RETURN_STR(BTM_ENCRYPTION_STATUS_EVT)
-    CASE_RETURN_STR(BTM_SECURITY_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_SECURITY_FAILED_EVT)
-    CASE_RETURN_STR(BTM_SECURITY_ABORTED_EVT)
-    CASE_RETURN_STR(BTM_READ_LOCAL_OOB_DATA_COMPLETE_EVT)
-    CASE_RETURN_STR(BTM_REMOTE_OOB_DATA_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_PAIRED_DEVICE_LINK_KEYS_UPDATE_EVT)
-    CASE_RETURN_STR(BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_LOCAL_IDENTITY_KEYS_UPDATE_EVT)
-    CASE_RETURN_STR(BTM_LOCAL_IDENTITY_KEYS_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_BLE_SCAN_STATE_CHANGED_EVT)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_STATE_CHANGED_EVT)
-    CASE_RETURN_STR(BTM_SMP_REMOTE_OOB_DATA_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_SMP_SC_REMOTE_OOB_DATA_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_SMP_SC_LOCAL_OOB_DATA_NOTIFICATION_EVT)
-    CASE_RETURN_STR(BTM_SCO_CONNECTED_EVT)
-    CASE_RETURN_STR(BTM_SCO_DISCONNECTED_EVT)
-    CASE_RETURN_STR(BTM_SCO_CONNECTION_REQUEST_EVT)
-    CASE_RETURN_STR(BTM_SCO_CONNECTION_CHANGE_EVT)
-    CASE_RETURN_STR(BTM_BLE_CONNECTION_PARAM_UPDATE)
-    CASE_RETURN_STR(BTM_BLE_PHY_UPDATE_EVT)
-    CASE_DEFAULT_STR
-    }
-
-    return "UNKNOWN_EVENT";
+    return app_bt_utils_name(bt_event_names, APP_FMT_NAMES_COUNT(bt_event_names), (unsigned int)event, "UNKNOWN_EVENT", __FUNCTION__);
 }
 
 /*******************************************************************************
@@ -150,21 +292,7 @@ const char *get_bt_event_name(wiced_bt_management_evt_t event)
 *******************************************************************************/
 const char *get_bt_advert_mode_name(wiced_bt_ble_advert_mode_t mode)
 {
-    switch ((int)mode)
-    {
-    CASE_RETURN_STR(BTM_BLE_ADVERT_OFF)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_DIRECTED_HIGH)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_DIRECTED_LOW)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_UNDIRECTED_HIGH)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_UNDIRECTED_LOW)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_NONCONN_HIGH)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_NONCONN_LOW)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_DISCOVERABLE_HIGH)
-    CASE_RETURN_STR(BTM_BLE_ADVERT_DISCOVERABLE_LOW)
-    CASE_DEFAULT_STR
-    }
-
-    return "UNKNOWN_MODE";
+    return app_bt_utils_name(bt_advert_mode_names, APP_FMT_NAMES_COUNT(bt_advert_mode_names), (unsigned int)mode, "UNKNOWN_MODE", __FUNCTION__);
 }
 
 /*******************************************************************************
@@ -184,20 +312,7 @@ const char *get_bt_advert_mode_name(wiced_bt_ble_advert_mode_t mode)
 *******************************************************************************/
 const char *get_bt_gatt_disconn_reason_name(wiced_bt_gatt_disconn_reason_t reason)
 {
-    switch ((int)reason)
-    {
-    CASE_RETURN_STR(GATT_CONN_UNKNOWN)
-    CASE_RETURN_STR(GATT_CONN_L2C_FAILURE)
-    CASE_RETURN_STR(GATT_CONN_TIMEOUT)
-    CASE_RETURN_STR(GATT_CONN_TERMINATE_PEER_USER)
-    CASE_RETURN_STR(GATT_CONN_TERMINATE_LOCAL_HOST)
-    CASE_RETURN_STR(GATT_CONN_FAIL_ESTABLISH)
-    CASE_RETURN_STR(GATT_CONN_LMP_TIMEOUT)
-    CASE_RETURN_STR(GATT_CONN_CANCEL)
-    CASE_DEFAULT_STR
-    }
-
-    return "UNKNOWN_REASON";
+    return app_bt_utils_name(bt_gatt_disconn_reason_names, APP_FMT_NAMES_COUNT(bt_gatt_disconn_reason_names), (unsigned int)reason, "UNKNOWN_REASON", __FUNCTION__);
 }
 
 /*******************************************************************************
@@ -217,50 +332,7 @@ const char *get_bt_gatt_disconn_reason_name(wiced_bt_gatt_disconn_reason_t reaso
 *******************************************************************************/
 const char *get_bt_gatt_status_name(wiced_bt_gatt_status_t status)
 {
-    switch ((int)status)
-    {
-    CASE_RETURN_STR(WICED_BT_GATT_SUCCESS || WICED_BT_GATT_ENCRYPTED_MITM)
-    CASE_RETURN_STR(WICED_BT_GATT_INVALID_HANDLE)
-    CASE_RETURN_STR(WICED_BT_GATT_READ_NOT_PERMIT)
-    CASE_RETURN_STR(WICED_BT_GATT_WRITE_NOT_PERMIT)
-    CASE_RETURN_STR(WICED_BT_GATT_INVALID_PDU)
-    CASE_RETURN_STR(WICED_BT_GATT_INSUF_AUTHENTICATION)
-    CASE_RETURN_STR(WICED_BT_GATT_REQ_NOT_SUPPORTED)
-    CASE_RETURN_STR(WICED_BT_GATT_INVALID_OFFSET)
-    CASE_RETURN_STR(WICED_BT_GATT_INSUF_AUTHORIZATION)
-    CASE_RETURN_STR(WICED_BT_GATT_PREPARE_Q_FULL)
-    CASE_RETURN_STR(WICED_BT_GATT_ATTRIBUTE_NOT_FOUND)
-    CASE_RETURN_STR(WICED_BT_GATT_NOT_LONG)
-    CASE_RETURN_STR(WICED_BT_GATT_INSUF_KEY_SIZE)
-    CASE_RETURN_STR(WICED_BT_GATT_INVALID_ATTR_LEN)
-    CASE_RETURN_STR(WICED_BT_GATT_ERR_UNLIKELY)
-    CASE_RETURN_STR(WICED_BT_GATT_INSUF_ENCRYPTION)
-    CASE_RETURN_STR(WICED_BT_GATT_UNSUPPORT_GRP_TYPE)
-    CASE_RETURN_STR(WICED_BT_GATT_INSUF_RESOURCE)
-    CASE_RETURN_STR(WICED_BT_GATT_ILLEGAL_PARAMETER)
-    CASE_RETURN_STR(WICED_BT_GATT_NO_RESOURCES)
-    CASE_RETURN_STR(WICED_BT_GATT_INTERNAL_ERROR)
-    CASE_RETURN_STR(WICED_BT_GATT_WRONG_STATE)
-    CASE_RETURN_STR(WICED_BT_GATT_DB_FULL)
-    CASE_RETURN_STR(WICED_BT_GATT_BUSY)
-    CASE_RETURN_STR(WICED_BT_GATT_ERROR)
-    CASE_RETURN_STR(WICED_BT_GATT_CMD_STARTED)
-    CASE_RETURN_STR(WICED_BT_GATT_PENDING)
-    CASE_RETURN_STR(WICED_BT_GATT_AUTH_FAIL)
-    CASE_RETURN_STR(WICED_BT_GATT_MORE)
-    CASE_RETURN_STR(WICED_BT_GATT_INVALID_CFG)
-    CASE_RETURN_STR(WICED_BT_GATT_SERVICE_STARTED)
-    CASE_RETURN_STR(WICED_BT_GATT_ENCRYPTED_NO_MITM)
-    CASE_RETURN_STR(WICED_BT_GATT_NOT_ENCRYPTED)
-    CASE_RETURN_STR(WICED_BT_GATT_CONGESTED)
-    CASE_RETURN_STR(WICED_BT_GATT_WRITE_REQ_REJECTED)
-    CASE_RETURN_STR(WICED_BT_GATT_CCC_CFG_ERR)
-    CASE_RETURN_STR(WICED_BT_GATT_PRC_IN_PROGRESS)
-    CASE_RETURN_STR(WICED_BT_GATT_OUT_OF_RANGE)
-    CASE_DEFAULT_STR
-    }
-
-    return "UNKNOWN_STATUS";
+    return app_bt_utils_name(bt_gatt_status_names, APP_FMT_NAMES_COUNT(bt_gatt_status_names), (unsigned int)status, "UNKNOWN_STATUS", __FUNCTION__);
 }
 
 /*******************************************************************************
@@ -280,37 +352,6 @@ const char *get_bt_gatt_status_name(wiced_bt_gatt_status_t status)
 *******************************************************************************/
 const char *get_bt_smp_status_name(wiced_bt_smp_status_t status)
 {
-    switch ((int)status)
-    {
-    CASE_RETURN_STR(SMP_SUCCESS)                 /**< Success */
-    CASE_RETURN_STR(SMP_PASSKEY_ENTRY_FAIL)      /**< Passkey entry failed */
-    CASE_RETURN_STR(SMP_OOB_FAIL)                /**< OOB failed */
-    CASE_RETURN_STR(SMP_PAIR_AUTH_FAIL)          /**< Authentication failed */
-    CASE_RETURN_STR(SMP_CONFIRM_VALUE_ERR)       /**< Value confirmation failed */
-    CASE_RETURN_STR(SMP_PAIR_NOT_SUPPORT)        /**< Not supported */
-    CASE_RETURN_STR(SMP_ENC_KEY_SIZE)            /**< Encryption key size failure */
-    CASE_RETURN_STR(SMP_INVALID_CMD)             /**< Invalid command */
-    CASE_RETURN_STR(SMP_PAIR_FAIL_UNKNOWN)       /**< Unknown failure */
-    CASE_RETURN_STR(SMP_REPEATED_ATTEMPTS)       /**< Repeated attempts */
-    CASE_RETURN_STR(SMP_INVALID_PARAMETERS)      /**< Invalid parameters  */
-    CASE_RETURN_STR(SMP_DHKEY_CHK_FAIL)          /**< DH Key check failed */
-    CASE_RETURN_STR(SMP_NUMERIC_COMPAR_FAIL)     /**< Numeric comparison failed */
-    CASE_RETURN_STR(SMP_BR_PAIRING_IN_PROGR)     /**< BR paIring in progress */
-    CASE_RETURN_STR(SMP_XTRANS_DERIVE_NOT_ALLOW) /**< Cross transport key derivation not allowed */
-    /* bte smp status codes */
-    CASE_RETURN_STR(SMP_PAIR_INTERNAL_ERR) /**< Internal error */
-    CASE_RETURN_STR(SMP_UNKNOWN_IO_CAP)    /**< unknown IO capability, unable to decide associatino model */
-    CASE_RETURN_STR(SMP_INIT_FAIL)         /**< Initialization failed */
-    CASE_RETURN_STR(SMP_CONFIRM_FAIL)      /**< Confirmation failed */
-    CASE_RETURN_STR(SMP_BUSY)              /**< Busy */
-    CASE_RETURN_STR(SMP_ENC_FAIL)          /**< Encryption failed */
-    CASE_RETURN_STR(SMP_STARTED)           /**< Started */
-    CASE_RETURN_STR(SMP_RSP_TIMEOUT)       /**< Response timeout */
-    CASE_RETURN_STR(SMP_FAIL)              /**< Generic failure */
-    CASE_RETURN_STR(SMP_CONN_TOUT)         /**< Connection timeout */
-    CASE_DEFAULT_STR
-    }
-
-    return "UNKNOWN_STATUS";
+    return app_bt_utils_name(bt_smp_status_names, APP_FMT_NAMES_COUNT(bt_smp_status_names), (unsigned int)status, "UNKNOWN_STATUS", __FUNCTION__);
 }
 /* [] END OF FILE */
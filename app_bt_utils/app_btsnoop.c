@@ -0,0 +1,399 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_btsnoop.c
+ *
+ * Description: This is the source file for the btsnoop HCI capture.
+ *
+ *              The HCI threads only copy into the mapping under a mutex.
+ *              A helper thread does every system call: it keeps a spare
+ *              mapped file ready, and when the HCI side switches to it, it
+ *              renames the files and trims the full one to its used length.
+ *              A packet that arrives while no spare is ready is dropped and
+ *              counted in the drops field of the next record.
+ *
+ *              Files are trimmed on rotation and close; after a crash the
+ *              current file ends in zero filled space past the last record.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "app_btsnoop.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_BTSNOOP_HDR_LEN             ( 16U )
+#define APP_BTSNOOP_REC_HDR_LEN         ( 24U )
+#define APP_BTSNOOP_DATALINK_H4         ( 1002U )
+/* microseconds from 0000-01-01 to the Unix epoch */
+#define APP_BTSNOOP_EPOCH_DELTA_US      ( 0x00DCDDB30F2F8000ULL )
+#define APP_BTSNOOP_PATH_MAX            ( 256U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    int         fd;
+    uint8_t     *p_map;
+    uint32_t    used;
+} app_btsnoop_file_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static pthread_mutex_t      snoop_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t       snoop_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t            snoop_thread;
+static uint32_t             snoop_open = 0;
+static uint32_t             snoop_stopping = 0;
+static uint32_t             snoop_size = 0;
+static char                 snoop_path[APP_BTSNOOP_PATH_MAX];
+static char                 snoop_path_old[APP_BTSNOOP_PATH_MAX + 2];
+static char                 snoop_path_spare[APP_BTSNOOP_PATH_MAX + 6];
+static app_btsnoop_file_t   snoop_cur = { -1, NULL, 0 };
+static app_btsnoop_file_t   snoop_spare = { -1, NULL, 0 };
+static app_btsnoop_file_t   snoop_full = { -1, NULL, 0 };
+static uint64_t             snoop_dropped = 0;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_btsnoop_put32()
+ ******************************************************************************
+ * Summary:
+ *   Store a big endian 32 bit value, btsnoop fields are network order
+ *
+ *****************************************************************************/
+static void app_btsnoop_put32( uint8_t *p, uint32_t v )
+{
+    p[0] = (uint8_t)( v >> 24 );
+    p[1] = (uint8_t)( v >> 16 );
+    p[2] = (uint8_t)( v >> 8 );
+    p[3] = (uint8_t)v;
+}
+
+/******************************************************************************
+ * Function Name: app_btsnoop_file_create()
+ ******************************************************************************
+ * Summary:
+ *   Create, size and map a capture file and write the btsnoop header
+ *
+ *****************************************************************************/
+static int app_btsnoop_file_create( app_btsnoop_file_t *p_file, const char *path )
+{
+    p_file->fd = open( path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+    if ( p_file->fd < 0 )
+    {
+        return APP_BTSNOOP_ERROR;
+    }
+    /* allocate the blocks now so page faults on the HCI path never wait for the filesystem */
+    if ( posix_fallocate( p_file->fd, 0, snoop_size ) != 0 )
+    {
+        close( p_file->fd );
+        p_file->fd = -1;
+        return APP_BTSNOOP_ERROR;
+    }
+    p_file->p_map = mmap( NULL, snoop_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p_file->fd, 0 );
+    if ( p_file->p_map == MAP_FAILED )
+    {
+        p_file->p_map = NULL;
+        close( p_file->fd );
+        p_file->fd = -1;
+        return APP_BTSNOOP_ERROR;
+    }
+
+    memcpy( p_file->p_map, "btsnoop\0", 8 );
+    app_btsnoop_put32( p_file->p_map + 8, 1 );
+    app_btsnoop_put32( p_file->p_map + 12, APP_BTSNOOP_DATALINK_H4 );
+    p_file->used = APP_BTSNOOP_HDR_LEN;
+    return APP_BTSNOOP_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_btsnoop_file_finish()
+ ******************************************************************************
+ * Summary:
+ *   Unmap a capture file and trim it to the records written
+ *
+ *****************************************************************************/
+static void app_btsnoop_file_finish( app_btsnoop_file_t *p_file )
+{
+    if ( p_file->fd < 0 )
+    {
+        return;
+    }
+    munmap( p_file->p_map, snoop_size );
+    if ( ftruncate( p_file->fd, p_file->used ) != 0 )
+    {
+        perror( "btsnoop ftruncate" );
+    }
+    close( p_file->fd );
+    p_file->fd = -1;
+    p_file->p_map = NULL;
+    p_file->used = 0;
+}
+
+/******************************************************************************
+ * Function Name: app_btsnoop_thread_main()
+ ******************************************************************************
+ * Summary:
+ *   Rotation helper: finishes the file the HCI side filled and prepares the
+ *   next spare
+ *
+ *****************************************************************************/
+static void *app_btsnoop_thread_main( void *p_arg )
+{
+    app_btsnoop_file_t full, spare;
+
+    (void)p_arg;
+    pthread_mutex_lock( &snoop_lock );
+    while ( !snoop_stopping )
+    {
+        if ( snoop_full.fd >= 0 )
+        {
+            /* the HCI side moved to the spare, which is still named <path>.tmp */
+            full = snoop_full;
+            snoop_full.fd = -1;
+            pthread_mutex_unlock( &snoop_lock );
+            rename( snoop_path, snoop_path_old );
+            rename( snoop_path_spare, snoop_path );
+            app_btsnoop_file_finish( &full );
+            pthread_mutex_lock( &snoop_lock );
+            continue;
+        }
+        if ( snoop_spare.fd < 0 )
+        {
+            pthread_mutex_unlock( &snoop_lock );
+            if ( app_btsnoop_file_create( &spare, snoop_path_spare ) != APP_BTSNOOP_SUCCESS )
+            {
+                perror( "btsnoop spare file" );
+                spare.fd = -1;
+            }
+            pthread_mutex_lock( &snoop_lock );
+            snoop_spare = spare;
+            if ( spare.fd < 0 )
+            {
+                /* retried when the HCI side next needs it */
+                pthread_cond_wait( &snoop_cond, &snoop_lock );
+            }
+            continue;
+        }
+        pthread_cond_wait( &snoop_cond, &snoop_lock );
+    }
+    pthread_mutex_unlock( &snoop_lock );
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_btsnoop_open()
+ ******************************************************************************
+ * Summary:
+ *   Start capturing to <path>. Any previous <path> becomes <path>.1.
+ *
+ * Parameters:
+ *   const char *path         : capture file
+ *   uint32_t file_size       : bytes per file, the whole file is allocated
+ *                              and mapped up front
+ *
+ * Return:
+ *  APP_BTSNOOP_SUCCESS or APP_BTSNOOP_ERROR
+ *
+ *****************************************************************************/
+int app_btsnoop_open( const char *path, uint32_t file_size )
+{
+    if ( snoop_open || ( strlen( path ) >= sizeof( snoop_path ) ) )
+    {
+        return APP_BTSNOOP_ERROR;
+    }
+
+    snoop_size = ( file_size < APP_BTSNOOP_FILE_SIZE_MIN ) ? APP_BTSNOOP_FILE_SIZE_MIN : file_size;
+    snprintf( snoop_path, sizeof( snoop_path ), "%s", path );
+    snprintf( snoop_path_old, sizeof( snoop_path_old ), "%s.1", path );
+    snprintf( snoop_path_spare, sizeof( snoop_path_spare ), "%s.tmp", path );
+    rename( snoop_path, snoop_path_old );
+
+    if ( app_btsnoop_file_create( &snoop_cur, snoop_path ) != APP_BTSNOOP_SUCCESS )
+    {
+        return APP_BTSNOOP_ERROR;
+    }
+    snoop_stopping = 0;
+    if ( pthread_create( &snoop_thread, NULL, app_btsnoop_thread_main, NULL ) != 0 )
+    {
+        app_btsnoop_file_finish( &snoop_cur );
+        return APP_BTSNOOP_ERROR;
+    }
+    __atomic_store_n( &snoop_open, 1, __ATOMIC_RELEASE );
+    return APP_BTSNOOP_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_btsnoop_close()
+ ******************************************************************************
+ * Summary:
+ *   Stop capturing and trim the current file
+ *
+ *****************************************************************************/
+void app_btsnoop_close( void )
+{
+    if ( !__atomic_load_n( &snoop_open, __ATOMIC_ACQUIRE ) )
+    {
+        return;
+    }
+
+    pthread_mutex_lock( &snoop_lock );
+    __atomic_store_n( &snoop_open, 0, __ATOMIC_RELEASE );
+    snoop_stopping = 1;
+    pthread_cond_signal( &snoop_cond );
+    pthread_mutex_unlock( &snoop_lock );
+    pthread_join( snoop_thread, NULL );
+
+    if ( snoop_full.fd >= 0 )
+    {
+        rename( snoop_path, snoop_path_old );
+        rename( snoop_path_spare, snoop_path );
+        app_btsnoop_file_finish( &snoop_full );
+    }
+    app_btsnoop_file_finish( &snoop_cur );
+    if ( snoop_spare.fd >= 0 )
+    {
+        app_btsnoop_file_finish( &snoop_spare );
+        unlink( snoop_path_spare );
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_btsnoop_write()
+ ******************************************************************************
+ * Summary:
+ *   Append one HCI packet without file system calls: a full file is
+ *   swapped for the spare and handed to the helper thread.
+ *
+ * Parameters:
+ *   uint8_t h4_type          : APP_BTSNOOP_H4_*
+ *   int received             : 1 controller to host, 0 host to controller
+ *   const uint8_t *p_data    : packet without the indicator byte
+ *   uint32_t len             : packet length
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void app_btsnoop_write( uint8_t h4_type, int received, const uint8_t *p_data, uint32_t len )
+{
+    uint32_t rec_len = APP_BTSNOOP_REC_HDR_LEN + 1 + len;
+    uint32_t flags = received ? 1U : 0U;
+    struct timespec ts;
+    uint64_t us;
+    uint8_t *p;
+
+    if ( !__atomic_load_n( &snoop_open, __ATOMIC_ACQUIRE ) )
+    {
+        return;
+    }
+    if ( ( h4_type == APP_BTSNOOP_H4_CMD ) || ( h4_type == APP_BTSNOOP_H4_EVT ) )
+    {
+        flags |= 2U;
+    }
+    clock_gettime( CLOCK_REALTIME, &ts );
+    us = (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U + APP_BTSNOOP_EPOCH_DELTA_US;
+
+    pthread_mutex_lock( &snoop_lock );
+    if ( !snoop_open || ( rec_len > snoop_size - APP_BTSNOOP_HDR_LEN ) )
+    {
+        snoop_dropped += snoop_open ? 1 : 0;
+        pthread_mutex_unlock( &snoop_lock );
+        return;
+    }
+    if ( snoop_cur.used + rec_len > snoop_size )
+    {
+        if ( ( snoop_spare.fd < 0 ) || ( snoop_full.fd >= 0 ) )
+        {
+            snoop_dropped++;
+            pthread_cond_signal( &snoop_cond );
+            pthread_mutex_unlock( &snoop_lock );
+            return;
+        }
+        snoop_full = snoop_cur;
+        snoop_cur = snoop_spare;
+        snoop_spare.fd = -1;
+        pthread_cond_signal( &snoop_cond );
+    }
+
+    p = snoop_cur.p_map + snoop_cur.used;
+    app_btsnoop_put32( p, len + 1 );
+    app_btsnoop_put32( p + 4, len + 1 );
+    app_btsnoop_put32( p + 8, flags );
+    app_btsnoop_put32( p + 12, (uint32_t)snoop_dropped );
+    app_btsnoop_put32( p + 16, (uint32_t)( us >> 32 ) );
+    app_btsnoop_put32( p + 20, (uint32_t)us );
+    p[APP_BTSNOOP_REC_HDR_LEN] = h4_type;
+    memcpy( p + APP_BTSNOOP_REC_HDR_LEN + 1, p_data, len );
+    snoop_cur.used += rec_len;
+    pthread_mutex_unlock( &snoop_lock );
+}
+
+/******************************************************************************
+ * Function Name: app_btsnoop_dropped()
+ ******************************************************************************
+ * Summary:
+ *   Packets not captured because no spare file was ready
+ *
+ *****************************************************************************/
+uint64_t app_btsnoop_dropped( void )
+{
+    uint64_t dropped;
+
+    pthread_mutex_lock( &snoop_lock );
+    dropped = snoop_dropped;
+    pthread_mutex_unlock( &snoop_lock );
+    return dropped;
+}
+
+/* [] END OF FILE */
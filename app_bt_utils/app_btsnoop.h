@@ -0,0 +1,85 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_btsnoop.h
+ *
+ * Description: This is the header file for the btsnoop HCI capture.
+ *
+ *              Packets are appended to a memory mapped, pre-sized file in
+ *              btsnoop format (datalink 1002, HCI UART), which Wireshark
+ *              and btmon read directly. When the file is full it becomes
+ *              <path>.1 and capture continues in a fresh <path>.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_BTSNOOP_H__
+#define __APP_BTSNOOP_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+/* HCI UART packet indicators */
+#define APP_BTSNOOP_H4_CMD              ( 0x01U )
+#define APP_BTSNOOP_H4_ACL              ( 0x02U )
+#define APP_BTSNOOP_H4_SCO              ( 0x03U )
+#define APP_BTSNOOP_H4_EVT              ( 0x04U )
+#define APP_BTSNOOP_H4_ISO              ( 0x05U )
+
+#define APP_BTSNOOP_FILE_SIZE_DEFAULT   ( 16U << 20 )
+#define APP_BTSNOOP_FILE_SIZE_MIN       ( 64U << 10 )
+
+#define APP_BTSNOOP_SUCCESS             ( 0 )
+#define APP_BTSNOOP_ERROR               ( -1 )
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int  app_btsnoop_open( const char *path, uint32_t file_size );
+
+void app_btsnoop_close( void );
+
+void app_btsnoop_write( uint8_t h4_type, int received, const uint8_t *p_data, uint32_t len );
+
+uint64_t app_btsnoop_dropped( void );
+
+#endif /* __APP_BTSNOOP_H__ */
+
+/* [] END OF FILE */
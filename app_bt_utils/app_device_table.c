@@ -0,0 +1,505 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_device_table.c
+ *
+ * Description: This is the source file for the device table.
+ *
+ *              Entries live in a fixed arena and are chained in LRU order.
+ *              Lookup goes through a separate open addressing index, sized
+ *              to at most 50% load, probed linearly. Each index slot holds
+ *              the entry number plus 8 bits of the hash, so most probes that
+ *              miss are rejected without touching the entry. Deletes shift
+ *              the following cluster back instead of leaving tombstones, so
+ *              probe lengths do not grow under eviction churn.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "app_device_table.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_DEVICE_NIL                      ( 0xFFFFFFFFU )
+#define APP_DEVICE_SLOT_EMPTY               ( 0U )
+#define APP_DEVICE_SLOT_ENTRY_MASK          ( 0x00FFFFFFU )
+#define APP_DEVICE_SLOT_TAG_SHIFT           ( 24 )
+#define APP_DEVICE_CACHE_LINE               ( 64 )
+/* RSSI EWMA weight, 1/8 of the new sample */
+#define APP_DEVICE_RSSI_SHIFT               ( 3 )
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_device_hash()
+ ******************************************************************************
+ * Summary:
+ *   Mix the 48 bit address into 32 bits. Random and resolvable private
+ *   addresses are already uniform, public ones share their OUI, hence the
+ *   multiply.
+ *
+ *****************************************************************************/
+static inline uint32_t app_device_hash( const uint8_t *p_addr )
+{
+    uint64_t k = (uint64_t)p_addr[0] | ( (uint64_t)p_addr[1] << 8 ) | ( (uint64_t)p_addr[2] << 16 ) |
+                 ( (uint64_t)p_addr[3] << 24 ) | ( (uint64_t)p_addr[4] << 32 ) | ( (uint64_t)p_addr[5] << 40 );
+
+    k *= 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)( k >> 32 );
+}
+
+static inline uint32_t app_device_slot_make( uint32_t hash, uint32_t entry )
+{
+    return ( ( hash >> 24 ) << APP_DEVICE_SLOT_TAG_SHIFT ) | ( entry + 1U );
+}
+
+static inline uint32_t app_device_slot_entry( uint32_t slot )
+{
+    return ( slot & APP_DEVICE_SLOT_ENTRY_MASK ) - 1U;
+}
+
+/******************************************************************************
+ * Function Name: app_device_find_slot()
+ ******************************************************************************
+ * Summary:
+ *   Probe the index for an address
+ *
+ * Return:
+ *  index position holding the address, or the empty position ending the
+ *  probe; *p_found tells which
+ *
+ *****************************************************************************/
+static uint32_t app_device_find_slot( const app_device_table_t *p_table, const uint8_t *p_addr,
+                                      uint32_t hash, int *p_found )
+{
+    uint32_t pos = hash & p_table->index_mask;
+    uint32_t tag = hash >> 24;
+    uint32_t slot;
+
+    for ( ;; )
+    {
+        slot = p_table->p_index[pos];
+        if ( slot == APP_DEVICE_SLOT_EMPTY )
+        {
+            *p_found = 0;
+            return pos;
+        }
+        if ( ( ( slot >> APP_DEVICE_SLOT_TAG_SHIFT ) == tag ) &&
+             ( memcmp( p_table->p_entries[app_device_slot_entry( slot )].addr, p_addr, 6 ) == 0 ) )
+        {
+            *p_found = 1;
+            return pos;
+        }
+        pos = ( pos + 1 ) & p_table->index_mask;
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_device_index_delete()
+ ******************************************************************************
+ * Summary:
+ *   Empty an index position and shift back the entries of the cluster that
+ *   follows it, keeping every entry reachable from its home position
+ *
+ *****************************************************************************/
+static void app_device_index_delete( app_device_table_t *p_table, uint32_t pos )
+{
+    const uint32_t mask = p_table->index_mask;
+    uint32_t next = ( pos + 1 ) & mask;
+    uint32_t slot, home;
+
+    while ( ( slot = p_table->p_index[next] ) != APP_DEVICE_SLOT_EMPTY )
+    {
+        home = app_device_hash( p_table->p_entries[app_device_slot_entry( slot )].addr ) & mask;
+        /* movable unless its home lies cyclically in (pos, next] */
+        if ( ( ( next - home ) & mask ) >= ( ( next - pos ) & mask ) )
+        {
+            p_table->p_index[pos] = slot;
+            pos = next;
+        }
+        next = ( next + 1 ) & mask;
+    }
+    p_table->p_index[pos] = APP_DEVICE_SLOT_EMPTY;
+}
+
+static void app_device_lru_unlink( app_device_table_t *p_table, uint32_t e )
+{
+    app_device_entry_t *p_entry = &p_table->p_entries[e];
+
+    if ( p_entry->lru_prev != APP_DEVICE_NIL )
+    {
+        p_table->p_entries[p_entry->lru_prev].lru_next = p_entry->lru_next;
+    }
+    else
+    {
+        p_table->lru_head = p_entry->lru_next;
+    }
+    if ( p_entry->lru_next != APP_DEVICE_NIL )
+    {
+        p_table->p_entries[p_entry->lru_next].lru_prev = p_entry->lru_prev;
+    }
+    else
+    {
+        p_table->lru_tail = p_entry->lru_prev;
+    }
+}
+
+static void app_device_lru_push_head( app_device_table_t *p_table, uint32_t e )
+{
+    app_device_entry_t *p_entry = &p_table->p_entries[e];
+
+    p_entry->lru_prev = APP_DEVICE_NIL;
+    p_entry->lru_next = p_table->lru_head;
+    if ( p_table->lru_head != APP_DEVICE_NIL )
+    {
+        p_table->p_entries[p_table->lru_head].lru_prev = e;
+    }
+    else
+    {
+        p_table->lru_tail = e;
+    }
+    p_table->lru_head = e;
+}
+
+/******************************************************************************
+ * Function Name: app_device_detach()
+ ******************************************************************************
+ * Summary:
+ *   Remove an entry from the index and the LRU list, the arena slot is left
+ *   to the caller
+ *
+ *****************************************************************************/
+static void app_device_detach( app_device_table_t *p_table, uint32_t e )
+{
+    int found;
+    const uint8_t *p_addr = p_table->p_entries[e].addr;
+    uint32_t pos = app_device_find_slot( p_table, p_addr, app_device_hash( p_addr ), &found );
+
+    if ( found )
+    {
+        app_device_index_delete( p_table, pos );
+    }
+    app_device_lru_unlink( p_table, e );
+    p_table->count--;
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_footprint()
+ ******************************************************************************
+ * Summary:
+ *   Bytes allocated by app_device_table_init() for max_devices
+ *
+ *****************************************************************************/
+size_t app_device_table_footprint( uint32_t max_devices )
+{
+    size_t index_slots = 2;
+
+    while ( index_slots < 2ULL * max_devices )
+    {
+        index_slots <<= 1;
+    }
+    return (size_t)max_devices * sizeof( app_device_entry_t ) + index_slots * sizeof( uint32_t );
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_init()
+ ******************************************************************************
+ * Summary:
+ *   Allocate and prefault the arena and the index
+ *
+ * Parameters:
+ *   app_device_table_t *p_table : table
+ *   uint32_t max_devices        : capacity, 1 to APP_DEVICE_TABLE_MAX
+ *
+ * Return:
+ *  APP_DEVICE_TABLE_SUCCESS or APP_DEVICE_TABLE_ERROR
+ *
+ *****************************************************************************/
+int app_device_table_init( app_device_table_t *p_table, uint32_t max_devices )
+{
+    size_t index_slots = 2;
+    size_t bytes;
+    void *p_mem;
+
+    if ( ( max_devices == 0 ) || ( max_devices > APP_DEVICE_TABLE_MAX ) )
+    {
+        return APP_DEVICE_TABLE_ERROR;
+    }
+    while ( index_slots < 2ULL * max_devices )
+    {
+        index_slots <<= 1;
+    }
+
+    bytes = app_device_table_footprint( max_devices );
+    if ( posix_memalign( &p_mem, APP_DEVICE_CACHE_LINE, bytes ) != 0 )
+    {
+        return APP_DEVICE_TABLE_ERROR;
+    }
+    /* touch every page now, the scan worker never takes a page fault */
+    memset( p_mem, 0, bytes );
+
+    memset( p_table, 0, sizeof( *p_table ) );
+    pthread_mutex_init( &p_table->lock, NULL );
+    p_table->p_entries = (app_device_entry_t *)p_mem;
+    p_table->p_index = (uint32_t *)( p_table->p_entries + max_devices );
+    p_table->index_mask = (uint32_t)( index_slots - 1 );
+    p_table->max_devices = max_devices;
+    p_table->lru_head = APP_DEVICE_NIL;
+    p_table->lru_tail = APP_DEVICE_NIL;
+    p_table->free_head = APP_DEVICE_NIL;
+    return APP_DEVICE_TABLE_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_deinit()
+ ******************************************************************************
+ * Summary:
+ *   Free the table memory
+ *
+ *****************************************************************************/
+void app_device_table_deinit( app_device_table_t *p_table )
+{
+    if ( p_table->p_entries == NULL )
+    {
+        return;
+    }
+    pthread_mutex_destroy( &p_table->lock );
+    free( p_table->p_entries );
+    p_table->p_entries = NULL;
+    p_table->p_index = NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_update()
+ ******************************************************************************
+ * Summary:
+ *   Record one report. A new device takes a free arena entry, or the least
+ *   recently seen one when the table is full.
+ *
+ * Parameters:
+ *   app_device_table_t *p_table : table
+ *   const uint8_t *p_addr       : BD address, 6 bytes
+ *   uint8_t addr_type           : address type from the report
+ *   int8_t rssi                 : RSSI of the report
+ *   uint8_t filter_idx          : matched rule, APP_DEVICE_FILTER_NONE if none
+ *   uint64_t now_ns             : report time
+ *
+ * Return:
+ *  1 if the device is new, 0 if it was known, APP_DEVICE_TABLE_ERROR
+ *
+ *****************************************************************************/
+int app_device_table_update( app_device_table_t *p_table, const uint8_t *p_addr, uint8_t addr_type,
+                             int8_t rssi, uint8_t filter_idx, uint64_t now_ns )
+{
+    uint32_t hash = app_device_hash( p_addr );
+    app_device_entry_t *p_entry;
+    uint32_t pos, e;
+    int found;
+
+    if ( p_table->p_entries == NULL )
+    {
+        return APP_DEVICE_TABLE_ERROR;
+    }
+
+    pthread_mutex_lock( &p_table->lock );
+    pos = app_device_find_slot( p_table, p_addr, hash, &found );
+    if ( found )
+    {
+        e = app_device_slot_entry( p_table->p_index[pos] );
+        p_entry = &p_table->p_entries[e];
+        p_entry->rssi_avg_q4 = (int16_t)( p_entry->rssi_avg_q4 +
+                               ( ( ( rssi * 16 ) - p_entry->rssi_avg_q4 ) >> APP_DEVICE_RSSI_SHIFT ) );
+    }
+    else
+    {
+        if ( p_table->free_head != APP_DEVICE_NIL )
+        {
+            e = p_table->free_head;
+            p_table->free_head = p_table->p_entries[e].lru_next;
+        }
+        else if ( p_table->used < p_table->max_devices )
+        {
+            e = p_table->used++;
+        }
+        else
+        {
+            e = p_table->lru_tail;
+            app_device_detach( p_table, e );
+            p_table->evictions++;
+            /* the shift may have moved our empty position */
+            pos = app_device_find_slot( p_table, p_addr, hash, &found );
+        }
+
+        p_entry = &p_table->p_entries[e];
+        memset( p_entry, 0, sizeof( *p_entry ) );
+        memcpy( p_entry->addr, p_addr, 6 );
+        p_entry->filter_idx = APP_DEVICE_FILTER_NONE;
+        p_entry->rssi_avg_q4 = (int16_t)( rssi * 16 );
+        p_table->p_index[pos] = app_device_slot_make( hash, e );
+        p_table->count++;
+        p_table->inserts++;
+        app_device_lru_push_head( p_table, e );
+    }
+
+    if ( p_table->lru_head != e )
+    {
+        app_device_lru_unlink( p_table, e );
+        app_device_lru_push_head( p_table, e );
+    }
+    p_entry->addr_type = addr_type;
+    p_entry->rssi_last = rssi;
+    p_entry->last_seen_ns = now_ns;
+    p_entry->count++;
+    if ( filter_idx != APP_DEVICE_FILTER_NONE )
+    {
+        p_entry->filter_idx = filter_idx;
+    }
+    pthread_mutex_unlock( &p_table->lock );
+    return !found;
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_lookup()
+ ******************************************************************************
+ * Summary:
+ *   Copy out what is known about a device
+ *
+ * Parameters:
+ *   app_device_table_t *p_table : table
+ *   const uint8_t *p_addr       : BD address, 6 bytes
+ *   app_device_info_t *p_info   : output, may be NULL
+ *
+ * Return:
+ *  1 if known, 0 otherwise
+ *
+ *****************************************************************************/
+int app_device_table_lookup( app_device_table_t *p_table, const uint8_t *p_addr, app_device_info_t *p_info )
+{
+    const app_device_entry_t *p_entry;
+    uint32_t pos;
+    int found;
+
+    if ( p_table->p_entries == NULL )
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock( &p_table->lock );
+    pos = app_device_find_slot( p_table, p_addr, app_device_hash( p_addr ), &found );
+    if ( found && ( p_info != NULL ) )
+    {
+        p_entry = &p_table->p_entries[app_device_slot_entry( p_table->p_index[pos] )];
+        memcpy( p_info->addr, p_entry->addr, 6 );
+        p_info->addr_type = p_entry->addr_type;
+        p_info->filter_idx = p_entry->filter_idx;
+        p_info->rssi_last = p_entry->rssi_last;
+        p_info->rssi_avg = (int8_t)( ( p_entry->rssi_avg_q4 + 8 ) >> 4 );
+        p_info->count = p_entry->count;
+        p_info->last_seen_ns = p_entry->last_seen_ns;
+    }
+    pthread_mutex_unlock( &p_table->lock );
+    return found;
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_present()
+ ******************************************************************************
+ * Summary:
+ *   Whether a device was seen within the last window_ns
+ *
+ *****************************************************************************/
+int app_device_table_present( app_device_table_t *p_table, const uint8_t *p_addr, uint64_t window_ns, uint64_t now_ns )
+{
+    app_device_info_t info;
+
+    return app_device_table_lookup( p_table, p_addr, &info ) && ( now_ns - info.last_seen_ns <= window_ns );
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_remove()
+ ******************************************************************************
+ * Summary:
+ *   Forget a device
+ *
+ * Return:
+ *  1 if it was known, 0 otherwise
+ *
+ *****************************************************************************/
+int app_device_table_remove( app_device_table_t *p_table, const uint8_t *p_addr )
+{
+    uint32_t pos, e;
+    int found;
+
+    if ( p_table->p_entries == NULL )
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock( &p_table->lock );
+    pos = app_device_find_slot( p_table, p_addr, app_device_hash( p_addr ), &found );
+    if ( found )
+    {
+        e = app_device_slot_entry( p_table->p_index[pos] );
+        app_device_index_delete( p_table, pos );
+        app_device_lru_unlink( p_table, e );
+        p_table->count--;
+        p_table->p_entries[e].lru_next = p_table->free_head;
+        p_table->free_head = e;
+    }
+    pthread_mutex_unlock( &p_table->lock );
+    return found;
+}
+
+/******************************************************************************
+ * Function Name: app_device_table_count()
+ ******************************************************************************
+ * Summary:
+ *   Number of devices currently tracked
+ *
+ *****************************************************************************/
+uint32_t app_device_table_count( app_device_table_t *p_table )
+{
+    return __atomic_load_n( &p_table->count, __ATOMIC_RELAXED );
+}
+
+/* [] END OF FILE */
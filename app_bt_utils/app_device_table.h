@@ -0,0 +1,136 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_device_table.h
+ *
+ * Description: This is the header file for the device table. It tracks
+ *              every advertiser seen by BD address: last seen time, last and
+ *              smoothed RSSI, report count and the last wake rule matched.
+ *              All memory is allocated once by app_device_table_init(); when
+ *              the table is full the least recently seen device is evicted.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_DEVICE_TABLE_H__
+#define __APP_DEVICE_TABLE_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_DEVICE_TABLE_SUCCESS            ( 0 )
+#define APP_DEVICE_TABLE_ERROR              ( -1 )
+
+/* entry indexes share a 32 bit index slot with an 8 bit hash tag */
+#define APP_DEVICE_TABLE_MAX                ( ( 1U << 24 ) - 1U )
+#define APP_DEVICE_FILTER_NONE              ( 0xFF )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* 32 bytes, two entries per cache line */
+typedef struct
+{
+    uint8_t     addr[6];
+    uint8_t     addr_type;
+    uint8_t     filter_idx;         /* last matched rule, APP_DEVICE_FILTER_NONE if never */
+    int16_t     rssi_avg_q4;        /* EWMA of the RSSI, 1/16 dBm */
+    int8_t      rssi_last;
+    uint8_t     reserved;
+    uint32_t    count;
+    uint64_t    last_seen_ns;
+    uint32_t    lru_prev;
+    uint32_t    lru_next;
+} app_device_entry_t;
+
+/* copy returned to consumers */
+typedef struct
+{
+    uint8_t     addr[6];
+    uint8_t     addr_type;
+    uint8_t     filter_idx;
+    int8_t      rssi_last;
+    int8_t      rssi_avg;
+    uint32_t    count;
+    uint64_t    last_seen_ns;
+} app_device_info_t;
+
+typedef struct
+{
+    pthread_mutex_t     lock;
+    app_device_entry_t  *p_entries;     /* arena, max_devices entries */
+    uint32_t            *p_index;       /* open addressing, tag << 24 | entry + 1 */
+    uint32_t            index_mask;
+    uint32_t            max_devices;
+    uint32_t            used;           /* arena entries handed out so far */
+    uint32_t            count;          /* live devices */
+    uint32_t            free_head;      /* removed entries, chained by lru_next */
+    uint32_t            lru_head;       /* most recently seen */
+    uint32_t            lru_tail;       /* eviction candidate */
+    /* statistics */
+    uint64_t            inserts;
+    uint64_t            evictions;
+} app_device_table_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int app_device_table_init( app_device_table_t *p_table, uint32_t max_devices );
+
+void app_device_table_deinit( app_device_table_t *p_table );
+
+size_t app_device_table_footprint( uint32_t max_devices );
+
+int app_device_table_update( app_device_table_t *p_table, const uint8_t *p_addr, uint8_t addr_type,
+                             int8_t rssi, uint8_t filter_idx, uint64_t now_ns );
+
+int app_device_table_lookup( app_device_table_t *p_table, const uint8_t *p_addr, app_device_info_t *p_info );
+
+int app_device_table_present( app_device_table_t *p_table, const uint8_t *p_addr, uint64_t window_ns, uint64_t now_ns );
+
+int app_device_table_remove( app_device_table_t *p_table, const uint8_t *p_addr );
+
+uint32_t app_device_table_count( app_device_table_t *p_table );
+
+#endif /* __APP_DEVICE_TABLE_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,361 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_event_json.c
+ *
+ * Description: This is the source file for the JSON lines event output.
+ *              Numbers are converted by hand and hex with app_fmt: printf
+ *              would dominate the cost of a record.
+ *
+ *              Lines are at most APP_EVENT_JSON_LINE_MAX bytes, below
+ *              PIPE_BUF, so lines from different threads never interleave
+ *              on a pipe or an O_APPEND file.
+ *
+ *              The output never blocks: the writers are the scan worker and
+ *              the host wake callback. A line that does not fit is dropped
+ *              and counted.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include "app_time.h"
+#include "app_fmt.h"
+#include "app_event_json.h"
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static int                  json_fd = -1;
+static int                  json_fd_owned = 0;
+static int                  json_fd_socket = 0;
+static uint64_t             json_dropped = 0;
+static __thread char        json_line[APP_EVENT_JSON_LINE_MAX];
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_event_json_str()
+ ******************************************************************************
+ * Summary:
+ *   Append a string literal
+ *
+ *****************************************************************************/
+static char *app_event_json_str( char *p, const char *p_str )
+{
+    size_t len = strlen( p_str );
+
+    memcpy( p, p_str, len );
+    return p + len;
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_u64()
+ ******************************************************************************
+ * Summary:
+ *   Append an unsigned decimal number
+ *
+ *****************************************************************************/
+static char *app_event_json_u64( char *p, uint64_t value )
+{
+    char tmp[20];
+    size_t n = 0;
+
+    do
+    {
+        tmp[n++] = (char)( '0' + value % 10 );
+        value /= 10;
+    } while ( value != 0 );
+    while ( n > 0 )
+    {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_i32()
+ ******************************************************************************
+ * Summary:
+ *   Append a signed decimal number
+ *
+ *****************************************************************************/
+static char *app_event_json_i32( char *p, int32_t value )
+{
+    if ( value < 0 )
+    {
+        *p++ = '-';
+        return app_event_json_u64( p, (uint64_t)( -(int64_t)value ) );
+    }
+    return app_event_json_u64( p, (uint64_t)value );
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_type()
+ ******************************************************************************
+ * Summary:
+ *   Name of an event type
+ *
+ *****************************************************************************/
+static const char *app_event_json_type( uint16_t type )
+{
+    switch ( type )
+    {
+        case APP_EVENT_ARMED:       return "armed";
+        case APP_EVENT_DISARMED:    return "disarmed";
+        case APP_EVENT_WAKE:        return "wake";
+        case APP_EVENT_SCAN_REPORT: return "scan_report";
+        default:                    return "none";
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_format()
+ ******************************************************************************
+ * Summary:
+ *   Serialize an event as one JSON line, newline included. Address and
+ *   advertising fields are only present in scan reports, latency only when
+ *   it was measured.
+ *
+ * Parameters:
+ *   const app_event_t *p_event : event
+ *   char *p_line               : APP_EVENT_JSON_LINE_MAX bytes
+ *
+ * Return:
+ *  line length
+ *
+ *****************************************************************************/
+size_t app_event_json_format( const app_event_t *p_event, char *p_line )
+{
+    uint32_t adv_len = p_event->adv_len;
+    char *p = p_line;
+
+    p = app_event_json_str( p, "{\"type\":\"" );
+    p = app_event_json_str( p, app_event_json_type( p_event->type ) );
+    p = app_event_json_str( p, "\",\"ts_ns\":" );
+    p = app_event_json_u64( p, p_event->timestamp_ns );
+    p = app_event_json_str( p, ",\"filter_idx\":" );
+    if ( p_event->filter_idx == APP_EVENT_FILTER_IDX_NONE )
+    {
+        p = app_event_json_str( p, "null" );
+    }
+    else
+    {
+        p = app_event_json_u64( p, p_event->filter_idx );
+    }
+    if ( p_event->latency_ns != 0 )
+    {
+        p = app_event_json_str( p, ",\"latency_ns\":" );
+        p = app_event_json_u64( p, p_event->latency_ns );
+    }
+
+    if ( p_event->type == APP_EVENT_SCAN_REPORT )
+    {
+        p = app_event_json_str( p, ",\"addr\":\"" );
+        app_fmt_bdaddr( p, p_event->addr );
+        p += APP_FMT_BDADDR_LEN - 1;
+        *p++ = '"';
+        p = app_event_json_str( p, ",\"addr_type\":" );
+        p = app_event_json_u64( p, p_event->addr_type );
+        p = app_event_json_str( p, ",\"rssi\":" );
+        p = app_event_json_i32( p, p_event->rssi );
+        p = app_event_json_str( p, ",\"evt_type\":" );
+        p = app_event_json_u64( p, p_event->evt_type );
+        p = app_event_json_str( p, ",\"adv\":\"" );
+        if ( adv_len > APP_EVENT_ADV_DATA_MAX )
+        {
+            adv_len = APP_EVENT_ADV_DATA_MAX;
+        }
+        p = app_fmt_hex( p, p_event->adv_data, adv_len );
+        *p++ = '"';
+    }
+
+    *p++ = '}';
+    *p++ = '\n';
+    return (size_t)( p - p_line );
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_open()
+ ******************************************************************************
+ * Summary:
+ *   Start writing events to a file, "-" for stdout
+ *
+ * Parameters:
+ *   const char *path         : output file, appended to
+ *
+ * Return:
+ *  APP_EVENT_JSON_SUCCESS or APP_EVENT_JSON_ERROR
+ *
+ *****************************************************************************/
+int app_event_json_open( const char *path )
+{
+    struct stat st;
+    int fd;
+
+    json_fd_socket = 0;
+    if ( strcmp( path, "-" ) == 0 )
+    {
+        if ( ( fstat( STDOUT_FILENO, &st ) == 0 ) && S_ISREG( st.st_mode ) )
+        {
+            json_fd_owned = 0;
+            __atomic_store_n( &json_fd, STDOUT_FILENO, __ATOMIC_RELEASE );
+            return APP_EVENT_JSON_SUCCESS;
+        }
+
+        /* a pipe or a terminal: a new open file description can be made
+         * non-blocking without changing stdout for the rest of the program */
+        fd = open( "/proc/self/fd/1", O_WRONLY | O_NONBLOCK | O_CLOEXEC );
+        if ( fd < 0 )
+        {
+            if ( ( fstat( STDOUT_FILENO, &st ) != 0 ) || !S_ISSOCK( st.st_mode ) )
+            {
+                return APP_EVENT_JSON_ERROR;
+            }
+            /* a socket cannot be reopened, send() with MSG_DONTWAIT instead */
+            json_fd_owned = 0;
+            json_fd_socket = 1;
+            __atomic_store_n( &json_fd, STDOUT_FILENO, __ATOMIC_RELEASE );
+            return APP_EVENT_JSON_SUCCESS;
+        }
+        json_fd_owned = 1;
+        __atomic_store_n( &json_fd, fd, __ATOMIC_RELEASE );
+        return APP_EVENT_JSON_SUCCESS;
+    }
+
+    fd = open( path, O_WRONLY | O_CREAT | O_APPEND | O_NONBLOCK | O_CLOEXEC, 0644 );
+    if ( fd < 0 )
+    {
+        return APP_EVENT_JSON_ERROR;
+    }
+    json_fd_owned = 1;
+    __atomic_store_n( &json_fd, fd, __ATOMIC_RELEASE );
+    return APP_EVENT_JSON_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_close()
+ ******************************************************************************
+ * Summary:
+ *   Stop writing events
+ *
+ *****************************************************************************/
+void app_event_json_close( void )
+{
+    int fd = __atomic_exchange_n( &json_fd, -1, __ATOMIC_ACQ_REL );
+
+    if ( ( fd >= 0 ) && json_fd_owned )
+    {
+        close( fd );
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_write()
+ ******************************************************************************
+ * Summary:
+ *   Write one event line if the output is open. A full pipe (EAGAIN), a
+ *   full disk or a short write drops the line rather than retrying on the
+ *   event path; drops are counted.
+ *
+ * Parameters:
+ *   const app_event_t *p_event : event, timestamp_ns 0 means now
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void app_event_json_write( const app_event_t *p_event )
+{
+    int fd = __atomic_load_n( &json_fd, __ATOMIC_ACQUIRE );
+    app_event_t stamped;
+    size_t len;
+    ssize_t n;
+
+    if ( fd < 0 )
+    {
+        return;
+    }
+
+    if ( p_event->timestamp_ns == 0 )
+    {
+        memcpy( &stamped, p_event, offsetof( app_event_t, adv_data ) );
+        stamped.timestamp_ns = app_time_now_ns();
+        stamped.adv_len = 0;
+        p_event = &stamped;
+    }
+
+    len = app_event_json_format( p_event, json_line );
+    do
+    {
+        if ( json_fd_socket )
+        {
+            n = send( fd, json_line, len, MSG_DONTWAIT | MSG_NOSIGNAL );
+        }
+        else
+        {
+            n = write( fd, json_line, len );
+        }
+    } while ( ( n < 0 ) && ( errno == EINTR ) );
+
+    if ( n != (ssize_t)len )
+    {
+        __atomic_add_fetch( &json_dropped, 1, __ATOMIC_RELAXED );
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_event_json_dropped()
+ ******************************************************************************
+ * Summary:
+ *   Lines dropped because the output was full or failed
+ *
+ *****************************************************************************/
+uint64_t app_event_json_dropped( void )
+{
+    return __atomic_load_n( &json_dropped, __ATOMIC_RELAXED );
+}
+
+/* [] END OF FILE */
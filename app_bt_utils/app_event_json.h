@@ -0,0 +1,89 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_event_json.h
+ *
+ * Description: This is the header file for the JSON lines event output.
+ *
+ *              Every event published to the event ring can also be written
+ *              as one JSON object per line, eg:
+ *
+ *              {"type":"scan_report","ts_ns":1681421185329,"filter_idx":1,
+ *               "addr":"00:A0:50:12:34:56","addr_type":0,"rssi":-61,
+ *               "evt_type":0,"adv":"0201061AFF4C00..."}
+ *
+ *              Records are serialized into a per-thread buffer and written
+ *              with a single write(), without heap allocation or stdio.
+ *              The output is non-blocking; lines that do not fit are
+ *              dropped and counted.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_EVENT_JSON_H__
+#define __APP_EVENT_JSON_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include "app_event_ring.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+/* longest line: the fixed fields plus the AD payload in hex */
+#define APP_EVENT_JSON_LINE_MAX         ( 256U + 2U * APP_EVENT_ADV_DATA_MAX )
+
+#define APP_EVENT_JSON_SUCCESS          ( 0 )
+#define APP_EVENT_JSON_ERROR            ( -1 )
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int  app_event_json_open( const char *path );
+
+void app_event_json_close( void );
+
+size_t app_event_json_format( const app_event_t *p_event, char *p_line );
+
+void app_event_json_write( const app_event_t *p_event );
+
+uint64_t app_event_json_dropped( void );
+
+#endif /* __APP_EVENT_JSON_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,379 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_event_ring.c
+ *
+ * Description: This is the source file for the shared memory event ring.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "app_time.h"
+#include "app_event_ring.h"
+
+/******************************************************************************
+ *                                MACROS
+ *****************************************************************************/
+#define APP_EVENT_RING_ALIGN        ( 64U )
+#define APP_EVENT_RING_ROUND(x)     ( ((x) + APP_EVENT_RING_ALIGN - 1) & ~(size_t)(APP_EVENT_RING_ALIGN - 1) )
+
+/* slot = sequence lock followed by the record */
+#define APP_EVENT_SLOT_SIZE         APP_EVENT_RING_ROUND( sizeof(uint64_t) + sizeof(app_event_t) )
+#define APP_EVENT_RECORD_HDR_LEN    offsetof( app_event_t, adv_data )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    uint64_t    lock;   /* 2 * seq + 1 while writing, 2 * seq + 2 when valid */
+    app_event_t event;
+} app_event_slot_t;
+
+/******************************************************************************
+ *                               GLOBAL VARIABLES
+ *****************************************************************************/
+static app_event_ring_hdr_t *p_ring_hdr   = NULL;
+static uint8_t              *p_ring_slots = NULL;
+static size_t               ring_map_size = 0;
+static uint64_t             ring_mask     = 0;
+static char                 ring_name[256];
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_event_ring_map_size()
+ ******************************************************************************
+ * Summary:
+ *   Size of the shared memory object for a given number of slots.
+ *
+ *****************************************************************************/
+static size_t app_event_ring_map_size( uint32_t slot_count )
+{
+    return sizeof( app_event_ring_hdr_t ) + (size_t)slot_count * APP_EVENT_SLOT_SIZE;
+}
+
+/******************************************************************************
+ * Function Name: app_event_ring_create()
+ ******************************************************************************
+ * Summary:
+ *   Create (or recreate) the shared memory ring and map it for publishing.
+ *   The memory is prefaulted so that publishing never takes a page fault.
+ *
+ * Parameters:
+ *   const char *name         : POSIX shared memory name, eg: "/wakeonle_events"
+ *   uint32_t slot_count      : number of slots, rounded up to a power of 2
+ *
+ * Return:
+ *  APP_EVENT_RING_SUCCESS or APP_EVENT_RING_ERROR
+ *
+ *****************************************************************************/
+int app_event_ring_create( const char *name, uint32_t slot_count )
+{
+    uint32_t count = 1;
+    size_t size;
+    void *p_map;
+    int fd;
+
+    if ( ( name == NULL ) || ( name[0] == '\0' ) || ( p_ring_hdr != NULL ) )
+    {
+        return APP_EVENT_RING_ERROR;
+    }
+
+    while ( ( count < slot_count ) && ( count < APP_EVENT_RING_MAX_SLOTS ) )
+    {
+        count <<= 1;
+    }
+    size = app_event_ring_map_size( count );
+
+    shm_unlink( name );
+    fd = shm_open( name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+    if ( fd < 0 )
+    {
+        perror( "event ring shm_open" );
+        return APP_EVENT_RING_ERROR;
+    }
+    if ( ftruncate( fd, (off_t)size ) != 0 )
+    {
+        perror( "event ring ftruncate" );
+        close( fd );
+        shm_unlink( name );
+        return APP_EVENT_RING_ERROR;
+    }
+    p_map = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0 );
+    close( fd );
+    if ( p_map == MAP_FAILED )
+    {
+        perror( "event ring mmap" );
+        shm_unlink( name );
+        return APP_EVENT_RING_ERROR;
+    }
+
+    memset( p_map, 0, size );
+    p_ring_hdr   = (app_event_ring_hdr_t *)p_map;
+    p_ring_slots = (uint8_t *)p_map + sizeof( app_event_ring_hdr_t );
+    ring_map_size = size;
+    ring_mask    = count - 1;
+    strncpy( ring_name, name, sizeof( ring_name ) - 1 );
+
+    p_ring_hdr->version    = APP_EVENT_RING_VERSION;
+    p_ring_hdr->slot_size  = (uint32_t)APP_EVENT_SLOT_SIZE;
+    p_ring_hdr->slot_count = count;
+    /* magic last, readers refuse a ring without it */
+    __atomic_store_n( &p_ring_hdr->magic, APP_EVENT_RING_MAGIC, __ATOMIC_RELEASE );
+    return APP_EVENT_RING_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_event_ring_destroy()
+ ******************************************************************************
+ * Summary:
+ *   Unmap and unlink the ring. Readers that still have it mapped keep their
+ *   mapping until they close it.
+ *
+ *****************************************************************************/
+void app_event_ring_destroy( void )
+{
+    if ( p_ring_hdr == NULL )
+    {
+        return;
+    }
+    munmap( p_ring_hdr, ring_map_size );
+    shm_unlink( ring_name );
+    p_ring_hdr   = NULL;
+    p_ring_slots = NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_event_ring_publish()
+ ******************************************************************************
+ * Summary:
+ *   Publish one record. Safe to call from any thread; a no-op if the ring
+ *   was not created. The cost is one atomic increment plus a copy of the
+ *   used part of the record, independent of the number of readers.
+ *
+ * Parameters:
+ *   app_event_t *p_event     : record to publish, seq is filled in here and
+ *                              timestamp_ns when the caller left it 0
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void app_event_ring_publish( app_event_t *p_event )
+{
+    app_event_slot_t *p_slot;
+    uint64_t seq;
+    size_t len;
+
+    if ( p_ring_hdr == NULL )
+    {
+        return;
+    }
+
+    if ( p_event->timestamp_ns == 0 )
+    {
+        p_event->timestamp_ns = app_time_now_ns();
+    }
+    if ( p_event->adv_len > APP_EVENT_ADV_DATA_MAX )
+    {
+        p_event->adv_len = APP_EVENT_ADV_DATA_MAX;
+    }
+
+    seq = __atomic_fetch_add( &p_ring_hdr->head, 1, __ATOMIC_RELAXED );
+    p_slot = (app_event_slot_t *)( p_ring_slots + ( seq & ring_mask ) * APP_EVENT_SLOT_SIZE );
+    p_event->seq = seq;
+    len = APP_EVENT_RECORD_HDR_LEN + p_event->adv_len;
+
+    __atomic_store_n( &p_slot->lock, 2 * seq + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    memcpy( &p_slot->event, p_event, len );
+    __atomic_store_n( &p_slot->lock, 2 * seq + 2, __ATOMIC_RELEASE );
+}
+
+/******************************************************************************
+ * Function Name: app_event_ring_reader_open()
+ ******************************************************************************
+ * Summary:
+ *   Map an existing ring read-only. The reader starts at the current head,
+ *   so only records published after opening are returned.
+ *
+ * Parameters:
+ *   app_event_ring_reader_t *p_reader  : reader handle to initialize
+ *   const char *name                   : POSIX shared memory name
+ *
+ * Return:
+ *  APP_EVENT_RING_SUCCESS or APP_EVENT_RING_ERROR
+ *
+ *****************************************************************************/
+int app_event_ring_reader_open( app_event_ring_reader_t *p_reader, const char *name )
+{
+    app_event_ring_hdr_t hdr;
+    struct stat st;
+    void *p_map;
+    int fd;
+
+    memset( p_reader, 0, sizeof( *p_reader ) );
+    fd = shm_open( name, O_RDONLY, 0 );
+    if ( fd < 0 )
+    {
+        return APP_EVENT_RING_ERROR;
+    }
+    if ( ( fstat( fd, &st ) != 0 ) || ( (size_t)st.st_size < sizeof( hdr ) ) )
+    {
+        close( fd );
+        return APP_EVENT_RING_ERROR;
+    }
+    p_map = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( p_map == MAP_FAILED )
+    {
+        return APP_EVENT_RING_ERROR;
+    }
+
+    memcpy( &hdr, p_map, sizeof( hdr ) );
+    if ( ( __atomic_load_n( &((app_event_ring_hdr_t *)p_map)->magic, __ATOMIC_ACQUIRE ) != APP_EVENT_RING_MAGIC ) ||
+         ( hdr.version != APP_EVENT_RING_VERSION ) ||
+         ( hdr.slot_size != APP_EVENT_SLOT_SIZE ) ||
+         ( hdr.slot_count == 0 ) || ( ( hdr.slot_count & ( hdr.slot_count - 1 ) ) != 0 ) ||
+         ( app_event_ring_map_size( hdr.slot_count ) > (size_t)st.st_size ) )
+    {
+        munmap( p_map, (size_t)st.st_size );
+        return APP_EVENT_RING_ERROR;
+    }
+
+    p_reader->p_hdr    = (app_event_ring_hdr_t *)p_map;
+    p_reader->p_slots  = (uint8_t *)p_map + sizeof( app_event_ring_hdr_t );
+    p_reader->map_size = (size_t)st.st_size;
+    p_reader->next     = __atomic_load_n( &p_reader->p_hdr->head, __ATOMIC_ACQUIRE );
+    return APP_EVENT_RING_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_event_ring_reader_poll()
+ ******************************************************************************
+ * Summary:
+ *   Copy the next record out of the ring without any system call. If the
+ *   writer has lapped the reader, the reader skips ahead to the oldest
+ *   record still in the ring and adds the skipped records to p_reader->lost.
+ *
+ * Parameters:
+ *   app_event_ring_reader_t *p_reader  : reader handle
+ *   app_event_t *p_event               : record output
+ *
+ * Return:
+ *  1 if a record was copied, 0 if the ring is empty
+ *
+ *****************************************************************************/
+int app_event_ring_reader_poll( app_event_ring_reader_t *p_reader, app_event_t *p_event )
+{
+    uint64_t count = p_reader->p_hdr->slot_count;
+    app_event_slot_t *p_slot;
+    uint64_t lock, head;
+    uint16_t adv_len;
+
+    for ( ;; )
+    {
+        p_slot = (app_event_slot_t *)( p_reader->p_slots +
+                                       ( p_reader->next & ( count - 1 ) ) * p_reader->p_hdr->slot_size );
+        lock = __atomic_load_n( &p_slot->lock, __ATOMIC_ACQUIRE );
+        if ( lock < 2 * p_reader->next + 2 )
+        {
+            /* not published yet, or still being written */
+            return 0;
+        }
+
+        if ( lock == 2 * p_reader->next + 2 )
+        {
+            memcpy( p_event, &p_slot->event, APP_EVENT_RECORD_HDR_LEN );
+            adv_len = p_event->adv_len;
+            if ( adv_len > APP_EVENT_ADV_DATA_MAX )
+            {
+                adv_len = APP_EVENT_ADV_DATA_MAX;
+            }
+            memcpy( p_event->adv_data, p_slot->event.adv_data, adv_len );
+            __atomic_thread_fence( __ATOMIC_ACQUIRE );
+            if ( __atomic_load_n( &p_slot->lock, __ATOMIC_RELAXED ) == lock )
+            {
+                p_event->adv_len = adv_len;
+                p_reader->next++;
+                return 1;
+            }
+        }
+
+        /* lapped: restart from the oldest record that can still be valid */
+        head = __atomic_load_n( &p_reader->p_hdr->head, __ATOMIC_ACQUIRE );
+        if ( head > count )
+        {
+            p_reader->lost += ( head - count + 1 ) - p_reader->next;
+            p_reader->next = head - count + 1;
+        }
+        else
+        {
+            p_reader->lost++;
+            p_reader->next++;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_event_ring_reader_close()
+ ******************************************************************************
+ * Summary:
+ *   Unmap a reader.
+ *
+ *****************************************************************************/
+void app_event_ring_reader_close( app_event_ring_reader_t *p_reader )
+{
+    if ( p_reader->p_hdr != NULL )
+    {
+        munmap( p_reader->p_hdr, p_reader->map_size );
+        p_reader->p_hdr = NULL;
+    }
+}
+
+/* [] END OF FILE */
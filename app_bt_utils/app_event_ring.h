@@ -0,0 +1,147 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_event_ring.h
+ *
+ * Description: This is the header file for the shared memory event ring.
+ *              The application publishes fixed layout wake and scan event
+ *              records into a POSIX shared memory ring. Any number of local
+ *              readers can map the ring and consume the records without a
+ *              system call per event.
+ *
+ *              Each slot is protected by a sequence lock: the writer marks
+ *              the slot odd while copying and even when done, and a reader
+ *              that finds the sequence changed during its copy knows it has
+ *              been lapped. Readers never write to the ring, so adding a
+ *              reader costs the writer nothing.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_EVENT_RING_H__
+#define __APP_EVENT_RING_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_EVENT_RING_MAGIC            ( 0x524C4557U )  /* "WELR" */
+#define APP_EVENT_RING_VERSION          ( 1U )
+#define APP_EVENT_RING_DEFAULT_SLOTS    ( 1024U )
+#define APP_EVENT_RING_MAX_SLOTS        ( 1U << 20 )
+
+/* Largest AD payload carried by a record (extended advertising) */
+#define APP_EVENT_ADV_DATA_MAX          ( 255U )
+#define APP_EVENT_FILTER_IDX_NONE       ( 0xFFU )
+
+#define APP_EVENT_RING_SUCCESS          ( 0 )
+#define APP_EVENT_RING_ERROR            ( -1 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef enum
+{
+    APP_EVENT_NONE          = 0,
+    APP_EVENT_ARMED         = 1,    /* APCF + sleep mode set, waiting for HOST-WAKE */
+    APP_EVENT_DISARMED      = 2,    /* WakeOnLE disabled by the user */
+    APP_EVENT_WAKE          = 3,    /* HOST-WAKE asserted by the controller */
+    APP_EVENT_SCAN_REPORT   = 4     /* advertising report delivered to the host */
+} app_event_type_t;
+
+/* Fixed layout event record, shared with readers in other processes */
+typedef struct
+{
+    uint64_t    seq;                /* publish sequence number, gap means lost records */
+    uint64_t    timestamp_ns;       /* CLOCK_MONOTONIC time of the event */
+    uint64_t    latency_ns;         /* event specific duration, eg: arm or wake path */
+    uint16_t    type;               /* app_event_type_t */
+    uint8_t     filter_idx;         /* APCF filter index, APP_EVENT_FILTER_IDX_NONE if n/a */
+    uint8_t     addr_type;          /* peer address type */
+    uint8_t     addr[6];            /* peer BD address */
+    int8_t      rssi;               /* RSSI in dBm */
+    uint8_t     evt_type;           /* advertising event type */
+    uint16_t    adv_len;            /* valid bytes in adv_data */
+    uint8_t     reserved[6];
+    uint8_t     adv_data[APP_EVENT_ADV_DATA_MAX];
+} app_event_t;
+
+/* Shared memory header at offset 0 of the ring */
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    slot_size;          /* bytes per slot */
+    uint32_t    slot_count;         /* power of 2 */
+    uint8_t     pad[48];
+    uint64_t    head;               /* next sequence number to publish, own cache line */
+    uint8_t     pad2[56];
+} app_event_ring_hdr_t;
+
+/* Reader handle, one per consumer */
+typedef struct
+{
+    app_event_ring_hdr_t    *p_hdr;
+    uint8_t                 *p_slots;
+    size_t                  map_size;
+    uint64_t                next;       /* next sequence number to read */
+    uint64_t                lost;       /* records overwritten before they were read */
+} app_event_ring_reader_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+/* writer side, one ring per process */
+int  app_event_ring_create( const char *name, uint32_t slot_count );
+
+void app_event_ring_destroy( void );
+
+void app_event_ring_publish( app_event_t *p_event );
+
+/* reader side */
+int  app_event_ring_reader_open( app_event_ring_reader_t *p_reader, const char *name );
+
+int  app_event_ring_reader_poll( app_event_ring_reader_t *p_reader, app_event_t *p_event );
+
+void app_event_ring_reader_close( app_event_ring_reader_t *p_reader );
+
+#endif /* __APP_EVENT_RING_H__ */
+
+/* [] END OF FILE */
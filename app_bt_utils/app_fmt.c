@@ -0,0 +1,163 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_fmt.c
+ *
+ * Description: This is the source file for the formatting helpers. Each
+ *              byte is converted with one 2 byte load from a 512 byte
+ *              table.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <string.h>
+#include "app_fmt.h"
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+/* upper case hex digits of every byte value */
+static const char app_fmt_hex_pairs[512 + 1] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_fmt_hex()
+ ******************************************************************************
+ * Summary:
+ *   Encode bytes as upper case hex, no separators
+ *
+ * Parameters:
+ *   char *p_out              : 2 * len + 1 bytes
+ *   const uint8_t *p_in      : bytes to encode
+ *   size_t len               : number of bytes
+ *
+ * Return:
+ *  pointer to the terminating NUL
+ *
+ *****************************************************************************/
+char *app_fmt_hex( char *p_out, const uint8_t *p_in, size_t len )
+{
+    size_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        memcpy( p_out, &app_fmt_hex_pairs[2U * p_in[i]], 2 );
+        p_out += 2;
+    }
+    *p_out = '\0';
+    return p_out;
+}
+
+/******************************************************************************
+ * Function Name: app_fmt_bdaddr()
+ ******************************************************************************
+ * Summary:
+ *   Format a BD address as "XX:XX:XX:XX:XX:XX", most significant byte first
+ *   as stored by the stack
+ *
+ * Parameters:
+ *   char *p_out              : APP_FMT_BDADDR_LEN bytes
+ *   const uint8_t *p_addr    : 6 byte address
+ *
+ * Return:
+ *  p_out
+ *
+ *****************************************************************************/
+char *app_fmt_bdaddr( char *p_out, const uint8_t *p_addr )
+{
+    uint32_t i;
+
+    for ( i = 0; i < 6; i++ )
+    {
+        memcpy( &p_out[3 * i], &app_fmt_hex_pairs[2U * p_addr[i]], 2 );
+        p_out[3 * i + 2] = ':';
+    }
+    p_out[APP_FMT_BDADDR_LEN - 1] = '\0';
+    return p_out;
+}
+
+/******************************************************************************
+ * Function Name: app_fmt_hex_dump()
+ ******************************************************************************
+ * Summary:
+ *   Format bytes as "XX " with a newline before every 16th byte, the layout
+ *   of print_array(). A long buffer can be formatted in pieces: offset is
+ *   the position of p_in[0] in the whole buffer and keeps the line breaks in
+ *   place. A piece that ends the buffer should be followed by "\n".
+ *
+ * Parameters:
+ *   char *p_out              : APP_FMT_HEX_DUMP_LEN( len ) bytes
+ *   const uint8_t *p_in      : bytes to format
+ *   size_t len               : number of bytes
+ *   size_t offset            : position of p_in[0]
+ *
+ * Return:
+ *  characters written, NUL excluded
+ *
+ *****************************************************************************/
+size_t app_fmt_hex_dump( char *p_out, const uint8_t *p_in, size_t len, size_t offset )
+{
+    char *p = p_out;
+    size_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        if ( ( ( offset + i ) & 0x0F ) == 0 )
+        {
+            *p++ = '\n';
+        }
+        memcpy( p, &app_fmt_hex_pairs[2U * p_in[i]], 2 );
+        p[2] = ' ';
+        p += 3;
+    }
+    *p = '\0';
+    return (size_t)( p - p_out );
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,95 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_fmt.h
+ *
+ * Description: This is the header file for the formatting helpers: hex and
+ *              BD address encoding into caller buffers through a lookup
+ *              table, and constant name tables indexed by value. Nothing
+ *              here allocates or calls stdio.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_FMT_H__
+#define __APP_FMT_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+/* "XX:XX:XX:XX:XX:XX" and the terminating NUL */
+#define APP_FMT_BDADDR_LEN                  ( 18U )
+
+/* app_fmt_hex_dump() output for len bytes, NUL included */
+#define APP_FMT_HEX_DUMP_LEN( len )         ( 3U * (len) + (len) / 16U + 3U )
+
+/* dense name table entry, eg: static const char *const names[] = { APP_FMT_NAME( X ) ... } */
+#define APP_FMT_NAME( const_ )              [const_] = #const_,
+
+#define APP_FMT_NAMES_COUNT( table_ )       ( sizeof( table_ ) / sizeof( ( table_ )[0] ) )
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+char *app_fmt_hex( char *p_out, const uint8_t *p_in, size_t len );
+
+char *app_fmt_bdaddr( char *p_out, const uint8_t *p_addr );
+
+size_t app_fmt_hex_dump( char *p_out, const uint8_t *p_in, size_t len, size_t offset );
+
+/*******************************************************************************
+* Function Name: app_fmt_name
+********************************************************************************
+* Summary:
+*   Look up a value in a table built with APP_FMT_NAME
+*
+* Return:
+*   name, NULL if the value has no entry
+*
+*******************************************************************************/
+static inline const char *app_fmt_name( const char *const *p_names, size_t count, unsigned int value )
+{
+    return ( value < count ) ? p_names[value] : NULL;
+}
+
+#endif /* __APP_FMT_H__ */
+
+/* [] END OF FILE */
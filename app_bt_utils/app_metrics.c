@@ -0,0 +1,520 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_metrics.c
+ *
+ * Description: This is the source file for the metrics module.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "app_time.h"
+#include "app_metrics.h"
+
+/******************************************************************************
+ *                                MACROS
+ *****************************************************************************/
+#define APP_METRICS_RENDER_BUF_SIZE     ( 16 * 1024 )
+#define APP_METRICS_REQUEST_TIMEOUT_MS  ( 100 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    const char  *subcmd;
+    uint16_t    opcode;
+} app_metrics_vsc_desc_t;
+
+/******************************************************************************
+ *                               GLOBAL VARIABLES
+ *****************************************************************************/
+app_metrics_t app_metrics;
+
+/* histogram bucket upper bounds in ns: 100us .. 5s */
+static const uint64_t hist_bounds_ns[APP_METRICS_HIST_BUCKETS] =
+{
+    100000ULL, 250000ULL, 500000ULL,
+    1000000ULL, 2500000ULL, 5000000ULL,
+    10000000ULL, 25000000ULL, 50000000ULL,
+    100000000ULL, 250000000ULL, 500000000ULL,
+    1000000000ULL, 5000000000ULL,
+};
+
+static const app_metrics_vsc_desc_t vsc_desc[APP_METRICS_VSC_MAX] =
+{
+    [APP_METRICS_VSC_APCF_ENABLE]       = { "apcf_enable",       APP_METRICS_VSC_OPCODE_APCF },
+    [APP_METRICS_VSC_APCF_FILTER_PARAM] = { "apcf_filter_param", APP_METRICS_VSC_OPCODE_APCF },
+    [APP_METRICS_VSC_APCF_SRVC_UUID]    = { "apcf_srvc_uuid",    APP_METRICS_VSC_OPCODE_APCF },
+    [APP_METRICS_VSC_APCF_MANU_DATA]    = { "apcf_manu_data",    APP_METRICS_VSC_OPCODE_APCF },
+    [APP_METRICS_VSC_SLEEP_MODE]        = { "sleep_mode",        APP_METRICS_VSC_OPCODE_SLEEP_MODE },
+};
+
+static app_metrics_collector_t *collectors[APP_METRICS_COLLECTOR_MAX];
+static uint32_t                 num_collectors = 0;
+
+static int          server_fd = -1;
+static pthread_t    server_thread;
+static char         server_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static char         render_buf[APP_METRICS_RENDER_BUF_SIZE];
+
+/* previous scrape, for the scan report rate */
+static uint64_t     last_scrape_ns = 0;
+static uint64_t     last_scan_reports = 0;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_metrics_hist_observe()
+ ******************************************************************************
+ * Summary:
+ *   Add one sample to a latency histogram. Lock-free; concurrent observers
+ *   may make count and sum briefly disagree during a scrape, which Prometheus
+ *   tolerates.
+ *
+ * Parameters:
+ *   app_metrics_hist_t *p_hist : histogram
+ *   uint64_t value_ns          : sample in ns
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void app_metrics_hist_observe( app_metrics_hist_t *p_hist, uint64_t value_ns )
+{
+    uint32_t i = 0;
+
+    while ( ( i < APP_METRICS_HIST_BUCKETS ) && ( value_ns > hist_bounds_ns[i] ) )
+    {
+        i++;
+    }
+    APP_METRICS_INC( p_hist->bucket[i] );
+    APP_METRICS_ADD( p_hist->sum_ns, value_ns );
+    APP_METRICS_INC( p_hist->count );
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_set_asleep()
+ ******************************************************************************
+ * Summary:
+ *   Record a sleep state transition and charge the time since the previous
+ *   transition to the previous state.
+ *
+ * Parameters:
+ *   uint32_t asleep            : 1 when the controller entered sleep mode
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void app_metrics_set_asleep( uint32_t asleep )
+{
+    uint64_t now = app_time_now_ns();
+    uint64_t since = __atomic_exchange_n( &app_metrics.state_since_ns, now, __ATOMIC_RELAXED );
+    uint32_t was_asleep = __atomic_exchange_n( &app_metrics.asleep, asleep, __ATOMIC_RELAXED );
+
+    if ( since == 0 )
+    {
+        return;
+    }
+    if ( was_asleep )
+    {
+        APP_METRICS_ADD( app_metrics.asleep_ns_total, now - since );
+    }
+    else
+    {
+        APP_METRICS_ADD( app_metrics.awake_ns_total, now - since );
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_register_collector()
+ ******************************************************************************
+ * Summary:
+ *   Register a function that appends more metrics to every scrape. May be
+ *   called while the server runs; registration is single threaded.
+ *
+ *****************************************************************************/
+int app_metrics_register_collector( app_metrics_collector_t *p_collector )
+{
+    if ( num_collectors >= APP_METRICS_COLLECTOR_MAX )
+    {
+        return APP_METRICS_ERROR;
+    }
+    collectors[num_collectors] = p_collector;
+    __atomic_store_n( &num_collectors, num_collectors + 1, __ATOMIC_RELEASE );
+    return APP_METRICS_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_printf()
+ ******************************************************************************
+ * Summary:
+ *   Append formatted text to a metrics buffer, truncating when full.
+ *
+ *****************************************************************************/
+void app_metrics_printf( app_metrics_buf_t *p_out, const char *fmt, ... )
+{
+    va_list ap;
+    int n;
+
+    if ( p_out->len >= p_out->size )
+    {
+        return;
+    }
+    va_start( ap, fmt );
+    n = vsnprintf( p_out->p_buf + p_out->len, p_out->size - p_out->len, fmt, ap );
+    va_end( ap );
+    if ( n > 0 )
+    {
+        p_out->len += (size_t)n;
+        if ( p_out->len > p_out->size )
+        {
+            p_out->len = p_out->size;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_print_hist()
+ ******************************************************************************
+ * Summary:
+ *   Append a histogram in Prometheus format, values in seconds.
+ *
+ *****************************************************************************/
+void app_metrics_print_hist( app_metrics_buf_t *p_out, const char *name, const char *help,
+                             const app_metrics_hist_t *p_hist )
+{
+    uint64_t cumulative = 0;
+    uint32_t i;
+
+    app_metrics_printf( p_out, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name );
+    for ( i = 0; i < APP_METRICS_HIST_BUCKETS; i++ )
+    {
+        cumulative += __atomic_load_n( &p_hist->bucket[i], __ATOMIC_RELAXED );
+        app_metrics_printf( p_out, "%s_bucket{le=\"%g\"} %llu\n", name,
+                            (double)hist_bounds_ns[i] / 1e9, (unsigned long long)cumulative );
+    }
+    cumulative += __atomic_load_n( &p_hist->bucket[APP_METRICS_HIST_BUCKETS], __ATOMIC_RELAXED );
+    app_metrics_printf( p_out, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)cumulative );
+    app_metrics_printf( p_out, "%s_sum %.9f\n", name,
+                        (double)__atomic_load_n( &p_hist->sum_ns, __ATOMIC_RELAXED ) / 1e9 );
+    app_metrics_printf( p_out, "%s_count %llu\n", name, (unsigned long long)cumulative );
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_print_counter()
+ ******************************************************************************
+ * Summary:
+ *   Append a single unlabelled counter.
+ *
+ *****************************************************************************/
+static void app_metrics_print_counter( app_metrics_buf_t *p_out, const char *name, const char *help,
+                                       const uint64_t *p_value )
+{
+    app_metrics_printf( p_out, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", name, help, name, name,
+                        (unsigned long long)__atomic_load_n( p_value, __ATOMIC_RELAXED ) );
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_render()
+ ******************************************************************************
+ * Summary:
+ *   Render all metrics in Prometheus text exposition format.
+ *
+ * Parameters:
+ *   char *p_buf                : output buffer
+ *   size_t size                : output buffer size
+ *
+ * Return:
+ *  number of bytes written
+ *
+ *****************************************************************************/
+size_t app_metrics_render( char *p_buf, size_t size )
+{
+    app_metrics_buf_t out = { p_buf, size, 0 };
+    uint64_t now = app_time_now_ns();
+    uint64_t since, asleep_ns, awake_ns, reports, value;
+    double rate = 0.0;
+    uint32_t i;
+
+    app_metrics_print_counter( &out, "wakeonle_arm_total", "WakeOnLE arm sequences completed",
+                               &app_metrics.arm_total );
+    app_metrics_print_counter( &out, "wakeonle_disarm_total", "WakeOnLE disabled by the user",
+                               &app_metrics.disarm_total );
+    app_metrics_print_counter( &out, "wakeonle_wake_total", "HOST-WAKE asserted while armed",
+                               &app_metrics.wake_total );
+    app_metrics_print_counter( &out, "wakeonle_spurious_wake_total", "HOST-WAKE asserted while not armed",
+                               &app_metrics.spurious_wake_total );
+    app_metrics_print_counter( &out, "wakeonle_scan_reports_total", "Advertising reports delivered to the host",
+                               &app_metrics.scan_reports_total );
+    app_metrics_print_counter( &out, "wakeonle_scan_reports_dropped_total", "Advertising reports dropped, scan worker behind",
+                               &app_metrics.scan_reports_dropped_total );
+    app_metrics_print_counter( &out, "wakeonle_scan_reports_matched_total", "Advertising reports matching an armed wake rule",
+                               &app_metrics.scan_reports_matched_total );
+
+    app_metrics_printf( &out, "# HELP wakeonle_vsc_failures_total Vendor specific command failures\n"
+                              "# TYPE wakeonle_vsc_failures_total counter\n" );
+    for ( i = 0; i < APP_METRICS_VSC_MAX; i++ )
+    {
+        app_metrics_printf( &out, "wakeonle_vsc_failures_total{opcode=\"0x%04x\",subcmd=\"%s\"} %llu\n",
+                            vsc_desc[i].opcode, vsc_desc[i].subcmd,
+                            (unsigned long long)__atomic_load_n( &app_metrics.vsc_failures[i], __ATOMIC_RELAXED ) );
+    }
+
+    app_metrics_printf( &out, "# HELP wakeonle_filter_hits_total Wakes attributed to each APCF filter index\n"
+                              "# TYPE wakeonle_filter_hits_total counter\n" );
+    for ( i = 0; i < APP_METRICS_FILTER_MAX; i++ )
+    {
+        value = __atomic_load_n( &app_metrics.filter_hits[i], __ATOMIC_RELAXED );
+        if ( value != 0 )
+        {
+            app_metrics_printf( &out, "wakeonle_filter_hits_total{filter=\"%u\"} %llu\n", i,
+                                (unsigned long long)value );
+        }
+    }
+
+    /* reports per second since the previous scrape */
+    reports = __atomic_load_n( &app_metrics.scan_reports_total, __ATOMIC_RELAXED );
+    if ( ( last_scrape_ns != 0 ) && ( now > last_scrape_ns ) )
+    {
+        rate = (double)( reports - last_scan_reports ) * 1e9 / (double)( now - last_scrape_ns );
+    }
+    last_scrape_ns = now;
+    last_scan_reports = reports;
+    app_metrics_printf( &out, "# HELP wakeonle_scan_reports_per_second Report rate since the previous scrape\n"
+                              "# TYPE wakeonle_scan_reports_per_second gauge\n"
+                              "wakeonle_scan_reports_per_second %.3f\n", rate );
+
+    /* include the time spent in the current state */
+    asleep_ns = __atomic_load_n( &app_metrics.asleep_ns_total, __ATOMIC_RELAXED );
+    awake_ns  = __atomic_load_n( &app_metrics.awake_ns_total, __ATOMIC_RELAXED );
+    since     = __atomic_load_n( &app_metrics.state_since_ns, __ATOMIC_RELAXED );
+    if ( ( since != 0 ) && ( now > since ) )
+    {
+        if ( __atomic_load_n( &app_metrics.asleep, __ATOMIC_RELAXED ) )
+        {
+            asleep_ns += now - since;
+        }
+        else
+        {
+            awake_ns += now - since;
+        }
+    }
+    app_metrics_printf( &out, "# HELP wakeonle_state_seconds_total Time spent with the controller asleep or awake\n"
+                              "# TYPE wakeonle_state_seconds_total counter\n"
+                              "wakeonle_state_seconds_total{state=\"asleep\"} %.3f\n"
+                              "wakeonle_state_seconds_total{state=\"awake\"} %.3f\n",
+                        (double)asleep_ns / 1e9, (double)awake_ns / 1e9 );
+
+    app_metrics_print_hist( &out, "wakeonle_arm_latency_seconds",
+                            "Time from a WakeOnLE enable request to sleep mode confirmed",
+                            &app_metrics.arm_latency );
+    app_metrics_print_hist( &out, "wakeonle_wake_latency_seconds",
+                            "Time from HOST-WAKE assert to scan, APCF and sleep mode disabled",
+                            &app_metrics.wake_latency );
+    app_metrics_print_hist( &out, "wakeonle_sched_latency_seconds",
+                            "Delay from a --rt-probe timer expiring to its thread running",
+                            &app_metrics.sched_latency );
+
+    for ( i = 0; i < __atomic_load_n( &num_collectors, __ATOMIC_ACQUIRE ); i++ )
+    {
+        collectors[i]( &out );
+    }
+    return out.len;
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_write_all()
+ ******************************************************************************
+ * Summary:
+ *   Write a whole buffer to a socket.
+ *
+ *****************************************************************************/
+static int app_metrics_write_all( int fd, const char *p_buf, size_t len )
+{
+    ssize_t n;
+
+    while ( len > 0 )
+    {
+        n = send( fd, p_buf, len, MSG_NOSIGNAL );
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return APP_METRICS_ERROR;
+        }
+        p_buf += n;
+        len -= (size_t)n;
+    }
+    return APP_METRICS_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_server_main()
+ ******************************************************************************
+ * Summary:
+ *   Exporter thread. Each connection gets one HTTP/1.0 response with the
+ *   current metrics, so both "curl --unix-socket" and a plain "socat" work.
+ *
+ *****************************************************************************/
+static void *app_metrics_server_main( void *p_arg )
+{
+    struct timeval tv = { 0, APP_METRICS_REQUEST_TIMEOUT_MS * 1000 };
+    char request[1024];
+    char header[128];
+    size_t len;
+    int fd;
+
+    (void)p_arg;
+    for ( ;; )
+    {
+        fd = accept( server_fd, NULL, NULL );
+        if ( fd < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            break;
+        }
+
+        /* drain whatever request line the client sent */
+        setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof( tv ) );
+        (void)recv( fd, request, sizeof( request ), 0 );
+
+        len = app_metrics_render( render_buf, sizeof( render_buf ) );
+        snprintf( header, sizeof( header ),
+                  "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n", len );
+        if ( app_metrics_write_all( fd, header, strlen( header ) ) == APP_METRICS_SUCCESS )
+        {
+            app_metrics_write_all( fd, render_buf, len );
+        }
+        close( fd );
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_server_start()
+ ******************************************************************************
+ * Summary:
+ *   Start the exporter on a Unix stream socket.
+ *
+ * Parameters:
+ *   const char *path           : socket path, eg: /tmp/wakeonle.metrics
+ *
+ * Return:
+ *  APP_METRICS_SUCCESS or APP_METRICS_ERROR
+ *
+ *****************************************************************************/
+int app_metrics_server_start( const char *path )
+{
+    struct sockaddr_un addr;
+
+    if ( ( path == NULL ) || ( strlen( path ) >= sizeof( addr.sun_path ) ) || ( server_fd >= 0 ) )
+    {
+        return APP_METRICS_ERROR;
+    }
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    strncpy( addr.sun_path, path, sizeof( addr.sun_path ) - 1 );
+    strncpy( server_path, path, sizeof( server_path ) - 1 );
+
+    server_fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if ( server_fd < 0 )
+    {
+        perror( "metrics socket" );
+        return APP_METRICS_ERROR;
+    }
+    unlink( path );
+    if ( ( bind( server_fd, (struct sockaddr *)&addr, sizeof( addr ) ) != 0 ) ||
+         ( listen( server_fd, 4 ) != 0 ) )
+    {
+        perror( "metrics bind" );
+        close( server_fd );
+        server_fd = -1;
+        return APP_METRICS_ERROR;
+    }
+
+    if ( pthread_create( &server_thread, NULL, app_metrics_server_main, NULL ) != 0 )
+    {
+        close( server_fd );
+        server_fd = -1;
+        unlink( path );
+        return APP_METRICS_ERROR;
+    }
+    return APP_METRICS_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_metrics_server_stop()
+ ******************************************************************************
+ * Summary:
+ *   Stop the exporter and remove the socket.
+ *
+ *****************************************************************************/
+void app_metrics_server_stop( void )
+{
+    if ( server_fd < 0 )
+    {
+        return;
+    }
+    shutdown( server_fd, SHUT_RDWR );
+    pthread_join( server_thread, NULL );
+    close( server_fd );
+    unlink( server_path );
+    server_fd = -1;
+}
+
+/* [] END OF FILE */
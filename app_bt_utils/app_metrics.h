@@ -0,0 +1,161 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_metrics.h
+ *
+ * Description: This is the header file for the metrics module. Counters and
+ *              latency histograms are plain 64-bit words updated with relaxed
+ *              atomic adds, so updating them from the GPIO and HCI callbacks
+ *              takes no lock and allocates nothing. An exporter thread
+ *              serves them in Prometheus text format over a Unix socket.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_METRICS_H__
+#define __APP_METRICS_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_METRICS_SUCCESS             ( 0 )
+#define APP_METRICS_ERROR               ( -1 )
+
+/* latency histogram buckets, upper bounds in ns, plus +Inf */
+#define APP_METRICS_HIST_BUCKETS        ( 14 )
+
+/* APCF filter indexes 0x00 - 0x1F */
+#define APP_METRICS_FILTER_MAX          ( 32 )
+
+/* extra collectors that can append to the exported text */
+#define APP_METRICS_COLLECTOR_MAX       ( 8 )
+
+/* Broadcom vendor specific opcodes used on the arm/wake path */
+#define APP_METRICS_VSC_OPCODE_APCF         ( 0xFD57 )
+#define APP_METRICS_VSC_OPCODE_SLEEP_MODE   ( 0xFC27 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* vendor specific commands whose failures are counted */
+typedef enum
+{
+    APP_METRICS_VSC_APCF_ENABLE,
+    APP_METRICS_VSC_APCF_FILTER_PARAM,
+    APP_METRICS_VSC_APCF_SRVC_UUID,
+    APP_METRICS_VSC_APCF_MANU_DATA,
+    APP_METRICS_VSC_SLEEP_MODE,
+    APP_METRICS_VSC_MAX
+} app_metrics_vsc_t;
+
+typedef struct
+{
+    uint64_t    bucket[APP_METRICS_HIST_BUCKETS + 1];
+    uint64_t    sum_ns;
+    uint64_t    count;
+} app_metrics_hist_t;
+
+typedef struct
+{
+    uint64_t            arm_total;
+    uint64_t            disarm_total;
+    uint64_t            wake_total;
+    uint64_t            spurious_wake_total;
+    uint64_t            scan_reports_total;
+    uint64_t            scan_reports_dropped_total;
+    uint64_t            scan_reports_matched_total;
+    uint64_t            vsc_failures[APP_METRICS_VSC_MAX];
+    uint64_t            filter_hits[APP_METRICS_FILTER_MAX];
+
+    /* sleep state accounting */
+    uint32_t            asleep;
+    uint64_t            state_since_ns;
+    uint64_t            asleep_ns_total;
+    uint64_t            awake_ns_total;
+
+    app_metrics_hist_t  arm_latency;
+    app_metrics_hist_t  wake_latency;
+    app_metrics_hist_t  sched_latency;
+} app_metrics_t;
+
+/* output buffer handed to collectors */
+typedef struct
+{
+    char    *p_buf;
+    size_t  size;
+    size_t  len;
+} app_metrics_buf_t;
+
+typedef void (app_metrics_collector_t)( app_metrics_buf_t *p_out );
+
+/******************************************************************************
+ *                                EXTERNS
+ *****************************************************************************/
+extern app_metrics_t app_metrics;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void app_metrics_hist_observe( app_metrics_hist_t *p_hist, uint64_t value_ns );
+
+void app_metrics_set_asleep( uint32_t asleep );
+
+int  app_metrics_register_collector( app_metrics_collector_t *p_collector );
+
+void app_metrics_printf( app_metrics_buf_t *p_out, const char *fmt, ... )
+    __attribute__(( format( printf, 2, 3 ) ));
+
+void app_metrics_print_hist( app_metrics_buf_t *p_out, const char *name, const char *help,
+                             const app_metrics_hist_t *p_hist );
+
+size_t app_metrics_render( char *p_buf, size_t size );
+
+int  app_metrics_server_start( const char *path );
+
+void app_metrics_server_stop( void );
+
+/* relaxed atomic counter update, safe from any thread */
+#define APP_METRICS_INC(counter)        __atomic_fetch_add( &(counter), 1, __ATOMIC_RELAXED )
+#define APP_METRICS_ADD(counter, n)     __atomic_fetch_add( &(counter), (n), __ATOMIC_RELAXED )
+
+#endif /* __APP_METRICS_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,305 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_opts.c
+ *
+ * Description: This is the source file for the application option module.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_opts.h"
+#include "app_event_ring.h"
+#include "app_trace.h"
+#include "app_btsnoop.h"
+
+/******************************************************************************
+ *                                MACROS
+ *****************************************************************************/
+#define ARRAY_SIZE(a)       ( sizeof(a) / sizeof((a)[0]) )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef enum
+{
+    APP_OPT_FLAG,       /* no argument, sets a uint8_t to 1 */
+    APP_OPT_STRING,     /* one argument, copied into a char array */
+    APP_OPT_UINT        /* one argument, parsed into a uint32_t */
+} app_opt_type_t;
+
+typedef struct
+{
+    const char      *name;
+    app_opt_type_t  type;
+    void            *p_value;
+    size_t          value_size;
+    const char      *help;
+} app_opt_desc_t;
+
+/******************************************************************************
+ *                               GLOBAL VARIABLES
+ *****************************************************************************/
+app_opts_t app_opts =
+{
+    .event_ring_name    = "",
+    .event_ring_slots   = APP_EVENT_RING_DEFAULT_SLOTS,
+    .metrics_path       = "",
+    .scan_queue_depth   = APP_OPTS_SCAN_QUEUE_DEPTH_DEFAULT,
+    .max_devices        = APP_OPTS_MAX_DEVICES_DEFAULT,
+    .log_level          = APP_TRACE_LEVEL_DEBUG,
+    .json_path          = "",
+    .btsnoop_path       = "",
+    .btsnoop_size       = APP_BTSNOOP_FILE_SIZE_DEFAULT,
+    .heap_size          = 0,
+    .heap_calibrate_s   = 0,
+    .capture_path       = "",
+    .replay_path        = "",
+    .replay_speed       = 1,
+    .replay_loops       = 1,
+    .arm_rule           = "",
+    .radios_path        = "",
+    .radio_name         = "",
+    .rearm_s            = 0,
+    .scan_interval      = 0,
+    .scan_window        = 0,
+    .stagger            = "",
+    .scan_phy           = "",
+    .rt_hci             = "",
+    .rt_gpio            = "",
+    .mlock              = 0,
+    .mlock_stack_kb     = 256,
+    .rt_probe_us        = 0,
+};
+
+static const app_opt_desc_t app_opt_table[] =
+{
+    { "--event-ring",       APP_OPT_STRING, app_opts.event_ring_name,   sizeof(app_opts.event_ring_name),
+      "<name>  publish wake/scan events to shared memory ring <name>, eg: /wakeonle_events" },
+    { "--event-ring-slots", APP_OPT_UINT,   &app_opts.event_ring_slots, sizeof(app_opts.event_ring_slots),
+      "<n>     number of event ring slots, rounded up to a power of 2" },
+    { "--metrics",          APP_OPT_STRING, app_opts.metrics_path,      sizeof(app_opts.metrics_path),
+      "<path>  serve Prometheus metrics on Unix socket <path>, eg: /tmp/wakeonle.metrics" },
+    { "--scan-queue",       APP_OPT_UINT,   &app_opts.scan_queue_depth, sizeof(app_opts.scan_queue_depth),
+      "<n>     advertising reports queued for the scan worker (default " APP_OPTS_SCAN_QUEUE_DEPTH_TEXT ")" },
+    { "--devices",          APP_OPT_UINT,   &app_opts.max_devices,      sizeof(app_opts.max_devices),
+      "<n>     advertisers tracked in the device table (default " APP_OPTS_MAX_DEVICES_TEXT ", 32 bytes + index each)" },
+    { "--log-level",        APP_OPT_UINT,   &app_opts.log_level,        sizeof(app_opts.log_level),
+      "<n>     0 none, 1 errors, 2 info, 3 debug (default); levels compiled out stay off" },
+    { "--json",             APP_OPT_STRING, app_opts.json_path,         sizeof(app_opts.json_path),
+      "<path>  write wake/scan events as JSON lines to <path>, \"-\" for stdout" },
+    { "--btsnoop",          APP_OPT_STRING, app_opts.btsnoop_path,      sizeof(app_opts.btsnoop_path),
+      "<path>  capture HCI traffic in btsnoop format, rotated to <path>.1 when full" },
+    { "--btsnoop-size",     APP_OPT_UINT,   &app_opts.btsnoop_size,     sizeof(app_opts.btsnoop_size),
+      "<n>     btsnoop bytes per file, allocated up front (default 16 MiB)" },
+    { "--heap-size",        APP_OPT_UINT,   &app_opts.heap_size,        sizeof(app_opts.heap_size),
+      "<n>     BT stack default heap size in bytes (default 0xF000)" },
+    { "--heap-calibrate",   APP_OPT_UINT,   &app_opts.heap_calibrate_s, sizeof(app_opts.heap_calibrate_s),
+      "<s>     run with a large heap and print the high-water mark and a --heap-size every <s> seconds" },
+    { "--capture",          APP_OPT_STRING, app_opts.capture_path,      sizeof(app_opts.capture_path),
+      "<path>  append every advertising report to the compact capture <path>" },
+    { "--replay",           APP_OPT_STRING, app_opts.replay_path,       sizeof(app_opts.replay_path),
+      "<path>  btsnoop or --capture file whose advertising reports menu option 6 replays into the scan path" },
+    { "--replay-speed",     APP_OPT_UINT,   &app_opts.replay_speed,     sizeof(app_opts.replay_speed),
+      "<n>     replay at <n> times the captured pace, 0 for as fast as possible (default 1)" },
+    { "--replay-loops",     APP_OPT_UINT,   &app_opts.replay_loops,     sizeof(app_opts.replay_loops),
+      "<n>     replay the capture <n> times (default 1)" },
+    { "--arm",              APP_OPT_STRING, app_opts.arm_rule,          sizeof(app_opts.arm_rule),
+      "<rule>  arm <uuid>[:<pattern>] (hex, eg: AABB or 11223344:0102) once the controller is up" },
+    { "--radios",           APP_OPT_STRING, app_opts.radios_path,       sizeof(app_opts.radios_path),
+      "<path>  run one process per radio listed in <path>, see README" },
+    { "--radio-name",       APP_OPT_STRING, app_opts.radio_name,        sizeof(app_opts.radio_name),
+      "<name>  run as radio <name> of --radios: no menu, stop on SIGTERM" },
+    { "--rearm",            APP_OPT_UINT,   &app_opts.rearm_s,          sizeof(app_opts.rearm_s),
+      "<s>     with --radio-name, re-arm --arm <s> seconds after each wake (default 0, never)" },
+    { "--scan-interval",    APP_OPT_UINT,   &app_opts.scan_interval,    sizeof(app_opts.scan_interval),
+      "<n>     scan interval while armed, in 0.625 ms slots (default 2048)" },
+    { "--scan-window",      APP_OPT_UINT,   &app_opts.scan_window,      sizeof(app_opts.scan_window),
+      "<n>     scan window while armed, in 0.625 ms slots (default 1800)" },
+    { "--stagger",          APP_OPT_STRING, app_opts.stagger,           sizeof(app_opts.stagger),
+      "<k>/<n> start the scan at phase k/n of the interval, set by --radios for n > 1 radios" },
+    { "--scan-phy",         APP_OPT_STRING, app_opts.scan_phy,          sizeof(app_opts.scan_phy),
+      "<phys>  scan for extended advertising on 1m, coded or 1m,coded; wake rules see up to 255 bytes" },
+    { "--rt-hci",           APP_OPT_STRING, app_opts.rt_hci,            sizeof(app_opts.rt_hci),
+      "<p>@<c> run the HCI RX thread SCHED_FIFO priority <p> on CPUs <c>, eg: 80@2; 0 keeps SCHED_OTHER" },
+    { "--rt-gpio",          APP_OPT_STRING, app_opts.rt_gpio,           sizeof(app_opts.rt_gpio),
+      "<p>@<c> same for the HOST-WAKE GPIO thread, eg: 90@2" },
+    { "--mlock",            APP_OPT_UINT,   &app_opts.mlock,            sizeof(app_opts.mlock),
+      "<0|1>   lock and fault in all memory, so the wake path takes no page faults (default 0)" },
+    { "--mlock-stack",      APP_OPT_UINT,   &app_opts.mlock_stack_kb,   sizeof(app_opts.mlock_stack_kb),
+      "<KiB>   thread stack size with --mlock, which locks whole stacks (64..8192, default 256)" },
+    { "--rt-probe",         APP_OPT_UINT,   &app_opts.rt_probe_us,      sizeof(app_opts.rt_probe_us),
+      "<us>    measure scheduling latency with a timer every <us> (100..1000000) at the --rt-gpio setting" },
+};
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_opts_find()
+ ******************************************************************************
+ * Summary:
+ *   Look up an option descriptor by name.
+ *
+ * Parameters:
+ *   const char *name           : option name including the leading "--"
+ *
+ * Return:
+ *  option descriptor, NULL if the option is not owned by this module
+ *
+ *****************************************************************************/
+static const app_opt_desc_t *app_opts_find( const char *name )
+{
+    size_t i;
+
+    for ( i = 0; i < ARRAY_SIZE( app_opt_table ); i++ )
+    {
+        if ( strcmp( app_opt_table[i].name, name ) == 0 )
+        {
+            return &app_opt_table[i];
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_opts_print_usage()
+ ******************************************************************************
+ * Summary:
+ *   Print the application options.
+ *
+ * Parameters:
+ *   None
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void app_opts_print_usage( void )
+{
+    size_t i;
+
+    printf( "\nApplication options:\n" );
+    for ( i = 0; i < ARRAY_SIZE( app_opt_table ); i++ )
+    {
+        printf( " %-20s %s\n", app_opt_table[i].name, app_opt_table[i].help );
+    }
+    printf( "\n" );
+}
+
+/******************************************************************************
+ * Function Name: app_opts_parse()
+ ******************************************************************************
+ * Summary:
+ *   Parse the application "--long" options into app_opts and remove them
+ *   from argv, so the remaining arguments can be passed unchanged to the
+ *   porting layer argument parser.
+ *
+ * Parameters:
+ *   int *p_argc              : Argument count, updated on return
+ *   char **argv              : Arguments, compacted on return
+ *
+ * Return:
+ *  APP_OPTS_SUCCESS or APP_OPTS_ERROR
+ *
+ *****************************************************************************/
+int app_opts_parse( int *p_argc, char **argv )
+{
+    const app_opt_desc_t *p_desc;
+    int argc = *p_argc;
+    int out = 1; /* argv[0] is kept */
+    int i;
+
+    for ( i = 1; i < argc; i++ )
+    {
+        if ( strncmp( argv[i], "--", 2 ) != 0 )
+        {
+            argv[out++] = argv[i];
+            continue;
+        }
+
+        p_desc = app_opts_find( argv[i] );
+        if ( p_desc == NULL )
+        {
+            printf( "Unknown option %s\n", argv[i] );
+            app_opts_print_usage();
+            return APP_OPTS_ERROR;
+        }
+
+        if ( p_desc->type == APP_OPT_FLAG )
+        {
+            *(uint8_t *)p_desc->p_value = 1;
+            continue;
+        }
+
+        if ( i + 1 >= argc )
+        {
+            printf( "No value for option %s\n", argv[i] );
+            app_opts_print_usage();
+            return APP_OPTS_ERROR;
+        }
+
+        i++;
+        if ( p_desc->type == APP_OPT_STRING )
+        {
+            strncpy( (char *)p_desc->p_value, argv[i], p_desc->value_size - 1 );
+            ((char *)p_desc->p_value)[p_desc->value_size - 1] = '\0';
+        }
+        else
+        {
+            char *p_end = NULL;
+            unsigned long val = strtoul( argv[i], &p_end, 0 );
+            if ( ( p_end == argv[i] ) || ( *p_end != '\0' ) || ( val > UINT32_MAX ) )
+            {
+                printf( "Invalid value %s for option %s\n", argv[i], p_desc->name );
+                return APP_OPTS_ERROR;
+            }
+            *(uint32_t *)p_desc->p_value = (uint32_t)val;
+        }
+    }
+
+    argv[out] = NULL;
+    *p_argc = out;
+    return APP_OPTS_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,152 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_opts.h
+ *
+ * Description: This is the header file for the application option module.
+ *              It handles the "--long" options owned by this application and
+ *              removes them from argv before the porting layer argument
+ *              parser runs.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_OPTS_H__
+#define __APP_OPTS_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_OPTS_SUCCESS            ( 0 )
+#define APP_OPTS_ERROR              ( -1 )
+
+#define APP_OPTS_STR_MAX            ( 256 )
+
+/* the scanner-only build profile (WAKEONLE_CFG_PROFILE=SCANNER) trades
+ * burst headroom and device table size for a smaller resident set */
+#ifdef WAKEONLE_CFG_SCANNER_ONLY
+#define APP_OPTS_SCAN_QUEUE_DEPTH_DEFAULT   ( 256U )
+#define APP_OPTS_SCAN_QUEUE_DEPTH_TEXT      "256"
+#define APP_OPTS_MAX_DEVICES_DEFAULT        ( 1024U )
+#define APP_OPTS_MAX_DEVICES_TEXT           "1024"
+#else
+#define APP_OPTS_SCAN_QUEUE_DEPTH_DEFAULT   ( 1024U )
+#define APP_OPTS_SCAN_QUEUE_DEPTH_TEXT      "1024"
+#define APP_OPTS_MAX_DEVICES_DEFAULT        ( 50000U )
+#define APP_OPTS_MAX_DEVICES_TEXT           "50000"
+#endif
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* Application options, filled by app_opts_parse() */
+typedef struct
+{
+    /* shared memory event ring name, empty when disabled */
+    char        event_ring_name[APP_OPTS_STR_MAX];
+    /* number of record slots in the event ring */
+    uint32_t    event_ring_slots;
+    /* Prometheus exporter Unix socket path, empty when disabled */
+    char        metrics_path[APP_OPTS_STR_MAX];
+    /* advertising report queue depth between stack thread and scan worker */
+    uint32_t    scan_queue_depth;
+    /* device table capacity, least recently seen devices are evicted */
+    uint32_t    max_devices;
+    /* runtime trace level, 0 none .. 3 debug, capped by the build */
+    uint32_t    log_level;
+    /* JSON lines event output file, "-" for stdout, empty when disabled */
+    char        json_path[APP_OPTS_STR_MAX];
+    /* btsnoop HCI capture file, empty when disabled */
+    char        btsnoop_path[APP_OPTS_STR_MAX];
+    /* btsnoop bytes per file before rotating */
+    uint32_t    btsnoop_size;
+    /* BT stack default heap size, 0 for the built-in size */
+    uint32_t    heap_size;
+    /* heap calibration report interval in seconds, 0 when disabled */
+    uint32_t    heap_calibrate_s;
+    /* advertising report capture file, empty when disabled */
+    char        capture_path[APP_OPTS_STR_MAX];
+    /* btsnoop or report capture to replay into the scan path, empty when disabled */
+    char        replay_path[APP_OPTS_STR_MAX];
+    /* replay pace multiplier, 0 for as fast as possible */
+    uint32_t    replay_speed;
+    /* replay passes over the capture */
+    uint32_t    replay_loops;
+    /* wake rule armed at startup, "<uuid>[:<pattern>]" in hex, empty for none */
+    char        arm_rule[APP_OPTS_STR_MAX];
+    /* radio list file: supervise one process per radio, empty when disabled */
+    char        radios_path[APP_OPTS_STR_MAX];
+    /* name of this radio when started by the supervisor, empty otherwise */
+    char        radio_name[APP_OPTS_STR_MAX];
+    /* seconds after a wake until a supervised radio re-arms, 0 for never */
+    uint32_t    rearm_s;
+    /* low duty scan interval and window in 0.625 ms slots, 0 for the built-in */
+    uint32_t    scan_interval;
+    uint32_t    scan_window;
+    /* scan phase "<index>/<count>" of this radio, empty for no staggering */
+    char        stagger[APP_OPTS_STR_MAX];
+    /* extended scanning PHYs "1m", "coded" or "1m,coded", empty for legacy scanning */
+    char        scan_phy[APP_OPTS_STR_MAX];
+    /* HCI RX and HOST-WAKE thread scheduling "<priority>[@<cpus>]", empty to leave as is */
+    char        rt_hci[APP_OPTS_STR_MAX];
+    char        rt_gpio[APP_OPTS_STR_MAX];
+    /* lock and fault in all memory when not 0 */
+    uint32_t    mlock;
+    /* thread stack size in KiB with --mlock */
+    uint32_t    mlock_stack_kb;
+    /* scheduling latency probe period in us, 0 when disabled */
+    uint32_t    rt_probe_us;
+} app_opts_t;
+
+/******************************************************************************
+ *                                EXTERNS
+ *****************************************************************************/
+extern app_opts_t app_opts;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int app_opts_parse( int *p_argc, char **argv );
+
+void app_opts_print_usage( void );
+
+#endif /* __APP_OPTS_H__ */
+
+/* [] END OF FILE */
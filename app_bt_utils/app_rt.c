@@ -0,0 +1,565 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_rt.c
+ *
+ * Description: This is the source file for the real-time thread helpers.
+ *
+ *              mlockall( MCL_CURRENT | MCL_FUTURE ) also populates what it
+ *              locks: every page of the rings, pools and thread stacks that
+ *              exist is faulted in by the call, and later mappings are
+ *              faulted in as they are made. Nothing on the wake path takes
+ *              a page fault afterwards. A thread stack is locked whole, so
+ *              app_rt_set_stack_size() first shrinks the stacks of threads
+ *              created without an explicit size, the porting layer's too,
+ *              from the RLIMIT_STACK default of usually 8 MiB.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "app_rt.h"
+
+/******************************************************************************
+ *                                MACROS
+ *****************************************************************************/
+#define RT_NS_PER_SEC                   ( 1000000000ULL )
+
+/******************************************************************************
+ *                               GLOBAL VARIABLES
+ *****************************************************************************/
+static pthread_t            rt_probe_thread;
+static uint32_t             rt_probe_running = 0;
+static uint32_t             rt_probe_period_us;
+static app_rt_thread_cfg_t  rt_probe_cfg;
+static app_rt_probe_cb_t    *p_rt_probe_cb;
+/* written by the probe thread only, read after it is joined */
+static app_rt_latency_t     rt_probe_latency;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint64_t app_rt_now_ns( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * RT_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/* bucket of a delay in us: exact below 4, then four per power of two */
+static uint32_t app_rt_bucket( uint64_t us )
+{
+    uint32_t msb;
+
+    if ( us < 4U )
+    {
+        return (uint32_t)us;
+    }
+    msb = 63U - (uint32_t)__builtin_clzll( us );
+    if ( msb > 31U )
+    {
+        return APP_RT_LATENCY_BUCKETS - 1U;
+    }
+    return ( msb - 1U ) * 4U + (uint32_t)( ( us >> ( msb - 2U ) ) & 3U );
+}
+
+/* largest delay in us that falls in bucket i */
+static uint64_t app_rt_bucket_max_us( uint32_t i )
+{
+    uint32_t msb;
+
+    if ( i < 4U )
+    {
+        return i;
+    }
+    msb = i / 4U + 1U;
+    return ( ( 5ULL + ( i % 4U ) ) << ( msb - 2U ) ) - 1U;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_parse_thread()
+ ******************************************************************************
+ * Summary:
+ *   Parse a "<priority>[@<cpus>]" thread setting, where <cpus> is a list
+ *   of CPUs and ranges, eg: "80@2" or "70@0,2-3"
+ *
+ * Parameters:
+ *   const char *p_text             : setting
+ *   app_rt_thread_cfg_t *p_cfg     : parsed setting
+ *
+ * Return:
+ *  APP_RT_SUCCESS or APP_RT_ERROR
+ *
+ *****************************************************************************/
+int app_rt_parse_thread( const char *p_text, app_rt_thread_cfg_t *p_cfg )
+{
+    unsigned long priority, first, last;
+    char *p_end;
+
+    memset( p_cfg, 0, sizeof( *p_cfg ) );
+    priority = strtoul( p_text, &p_end, 10 );
+    if ( ( p_end == p_text ) || ( (long)priority > sched_get_priority_max( SCHED_FIFO ) ) )
+    {
+        return APP_RT_ERROR;
+    }
+    p_cfg->policy = ( priority > 0 ) ? SCHED_FIFO : SCHED_OTHER;
+    p_cfg->priority = (int)priority;
+    if ( *p_end == '\0' )
+    {
+        return APP_RT_SUCCESS;
+    }
+    if ( *p_end != '@' )
+    {
+        return APP_RT_ERROR;
+    }
+
+    p_cfg->pinned = 1;
+    do
+    {
+        p_text = p_end + 1;
+        first = strtoul( p_text, &p_end, 10 );
+        if ( p_end == p_text )
+        {
+            return APP_RT_ERROR;
+        }
+        last = first;
+        if ( *p_end == '-' )
+        {
+            p_text = p_end + 1;
+            last = strtoul( p_text, &p_end, 10 );
+            if ( ( p_end == p_text ) || ( last < first ) )
+            {
+                return APP_RT_ERROR;
+            }
+        }
+        if ( last >= APP_RT_CPUS_MAX )
+        {
+            return APP_RT_ERROR;
+        }
+        for ( ; first <= last; first++ )
+        {
+            p_cfg->cpus[first / 64U] |= 1ULL << ( first % 64U );
+        }
+    } while ( *p_end == ',' );
+
+    return ( *p_end == '\0' ) ? APP_RT_SUCCESS : APP_RT_ERROR;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_get_thread()
+ ******************************************************************************
+ * Summary:
+ *   Read the policy, priority and CPUs of the calling thread, so that
+ *   app_rt_set_thread() can restore them
+ *
+ * Return:
+ *  APP_RT_SUCCESS or APP_RT_ERROR
+ *
+ *****************************************************************************/
+int app_rt_get_thread( app_rt_thread_cfg_t *p_cfg )
+{
+    struct sched_param param;
+    cpu_set_t cpus;
+    uint32_t cpu;
+
+    memset( p_cfg, 0, sizeof( *p_cfg ) );
+    if ( ( pthread_getschedparam( pthread_self(), &p_cfg->policy, &param ) != 0 ) ||
+         ( pthread_getaffinity_np( pthread_self(), sizeof( cpus ), &cpus ) != 0 ) )
+    {
+        return APP_RT_ERROR;
+    }
+    p_cfg->priority = param.sched_priority;
+    p_cfg->pinned = 1;
+    for ( cpu = 0; cpu < APP_RT_CPUS_MAX; cpu++ )
+    {
+        if ( CPU_ISSET( cpu, &cpus ) )
+        {
+            p_cfg->cpus[cpu / 64U] |= 1ULL << ( cpu % 64U );
+        }
+    }
+    return APP_RT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_set_thread()
+ ******************************************************************************
+ * Summary:
+ *   Apply a thread setting to the calling thread. SCHED_FIFO needs
+ *   CAP_SYS_NICE or a large enough RLIMIT_RTPRIO.
+ *
+ * Return:
+ *  APP_RT_SUCCESS or APP_RT_ERROR, with errno set
+ *
+ *****************************************************************************/
+int app_rt_set_thread( const app_rt_thread_cfg_t *p_cfg )
+{
+    struct sched_param param;
+    cpu_set_t cpus;
+    uint32_t cpu;
+    int err;
+
+    if ( p_cfg->pinned )
+    {
+        CPU_ZERO( &cpus );
+        for ( cpu = 0; cpu < APP_RT_CPUS_MAX; cpu++ )
+        {
+            if ( p_cfg->cpus[cpu / 64U] & ( 1ULL << ( cpu % 64U ) ) )
+            {
+                CPU_SET( cpu, &cpus );
+            }
+        }
+        err = pthread_setaffinity_np( pthread_self(), sizeof( cpus ), &cpus );
+        if ( err != 0 )
+        {
+            errno = err;
+            return APP_RT_ERROR;
+        }
+    }
+
+    memset( &param, 0, sizeof( param ) );
+    param.sched_priority = p_cfg->priority;
+    err = pthread_setschedparam( pthread_self(), p_cfg->policy, &param );
+    if ( err != 0 )
+    {
+        errno = err;
+        return APP_RT_ERROR;
+    }
+    return APP_RT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_format_thread()
+ ******************************************************************************
+ * Summary:
+ *   Describe a thread setting, eg: "SCHED_FIFO 80 on CPUs 2-3"
+ *
+ * Return:
+ *  length of the description, as snprintf()
+ *
+ *****************************************************************************/
+int app_rt_format_thread( const app_rt_thread_cfg_t *p_cfg, char *p_buf, size_t size )
+{
+    int len, sep = ' ';
+    uint32_t cpu, last;
+
+#define RT_CPU_SET( c )     ( ( p_cfg->cpus[( c ) / 64U] >> ( ( c ) % 64U ) ) & 1U )
+    if ( p_cfg->policy == SCHED_FIFO )
+    {
+        len = snprintf( p_buf, size, "SCHED_FIFO %d", p_cfg->priority );
+    }
+    else
+    {
+        len = snprintf( p_buf, size, "SCHED_OTHER" );
+    }
+    if ( !p_cfg->pinned )
+    {
+        return len;
+    }
+    len += snprintf( p_buf + len, ( (size_t)len < size ) ? size - len : 0, " on CPUs" );
+    for ( cpu = 0; cpu < APP_RT_CPUS_MAX; cpu++ )
+    {
+        if ( !RT_CPU_SET( cpu ) )
+        {
+            continue;
+        }
+        for ( last = cpu; ( last + 1U < APP_RT_CPUS_MAX ) && RT_CPU_SET( last + 1U ); last++ )
+        {
+        }
+        if ( last == cpu )
+        {
+            len += snprintf( p_buf + len, ( (size_t)len < size ) ? size - len : 0, "%c%u", sep, cpu );
+        }
+        else
+        {
+            len += snprintf( p_buf + len, ( (size_t)len < size ) ? size - len : 0, "%c%u-%u", sep, cpu, last );
+        }
+        sep = ',';
+        cpu = last;
+    }
+#undef RT_CPU_SET
+    return len;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_lock_memory()
+ ******************************************************************************
+ * Summary:
+ *   Lock and fault in all current and future mappings of the process
+ *
+ * Return:
+ *  APP_RT_SUCCESS or APP_RT_ERROR, with errno set
+ *
+ *****************************************************************************/
+int app_rt_lock_memory( void )
+{
+    return ( mlockall( MCL_CURRENT | MCL_FUTURE ) == 0 ) ? APP_RT_SUCCESS : APP_RT_ERROR;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_set_stack_size()
+ ******************************************************************************
+ * Summary:
+ *   Set the stack size of threads created afterwards without one in their
+ *   attributes; call before the first thread is created
+ *
+ * Parameters:
+ *  size_t size                : stack size in bytes, at least PTHREAD_STACK_MIN
+ *
+ * Return:
+ *  APP_RT_SUCCESS or APP_RT_ERROR, with errno set
+ *
+ *****************************************************************************/
+int app_rt_set_stack_size( size_t size )
+{
+    pthread_attr_t attr;
+    int err;
+
+    err = pthread_attr_init( &attr );
+    if ( err == 0 )
+    {
+        err = pthread_attr_setstacksize( &attr, size );
+        if ( err == 0 )
+        {
+            err = pthread_setattr_default_np( &attr );
+        }
+        pthread_attr_destroy( &attr );
+    }
+    if ( err != 0 )
+    {
+        errno = err;
+        return APP_RT_ERROR;
+    }
+    return APP_RT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_locked_kb()
+ ******************************************************************************
+ * Summary:
+ *   Locked memory of the process, VmLck in /proc/self/status
+ *
+ * Return:
+ *  KiB locked, 0 if unknown
+ *
+ *****************************************************************************/
+uint32_t app_rt_locked_kb( void )
+{
+    char line[128];
+    unsigned long kb = 0;
+    FILE *p_file = fopen( "/proc/self/status", "r" );
+
+    if ( p_file == NULL )
+    {
+        return 0;
+    }
+    while ( fgets( line, sizeof( line ), p_file ) != NULL )
+    {
+        if ( sscanf( line, "VmLck: %lu", &kb ) == 1 )
+        {
+            break;
+        }
+    }
+    fclose( p_file );
+    return (uint32_t)kb;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_probe_main()
+ ******************************************************************************
+ * Summary:
+ *   Probe thread: sleep to absolute deadlines and record how late it runs
+ *
+ *****************************************************************************/
+static void *app_rt_probe_main( void *p_arg )
+{
+    uint64_t next_ns, late_ns, late_us;
+    struct timespec until;
+
+    (void)p_arg;
+    /* a failure was reported by app_rt_probe_start(), the thread still measures */
+    app_rt_set_thread( &rt_probe_cfg );
+
+    next_ns = app_rt_now_ns();
+    while ( __atomic_load_n( &rt_probe_running, __ATOMIC_ACQUIRE ) )
+    {
+        next_ns += (uint64_t)rt_probe_period_us * 1000U;
+        until.tv_sec = (time_t)( next_ns / RT_NS_PER_SEC );
+        until.tv_nsec = (long)( next_ns % RT_NS_PER_SEC );
+        if ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL ) != 0 )
+        {
+            continue;
+        }
+        late_ns = app_rt_now_ns() - next_ns;
+        late_us = late_ns / 1000U;
+        rt_probe_latency.samples++;
+        rt_probe_latency.bucket[app_rt_bucket( late_us )]++;
+        if ( late_us > rt_probe_latency.max_us )
+        {
+            rt_probe_latency.max_us = late_us;
+        }
+        if ( p_rt_probe_cb != NULL )
+        {
+            p_rt_probe_cb( late_ns );
+        }
+        /* after a stall, skip the missed deadlines instead of running behind */
+        if ( late_ns > (uint64_t)rt_probe_period_us * 1000U )
+        {
+            next_ns = app_rt_now_ns();
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_probe_start()
+ ******************************************************************************
+ * Summary:
+ *   Start the latency probe with a thread setting, waking up every
+ *   period_us. The setting is checked on the calling thread first, so a
+ *   missing permission is reported here.
+ *
+ * Parameters:
+ *   const app_rt_thread_cfg_t *p_cfg : probe thread setting
+ *   uint32_t period_us               : deadline period
+ *   app_rt_probe_cb_t *p_cb          : called with each delay, may be NULL
+ *
+ * Return:
+ *  APP_RT_SUCCESS or APP_RT_ERROR, with errno set
+ *
+ *****************************************************************************/
+int app_rt_probe_start( const app_rt_thread_cfg_t *p_cfg, uint32_t period_us, app_rt_probe_cb_t *p_cb )
+{
+    app_rt_thread_cfg_t saved;
+    int err;
+
+    if ( ( period_us < APP_RT_PROBE_PERIOD_MIN_US ) || ( period_us > APP_RT_PROBE_PERIOD_MAX_US ) ||
+         __atomic_load_n( &rt_probe_running, __ATOMIC_ACQUIRE ) )
+    {
+        errno = EINVAL;
+        return APP_RT_ERROR;
+    }
+    if ( ( app_rt_get_thread( &saved ) != APP_RT_SUCCESS ) || ( app_rt_set_thread( p_cfg ) != APP_RT_SUCCESS ) )
+    {
+        return APP_RT_ERROR;
+    }
+    app_rt_set_thread( &saved );
+
+    rt_probe_cfg = *p_cfg;
+    rt_probe_period_us = period_us;
+    p_rt_probe_cb = p_cb;
+    memset( &rt_probe_latency, 0, sizeof( rt_probe_latency ) );
+    __atomic_store_n( &rt_probe_running, 1, __ATOMIC_RELEASE );
+    err = pthread_create( &rt_probe_thread, NULL, app_rt_probe_main, NULL );
+    if ( err != 0 )
+    {
+        __atomic_store_n( &rt_probe_running, 0, __ATOMIC_RELEASE );
+        errno = err;
+        return APP_RT_ERROR;
+    }
+    return APP_RT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_rt_probe_stop()
+ ******************************************************************************
+ * Summary:
+ *   Stop the latency probe, within one period
+ *
+ * Parameters:
+ *   app_rt_latency_t *p_out        : delays recorded, may be NULL
+ *
+ *****************************************************************************/
+void app_rt_probe_stop( app_rt_latency_t *p_out )
+{
+    if ( __atomic_exchange_n( &rt_probe_running, 0, __ATOMIC_ACQ_REL ) )
+    {
+        pthread_join( rt_probe_thread, NULL );
+    }
+    if ( p_out != NULL )
+    {
+        *p_out = rt_probe_latency;
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_rt_latency_percentile_us()
+ ******************************************************************************
+ * Summary:
+ *   Delay percentile, in us, rounded up to its bucket: at most 25 % high
+ *
+ * Parameters:
+ *   const app_rt_latency_t *p_latency : recorded delays
+ *   double fraction                   : eg: 0.99
+ *
+ * Return:
+ *  delay in us, 0 without samples
+ *
+ *****************************************************************************/
+uint64_t app_rt_latency_percentile_us( const app_rt_latency_t *p_latency, double fraction )
+{
+    uint64_t rank = (uint64_t)( fraction * (double)p_latency->samples ), seen = 0;
+    uint64_t bound;
+    uint32_t i;
+
+    if ( p_latency->samples == 0 )
+    {
+        return 0;
+    }
+    for ( i = 0; i < APP_RT_LATENCY_BUCKETS; i++ )
+    {
+        seen += p_latency->bucket[i];
+        if ( ( seen > rank ) || ( seen == p_latency->samples ) )
+        {
+            bound = app_rt_bucket_max_us( i );
+            return ( bound < p_latency->max_us ) ? bound : p_latency->max_us;
+        }
+    }
+    return p_latency->max_us;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,125 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_rt.h
+ *
+ * Description: This is the header file for the real-time thread helpers.
+ *
+ *              A thread setting is a SCHED_FIFO priority and an optional
+ *              CPU set, given as "<priority>[@<cpus>]", eg: "80@2" or
+ *              "70@2-3,6". Priority 0 keeps SCHED_OTHER, so "0@1" only pins.
+ *              Settings apply to the calling thread; threads it creates
+ *              afterwards inherit them.
+ *
+ *              The latency probe is a thread that sleeps until absolute
+ *              CLOCK_MONOTONIC deadlines and records how late it wakes up,
+ *              the same delay a thread blocked on a GPIO edge sees between
+ *              the interrupt and running.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_RT_H__
+#define __APP_RT_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_RT_SUCCESS                  ( 0 )
+#define APP_RT_ERROR                    ( -1 )
+
+/* probe latency buckets: exact below 4 us, then four per power of two */
+#define APP_RT_LATENCY_BUCKETS          ( 124 )
+
+/* CPUs a thread setting can name */
+#define APP_RT_CPUS_MAX                 ( 256 )
+
+#define APP_RT_PROBE_PERIOD_MIN_US      ( 100U )
+#define APP_RT_PROBE_PERIOD_MAX_US      ( 1000000U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    int         policy;             /* SCHED_FIFO or SCHED_OTHER */
+    int         priority;           /* SCHED_FIFO priority, 0 for SCHED_OTHER */
+    int         pinned;             /* cpus is set */
+    uint64_t    cpus[APP_RT_CPUS_MAX / 64];
+} app_rt_thread_cfg_t;
+
+/* probe wake-up delays, in us */
+typedef struct
+{
+    uint64_t    samples;
+    uint64_t    max_us;
+    uint64_t    bucket[APP_RT_LATENCY_BUCKETS];
+} app_rt_latency_t;
+
+/* called by the probe with each wake-up delay, eg: to update a metric */
+typedef void (app_rt_probe_cb_t)( uint64_t latency_ns );
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int app_rt_parse_thread( const char *p_text, app_rt_thread_cfg_t *p_cfg );
+
+int app_rt_get_thread( app_rt_thread_cfg_t *p_cfg );
+
+int app_rt_set_thread( const app_rt_thread_cfg_t *p_cfg );
+
+int app_rt_format_thread( const app_rt_thread_cfg_t *p_cfg, char *p_buf, size_t size );
+
+int app_rt_lock_memory( void );
+
+int app_rt_set_stack_size( size_t size );
+
+uint32_t app_rt_locked_kb( void );
+
+int app_rt_probe_start( const app_rt_thread_cfg_t *p_cfg, uint32_t period_us, app_rt_probe_cb_t *p_cb );
+
+void app_rt_probe_stop( app_rt_latency_t *p_out );
+
+uint64_t app_rt_latency_percentile_us( const app_rt_latency_t *p_latency, double fraction );
+
+#endif /* __APP_RT_H__ */
+
+/* [] END OF FILE */
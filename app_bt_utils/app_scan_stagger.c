@@ -0,0 +1,240 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_scan_stagger.c
+ *
+ * Description: This is the source file for the staggered scan schedule.
+ *
+ *              The phase of a scan is set when it is enabled, so a radio
+ *              delays its scan enable to the next multiple of the interval
+ *              on CLOCK_MONOTONIC, plus its share of the interval. The
+ *              controllers' sleep clocks then let the phases drift apart
+ *              slowly; each arm sets them again.
+ *
+ *              The latency model simulates an advertiser that appears at a
+ *              random time with a random phase and advertises every interval
+ *              plus the 0 to 10 ms advDelay. It is seen by the first event
+ *              that falls in one of the windows. Channels and packet loss
+ *              are not modelled.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_scan_stagger.h"
+
+/******************************************************************************
+ *                                MACROS
+ *****************************************************************************/
+#define SCAN_STAGGER_TRIALS                 ( 10000U )
+/* an advertiser not seen after this long counts as missed */
+#define SCAN_STAGGER_HORIZON_MS             ( 60000.0 )
+#define SCAN_STAGGER_ADV_DELAY_MS           ( 10.0 )
+#define SCAN_STAGGER_SEED                   ( 0x9E3779B97F4A7C15ULL )
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/* xorshift64*, uniform in [0, 1) */
+static double scan_stagger_rand( uint64_t *p_state )
+{
+    *p_state ^= *p_state >> 12;
+    *p_state ^= *p_state << 25;
+    *p_state ^= *p_state >> 27;
+    return (double)( ( *p_state * 0x2545F4914F6CDD1DULL ) >> 11 ) / 9007199254740992.0;
+}
+
+static int scan_stagger_cmp( const void *p_a, const void *p_b )
+{
+    double a = *(const double *)p_a;
+    double b = *(const double *)p_b;
+
+    return ( a > b ) - ( a < b );
+}
+
+/******************************************************************************
+ * Function Name: app_scan_stagger_parse()
+ ******************************************************************************
+ * Summary:
+ *   Parse a "<index>/<count>" schedule position, eg: "1/3"
+ *
+ * Return:
+ *  APP_SCAN_STAGGER_SUCCESS or APP_SCAN_STAGGER_ERROR
+ *
+ *****************************************************************************/
+int app_scan_stagger_parse( const char *p_text, uint32_t *p_index, uint32_t *p_count )
+{
+    unsigned long index, count;
+    char *p_end;
+
+    index = strtoul( p_text, &p_end, 10 );
+    if ( ( p_end == p_text ) || ( *p_end != '/' ) )
+    {
+        return APP_SCAN_STAGGER_ERROR;
+    }
+    p_text = p_end + 1;
+    count = strtoul( p_text, &p_end, 10 );
+    if ( ( p_end == p_text ) || ( *p_end != '\0' ) || ( count == 0 ) || ( count > APP_SCAN_STAGGER_RADIOS_MAX ) ||
+         ( index >= count ) )
+    {
+        return APP_SCAN_STAGGER_ERROR;
+    }
+    *p_index = (uint32_t)index;
+    *p_count = (uint32_t)count;
+    return APP_SCAN_STAGGER_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_scan_stagger_delay_ns()
+ ******************************************************************************
+ * Summary:
+ *   Time to wait before enabling the scan of radio index of count
+ *
+ * Parameters:
+ *   uint64_t now_ns            : CLOCK_MONOTONIC now
+ *   uint32_t interval_slots    : scan interval shared by the radios
+ *   uint32_t index             : position of this radio
+ *   uint32_t count             : radios in the schedule, 1 for no delay
+ *
+ * Return:
+ *  nanoseconds, less than one interval
+ *
+ *****************************************************************************/
+uint64_t app_scan_stagger_delay_ns( uint64_t now_ns, uint32_t interval_slots, uint32_t index, uint32_t count )
+{
+    uint64_t interval_ns = (uint64_t)interval_slots * APP_SCAN_STAGGER_SLOT_NS;
+    uint64_t phase_ns;
+
+    if ( ( count <= 1 ) || ( interval_ns == 0 ) )
+    {
+        return 0;
+    }
+    phase_ns = interval_ns * ( index % count ) / count;
+    return ( phase_ns + interval_ns - now_ns % interval_ns ) % interval_ns;
+}
+
+/******************************************************************************
+ * Function Name: app_scan_stagger_model()
+ ******************************************************************************
+ * Summary:
+ *   Model a schedule of count radios that scan window_slots out of every
+ *   interval_slots, staggered by interval / count
+ *
+ * Parameters:
+ *   uint32_t interval_slots            : scan interval of every radio
+ *   uint32_t window_slots              : scan window of every radio
+ *   uint32_t count                     : radios
+ *   uint32_t adv_interval_ms           : advertising interval, without advDelay
+ *   app_scan_stagger_model_t *p_out    : duty cycles and latency
+ *
+ * Return:
+ *  APP_SCAN_STAGGER_SUCCESS or APP_SCAN_STAGGER_ERROR
+ *
+ *****************************************************************************/
+int app_scan_stagger_model( uint32_t interval_slots, uint32_t window_slots, uint32_t count, uint32_t adv_interval_ms,
+                            app_scan_stagger_model_t *p_out )
+{
+    double interval_ms = (double)interval_slots * APP_SCAN_STAGGER_SLOT_NS / 1e6;
+    double window_ms = (double)window_slots * APP_SCAN_STAGGER_SLOT_NS / 1e6;
+    double start, t, phase, sum = 0.0, spacing;
+    uint64_t rng = SCAN_STAGGER_SEED;
+    uint32_t trial, k, seen = 0, missed = 0;
+    double *p_latency;
+
+    if ( ( interval_slots == 0 ) || ( window_slots == 0 ) || ( window_slots > interval_slots ) || ( count == 0 ) ||
+         ( count > APP_SCAN_STAGGER_RADIOS_MAX ) || ( adv_interval_ms == 0 ) )
+    {
+        return APP_SCAN_STAGGER_ERROR;
+    }
+    p_latency = malloc( SCAN_STAGGER_TRIALS * sizeof( double ) );
+    if ( p_latency == NULL )
+    {
+        return APP_SCAN_STAGGER_ERROR;
+    }
+
+    memset( p_out, 0, sizeof( *p_out ) );
+    spacing = interval_ms / count;
+    p_out->radio_duty = window_ms / interval_ms;
+    p_out->combined_duty = ( window_ms < spacing ) ? window_ms * count / interval_ms : 1.0;
+
+    for ( trial = 0; trial < SCAN_STAGGER_TRIALS; trial++ )
+    {
+        start = scan_stagger_rand( &rng ) * interval_ms;
+        t = start + scan_stagger_rand( &rng ) * adv_interval_ms;
+        for ( ; t - start < SCAN_STAGGER_HORIZON_MS;
+              t += adv_interval_ms + scan_stagger_rand( &rng ) * SCAN_STAGGER_ADV_DELAY_MS )
+        {
+            for ( k = 0; k < count; k++ )
+            {
+                phase = fmod( t - k * spacing, interval_ms );
+                if ( ( phase < 0.0 ? phase + interval_ms : phase ) < window_ms )
+                {
+                    break;
+                }
+            }
+            if ( k < count )
+            {
+                break;
+            }
+        }
+        if ( t - start >= SCAN_STAGGER_HORIZON_MS )
+        {
+            missed++;
+            continue;
+        }
+        p_latency[seen++] = t - start;
+        sum += t - start;
+    }
+
+    if ( seen > 0 )
+    {
+        qsort( p_latency, seen, sizeof( double ), scan_stagger_cmp );
+        p_out->mean_ms = sum / seen;
+        p_out->p50_ms = p_latency[seen / 2];
+        p_out->p90_ms = p_latency[(uint32_t)( seen * 0.90 )];
+        p_out->p99_ms = p_latency[(uint32_t)( seen * 0.99 )];
+    }
+    p_out->missed = (double)missed / SCAN_STAGGER_TRIALS;
+    free( p_latency );
+    return APP_SCAN_STAGGER_SUCCESS;
+}
+
+/* [] END OF FILE */
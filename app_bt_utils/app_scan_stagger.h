@@ -0,0 +1,100 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_scan_stagger.h
+ *
+ * Description: This is the header file for the staggered scan schedule.
+ *
+ *              Radios that scan with the same interval can split it between
+ *              them: radio k of n enables its scan at phase k * interval / n
+ *              of a CLOCK_MONOTONIC based period, which every process on the
+ *              host shares, so their windows follow each other instead of
+ *              overlapping. app_scan_stagger_model() gives the combined duty
+ *              cycle of such a schedule and the detection latency it yields
+ *              for an advertiser of a given interval.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_SCAN_STAGGER_H__
+#define __APP_SCAN_STAGGER_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_SCAN_STAGGER_SUCCESS            ( 0 )
+#define APP_SCAN_STAGGER_ERROR              ( -1 )
+
+/* HCI scan interval and window unit */
+#define APP_SCAN_STAGGER_SLOT_NS            ( 625000ULL )
+/* HCI limits of the scan interval and window, in slots */
+#define APP_SCAN_STAGGER_SLOTS_MIN          ( 0x0004U )
+#define APP_SCAN_STAGGER_SLOTS_MAX          ( 0x4000U )
+#define APP_SCAN_STAGGER_RADIOS_MAX         ( 16U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* Detection latency of one schedule for one advertiser, over random start
+ * times of the advertiser relative to the schedule */
+typedef struct
+{
+    double      radio_duty;         /* window / interval of one radio */
+    double      combined_duty;      /* time some radio is scanning */
+    double      mean_ms;
+    double      p50_ms;
+    double      p90_ms;
+    double      p99_ms;
+    double      missed;             /* fraction not seen within the horizon */
+} app_scan_stagger_model_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int app_scan_stagger_parse( const char *p_text, uint32_t *p_index, uint32_t *p_count );
+
+uint64_t app_scan_stagger_delay_ns( uint64_t now_ns, uint32_t interval_slots, uint32_t index, uint32_t count );
+
+int app_scan_stagger_model( uint32_t interval_slots, uint32_t window_slots, uint32_t count, uint32_t adv_interval_ms,
+                            app_scan_stagger_model_t *p_out );
+
+#endif /* __APP_SCAN_STAGGER_H__ */
+
+/* [] END OF FILE */
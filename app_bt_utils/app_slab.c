@@ -0,0 +1,318 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_slab.c
+ *
+ * Description: This is the source file for the fixed size slab pool. The
+ *              free list of a class is a Treiber stack of block indexes.
+ *              The head word also carries the blocks in use, so allocation
+ *              and free are a single compare-and-swap each with exact
+ *              statistics, and a tag incremented on every allocation so a
+ *              stale compare-and-swap fails instead of corrupting the list.
+ *              The links live outside the blocks, so a racing reader never
+ *              follows a pointer into memory that was handed out.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "app_slab.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_SLAB_HEAD_MASK                  ( (uint64_t)APP_SLAB_COUNT_MAX )
+#define APP_SLAB_HEAD_IDX( h )              ( (uint32_t)( ( h ) & APP_SLAB_HEAD_MASK ) )
+#define APP_SLAB_HEAD_IN_USE( h )           ( (uint32_t)( ( ( h ) >> APP_SLAB_HEAD_BITS ) & APP_SLAB_HEAD_MASK ) )
+#define APP_SLAB_HEAD_TAG( h )              ( ( h ) >> ( 2U * APP_SLAB_HEAD_BITS ) )
+#define APP_SLAB_HEAD( tag, in_use, idx )   ( ( (uint64_t)( tag ) << ( 2U * APP_SLAB_HEAD_BITS ) ) |     \
+                                              ( (uint64_t)( in_use ) << APP_SLAB_HEAD_BITS ) | ( idx ) )
+/* free list link of an allocated block, never a block index + 1 */
+#define APP_SLAB_LINK_IN_USE                ( 0xFFFFFFFFU )
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_slab_class_pop()
+ ******************************************************************************
+ * Summary:
+ *   Take a block from a class
+ *
+ * Return:
+ *  block, NULL if the class is empty
+ *
+ *****************************************************************************/
+static void *app_slab_class_pop( app_slab_class_t *p_class )
+{
+    uint64_t head = __atomic_load_n( &p_class->head, __ATOMIC_ACQUIRE );
+    uint64_t next;
+    uint32_t idx, in_use;
+
+    do
+    {
+        idx = APP_SLAB_HEAD_IDX( head );
+        if ( idx == 0 )
+        {
+            __atomic_fetch_add( &p_class->exhausted, 1, __ATOMIC_RELAXED );
+            return NULL;
+        }
+        in_use = APP_SLAB_HEAD_IN_USE( head ) + 1;
+        next = APP_SLAB_HEAD( APP_SLAB_HEAD_TAG( head ) + 1, in_use,
+                              __atomic_load_n( &p_class->p_next[idx - 1], __ATOMIC_RELAXED ) );
+    } while ( !__atomic_compare_exchange_n( &p_class->head, &head, next, 1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE ) );
+    /* a stale pop that reads this link fails its compare-and-swap on the tag */
+    __atomic_store_n( &p_class->p_next[idx - 1], APP_SLAB_LINK_IN_USE, __ATOMIC_RELAXED );
+
+    /* the high-water mark is only written when it moves */
+    if ( in_use > __atomic_load_n( &p_class->high_water, __ATOMIC_RELAXED ) )
+    {
+        __atomic_store_n( &p_class->high_water, in_use, __ATOMIC_RELAXED );
+    }
+    return p_class->p_base + (size_t)( idx - 1 ) * p_class->block_size;
+}
+
+/******************************************************************************
+ * Function Name: app_slab_init()
+ ******************************************************************************
+ * Summary:
+ *   Allocate the arenas of a pool and put every block on its free list
+ *
+ * Parameters:
+ *   app_slab_pool_t *p_pool      : pool to initialize
+ *   const uint32_t *p_sizes      : block size of each class, ascending
+ *   const uint32_t *p_counts     : blocks in each class
+ *   uint32_t num_classes         : up to APP_SLAB_CLASSES_MAX
+ *   app_slab_policy_t policy     : exhaustion policy
+ *
+ * Return:
+ *  APP_SLAB_SUCCESS or APP_SLAB_ERROR
+ *
+ *****************************************************************************/
+int app_slab_init( app_slab_pool_t *p_pool, const uint32_t *p_sizes, const uint32_t *p_counts,
+                   uint32_t num_classes, app_slab_policy_t policy )
+{
+    app_slab_class_t *p_class;
+    void *p_mem;
+    uint32_t c, i;
+
+    memset( p_pool, 0, sizeof( *p_pool ) );
+    if ( ( num_classes == 0 ) || ( num_classes > APP_SLAB_CLASSES_MAX ) )
+    {
+        return APP_SLAB_ERROR;
+    }
+    p_pool->policy = policy;
+
+    for ( c = 0; c < num_classes; c++ )
+    {
+        p_class = &p_pool->classes[c];
+        p_class->block_size = ( p_sizes[c] + APP_SLAB_ALIGN - 1U ) & ~( APP_SLAB_ALIGN - 1U );
+        p_class->count = p_counts[c];
+        if ( ( p_class->block_size == 0 ) || ( p_class->count == 0 ) || ( p_class->count > APP_SLAB_COUNT_MAX ) ||
+             ( ( c > 0 ) && ( p_class->block_size <= p_pool->classes[c - 1].block_size ) ) ||
+             ( posix_memalign( &p_mem, 64, (size_t)p_class->block_size * p_class->count ) != 0 ) )
+        {
+            app_slab_deinit( p_pool );
+            return APP_SLAB_ERROR;
+        }
+        p_class->p_base = (uint8_t *)p_mem;
+        p_class->p_next = (uint32_t *)malloc( sizeof( uint32_t ) * p_class->count );
+        p_pool->num_classes = c + 1;
+        if ( p_class->p_next == NULL )
+        {
+            app_slab_deinit( p_pool );
+            return APP_SLAB_ERROR;
+        }
+        /* touch the arena now, not on the first allocations */
+        memset( p_class->p_base, 0, (size_t)p_class->block_size * p_class->count );
+        for ( i = 0; i < p_class->count; i++ )
+        {
+            p_class->p_next[i] = ( i + 1 < p_class->count ) ? i + 2 : 0;
+        }
+        p_class->head = APP_SLAB_HEAD( 0, 0, 1 );
+    }
+    return APP_SLAB_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_slab_deinit()
+ ******************************************************************************
+ * Summary:
+ *   Free the arenas; no block may be in use
+ *
+ *****************************************************************************/
+void app_slab_deinit( app_slab_pool_t *p_pool )
+{
+    uint32_t c;
+
+    for ( c = 0; c < p_pool->num_classes; c++ )
+    {
+        free( p_pool->classes[c].p_base );
+        free( p_pool->classes[c].p_next );
+    }
+    memset( p_pool, 0, sizeof( *p_pool ) );
+}
+
+/******************************************************************************
+ * Function Name: app_slab_footprint()
+ ******************************************************************************
+ * Summary:
+ *   Bytes reserved by a pool
+ *
+ *****************************************************************************/
+size_t app_slab_footprint( const app_slab_pool_t *p_pool )
+{
+    size_t total = 0;
+    uint32_t c;
+
+    for ( c = 0; c < p_pool->num_classes; c++ )
+    {
+        total += (size_t)p_pool->classes[c].count * ( p_pool->classes[c].block_size + sizeof( uint32_t ) );
+    }
+    return total;
+}
+
+/******************************************************************************
+ * Function Name: app_slab_in_use()
+ ******************************************************************************
+ * Summary:
+ *   Blocks of a class currently allocated
+ *
+ *****************************************************************************/
+uint32_t app_slab_in_use( const app_slab_class_t *p_class )
+{
+    return APP_SLAB_HEAD_IN_USE( __atomic_load_n( &p_class->head, __ATOMIC_RELAXED ) );
+}
+
+/******************************************************************************
+ * Function Name: app_slab_alloc()
+ ******************************************************************************
+ * Summary:
+ *   Allocate a block of at least len bytes from the smallest class that
+ *   fits, then per the pool policy
+ *
+ * Parameters:
+ *   app_slab_pool_t *p_pool  : pool
+ *   size_t len               : bytes needed
+ *
+ * Return:
+ *  block, NULL if len is larger than every class or no block is free
+ *
+ *****************************************************************************/
+void *app_slab_alloc( app_slab_pool_t *p_pool, size_t len )
+{
+    void *p_block;
+    uint32_t c = 0;
+
+    while ( ( c < p_pool->num_classes ) && ( p_pool->classes[c].block_size < len ) )
+    {
+        c++;
+    }
+    for ( ; c < p_pool->num_classes; c++ )
+    {
+        p_block = app_slab_class_pop( &p_pool->classes[c] );
+        if ( ( p_block != NULL ) || ( p_pool->policy != APP_SLAB_EXHAUST_NEXT_CLASS ) )
+        {
+            return p_block;
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_slab_free()
+ ******************************************************************************
+ * Summary:
+ *   Return a block to its class
+ *
+ * Parameters:
+ *   app_slab_pool_t *p_pool  : pool
+ *   void *p_block            : block from app_slab_alloc(), NULL is ignored
+ *
+ * Return:
+ *  APP_SLAB_SUCCESS, APP_SLAB_ERROR if the block is not from this pool or
+ *  is already free
+ *
+ *****************************************************************************/
+int app_slab_free( app_slab_pool_t *p_pool, void *p_block )
+{
+    const uint8_t *p = (const uint8_t *)p_block;
+    app_slab_class_t *p_class;
+    uint64_t head, next;
+    size_t offset;
+    uint32_t c, idx, link;
+
+    if ( p_block == NULL )
+    {
+        return APP_SLAB_SUCCESS;
+    }
+
+    for ( c = 0; c < p_pool->num_classes; c++ )
+    {
+        p_class = &p_pool->classes[c];
+        if ( ( p < p_class->p_base ) || ( p >= p_class->p_base + (size_t)p_class->block_size * p_class->count ) )
+        {
+            continue;
+        }
+        offset = (size_t)( p - p_class->p_base );
+        if ( offset % p_class->block_size != 0 )
+        {
+            return APP_SLAB_ERROR;
+        }
+        idx = (uint32_t)( offset / p_class->block_size ) + 1;
+
+        /* claim the block, of two frees only one finds it in use */
+        link = APP_SLAB_LINK_IN_USE;
+        if ( !__atomic_compare_exchange_n( &p_class->p_next[idx - 1], &link, 0, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+        {
+            return APP_SLAB_ERROR;
+        }
+        head = __atomic_load_n( &p_class->head, __ATOMIC_RELAXED );
+        do
+        {
+            __atomic_store_n( &p_class->p_next[idx - 1], APP_SLAB_HEAD_IDX( head ), __ATOMIC_RELAXED );
+            next = APP_SLAB_HEAD( APP_SLAB_HEAD_TAG( head ), APP_SLAB_HEAD_IN_USE( head ) - 1, idx );
+        } while ( !__atomic_compare_exchange_n( &p_class->head, &head, next, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+        return APP_SLAB_SUCCESS;
+    }
+    return APP_SLAB_ERROR;
+}
+
+/* [] END OF FILE */
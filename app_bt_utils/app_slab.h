@@ -0,0 +1,119 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_slab.h
+ *
+ * Description: This is the header file for the fixed size slab pool.
+ *
+ *              A pool has a few size classes, each a preallocated arena of
+ *              equal blocks with a lock-free free list, so allocation and
+ *              free are one compare-and-swap from any thread, never call
+ *              malloc and cannot fragment. The class of a block is found
+ *              from its address; blocks carry no header. Freeing a block
+ *              that is already free is detected and refused.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_SLAB_H__
+#define __APP_SLAB_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_SLAB_SUCCESS                    ( 0 )
+#define APP_SLAB_ERROR                      ( -1 )
+
+#define APP_SLAB_CLASSES_MAX                ( 4U )
+/* block sizes are rounded up to this, which is also the block alignment */
+#define APP_SLAB_ALIGN                      ( 16U )
+/* the free list head packs ABA tag : blocks in use : first free block + 1 */
+#define APP_SLAB_HEAD_BITS                  ( 20U )
+#define APP_SLAB_COUNT_MAX                  ( ( 1U << APP_SLAB_HEAD_BITS ) - 1U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* what app_slab_alloc() does when the best fitting class is empty */
+typedef enum
+{
+    APP_SLAB_EXHAUST_FAIL       = 0,    /* return NULL */
+    APP_SLAB_EXHAUST_NEXT_CLASS = 1     /* take a block from a larger class */
+} app_slab_policy_t;
+
+typedef struct
+{
+    uint32_t    block_size;
+    uint32_t    count;
+    uint8_t     *p_base;
+    uint32_t    *p_next;        /* free list links, block index + 1, 0 ends */
+    uint64_t    head;           /* see APP_SLAB_HEAD_BITS */
+    /* statistics */
+    uint32_t    high_water;
+    uint64_t    exhausted;      /* requests that found this class empty */
+} app_slab_class_t;
+
+typedef struct
+{
+    uint32_t            num_classes;
+    app_slab_policy_t   policy;
+    app_slab_class_t    classes[APP_SLAB_CLASSES_MAX];   /* ascending block size */
+} app_slab_pool_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int app_slab_init( app_slab_pool_t *p_pool, const uint32_t *p_sizes, const uint32_t *p_counts,
+                   uint32_t num_classes, app_slab_policy_t policy );
+
+void app_slab_deinit( app_slab_pool_t *p_pool );
+
+size_t app_slab_footprint( const app_slab_pool_t *p_pool );
+
+uint32_t app_slab_in_use( const app_slab_class_t *p_class );
+
+void *app_slab_alloc( app_slab_pool_t *p_pool, size_t len );
+
+int app_slab_free( app_slab_pool_t *p_pool, void *p_block );
+
+#endif /* __APP_SLAB_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,113 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_spsc_ring.c
+ *
+ * Description: This is the source file for the single producer / single
+ *              consumer ring.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "app_spsc_ring.h"
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_spsc_ring_init()
+ ******************************************************************************
+ * Summary:
+ *   Allocate and prefault the element storage. This is the only allocation
+ *   the ring makes.
+ *
+ * Parameters:
+ *   app_spsc_ring_t *p_ring    : ring to initialize
+ *   uint32_t elem_size         : element size in bytes, rounded up to 8
+ *   uint32_t count             : number of elements, rounded up to a power of 2
+ *
+ * Return:
+ *  APP_SPSC_RING_SUCCESS or APP_SPSC_RING_ERROR
+ *
+ *****************************************************************************/
+int app_spsc_ring_init( app_spsc_ring_t *p_ring, uint32_t elem_size, uint32_t count )
+{
+    uint32_t n = 1;
+    void *p_buf = NULL;
+
+    if ( ( elem_size == 0 ) || ( count == 0 ) || ( count > ( 1U << 24 ) ) )
+    {
+        return APP_SPSC_RING_ERROR;
+    }
+    while ( n < count )
+    {
+        n <<= 1;
+    }
+    elem_size = ( elem_size + 7U ) & ~7U;
+
+    if ( posix_memalign( &p_buf, APP_SPSC_CACHE_LINE, (size_t)elem_size * n ) != 0 )
+    {
+        return APP_SPSC_RING_ERROR;
+    }
+    /* touch every page now so the producer never takes a page fault */
+    memset( p_buf, 0, (size_t)elem_size * n );
+
+    memset( p_ring, 0, sizeof( *p_ring ) );
+    p_ring->p_buf = (uint8_t *)p_buf;
+    p_ring->elem_size = elem_size;
+    p_ring->count = n;
+    return APP_SPSC_RING_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_spsc_ring_deinit()
+ ******************************************************************************
+ * Summary:
+ *   Free the element storage. Producer and consumer must have stopped.
+ *
+ *****************************************************************************/
+void app_spsc_ring_deinit( app_spsc_ring_t *p_ring )
+{
+    free( p_ring->p_buf );
+    p_ring->p_buf = NULL;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,165 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_spsc_ring.h
+ *
+ * Description: This is the header file for the single producer / single
+ *              consumer ring. Elements are fixed size and preallocated; the
+ *              producer reserves a slot, fills it in place and commits it,
+ *              so nothing is copied twice and nothing is allocated after
+ *              app_spsc_ring_init(). Producer and consumer indexes live on
+ *              separate cache lines and each side keeps a cached copy of the
+ *              other side's index to avoid cache line ping-pong.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_SPSC_RING_H__
+#define __APP_SPSC_RING_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_SPSC_RING_SUCCESS       ( 0 )
+#define APP_SPSC_RING_ERROR         ( -1 )
+
+#define APP_SPSC_CACHE_LINE         ( 64 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    /* producer cache line */
+    uint64_t    head;
+    uint64_t    cached_tail;
+    uint8_t     pad0[APP_SPSC_CACHE_LINE - 2 * sizeof(uint64_t)];
+    /* consumer cache line */
+    uint64_t    tail;
+    uint64_t    cached_head;
+    uint8_t     pad1[APP_SPSC_CACHE_LINE - 2 * sizeof(uint64_t)];
+    /* read-only after init */
+    uint8_t     *p_buf;
+    uint32_t    elem_size;
+    uint32_t    count;
+} app_spsc_ring_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int  app_spsc_ring_init( app_spsc_ring_t *p_ring, uint32_t elem_size, uint32_t count );
+
+void app_spsc_ring_deinit( app_spsc_ring_t *p_ring );
+
+/*******************************************************************************
+* Function Name: app_spsc_ring_reserve
+********************************************************************************
+* Summary:
+*   Producer: get the next free slot, or NULL when the ring is full. The slot
+*   becomes visible to the consumer on app_spsc_ring_commit().
+*
+*******************************************************************************/
+static inline void *app_spsc_ring_reserve( app_spsc_ring_t *p_ring )
+{
+    uint64_t head = p_ring->head;
+
+    if ( head - p_ring->cached_tail >= p_ring->count )
+    {
+        p_ring->cached_tail = __atomic_load_n( &p_ring->tail, __ATOMIC_ACQUIRE );
+        if ( head - p_ring->cached_tail >= p_ring->count )
+        {
+            return NULL;
+        }
+    }
+    return p_ring->p_buf + ( head & ( p_ring->count - 1 ) ) * p_ring->elem_size;
+}
+
+/*******************************************************************************
+* Function Name: app_spsc_ring_commit
+********************************************************************************
+* Summary:
+*   Producer: publish the slot returned by app_spsc_ring_reserve().
+*
+*******************************************************************************/
+static inline void app_spsc_ring_commit( app_spsc_ring_t *p_ring )
+{
+    __atomic_store_n( &p_ring->head, p_ring->head + 1, __ATOMIC_RELEASE );
+}
+
+/*******************************************************************************
+* Function Name: app_spsc_ring_peek
+********************************************************************************
+* Summary:
+*   Consumer: get the oldest committed slot, or NULL when the ring is empty.
+*   The slot stays owned by the consumer until app_spsc_ring_release().
+*
+*******************************************************************************/
+static inline void *app_spsc_ring_peek( app_spsc_ring_t *p_ring )
+{
+    uint64_t tail = p_ring->tail;
+
+    if ( tail == p_ring->cached_head )
+    {
+        p_ring->cached_head = __atomic_load_n( &p_ring->head, __ATOMIC_ACQUIRE );
+        if ( tail == p_ring->cached_head )
+        {
+            return NULL;
+        }
+    }
+    return p_ring->p_buf + ( tail & ( p_ring->count - 1 ) ) * p_ring->elem_size;
+}
+
+/*******************************************************************************
+* Function Name: app_spsc_ring_release
+********************************************************************************
+* Summary:
+*   Consumer: hand the slot returned by app_spsc_ring_peek() back to the
+*   producer.
+*
+*******************************************************************************/
+static inline void app_spsc_ring_release( app_spsc_ring_t *p_ring )
+{
+    __atomic_store_n( &p_ring->tail, p_ring->tail + 1, __ATOMIC_RELEASE );
+}
+
+#endif /* __APP_SPSC_RING_H__ */
+
+/* [] END OF FILE */
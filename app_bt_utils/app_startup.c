@@ -0,0 +1,308 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_startup.c
+ *
+ * Description: This is the source file for the startup timeline. Phases
+ *              are recorded in fixed arrays with atomic stores, so they
+ *              can be marked from the main, stack and porting layer
+ *              threads and read by the metrics exporter at any time.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "app_startup.h"
+#include "app_time.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_STARTUP_NS_PER_MS               ( 1000000ULL )
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+/* metric labels, also the summary names */
+static const char *const app_startup_names[APP_STARTUP_PHASES] =
+{
+    [APP_STARTUP_EXEC]              = "exec",
+    [APP_STARTUP_ARGS]              = "args",
+    [APP_STARTUP_PLATFORM_INIT]     = "platform_init",
+    [APP_STARTUP_UART_OPEN]         = "uart_open",
+    [APP_STARTUP_PATCH_DOWNLOAD]    = "patch_download",
+    [APP_STARTUP_BAUD_SWITCH]       = "baud_switch",
+    [APP_STARTUP_STACK_INIT]        = "stack_init",
+    [APP_STARTUP_BT_ENABLED]        = "bt_enabled",
+    [APP_STARTUP_HEAP_CREATE]       = "heap_create",
+    [APP_STARTUP_APP_INIT]          = "app_init",
+    [APP_STARTUP_CONTROLLER_RESET]  = "controller_reset",
+};
+
+/* CLOCK_MONOTONIC ns of the exec, the zero of the timeline */
+static uint64_t app_startup_origin_ns;
+/* per phase, 0 when not recorded */
+static uint64_t app_startup_begin_ns[APP_STARTUP_PHASES];
+static uint64_t app_startup_end_ns[APP_STARTUP_PHASES];
+static uint32_t app_startup_open;
+static uint32_t app_startup_completed;
+static uint64_t app_startup_total_ns;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_startup_exec_ago_ns()
+ ******************************************************************************
+ * Summary:
+ *   Time since the exec of this process, from its start time in
+ *   /proc/self/stat (clock tick resolution)
+ *
+ * Return:
+ *  ns since exec, 0 if unknown
+ *
+ *****************************************************************************/
+static uint64_t app_startup_exec_ago_ns( void )
+{
+    char stat[512];
+    unsigned long long start_ticks = 0;
+    struct timespec boot;
+    uint64_t now_ns, start_ns;
+    long hz = sysconf( _SC_CLK_TCK );
+    const char *p;
+    FILE *p_file;
+    size_t len;
+    int field;
+
+    p_file = fopen( "/proc/self/stat", "r" );
+    if ( p_file == NULL )
+    {
+        return 0;
+    }
+    len = fread( stat, 1, sizeof( stat ) - 1, p_file );
+    fclose( p_file );
+    stat[len] = '\0';
+
+    /* the command name may hold spaces, fields count from its ')' as field 2 */
+    p = strrchr( stat, ')' );
+    for ( field = 2; ( p != NULL ) && ( field < 22 ); field++ )
+    {
+        p = strchr( p + 1, ' ' );
+    }
+    if ( ( p == NULL ) || ( sscanf( p, " %llu", &start_ticks ) != 1 ) || ( hz <= 0 ) ||
+         ( clock_gettime( CLOCK_BOOTTIME, &boot ) != 0 ) )
+    {
+        return 0;
+    }
+    now_ns = (uint64_t)boot.tv_sec * APP_TIME_NS_PER_SEC + (uint64_t)boot.tv_nsec;
+    start_ns = (uint64_t)start_ticks * ( APP_TIME_NS_PER_SEC / (uint64_t)hz );
+    return ( now_ns > start_ns ) ? now_ns - start_ns : 0;
+}
+
+/******************************************************************************
+ * Function Name: app_startup_init()
+ ******************************************************************************
+ * Summary:
+ *   Start the timeline; call first thing in main()
+ *
+ *****************************************************************************/
+void app_startup_init( void )
+{
+    uint64_t now_ns = app_time_now_ns();
+
+    app_startup_origin_ns = now_ns - app_startup_exec_ago_ns();
+    app_startup_begin_ns[APP_STARTUP_EXEC] = app_startup_origin_ns;
+    app_startup_end_ns[APP_STARTUP_EXEC] = now_ns;
+}
+
+/******************************************************************************
+ * Function Name: app_startup_begin()
+ ******************************************************************************
+ * Summary:
+ *   Open a phase
+ *
+ *****************************************************************************/
+void app_startup_begin( app_startup_phase_t phase )
+{
+    if ( ( phase >= APP_STARTUP_PHASES ) || ( __atomic_load_n( &app_startup_begin_ns[phase], __ATOMIC_RELAXED ) != 0 ) )
+    {
+        return;
+    }
+    __atomic_add_fetch( &app_startup_open, 1, __ATOMIC_RELAXED );
+    __atomic_store_n( &app_startup_begin_ns[phase], app_time_now_ns(), __ATOMIC_RELEASE );
+}
+
+/******************************************************************************
+ * Function Name: app_startup_end()
+ ******************************************************************************
+ * Summary:
+ *   Close a phase
+ *
+ * Return:
+ *  APP_STARTUP_COMPLETE for exactly one call, the one that completes the
+ *  timeline; the caller prints the summary. APP_STARTUP_SUCCESS otherwise.
+ *
+ *****************************************************************************/
+int app_startup_end( app_startup_phase_t phase )
+{
+    uint64_t now_ns = app_time_now_ns();
+    uint32_t expected = 0;
+
+    if ( ( phase >= APP_STARTUP_PHASES ) || ( __atomic_load_n( &app_startup_begin_ns[phase], __ATOMIC_ACQUIRE ) == 0 ) ||
+         ( __atomic_load_n( &app_startup_end_ns[phase], __ATOMIC_RELAXED ) != 0 ) )
+    {
+        return APP_STARTUP_SUCCESS;
+    }
+    __atomic_store_n( &app_startup_end_ns[phase], now_ns, __ATOMIC_RELEASE );
+
+    if ( ( __atomic_sub_fetch( &app_startup_open, 1, __ATOMIC_ACQ_REL ) != 0 ) ||
+         ( __atomic_load_n( &app_startup_end_ns[APP_STARTUP_APP_INIT], __ATOMIC_ACQUIRE ) == 0 ) ||
+         !__atomic_compare_exchange_n( &app_startup_completed, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) )
+    {
+        return APP_STARTUP_SUCCESS;
+    }
+    __atomic_store_n( &app_startup_total_ns, now_ns - app_startup_origin_ns, __ATOMIC_RELEASE );
+    return APP_STARTUP_COMPLETE;
+}
+
+/******************************************************************************
+ * Function Name: app_startup_format()
+ ******************************************************************************
+ * Summary:
+ *   Format the timeline, one line per recorded phase with its start and
+ *   duration in ms from the exec
+ *
+ * Parameters:
+ *   char *p_buf        : output, APP_STARTUP_SUMMARY_MAX is enough
+ *   size_t size        : size of p_buf
+ *
+ * Return:
+ *  length written, without the terminating NUL
+ *
+ *****************************************************************************/
+size_t app_startup_format( char *p_buf, size_t size )
+{
+    uint64_t begin_ns, end_ns, total_ns;
+    size_t len;
+    int n, i;
+
+    n = snprintf( p_buf, size, "Startup timeline (ms from exec):\n  %-18s %10s %10s\n", "phase", "start", "duration" );
+    len = ( n > 0 ) ? (size_t)n : 0;
+    for ( i = 0; ( i < APP_STARTUP_PHASES ) && ( len < size ); i++ )
+    {
+        begin_ns = __atomic_load_n( &app_startup_begin_ns[i], __ATOMIC_ACQUIRE );
+        end_ns = __atomic_load_n( &app_startup_end_ns[i], __ATOMIC_ACQUIRE );
+        if ( begin_ns == 0 )
+        {
+            continue;
+        }
+        if ( end_ns == 0 )
+        {
+            n = snprintf( p_buf + len, size - len, "  %-18s %10.1f %10s\n", app_startup_names[i],
+                          (double)( begin_ns - app_startup_origin_ns ) / APP_STARTUP_NS_PER_MS, "open" );
+        }
+        else
+        {
+            n = snprintf( p_buf + len, size - len, "  %-18s %10.1f %10.1f\n", app_startup_names[i],
+                          (double)( begin_ns - app_startup_origin_ns ) / APP_STARTUP_NS_PER_MS,
+                          (double)( end_ns - begin_ns ) / APP_STARTUP_NS_PER_MS );
+        }
+        len += ( n > 0 ) ? (size_t)n : 0;
+    }
+    total_ns = __atomic_load_n( &app_startup_total_ns, __ATOMIC_ACQUIRE );
+    if ( ( total_ns != 0 ) && ( len < size ) )
+    {
+        n = snprintf( p_buf + len, size - len, "  %-18s %10s %10.1f\n", "ready", "", (double)total_ns / APP_STARTUP_NS_PER_MS );
+        len += ( n > 0 ) ? (size_t)n : 0;
+    }
+    return ( len < size ) ? len : size - 1;
+}
+
+/******************************************************************************
+ * Function Name: app_startup_metrics_collector()
+ ******************************************************************************
+ * Summary:
+ *   Export the timeline with the application metrics; register it with
+ *   app_metrics_register_collector()
+ *
+ *****************************************************************************/
+void app_startup_metrics_collector( app_metrics_buf_t *p_out )
+{
+    uint64_t begin_ns[APP_STARTUP_PHASES], end_ns[APP_STARTUP_PHASES];
+    uint64_t total_ns = __atomic_load_n( &app_startup_total_ns, __ATOMIC_ACQUIRE );
+    int i;
+
+    for ( i = 0; i < APP_STARTUP_PHASES; i++ )
+    {
+        begin_ns[i] = __atomic_load_n( &app_startup_begin_ns[i], __ATOMIC_ACQUIRE );
+        end_ns[i] = __atomic_load_n( &app_startup_end_ns[i], __ATOMIC_ACQUIRE );
+    }
+
+    app_metrics_printf( p_out, "# HELP wakeonle_startup_phase_start_seconds Phase start after exec\n"
+                               "# TYPE wakeonle_startup_phase_start_seconds gauge\n" );
+    for ( i = 0; i < APP_STARTUP_PHASES; i++ )
+    {
+        if ( begin_ns[i] != 0 )
+        {
+            app_metrics_printf( p_out, "wakeonle_startup_phase_start_seconds{phase=\"%s\"} %.6f\n", app_startup_names[i],
+                                (double)( begin_ns[i] - app_startup_origin_ns ) / APP_TIME_NS_PER_SEC );
+        }
+    }
+    app_metrics_printf( p_out, "# HELP wakeonle_startup_phase_duration_seconds Phase duration, for ended phases\n"
+                               "# TYPE wakeonle_startup_phase_duration_seconds gauge\n" );
+    for ( i = 0; i < APP_STARTUP_PHASES; i++ )
+    {
+        if ( ( begin_ns[i] != 0 ) && ( end_ns[i] != 0 ) )
+        {
+            app_metrics_printf( p_out, "wakeonle_startup_phase_duration_seconds{phase=\"%s\"} %.6f\n", app_startup_names[i],
+                                (double)( end_ns[i] - begin_ns[i] ) / APP_TIME_NS_PER_SEC );
+        }
+    }
+    if ( total_ns != 0 )
+    {
+        app_metrics_printf( p_out, "# HELP wakeonle_startup_seconds Exec to ready\n"
+                                   "# TYPE wakeonle_startup_seconds gauge\n"
+                                   "wakeonle_startup_seconds %.6f\n", (double)total_ns / APP_TIME_NS_PER_SEC );
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,102 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_startup.h
+ *
+ * Description: This is the header file for the startup timeline. Each
+ *              startup phase is a span with a begin and an end timestamp
+ *              on the app_time clock, relative to the exec of the process.
+ *              Spans may nest (the stack init runs inside the platform
+ *              init) and may be opened and closed on different threads.
+ *              The timeline is complete when the application init phase
+ *              has ended and no phase is open.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_STARTUP_H__
+#define __APP_STARTUP_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+#include "app_metrics.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_STARTUP_SUCCESS                 ( 0 )
+/* app_startup_end() closed the last open phase of a finished startup */
+#define APP_STARTUP_COMPLETE                ( 1 )
+
+#define APP_STARTUP_SUMMARY_MAX             ( 1024U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef enum
+{
+    APP_STARTUP_EXEC = 0,               /* exec to main(), from /proc */
+    APP_STARTUP_ARGS,                   /* option and argument parsing */
+    APP_STARTUP_PLATFORM_INIT,          /* cy_platform_bluetooth_init() */
+    APP_STARTUP_UART_OPEN,              /* marked by the porting layer */
+    APP_STARTUP_PATCH_DOWNLOAD,         /* marked by the porting layer */
+    APP_STARTUP_BAUD_SWITCH,            /* marked by the porting layer */
+    APP_STARTUP_STACK_INIT,             /* wiced_bt_stack_init() */
+    APP_STARTUP_BT_ENABLED,             /* stack init to BTM_ENABLED_EVT */
+    APP_STARTUP_HEAP_CREATE,            /* default heap creation */
+    APP_STARTUP_APP_INIT,               /* app_init() in BTM_ENABLED_EVT */
+    APP_STARTUP_CONTROLLER_RESET,       /* wait_controller_reset_ready() */
+    APP_STARTUP_PHASES
+} app_startup_phase_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void app_startup_init( void );
+
+void app_startup_begin( app_startup_phase_t phase );
+
+int app_startup_end( app_startup_phase_t phase );
+
+size_t app_startup_format( char *p_buf, size_t size );
+
+void app_startup_metrics_collector( app_metrics_buf_t *p_out );
+
+#endif /* __APP_STARTUP_H__ */
+
+/* [] END OF FILE */
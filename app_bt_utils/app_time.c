@@ -0,0 +1,237 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_time.c
+ *
+ * Description: This is the source file for the application time base. The
+ *              counter frequency is calibrated against CLOCK_MONOTONIC at
+ *              init (or read from CNTFRQ_EL0) and refined by
+ *              app_time_resync(), which also re-anchors the conversion so
+ *              NTP slewing of CLOCK_MONOTONIC does not accumulate.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <pthread.h>
+#include "app_time.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_TIME_CALIBRATE_NS               ( 10000000L )
+#define APP_TIME_RESYNC_NS                  ( 1000000000ULL )
+#define APP_TIME_PAIR_TRIES                 ( 5 )
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+/* identity until app_time_init() */
+app_time_base_t         app_time_base = { 0, 0, 1ULL << APP_TIME_MULT_SHIFT, 0, 0 };
+static pthread_mutex_t  app_time_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_time_pair()
+ ******************************************************************************
+ * Summary:
+ *   Read the counter and CLOCK_MONOTONIC as close together as possible: the
+ *   counter read is bracketed by two clock reads, the tightest of a few
+ *   tries wins and the clock value is taken at its midpoint
+ *
+ *****************************************************************************/
+static void app_time_pair( uint64_t *p_ticks, uint64_t *p_ns )
+{
+    uint64_t a, b, t, best = UINT64_MAX;
+    int i;
+
+    for ( i = 0; i < APP_TIME_PAIR_TRIES; i++ )
+    {
+        a = app_time_now_ns();
+        t = app_time_ticks();
+        b = app_time_now_ns();
+        if ( b - a < best )
+        {
+            best = b - a;
+            *p_ticks = t;
+            *p_ns = a + ( b - a ) / 2;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_time_counter_usable()
+ ******************************************************************************
+ * Summary:
+ *   x86 needs an invariant TSC (CPUID 0x80000007 EDX bit 8) to be used as a
+ *   clock; the AArch64 generic timer always qualifies
+ *
+ *****************************************************************************/
+static int app_time_counter_usable( void )
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+
+    if ( !__get_cpuid( 0x80000007, &eax, &ebx, &ecx, &edx ) )
+    {
+        return 0;
+    }
+    return ( edx & ( 1U << 8 ) ) != 0;
+#elif defined(__aarch64__)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/******************************************************************************
+ * Function Name: app_time_init()
+ ******************************************************************************
+ * Summary:
+ *   Select the tick source and calibrate it. Call once at startup, before
+ *   other threads take ticks; blocks for about 10 ms on x86.
+ *
+ *****************************************************************************/
+void app_time_init( void )
+{
+    uint64_t t0, n0, t1, n1, mult;
+#if !defined(__aarch64__)
+    struct timespec wait = { 0, APP_TIME_CALIBRATE_NS };
+#endif
+
+    if ( app_time_base.counter || !app_time_counter_usable() )
+    {
+        return;
+    }
+
+    app_time_base.counter = 1;
+    app_time_pair( &t0, &n0 );
+#if defined(__aarch64__)
+    {
+        uint64_t freq;
+
+        __asm__ __volatile__( "mrs %0, cntfrq_el0" : "=r"( freq ) );
+        mult = (uint64_t)( ( (unsigned __int128)APP_TIME_NS_PER_SEC << APP_TIME_MULT_SHIFT ) / freq );
+        (void)t1;
+        (void)n1;
+    }
+#else
+    nanosleep( &wait, NULL );
+    app_time_pair( &t1, &n1 );
+    if ( t1 <= t0 )
+    {
+        app_time_base.counter = 0;
+        return;
+    }
+    mult = (uint64_t)( ( (unsigned __int128)( n1 - n0 ) << APP_TIME_MULT_SHIFT ) / ( t1 - t0 ) );
+    t0 = t1;
+    n0 = n1;
+#endif
+    app_time_base.mult = mult;
+    app_time_base.base_ticks = t0;
+    app_time_base.base_ns = n0;
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+}
+
+/******************************************************************************
+ * Function Name: app_time_resync()
+ ******************************************************************************
+ * Summary:
+ *   Refine the frequency over the time since the last anchor and move the
+ *   anchor to now. Cheap when called early: does nothing until a second has
+ *   passed. Any thread may call it; concurrent calls are skipped.
+ *
+ *****************************************************************************/
+void app_time_resync( void )
+{
+    uint64_t ticks, ns, mult;
+
+    if ( !app_time_base.counter )
+    {
+        return;
+    }
+    if ( app_time_now_ns() - app_time_base.base_ns < APP_TIME_RESYNC_NS )
+    {
+        return;
+    }
+    if ( pthread_mutex_trylock( &app_time_lock ) != 0 )
+    {
+        return;
+    }
+
+    app_time_pair( &ticks, &ns );
+    if ( ( ticks > app_time_base.base_ticks ) && ( ns > app_time_base.base_ns ) )
+    {
+        mult = (uint64_t)( ( (unsigned __int128)( ns - app_time_base.base_ns ) << APP_TIME_MULT_SHIFT ) /
+                           ( ticks - app_time_base.base_ticks ) );
+        __atomic_store_n( &app_time_base.seq, app_time_base.seq + 1, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_RELEASE );
+        app_time_base.mult = mult;
+        app_time_base.base_ticks = ticks;
+        app_time_base.base_ns = ns;
+        __atomic_store_n( &app_time_base.seq, app_time_base.seq + 1, __ATOMIC_RELEASE );
+    }
+    pthread_mutex_unlock( &app_time_lock );
+}
+
+/******************************************************************************
+ * Function Name: app_time_source()
+ ******************************************************************************
+ * Summary:
+ *   Name of the tick source, for logs
+ *
+ *****************************************************************************/
+const char *app_time_source( void )
+{
+    if ( !app_time_base.counter )
+    {
+        return "clock_gettime";
+    }
+#if defined(__aarch64__)
+    return "cntvct";
+#else
+    return "tsc";
+#endif
+}
+
+/* [] END OF FILE */
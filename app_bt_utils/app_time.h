@@ -0,0 +1,157 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_time.h
+ *
+ * Description: This is the header file for the application time base.
+ *
+ *              app_time_now_ns() is CLOCK_MONOTONIC through the vDSO, for
+ *              timestamps that leave the process. app_time_ticks() reads
+ *              the CPU counter (invariant TSC on x86, CNTVCT_EL0 on AArch64)
+ *              and costs a few nanoseconds; hot paths store ticks and
+ *              convert them to CLOCK_MONOTONIC nanoseconds later with
+ *              app_time_ticks_to_ns(). Without a usable counter ticks are
+ *              CLOCK_MONOTONIC nanoseconds and the conversion is identity.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_TIME_H__
+#define __APP_TIME_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <time.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_TIME_NS_PER_SEC                 ( 1000000000ULL )
+/* fixed point of the tick to ns factor */
+#define APP_TIME_MULT_SHIFT                 ( 32 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* ns = base_ns + ( ( ticks - base_ticks ) * mult >> APP_TIME_MULT_SHIFT ),
+ * seq is odd while app_time_resync() updates the other fields */
+typedef struct
+{
+    uint32_t    seq;
+    uint32_t    counter;        /* 1 if ticks come from the CPU counter */
+    uint64_t    mult;
+    uint64_t    base_ticks;
+    uint64_t    base_ns;
+} app_time_base_t;
+
+/******************************************************************************
+ *                                EXTERNS
+ *****************************************************************************/
+extern app_time_base_t app_time_base;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void app_time_init( void );
+
+void app_time_resync( void );
+
+const char *app_time_source( void );
+
+/*******************************************************************************
+* Function Name: app_time_now_ns
+********************************************************************************
+* Summary:
+*   CLOCK_MONOTONIC in nanoseconds, served by the vDSO without a system call
+*
+*******************************************************************************/
+static inline uint64_t app_time_now_ns( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * APP_TIME_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+* Function Name: app_time_ticks
+********************************************************************************
+* Summary:
+*   Raw counter value, monotonic and comparable across threads
+*
+*******************************************************************************/
+static inline uint64_t app_time_ticks( void )
+{
+    if ( __builtin_expect( app_time_base.counter != 0, 1 ) )
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+        uint64_t v;
+
+        __asm__ __volatile__( "isb\n\tmrs %0, cntvct_el0" : "=r"( v ) :: "memory" );
+        return v;
+#endif
+    }
+    return app_time_now_ns();
+}
+
+/*******************************************************************************
+* Function Name: app_time_ticks_to_ns
+********************************************************************************
+* Summary:
+*   Convert a tick value to CLOCK_MONOTONIC nanoseconds
+*
+*******************************************************************************/
+static inline uint64_t app_time_ticks_to_ns( uint64_t ticks )
+{
+    uint32_t seq;
+    uint64_t ns;
+
+    do
+    {
+        seq = __atomic_load_n( &app_time_base.seq, __ATOMIC_ACQUIRE );
+        ns = app_time_base.base_ns +
+             (uint64_t)( ( (__int128)(int64_t)( ticks - app_time_base.base_ticks ) * app_time_base.mult ) >> APP_TIME_MULT_SHIFT );
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    } while ( ( seq & 1U ) || ( seq != __atomic_load_n( &app_time_base.seq, __ATOMIC_RELAXED ) ) );
+    return ns;
+}
+
+#endif /* __APP_TIME_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,856 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_trace.c
+ *
+ * Description: This is the source file for the asynchronous trace logger.
+ *
+ *              Record layout: call site pointer, app_time_ticks() stamp
+ *              (converted to CLOCK_MONOTONIC by the formatter), then the
+ *              arguments in order; int as 4 bytes, long, long long, double
+ *              and pointers as 8 bytes, strings as a length byte and the
+ *              characters. Strings share what the numbers leave of the
+ *              record and are truncated to fit.
+ *
+ *              Before app_trace_start(), after app_trace_stop(), and on a
+ *              thread that could not get a ring, records are formatted
+ *              and written on the calling thread instead.
+ *
+ *              A thread's ring is retired when the thread exits. The
+ *              formatter drains it and frees the slot, and the next new
+ *              thread takes the slot and its ring over, so threads that
+ *              come and go (one per arm) do not use up slots or memory.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+#include "app_spsc_ring.h"
+#include "app_time.h"
+#include "app_trace.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_TRACE_DATA_SIZE         ( APP_TRACE_RECORD_SIZE - sizeof( void * ) - sizeof( uint64_t ) )
+#define APP_TRACE_SPEC_MAX          ( 32 )
+#define APP_TRACE_LINE_MAX          ( 1024 )
+#define APP_TRACE_OUT_SIZE          ( 64 * 1024 )
+/* formatter poll interval, doubles while idle up to the max */
+#define APP_TRACE_POLL_MIN_NS       ( 1000000L )
+#define APP_TRACE_POLL_MAX_NS       ( 16000000L )
+/* app_trace_flush() gives up after this, the formatter may be stuck on stdout */
+#define APP_TRACE_FLUSH_WAIT_NS     ( 100000000ULL )
+
+/* app_trace_thread_t state: live -> retired (owner exited) -> free (drained) -> live */
+#define APP_TRACE_THREAD_LIVE       ( 0 )
+#define APP_TRACE_THREAD_RETIRED    ( 1 )
+#define APP_TRACE_THREAD_FREE       ( 2 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    const app_trace_site_t  *p_site;
+    uint64_t                ts;         /* app_time_ticks(), converted when formatted */
+    uint8_t                 data[APP_TRACE_DATA_SIZE];
+} app_trace_rec_t;
+
+/* one conversion of a format string */
+typedef struct
+{
+    uint8_t     type;       /* app_trace_arg_t, 0 for %% or unsupported */
+    uint8_t     stars;      /* '*' width / precision arguments before it */
+    uint8_t     len;        /* characters from the '%' */
+} app_trace_spec_t;
+
+typedef struct
+{
+    app_spsc_ring_t     ring;
+    uint64_t            dropped;            /* written by the owning thread */
+    uint64_t            dropped_reported;   /* formatter only */
+    uint64_t            written;            /* ring position already on stdout */
+    uint32_t            state;              /* APP_TRACE_THREAD_* */
+} app_trace_thread_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+int                                 app_trace_level = APP_TRACE_LEVEL_DEBUG;
+static __thread app_trace_thread_t  *p_trace_self = NULL;
+static __thread uint32_t            trace_self_failed = 0;
+static app_trace_thread_t           *trace_threads[APP_TRACE_THREADS_MAX];
+static uint32_t                     trace_num_threads = 0;
+static pthread_mutex_t              trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t               trace_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t                trace_key;
+static uint32_t                     trace_key_valid = 0;
+static pthread_t                    trace_formatter;
+static uint32_t                     trace_running = 0;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: app_trace_parse_spec()
+ ******************************************************************************
+ * Summary:
+ *   Parse one printf conversion
+ *
+ * Parameters:
+ *   const char *p            : points at the '%'
+ *   app_trace_spec_t *p_spec : output
+ *
+ * Return:
+ *  pointer past the conversion
+ *
+ *****************************************************************************/
+static const char *app_trace_parse_spec( const char *p, app_trace_spec_t *p_spec )
+{
+    const char *p_start = p++;
+    int longs = 0;
+
+    p_spec->type = 0;
+    p_spec->stars = 0;
+    if ( *p == '%' )
+    {
+        p_spec->len = 2;
+        return p + 1;
+    }
+
+    while ( ( *p != '\0' ) && ( strchr( "-+ #0", *p ) != NULL ) )
+    {
+        p++;
+    }
+    if ( *p == '*' )
+    {
+        p_spec->stars++;
+        p++;
+    }
+    while ( ( *p >= '0' ) && ( *p <= '9' ) )
+    {
+        p++;
+    }
+    if ( *p == '.' )
+    {
+        p++;
+        if ( *p == '*' )
+        {
+            p_spec->stars++;
+            p++;
+        }
+        while ( ( *p >= '0' ) && ( *p <= '9' ) )
+        {
+            p++;
+        }
+    }
+    for ( ; ( *p != '\0' ) && ( strchr( "hlLqjzt", *p ) != NULL ); p++ )
+    {
+        if ( ( *p == 'l' ) || ( *p == 'q' ) )
+        {
+            longs++;
+        }
+        else if ( ( *p == 'j' ) || ( *p == 'z' ) || ( *p == 't' ) )
+        {
+            longs = ( sizeof( long ) == sizeof( long long ) ) ? 1 : 2;
+        }
+    }
+
+    switch ( *p )
+    {
+        case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+            p_spec->type = ( longs == 0 ) ? APP_TRACE_ARG_INT : ( longs == 1 ) ? APP_TRACE_ARG_LONG : APP_TRACE_ARG_LLONG;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            p_spec->type = APP_TRACE_ARG_DOUBLE;
+            break;
+        case 's':
+            p_spec->type = APP_TRACE_ARG_STR;
+            break;
+        case 'p':
+            p_spec->type = APP_TRACE_ARG_PTR;
+            break;
+        default:
+            /* %n, long double and anything unknown are printed verbatim */
+            p_spec->stars = 0;
+            break;
+    }
+    if ( *p != '\0' )
+    {
+        p++;
+    }
+    p_spec->len = (uint8_t)( ( p - p_start ) < APP_TRACE_SPEC_MAX ? ( p - p_start ) : APP_TRACE_SPEC_MAX - 1 );
+    return p;
+}
+
+static uint32_t app_trace_arg_size( uint8_t type )
+{
+    switch ( type )
+    {
+        case APP_TRACE_ARG_INT: return sizeof( int32_t );
+        case APP_TRACE_ARG_STR: return 1;
+        default:                return sizeof( uint64_t );
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_trace_parse_site()
+ ******************************************************************************
+ * Summary:
+ *   Learn the argument types of a call site. Conversions that would not fit
+ *   in a record are not captured and get printed verbatim. Two threads may
+ *   race here on the first call; both write the same values.
+ *
+ *****************************************************************************/
+static void app_trace_parse_site( app_trace_site_t *p_site )
+{
+    app_trace_spec_t spec;
+    const char *p = p_site->p_fmt;
+    uint32_t nargs = 0, fixed = 0, i, need;
+
+    while ( ( p = strchr( p, '%' ) ) != NULL )
+    {
+        p = app_trace_parse_spec( p, &spec );
+        if ( spec.type == 0 )
+        {
+            continue;
+        }
+        need = spec.stars * sizeof( int32_t ) + app_trace_arg_size( spec.type );
+        if ( ( nargs + spec.stars + 1 > APP_TRACE_ARGS_MAX ) || ( fixed + need > APP_TRACE_DATA_SIZE ) )
+        {
+            break;
+        }
+        for ( i = 0; i < spec.stars; i++ )
+        {
+            p_site->args[nargs++] = APP_TRACE_ARG_INT;
+        }
+        p_site->args[nargs++] = spec.type;
+        fixed += need;
+    }
+    p_site->nargs = (uint8_t)nargs;
+    p_site->fixed_len = (uint8_t)fixed;
+    __atomic_store_n( &p_site->parsed, 1, __ATOMIC_RELEASE );
+}
+
+/******************************************************************************
+ * Function Name: app_trace_pack()
+ ******************************************************************************
+ * Summary:
+ *   Copy the raw argument values into a record
+ *
+ *****************************************************************************/
+static void app_trace_pack( app_trace_rec_t *p_rec, const app_trace_site_t *p_site, va_list ap )
+{
+    uint8_t *p = p_rec->data;
+    uint32_t str_room = APP_TRACE_DATA_SIZE - p_site->fixed_len;
+    uint32_t i, n;
+    int32_t v32;
+    uint64_t v64;
+    double d;
+    const char *p_str;
+
+    p_rec->p_site = p_site;
+    p_rec->ts = app_time_ticks();
+    for ( i = 0; i < p_site->nargs; i++ )
+    {
+        switch ( p_site->args[i] )
+        {
+            case APP_TRACE_ARG_INT:
+                v32 = va_arg( ap, int );
+                memcpy( p, &v32, sizeof( v32 ) );
+                p += sizeof( v32 );
+                break;
+            case APP_TRACE_ARG_LONG:
+                v64 = (uint64_t)va_arg( ap, long );
+                memcpy( p, &v64, sizeof( v64 ) );
+                p += sizeof( v64 );
+                break;
+            case APP_TRACE_ARG_LLONG:
+                v64 = (uint64_t)va_arg( ap, long long );
+                memcpy( p, &v64, sizeof( v64 ) );
+                p += sizeof( v64 );
+                break;
+            case APP_TRACE_ARG_DOUBLE:
+                d = va_arg( ap, double );
+                memcpy( p, &d, sizeof( d ) );
+                p += sizeof( d );
+                break;
+            case APP_TRACE_ARG_PTR:
+                v64 = (uint64_t)(uintptr_t)va_arg( ap, void * );
+                memcpy( p, &v64, sizeof( v64 ) );
+                p += sizeof( v64 );
+                break;
+            case APP_TRACE_ARG_STR:
+                p_str = va_arg( ap, const char * );
+                if ( p_str == NULL )
+                {
+                    p_str = "(null)";
+                }
+                n = (uint32_t)strnlen( p_str, str_room > 255 ? 255 : str_room );
+                *p++ = (uint8_t)n;
+                memcpy( p, p_str, n );
+                p += n;
+                str_room -= n;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: app_trace_format()
+ ******************************************************************************
+ * Summary:
+ *   Format a record the way the printf based TRACE_* macros did, one
+ *   conversion at a time.
+ *
+ * Return:
+ *  number of characters written, at most size - 1
+ *
+ *****************************************************************************/
+static size_t app_trace_format( const app_trace_rec_t *p_rec, char *p_out, size_t size )
+{
+    const app_trace_site_t *p_site = p_rec->p_site;
+    const uint8_t *p_arg = p_rec->data;
+    const char *p = p_site->p_fmt;
+    const char *p_pct;
+    app_trace_spec_t spec;
+    char fmt[APP_TRACE_SPEC_MAX];
+    char str[256];
+    int32_t stars[2];
+    uint32_t argi = 0, s;
+    size_t len = 0;
+    int n;
+    int32_t v32;
+    uint64_t v64, ts_ns;
+    double d;
+
+#define APP_TRACE_PUT( ... )                                                        \
+    do                                                                              \
+    {                                                                               \
+        n = snprintf( p_out + len, size - len, __VA_ARGS__ );                       \
+        len = ( n < 0 ) ? len : ( ( len + (size_t)n < size ) ? len + (size_t)n : size - 1 ); \
+    } while ( 0 )
+
+    if ( p_site->kind != APP_TRACE_KIND_MSG )
+    {
+        ts_ns = app_time_ticks_to_ns( p_rec->ts );
+        APP_TRACE_PUT( "[%llu.%09llu]", (unsigned long long)( ts_ns / APP_TIME_NS_PER_SEC ),
+                       (unsigned long long)( ts_ns % APP_TIME_NS_PER_SEC ) );
+    }
+    if ( p_site->kind == APP_TRACE_KIND_LOG )
+    {
+        APP_TRACE_PUT( "%s[%s]:", p_site->p_tag, p_site->p_func );
+    }
+    else if ( p_site->kind == APP_TRACE_KIND_ERR )
+    {
+        APP_TRACE_PUT( "%s[ERROR][%s]:", p_site->p_tag, p_site->p_func );
+    }
+
+    while ( ( p_pct = strchr( p, '%' ) ) != NULL )
+    {
+        APP_TRACE_PUT( "%.*s", (int)( p_pct - p ), p );
+        p = app_trace_parse_spec( p_pct, &spec );
+        if ( p_pct[1] == '%' )
+        {
+            APP_TRACE_PUT( "%%" );
+            continue;
+        }
+        if ( ( spec.type == 0 ) || ( argi + spec.stars >= p_site->nargs ) )
+        {
+            /* not captured, print the conversion itself */
+            APP_TRACE_PUT( "%.*s", (int)( p - p_pct ), p_pct );
+            continue;
+        }
+
+        for ( s = 0; s < spec.stars; s++, argi++ )
+        {
+            memcpy( &stars[s], p_arg, sizeof( int32_t ) );
+            p_arg += sizeof( int32_t );
+        }
+        memcpy( fmt, p_pct, spec.len );
+        fmt[spec.len] = '\0';
+
+#define APP_TRACE_PUT_ARG( v )                                                      \
+        do                                                                          \
+        {                                                                           \
+            if ( spec.stars == 0 )      APP_TRACE_PUT( fmt, v );                    \
+            else if ( spec.stars == 1 ) APP_TRACE_PUT( fmt, stars[0], v );          \
+            else                        APP_TRACE_PUT( fmt, stars[0], stars[1], v ); \
+        } while ( 0 )
+
+        switch ( p_site->args[argi++] )
+        {
+            case APP_TRACE_ARG_INT:
+                memcpy( &v32, p_arg, sizeof( v32 ) );
+                p_arg += sizeof( v32 );
+                APP_TRACE_PUT_ARG( v32 );
+                break;
+            case APP_TRACE_ARG_LONG:
+                memcpy( &v64, p_arg, sizeof( v64 ) );
+                p_arg += sizeof( v64 );
+                APP_TRACE_PUT_ARG( (long)v64 );
+                break;
+            case APP_TRACE_ARG_LLONG:
+                memcpy( &v64, p_arg, sizeof( v64 ) );
+                p_arg += sizeof( v64 );
+                APP_TRACE_PUT_ARG( (long long)v64 );
+                break;
+            case APP_TRACE_ARG_DOUBLE:
+                memcpy( &d, p_arg, sizeof( d ) );
+                p_arg += sizeof( d );
+                APP_TRACE_PUT_ARG( d );
+                break;
+            case APP_TRACE_ARG_PTR:
+                memcpy( &v64, p_arg, sizeof( v64 ) );
+                p_arg += sizeof( v64 );
+                APP_TRACE_PUT_ARG( (void *)(uintptr_t)v64 );
+                break;
+            case APP_TRACE_ARG_STR:
+                memcpy( str, p_arg + 1, p_arg[0] );
+                str[p_arg[0]] = '\0';
+                p_arg += 1 + p_arg[0];
+                APP_TRACE_PUT_ARG( str );
+                break;
+            default:
+                break;
+        }
+#undef APP_TRACE_PUT_ARG
+    }
+    APP_TRACE_PUT( "%s\n", p );
+#undef APP_TRACE_PUT
+    return len;
+}
+
+/******************************************************************************
+ * Function Name: app_trace_retire()
+ ******************************************************************************
+ * Summary:
+ *   Thread exit destructor: hand the ring to the formatter, which frees the
+ *   slot once it is drained. Trace calls from later destructors of the
+ *   thread are written synchronously.
+ *
+ *****************************************************************************/
+static void app_trace_retire( void *p_arg )
+{
+    app_trace_thread_t *p_thread = (app_trace_thread_t *)p_arg;
+
+    p_trace_self = NULL;
+    trace_self_failed = 1;
+    __atomic_store_n( &p_thread->state, APP_TRACE_THREAD_RETIRED, __ATOMIC_RELEASE );
+}
+
+static void app_trace_key_create( void )
+{
+    /* without the key rings are never retired and slots run out */
+    trace_key_valid = ( pthread_key_create( &trace_key, app_trace_retire ) == 0 );
+}
+
+/******************************************************************************
+ * Function Name: app_trace_self()
+ ******************************************************************************
+ * Summary:
+ *   Ring of the calling thread, taken on its first trace call: the ring of
+ *   an exited thread once the formatter drained it, else a new one
+ *
+ *****************************************************************************/
+static app_trace_thread_t *app_trace_self( void )
+{
+    app_trace_thread_t *p_thread = NULL;
+    void *p_mem;
+    uint32_t i;
+
+    if ( ( p_trace_self != NULL ) || trace_self_failed )
+    {
+        return p_trace_self;
+    }
+
+    pthread_once( &trace_key_once, app_trace_key_create );
+    pthread_mutex_lock( &trace_lock );
+    for ( i = 0; i < trace_num_threads; i++ )
+    {
+        if ( __atomic_load_n( &trace_threads[i]->state, __ATOMIC_ACQUIRE ) == APP_TRACE_THREAD_FREE )
+        {
+            /* the ring carries on where the exited thread left it */
+            p_thread = trace_threads[i];
+            __atomic_store_n( &p_thread->state, APP_TRACE_THREAD_LIVE, __ATOMIC_RELAXED );
+            break;
+        }
+    }
+    if ( ( p_thread == NULL ) && ( trace_num_threads < APP_TRACE_THREADS_MAX ) &&
+         ( posix_memalign( &p_mem, APP_SPSC_CACHE_LINE, sizeof( app_trace_thread_t ) ) == 0 ) )
+    {
+        p_thread = (app_trace_thread_t *)p_mem;
+        memset( p_thread, 0, sizeof( *p_thread ) );
+        if ( app_spsc_ring_init( &p_thread->ring, sizeof( app_trace_rec_t ), APP_TRACE_RING_DEPTH ) == APP_SPSC_RING_SUCCESS )
+        {
+            trace_threads[trace_num_threads] = p_thread;
+            __atomic_store_n( &trace_num_threads, trace_num_threads + 1, __ATOMIC_RELEASE );
+        }
+        else
+        {
+            free( p_thread );
+            p_thread = NULL;
+        }
+    }
+    if ( p_thread != NULL )
+    {
+        p_trace_self = p_thread;
+        if ( trace_key_valid )
+        {
+            pthread_setspecific( trace_key, p_thread );
+        }
+    }
+    trace_self_failed = ( p_trace_self == NULL );
+    pthread_mutex_unlock( &trace_lock );
+    return p_trace_self;
+}
+
+/******************************************************************************
+ * Function Name: app_trace_write()
+ ******************************************************************************
+ * Summary:
+ *   Queue one trace record, called through the TRACE_* macros. Drops the
+ *   record and counts it if the thread's ring is full.
+ *
+ * Parameters:
+ *   app_trace_site_t *p_site : call site
+ *   ...                      : format arguments
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void app_trace_write( app_trace_site_t *p_site, ... )
+{
+    app_trace_thread_t *p_thread = NULL;
+    app_trace_rec_t *p_rec;
+    app_trace_rec_t local;
+    char line[APP_TRACE_LINE_MAX];
+    size_t len;
+    va_list ap;
+
+    if ( !__atomic_load_n( &p_site->parsed, __ATOMIC_ACQUIRE ) )
+    {
+        app_trace_parse_site( p_site );
+    }
+
+    if ( __atomic_load_n( &trace_running, __ATOMIC_ACQUIRE ) )
+    {
+        p_thread = app_trace_self();
+    }
+    if ( p_thread == NULL )
+    {
+        va_start( ap, p_site );
+        app_trace_pack( &local, p_site, ap );
+        va_end( ap );
+        len = app_trace_format( &local, line, sizeof( line ) );
+        fwrite( line, 1, len, stdout );
+        return;
+    }
+
+    p_rec = app_spsc_ring_reserve( &p_thread->ring );
+    if ( p_rec == NULL )
+    {
+        __atomic_store_n( &p_thread->dropped, p_thread->dropped + 1, __ATOMIC_RELAXED );
+        return;
+    }
+    va_start( ap, p_site );
+    app_trace_pack( p_rec, p_site, ap );
+    va_end( ap );
+    app_spsc_ring_commit( &p_thread->ring );
+}
+
+/******************************************************************************
+ * Function Name: app_trace_drain()
+ ******************************************************************************
+ * Summary:
+ *   Format everything queued, oldest record first across all threads
+ *
+ * Return:
+ *  number of records written
+ *
+ *****************************************************************************/
+static uint32_t app_trace_drain( char *p_out )
+{
+    uint32_t nthreads = __atomic_load_n( &trace_num_threads, __ATOMIC_ACQUIRE );
+    const app_trace_rec_t *p_rec, *p_oldest;
+    app_trace_thread_t *p_from;
+    uint64_t dropped;
+    uint32_t i, count = 0;
+    size_t len = 0;
+
+    for ( ;; )
+    {
+        p_oldest = NULL;
+        p_from = NULL;
+        for ( i = 0; i < nthreads; i++ )
+        {
+            p_rec = app_spsc_ring_peek( &trace_threads[i]->ring );
+            if ( ( p_rec != NULL ) && ( ( p_oldest == NULL ) || ( p_rec->ts < p_oldest->ts ) ) )
+            {
+                p_oldest = p_rec;
+                p_from = trace_threads[i];
+            }
+        }
+        if ( p_oldest == NULL )
+        {
+            break;
+        }
+        if ( len + APP_TRACE_LINE_MAX > APP_TRACE_OUT_SIZE )
+        {
+            fwrite( p_out, 1, len, stdout );
+            len = 0;
+        }
+        len += app_trace_format( p_oldest, p_out + len, APP_TRACE_LINE_MAX );
+        app_spsc_ring_release( &p_from->ring );
+        count++;
+    }
+
+    for ( i = 0; i < nthreads; i++ )
+    {
+        dropped = __atomic_load_n( &trace_threads[i]->dropped, __ATOMIC_RELAXED );
+        if ( dropped != trace_threads[i]->dropped_reported )
+        {
+            if ( len + APP_TRACE_LINE_MAX > APP_TRACE_OUT_SIZE )
+            {
+                fwrite( p_out, 1, len, stdout );
+                len = 0;
+            }
+            len += (size_t)snprintf( p_out + len, APP_TRACE_LINE_MAX, "[TRACE] %llu records dropped\n",
+                                     (unsigned long long)( dropped - trace_threads[i]->dropped_reported ) );
+            trace_threads[i]->dropped_reported = dropped;
+            count++;
+        }
+    }
+
+    if ( len > 0 )
+    {
+        fwrite( p_out, 1, len, stdout );
+    }
+    if ( count > 0 )
+    {
+        fflush( stdout );
+        for ( i = 0; i < nthreads; i++ )
+        {
+            __atomic_store_n( &trace_threads[i]->written, trace_threads[i]->ring.tail, __ATOMIC_RELEASE );
+        }
+    }
+
+    /* the owner's last record was committed before it retired the ring */
+    for ( i = 0; i < nthreads; i++ )
+    {
+        if ( ( __atomic_load_n( &trace_threads[i]->state, __ATOMIC_ACQUIRE ) == APP_TRACE_THREAD_RETIRED ) &&
+             ( app_spsc_ring_peek( &trace_threads[i]->ring ) == NULL ) )
+        {
+            __atomic_store_n( &trace_threads[i]->state, APP_TRACE_THREAD_FREE, __ATOMIC_RELEASE );
+        }
+    }
+    return count;
+}
+
+/******************************************************************************
+ * Function Name: app_trace_formatter_main()
+ ******************************************************************************
+ * Summary:
+ *   Background formatter. Polls instead of being woken so the logging
+ *   threads never make a system call; the poll interval backs off while
+ *   idle.
+ *
+ *****************************************************************************/
+static void *app_trace_formatter_main( void *p_arg )
+{
+    struct timespec poll = { 0, APP_TRACE_POLL_MIN_NS };
+    char *p_out = (char *)p_arg;
+
+    while ( __atomic_load_n( &trace_running, __ATOMIC_ACQUIRE ) )
+    {
+        app_time_resync();
+        if ( app_trace_drain( p_out ) > 0 )
+        {
+            poll.tv_nsec = APP_TRACE_POLL_MIN_NS;
+            continue;
+        }
+        nanosleep( &poll, NULL );
+        if ( poll.tv_nsec < APP_TRACE_POLL_MAX_NS )
+        {
+            poll.tv_nsec *= 2;
+        }
+    }
+    app_trace_drain( p_out );
+    free( p_out );
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: app_trace_start()
+ ******************************************************************************
+ * Summary:
+ *   Start the formatter thread, trace calls are queued from now on
+ *
+ * Return:
+ *  APP_TRACE_SUCCESS or APP_TRACE_ERROR
+ *
+ *****************************************************************************/
+int app_trace_start( void )
+{
+    char *p_out;
+
+    if ( __atomic_load_n( &trace_running, __ATOMIC_ACQUIRE ) )
+    {
+        return APP_TRACE_SUCCESS;
+    }
+    p_out = malloc( APP_TRACE_OUT_SIZE );
+    if ( p_out == NULL )
+    {
+        return APP_TRACE_ERROR;
+    }
+    fflush( stdout );
+    __atomic_store_n( &trace_running, 1, __ATOMIC_RELEASE );
+    if ( pthread_create( &trace_formatter, NULL, app_trace_formatter_main, p_out ) != 0 )
+    {
+        __atomic_store_n( &trace_running, 0, __ATOMIC_RELEASE );
+        free( p_out );
+        return APP_TRACE_ERROR;
+    }
+    return APP_TRACE_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: app_trace_stop()
+ ******************************************************************************
+ * Summary:
+ *   Flush what is queued and stop the formatter. Later trace calls are
+ *   written synchronously.
+ *
+ *****************************************************************************/
+void app_trace_stop( void )
+{
+    if ( !__atomic_exchange_n( &trace_running, 0, __ATOMIC_ACQ_REL ) )
+    {
+        return;
+    }
+    pthread_join( trace_formatter, NULL );
+}
+
+/******************************************************************************
+ * Function Name: app_trace_flush()
+ ******************************************************************************
+ * Summary:
+ *   Wait until the formatter has written every record queued before the
+ *   call, so synchronous console output that follows stays in order. Not
+ *   for hot paths.
+ *
+ *****************************************************************************/
+void app_trace_flush( void )
+{
+    struct timespec poll = { 0, 100000L };
+    uint32_t nthreads = __atomic_load_n( &trace_num_threads, __ATOMIC_ACQUIRE );
+    uint64_t heads[APP_TRACE_THREADS_MAX];
+    uint64_t deadline;
+    uint32_t i, pending;
+
+    if ( !__atomic_load_n( &trace_running, __ATOMIC_ACQUIRE ) )
+    {
+        return;
+    }
+    for ( i = 0; i < nthreads; i++ )
+    {
+        heads[i] = __atomic_load_n( &trace_threads[i]->ring.head, __ATOMIC_ACQUIRE );
+    }
+
+    deadline = app_time_now_ns() + APP_TRACE_FLUSH_WAIT_NS;
+    do
+    {
+        pending = 0;
+        for ( i = 0; i < nthreads; i++ )
+        {
+            pending += ( __atomic_load_n( &trace_threads[i]->written, __ATOMIC_ACQUIRE ) < heads[i] );
+        }
+        if ( pending == 0 )
+        {
+            return;
+        }
+        nanosleep( &poll, NULL );
+    } while ( app_time_now_ns() < deadline );
+}
+
+/******************************************************************************
+ * Function Name: app_trace_dropped()
+ ******************************************************************************
+ * Summary:
+ *   Records dropped so far because a thread's ring was full
+ *
+ *****************************************************************************/
+uint64_t app_trace_dropped( void )
+{
+    uint32_t nthreads = __atomic_load_n( &trace_num_threads, __ATOMIC_ACQUIRE );
+    uint64_t total = 0;
+    uint32_t i;
+
+    for ( i = 0; i < nthreads; i++ )
+    {
+        total += __atomic_load_n( &trace_threads[i]->dropped, __ATOMIC_RELAXED );
+    }
+    return total;
+}
+
+/******************************************************************************
+ * Function Name: app_trace_stamp()
+ ******************************************************************************
+ * Summary:
+ *   Print the "[sec.nsec]" CLOCK_MONOTONIC prefix of a synchronous trace line
+ *
+ *****************************************************************************/
+void app_trace_stamp( void )
+{
+    uint64_t ns = app_time_now_ns();
+
+    printf( "[%llu.%09llu]", (unsigned long long)( ns / APP_TIME_NS_PER_SEC ),
+            (unsigned long long)( ns % APP_TIME_NS_PER_SEC ) );
+}
+
+/* [] END OF FILE */
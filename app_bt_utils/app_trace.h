@@ -0,0 +1,144 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: app_trace.h
+ *
+ * Description: This is the header file for the asynchronous trace logger.
+ *              A trace call packs the call site pointer, a timestamp and the
+ *              raw argument values into a fixed size record in a per-thread
+ *              SPSC ring and returns. A background thread merges the rings
+ *              in timestamp order, formats the records and writes them to
+ *              stdout. Each call site is a static descriptor; its format
+ *              string is parsed once, on first use, to learn the argument
+ *              types.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __APP_TRACE_H__
+#define __APP_TRACE_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define APP_TRACE_SUCCESS                   ( 0 )
+#define APP_TRACE_ERROR                     ( -1 )
+
+/* verbosity, see TRACE_LEVEL_* in log.h */
+#define APP_TRACE_LEVEL_NONE                ( 0 )
+#define APP_TRACE_LEVEL_ERR                 ( 1 )
+#define APP_TRACE_LEVEL_INFO                ( 2 )
+#define APP_TRACE_LEVEL_DEBUG               ( 3 )
+
+/* conversions per call, '*' width and precision count as arguments */
+#define APP_TRACE_ARGS_MAX                  ( 16 )
+/* record size, strings are copied into it and truncated to fit */
+#define APP_TRACE_RECORD_SIZE               ( 128 )
+/* records per thread */
+#define APP_TRACE_RING_DEPTH                ( 1024 )
+/* threads with a ring at once; rings of exited threads are reused */
+#define APP_TRACE_THREADS_MAX               ( 32 )
+
+/* the log.h macros route here when APP_TRACE_ASYNC is set */
+#define APP_TRACE( kind_, f_, ... )                                                         \
+    do                                                                                      \
+    {                                                                                       \
+        static app_trace_site_t app_trace_site_ =                                           \
+            { .kind = ( kind_ ), .p_tag = TAG, .p_func = __func__, .p_fmt = ( f_ ) };       \
+        app_trace_write( &app_trace_site_, ##__VA_ARGS__ );                                 \
+    } while ( 0 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef enum
+{
+    APP_TRACE_KIND_MSG = 0,     /* format only */
+    APP_TRACE_KIND_LOG,         /* TAG[func]: format */
+    APP_TRACE_KIND_ERR,         /* TAG[ERROR][func]: format */
+} app_trace_kind_t;
+
+typedef enum
+{
+    APP_TRACE_ARG_INT = 1,
+    APP_TRACE_ARG_LONG,
+    APP_TRACE_ARG_LLONG,
+    APP_TRACE_ARG_DOUBLE,
+    APP_TRACE_ARG_PTR,
+    APP_TRACE_ARG_STR,
+} app_trace_arg_t;
+
+/* one per trace call site, argument types filled in on first use */
+typedef struct
+{
+    uint8_t     kind;
+    uint8_t     parsed;
+    uint8_t     nargs;
+    uint8_t     fixed_len;          /* record bytes taken by non string arguments */
+    uint8_t     args[APP_TRACE_ARGS_MAX];
+    const char  *p_tag;
+    const char  *p_func;
+    const char  *p_fmt;
+} app_trace_site_t;
+
+/******************************************************************************
+ *                                EXTERNS
+ *****************************************************************************/
+/* runtime trace level, calls above it are skipped */
+extern int app_trace_level;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+int app_trace_start( void );
+
+void app_trace_stop( void );
+
+void app_trace_write( app_trace_site_t *p_site, ... );
+
+void app_trace_flush( void );
+
+uint64_t app_trace_dropped( void );
+
+void app_trace_stamp( void );
+
+#endif /* __APP_TRACE_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,252 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: bench.c
+ *
+ * Description: This is the source file for the microbenchmark harness. Each
+ *              benchmark is calibrated to the requested run time, then
+ *              sampled --samples times; the median and the minimum time
+ *              per operation and the allocations per operation are
+ *              reported, as text or as one JSON document. The JSON one
+ *              also carries every sample, for wakeonle_bench_compare.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include "bench.h"
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+volatile uint64_t bench_sink = 0;
+FILE *p_bench_out = NULL;
+static uint64_t bench_paused_ns = 0;
+static uint64_t bench_pause_start = 0;
+static uint32_t bench_results = 0;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: bench_now_ns()
+ ******************************************************************************
+ * Summary:
+ *   Monotonic time in nanoseconds
+ *
+ *****************************************************************************/
+uint64_t bench_now_ns( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/******************************************************************************
+ * Function Name: bench_pause()
+ ******************************************************************************
+ * Summary:
+ *   Stop counting time against the running sample, eg: while waiting for a
+ *   consumer to catch up
+ *
+ *****************************************************************************/
+void bench_pause( void )
+{
+    bench_pause_start = bench_now_ns();
+}
+
+void bench_resume( void )
+{
+    bench_paused_ns += bench_now_ns() - bench_pause_start;
+}
+
+/******************************************************************************
+ * Function Name: bench_report_begin()
+ ******************************************************************************
+ * Summary:
+ *   Start the report; the JSON one records the machine and the settings
+ *   so results from different hosts can be told apart
+ *
+ *****************************************************************************/
+void bench_report_begin( const bench_opts_t *p_opts )
+{
+    struct utsname host;
+
+    if ( !p_opts->json )
+    {
+        return;
+    }
+    if ( uname( &host ) != 0 )
+    {
+        memset( &host, 0, sizeof( host ) );
+    }
+    fprintf( p_bench_out,
+             "{\n  \"machine\": \"%s\",\n  \"kernel\": \"%s\",\n  \"cpus\": %ld,\n"
+             "  \"compiler\": \"%s\",\n  \"time_ms\": %u,\n  \"samples\": %u,\n  \"results\": [",
+             host.machine, host.release, sysconf( _SC_NPROCESSORS_ONLN ),
+#ifdef __VERSION__
+             __VERSION__,
+#else
+             "unknown",
+#endif
+             p_opts->min_time_ms, p_opts->samples );
+    bench_results = 0;
+}
+
+void bench_report_end( const bench_opts_t *p_opts )
+{
+    struct rusage usage;
+
+    if ( p_opts->json )
+    {
+        if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        {
+            memset( &usage, 0, sizeof( usage ) );
+        }
+        fprintf( p_bench_out, "\n  ],\n  \"max_rss_kb\": %ld\n}\n", usage.ru_maxrss );
+    }
+    fflush( p_bench_out );
+}
+
+static int bench_cmp_double( const void *p_a, const void *p_b )
+{
+    double a = *(const double *)p_a;
+    double b = *(const double *)p_b;
+
+    return ( a > b ) - ( a < b );
+}
+
+/******************************************************************************
+ * Function Name: bench_run()
+ ******************************************************************************
+ * Summary:
+ *   Calibrate, sample and report one benchmark
+ *
+ * Parameters:
+ *   const bench_opts_t *p_opts : run options
+ *   const char *p_suite        : suite name
+ *   const char *p_name         : benchmark name
+ *   bench_fn_t fn              : measured function
+ *   void *p_ctx                : passed to fn
+ *
+ * Return:
+ *  None
+ *
+ *****************************************************************************/
+void bench_run( const bench_opts_t *p_opts, const char *p_suite, const char *p_name,
+                bench_fn_t fn, void *p_ctx )
+{
+    uint64_t target_ns = (uint64_t)p_opts->min_time_ms * 1000000ULL / BENCH_SAMPLES;
+    uint64_t iters = 1;
+    uint64_t start, elapsed, allocs;
+    double ns_per_op[BENCH_SAMPLES_MAX];
+    double sorted[BENCH_SAMPLES_MAX];
+    double allocs_per_op;
+    uint32_t samples = p_opts->samples;
+    uint32_t i;
+
+    if ( ( p_opts->p_filter != NULL ) && ( strstr( p_name, p_opts->p_filter ) == NULL ) &&
+         ( strstr( p_suite, p_opts->p_filter ) == NULL ) )
+    {
+        return;
+    }
+
+    /* grow the batch until one sample takes about target_ns */
+    for ( ;; )
+    {
+        bench_paused_ns = 0;
+        start = bench_now_ns();
+        fn( p_ctx, iters );
+        elapsed = bench_now_ns() - start - bench_paused_ns;
+        if ( ( elapsed >= target_ns ) || ( iters >= ( 1ULL << 40 ) ) )
+        {
+            break;
+        }
+        if ( elapsed < target_ns / 16 )
+        {
+            iters *= 16;
+        }
+        else
+        {
+            iters = iters * target_ns / elapsed + 1;
+        }
+    }
+
+    allocs = __atomic_load_n( &bench_allocs, __ATOMIC_RELAXED );
+    for ( i = 0; i < samples; i++ )
+    {
+        bench_paused_ns = 0;
+        start = bench_now_ns();
+        fn( p_ctx, iters );
+        elapsed = bench_now_ns() - start - bench_paused_ns;
+        ns_per_op[i] = (double)elapsed / (double)iters;
+    }
+    allocs_per_op = (double)( __atomic_load_n( &bench_allocs, __ATOMIC_RELAXED ) - allocs ) /
+                    ( (double)iters * samples );
+    memcpy( sorted, ns_per_op, samples * sizeof( sorted[0] ) );
+    qsort( sorted, samples, sizeof( sorted[0] ), bench_cmp_double );
+
+    if ( p_opts->json )
+    {
+        fprintf( p_bench_out,
+                 "%s\n    { \"suite\": \"%s\", \"name\": \"%s\", \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, "
+                 "\"ops_per_s\": %.0f, \"allocs_per_op\": %.4f, \"iters\": %llu,\n      \"samples_ns\": [",
+                 ( bench_results++ > 0 ) ? "," : "", p_suite, p_name, sorted[samples / 2], sorted[0],
+                 1e9 / sorted[samples / 2], allocs_per_op, (unsigned long long)iters );
+        /* in run order, so drift over the run stays visible */
+        for ( i = 0; i < samples; i++ )
+        {
+            fprintf( p_bench_out, "%s%.3f", ( i > 0 ) ? ", " : "", ns_per_op[i] );
+        }
+        fprintf( p_bench_out, "] }" );
+        return;
+    }
+    fprintf( p_bench_out, "%-10s %-34s %10.2f ns/op  (min %8.2f)  %14.0f ops/s  %6.2f allocs/op\n", p_suite, p_name,
+             sorted[samples / 2], sorted[0], 1e9 / sorted[samples / 2], allocs_per_op );
+    fflush( p_bench_out );
+}
+
+/* [] END OF FILE */
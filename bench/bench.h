@@ -0,0 +1,125 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: bench.h
+ *
+ * Description: This is the header file for the microbenchmark harness. The
+ *              benchmarks exercise the hardware independent parts of the
+ *              application and do not need a controller.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+/* --time is split over the default number of samples; --samples adds more
+ * of the same length */
+#define BENCH_SAMPLES                       ( 5U )
+#define BENCH_SAMPLES_MAX                   ( 64U )
+#define BENCH_MIN_TIME_MS_DEFAULT           ( 250U )
+
+/* keep a value alive without a store the compiler can drop */
+#define BENCH_KEEP( x )                     ( bench_sink += (uint64_t)( x ) )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* run the measured operation iters times */
+typedef void ( *bench_fn_t )( void *p_ctx, uint64_t iters );
+
+typedef struct
+{
+    const char  *p_filter;          /* run only names containing this */
+    const char  *p_adv_file;        /* recorded payloads, one hex line each */
+    uint32_t    min_time_ms;        /* per benchmark */
+    uint32_t    samples;            /* per benchmark, up to BENCH_SAMPLES_MAX */
+    int         json;               /* JSON report instead of text */
+} bench_opts_t;
+
+typedef struct
+{
+    const char  *p_name;
+    void        ( *run )( const bench_opts_t *p_opts );
+} bench_suite_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+extern volatile uint64_t bench_sink;
+
+/* results go here, not to stdout, which the trace suite redirects */
+extern FILE *p_bench_out;
+
+/* malloc, calloc, realloc and posix_memalign calls made by the benchmarked
+ * code, counted by the --wrap link wrappers in bench_alloc.c */
+extern uint64_t bench_allocs;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+uint64_t bench_now_ns( void );
+
+/* exclude the time between the two calls from the running sample */
+void bench_pause( void );
+void bench_resume( void );
+
+void bench_report_begin( const bench_opts_t *p_opts );
+void bench_report_end( const bench_opts_t *p_opts );
+
+void bench_run( const bench_opts_t *p_opts, const char *p_suite, const char *p_name,
+                bench_fn_t fn, void *p_ctx );
+
+/* suites */
+void bench_adv_run( const bench_opts_t *p_opts );
+void bench_capture_run( const bench_opts_t *p_opts );
+void bench_device_table_run( const bench_opts_t *p_opts );
+void bench_event_run( const bench_opts_t *p_opts );
+void bench_fmt_run( const bench_opts_t *p_opts );
+void bench_slab_run( const bench_opts_t *p_opts );
+void bench_trace_run( const bench_opts_t *p_opts );
+
+#endif /* __BENCH_H__ */
+
+/* [] END OF FILE */
@@ -0,0 +1,435 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: bench_adv.c
+ *
+ * Description: This is the source file for the advertising data benchmarks:
+ *              AD structure walking and wake rule matching, vector and
+ *              scalar, on three payload corpora:
+ *              - reference: layouts of common beacons and accessories
+ *              - synthetic: randomly generated, valid AD structures
+ *              - recorded:  payloads loaded with --adv-file
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bench.h"
+#include "app_adv_parser.h"
+#include "app_adv_match.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define BENCH_ADV_LEN_MAX                   ( 31U )
+#define BENCH_ADV_SYNTHETIC_COUNT           ( 1024U )
+#define BENCH_ADV_RECORDED_MAX              ( 65536U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    uint8_t     len;
+    uint8_t     data[BENCH_ADV_LEN_MAX];
+} bench_adv_payload_t;
+
+typedef struct
+{
+    const bench_adv_payload_t   *p_payloads;
+    uint32_t                    count;
+    app_adv_rule_set_t          *p_rules;
+} bench_adv_ctx_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static const bench_adv_payload_t bench_adv_reference[] =
+{
+    /* iBeacon */
+    { 30, { 0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48,
+            0xD2, 0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0, 0x00, 0x01, 0x00, 0x02, 0xC5 } },
+    /* Eddystone-UID */
+    { 31, { 0x03, 0x03, 0xAA, 0xFE, 0x17, 0x16, 0xAA, 0xFE, 0x00, 0xE7, 0x36, 0xC8, 0x80, 0x7B, 0xF4, 0x60,
+            0xCB, 0x41, 0xD1, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+    /* Eddystone-URL */
+    { 25, { 0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x11, 0x16, 0xAA, 0xFE, 0x10, 0xEB, 0x03, 'e', 'x',
+            'a', 'm', 'p', 'l', 'e', '.', 'c', 'o', 'm' } },
+    /* heart rate sensor, two 16 bit services and a name */
+    { 19, { 0x02, 0x01, 0x06, 0x05, 0x03, 0x0D, 0x18, 0x0A, 0x18, 0x08, 0x09, 'H', 'R', 'M', '-', '1',
+            '2', '3', 0x00 } },
+    /* Apple continuity, manufacturer data only */
+    { 31, { 0x1E, 0xFF, 0x4C, 0x00, 0x12, 0x19, 0x10, 0x5C, 0x2F, 0x7A, 0x61, 0x3E, 0x04, 0x9B, 0x58, 0x21,
+            0xC4, 0x0D, 0x8E, 0x7F, 0x53, 0x27, 0xAA, 0x16, 0xB0, 0x3C, 0x61, 0x8F, 0x01, 0x00, 0x00 } },
+    /* Microsoft Swift Pair */
+    { 20, { 0x02, 0x01, 0x06, 0x06, 0xFF, 0x06, 0x00, 0x03, 0x00, 0x80, 0x08, 0x09, 'K', 'e', 'y', 'b',
+            'o', 'a', 'r', 'd' } },
+    /* Google Fast Pair */
+    { 14, { 0x02, 0x01, 0x06, 0x03, 0x03, 0x2C, 0xFE, 0x06, 0x16, 0x2C, 0xFE, 0x00, 0xB7, 0x27 } },
+    /* Xiaomi MiBeacon service data */
+    { 21, { 0x02, 0x01, 0x06, 0x11, 0x16, 0x95, 0xFE, 0x50, 0x20, 0xAA, 0x01, 0x3B, 0x7C, 0x91, 0x38, 0xC1,
+            0xA4, 0x08, 0x09, 0x04, 0x10 } },
+    /* Nordic UART service, 128 bit UUID */
+    { 21, { 0x02, 0x01, 0x06, 0x11, 0x07, 0x9E, 0xCA, 0xDC, 0x24, 0x0E, 0xE5, 0xA9, 0xE0, 0x93, 0xF3, 0xA3,
+            0xB5, 0x01, 0x00, 0x40, 0x6E } },
+    /* wake source as armed in the README example, 32 bit UUID and manufacturer data */
+    { 17, { 0x02, 0x01, 0x06, 0x05, 0x05, 0x44, 0x33, 0x22, 0x11, 0x07, 0xFF, 0x31, 0x01, 0x01, 0x02, 0x03,
+            0x04 } },
+};
+
+static bench_adv_payload_t  bench_adv_synthetic[BENCH_ADV_SYNTHETIC_COUNT];
+static uint32_t             bench_adv_seed = 0x2545F491U;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint32_t bench_adv_rand( void )
+{
+    bench_adv_seed ^= bench_adv_seed << 13;
+    bench_adv_seed ^= bench_adv_seed >> 17;
+    bench_adv_seed ^= bench_adv_seed << 5;
+    return bench_adv_seed;
+}
+
+/******************************************************************************
+ * Function Name: bench_adv_gen()
+ ******************************************************************************
+ * Summary:
+ *   Fill one payload with random AD structures: flags, service UUID lists of
+ *   every width, manufacturer data, service data and names, until full
+ *
+ *****************************************************************************/
+static void bench_adv_gen( bench_adv_payload_t *p_payload )
+{
+    static const uint8_t types[] = { APP_AD_TYPE_UUID16_COMPLETE, APP_AD_TYPE_UUID32_COMPLETE,
+                                     APP_AD_TYPE_UUID128_COMPLETE, APP_AD_TYPE_MANUFACTURER,
+                                     APP_AD_TYPE_SERVICE_DATA16, APP_AD_TYPE_NAME_COMPLETE,
+                                     APP_AD_TYPE_TX_POWER };
+    uint8_t *p = p_payload->data;
+    uint32_t room, type, vlen, i;
+
+    p_payload->len = 0;
+    if ( bench_adv_rand() & 1 )
+    {
+        p[0] = 2; p[1] = APP_AD_TYPE_FLAGS; p[2] = 0x06;
+        p_payload->len = 3;
+    }
+    while ( (uint32_t)p_payload->len + 3U <= BENCH_ADV_LEN_MAX )
+    {
+        room = BENCH_ADV_LEN_MAX - p_payload->len - 2;
+        type = types[bench_adv_rand() % sizeof( types )];
+        switch ( type )
+        {
+            case APP_AD_TYPE_UUID16_COMPLETE:  vlen = 2 * ( 1 + bench_adv_rand() % 4 ); break;
+            case APP_AD_TYPE_UUID32_COMPLETE:  vlen = 4 * ( 1 + bench_adv_rand() % 2 ); break;
+            case APP_AD_TYPE_UUID128_COMPLETE: vlen = 16; break;
+            case APP_AD_TYPE_TX_POWER:         vlen = 1; break;
+            default:                           vlen = 2 + bench_adv_rand() % 12; break;
+        }
+        if ( vlen > room )
+        {
+            break;
+        }
+        p = &p_payload->data[p_payload->len];
+        p[0] = (uint8_t)( vlen + 1 );
+        p[1] = (uint8_t)type;
+        for ( i = 0; i < vlen; i++ )
+        {
+            /* keep UUID16 in the assigned 0x18xx range so rules can hit */
+            p[2 + i] = ( ( type == APP_AD_TYPE_UUID16_COMPLETE ) && ( i & 1 ) ) ? 0x18 : (uint8_t)( bench_adv_rand() & 0x3F );
+        }
+        p_payload->len = (uint8_t)( p_payload->len + 2 + vlen );
+        if ( bench_adv_rand() % 4 == 0 )
+        {
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: bench_adv_load()
+ ******************************************************************************
+ * Summary:
+ *   Load recorded payloads, one hex string per line. Lines starting with #
+ *   and characters other than hex digits are ignored, so btmon or hcidump
+ *   output can be pasted after light editing.
+ *
+ *****************************************************************************/
+static uint32_t bench_adv_load( const char *p_path, bench_adv_payload_t *p_out, uint32_t max )
+{
+    char line[512];
+    uint32_t count = 0;
+    int hi;
+    char *p;
+    FILE *fp = fopen( p_path, "r" );
+
+    if ( fp == NULL )
+    {
+        fprintf( stderr, "cannot open %s\n", p_path );
+        return 0;
+    }
+    while ( ( count < max ) && ( fgets( line, sizeof( line ), fp ) != NULL ) )
+    {
+        if ( line[0] == '#' )
+        {
+            continue;
+        }
+        p_out[count].len = 0;
+        hi = -1;
+        for ( p = line; ( *p != '\0' ) && ( p_out[count].len < BENCH_ADV_LEN_MAX ); p++ )
+        {
+            int v;
+
+            if ( !isxdigit( (unsigned char)*p ) )
+            {
+                continue;
+            }
+            v = isdigit( (unsigned char)*p ) ? *p - '0' : ( tolower( (unsigned char)*p ) - 'a' + 10 );
+            if ( hi < 0 )
+            {
+                hi = v;
+            }
+            else
+            {
+                p_out[count].data[p_out[count].len++] = (uint8_t)( ( hi << 4 ) | v );
+                hi = -1;
+            }
+        }
+        if ( p_out[count].len > 0 )
+        {
+            count++;
+        }
+    }
+    fclose( fp );
+    return count;
+}
+
+/******************************************************************************
+ * Function Name: bench_adv_rules()
+ ******************************************************************************
+ * Summary:
+ *   Build a rule set of count rules: the reference wake source first, then
+ *   a mix of 16, 32 and 128 bit UUIDs, some with manufacturer patterns
+ *
+ *****************************************************************************/
+static void bench_adv_rules( app_adv_rule_set_t *p_set, uint32_t count )
+{
+    app_adv_rule_t rule;
+    uint32_t i;
+
+    app_adv_rule_set_init( p_set );
+    for ( i = 0; i < count; i++ )
+    {
+        memset( &rule, 0, sizeof( rule ) );
+        rule.filter_idx = (uint8_t)i;
+        if ( i == 0 )
+        {
+            static const uint8_t pattern[] = { 0x01, 0x02, 0x03, 0x04 };
+
+            rule.uuid_len = 4;
+            memcpy( rule.uuid, "\x44\x33\x22\x11", 4 );
+            rule.has_manu = 1;
+            rule.company_id = 0x0131;
+            rule.company_id_mask = 0xFFFF;
+            rule.pattern_len = sizeof( pattern );
+            memcpy( rule.pattern, pattern, sizeof( pattern ) );
+            memset( rule.pattern_mask, 0xFF, sizeof( pattern ) );
+        }
+        else if ( i % 4 == 3 )
+        {
+            rule.uuid_len = 16;
+            rule.uuid[0] = (uint8_t)i;
+            rule.uuid[15] = 0x6E;
+        }
+        else if ( i % 4 == 2 )
+        {
+            rule.uuid_len = 4;
+            rule.uuid[0] = (uint8_t)i;
+            rule.uuid[1] = 0x20;
+            if ( i % 8 == 2 )
+            {
+                rule.has_manu = 1;
+                rule.company_id = 0x004C;
+                rule.company_id_mask = 0xFFFF;
+            }
+        }
+        else
+        {
+            rule.uuid_len = 2;
+            rule.uuid[0] = (uint8_t)( 0x40 + i );
+            rule.uuid[1] = 0x18;
+        }
+        app_adv_rule_set_add( p_set, &rule );
+    }
+}
+
+static void bench_adv_iter_fn( void *p_arg, uint64_t iters )
+{
+    const bench_adv_ctx_t *p_ctx = (const bench_adv_ctx_t *)p_arg;
+    app_ad_iter_t iter;
+    app_ad_field_t field;
+    uint64_t n, sum = 0;
+    uint32_t i = 0;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        app_ad_iter_init( &iter, p_ctx->p_payloads[i].data, p_ctx->p_payloads[i].len );
+        while ( app_ad_iter_next( &iter, &field ) )
+        {
+            sum += field.type;
+        }
+        if ( ++i == p_ctx->count )
+        {
+            i = 0;
+        }
+    }
+    BENCH_KEEP( sum );
+}
+
+static void bench_adv_len_fn( void *p_arg, uint64_t iters )
+{
+    const bench_adv_ctx_t *p_ctx = (const bench_adv_ctx_t *)p_arg;
+    uint64_t n, sum = 0;
+    uint32_t i = 0;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        sum += app_ad_total_len( p_ctx->p_payloads[i].data, BENCH_ADV_LEN_MAX );
+        if ( ++i == p_ctx->count )
+        {
+            i = 0;
+        }
+    }
+    BENCH_KEEP( sum );
+}
+
+static void bench_adv_match_fn( void *p_arg, uint64_t iters )
+{
+    const bench_adv_ctx_t *p_ctx = (const bench_adv_ctx_t *)p_arg;
+    uint64_t n, sum = 0;
+    uint32_t i = 0;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        sum += (uint64_t)app_adv_rule_set_match( p_ctx->p_rules, p_ctx->p_payloads[i].data, p_ctx->p_payloads[i].len );
+        if ( ++i == p_ctx->count )
+        {
+            i = 0;
+        }
+    }
+    BENCH_KEEP( sum );
+}
+
+/******************************************************************************
+ * Function Name: bench_adv_corpus()
+ ******************************************************************************
+ * Summary:
+ *   Run every advertising benchmark on one corpus
+ *
+ *****************************************************************************/
+static void bench_adv_corpus( const bench_opts_t *p_opts, const char *p_corpus,
+                              const bench_adv_payload_t *p_payloads, uint32_t count )
+{
+    static app_adv_rule_set_t rules;
+    static const uint32_t rule_counts[] = { 1, 16, 64 };
+    bench_adv_ctx_t ctx = { p_payloads, count, &rules };
+    char name[64];
+    uint32_t r;
+    int scalar;
+
+    snprintf( name, sizeof( name ), "iter/%s", p_corpus );
+    bench_run( p_opts, "adv", name, bench_adv_iter_fn, &ctx );
+    snprintf( name, sizeof( name ), "total_len/%s", p_corpus );
+    bench_run( p_opts, "adv", name, bench_adv_len_fn, &ctx );
+
+    for ( r = 0; r < sizeof( rule_counts ) / sizeof( rule_counts[0] ); r++ )
+    {
+        bench_adv_rules( &rules, rule_counts[r] );
+        for ( scalar = 0; scalar < 2; scalar++ )
+        {
+            rules.scalar_only = (uint32_t)scalar;
+            snprintf( name, sizeof( name ), "match/%s/%u/%s", p_corpus, rule_counts[r],
+                      scalar ? "scalar" : app_adv_match_impl() );
+            bench_run( p_opts, "adv", name, bench_adv_match_fn, &ctx );
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: bench_adv_run()
+ ******************************************************************************
+ * Summary:
+ *   Advertising data suite entry point
+ *
+ *****************************************************************************/
+void bench_adv_run( const bench_opts_t *p_opts )
+{
+    bench_adv_payload_t *p_recorded;
+    uint32_t count, i;
+
+    for ( i = 0; i < BENCH_ADV_SYNTHETIC_COUNT; i++ )
+    {
+        bench_adv_gen( &bench_adv_synthetic[i] );
+    }
+
+    bench_adv_corpus( p_opts, "reference", bench_adv_reference,
+                      sizeof( bench_adv_reference ) / sizeof( bench_adv_reference[0] ) );
+    bench_adv_corpus( p_opts, "synthetic", bench_adv_synthetic, BENCH_ADV_SYNTHETIC_COUNT );
+
+    if ( p_opts->p_adv_file == NULL )
+    {
+        return;
+    }
+    p_recorded = malloc( BENCH_ADV_RECORDED_MAX * sizeof( *p_recorded ) );
+    if ( p_recorded == NULL )
+    {
+        return;
+    }
+    count = bench_adv_load( p_opts->p_adv_file, p_recorded, BENCH_ADV_RECORDED_MAX );
+    if ( count > 0 )
+    {
+        bench_adv_corpus( p_opts, "recorded", p_recorded, count );
+    }
+    free( p_recorded );
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,100 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: bench_alloc.c
+ *
+ * Description: This is the source file for the allocation counter. The
+ *              wakeonle_bench target links with -Wl,--wrap for the heap
+ *              functions, so calls from the benchmarks and the code under
+ *              test come here first. Allocations made inside the C library,
+ *              eg: by stdio, are not counted.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stddef.h>
+#include "bench.h"
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+uint64_t bench_allocs = 0;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void *__real_malloc( size_t size );
+void *__real_calloc( size_t nmemb, size_t size );
+void *__real_realloc( void *p, size_t size );
+int __real_posix_memalign( void **pp, size_t alignment, size_t size );
+
+void *__wrap_malloc( size_t size );
+void *__wrap_calloc( size_t nmemb, size_t size );
+void *__wrap_realloc( void *p, size_t size );
+int __wrap_posix_memalign( void **pp, size_t alignment, size_t size );
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+void *__wrap_malloc( size_t size )
+{
+    __atomic_fetch_add( &bench_allocs, 1, __ATOMIC_RELAXED );
+    return __real_malloc( size );
+}
+
+void *__wrap_calloc( size_t nmemb, size_t size )
+{
+    __atomic_fetch_add( &bench_allocs, 1, __ATOMIC_RELAXED );
+    return __real_calloc( nmemb, size );
+}
+
+void *__wrap_realloc( void *p, size_t size )
+{
+    __atomic_fetch_add( &bench_allocs, 1, __ATOMIC_RELAXED );
+    return __real_realloc( p, size );
+}
+
+int __wrap_posix_memalign( void **pp, size_t alignment, size_t size )
+{
+    __atomic_fetch_add( &bench_allocs, 1, __ATOMIC_RELAXED );
+    return __real_posix_memalign( pp, alignment, size );
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,177 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: bench_capture.c
+ *
+ * Description: This is the source file for the report capture benchmarks:
+ *              appending a 31 byte advertisement from one of 256 devices to
+ *              a --capture file, block writes included, and decoding the
+ *              records back from a mapped file of a fixed size.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "app_adv_capture.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define BENCH_CAPTURE_DEVICES               ( 256U )
+#define BENCH_CAPTURE_ADV_LEN               ( 31U )
+/* one report every 100 us of capture time */
+#define BENCH_CAPTURE_STEP_NS               ( 100000ULL )
+/* start the file over after this many records, about 40 MB */
+#define BENCH_CAPTURE_FILE_RECORDS          ( 1U << 20 )
+/* records of the file that is read back, a fixed size so the mapping and the
+ * peak RSS of the run do not depend on how many records append/31 wrote */
+#define BENCH_CAPTURE_READ_RECORDS          ( 1U << 16 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    app_adv_capture_writer_t    writer;
+    app_adv_capture_reader_t    reader;
+    uint64_t                    ts_ns;
+    uint32_t                    file_records;
+    char                        path[256];
+    uint8_t                     adv[BENCH_CAPTURE_ADV_LEN];
+} bench_capture_ctx_t;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static void bench_capture_append_fn( void *p_arg, uint64_t iters )
+{
+    bench_capture_ctx_t *p_ctx = (bench_capture_ctx_t *)p_arg;
+    uint8_t addr[6] = { 0x00, 0x00, 0x00, 0x80, 0x9B, 0xE3 };
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        if ( ++p_ctx->file_records == BENCH_CAPTURE_FILE_RECORDS )
+        {
+            bench_pause();
+            app_adv_capture_writer_close( &p_ctx->writer );
+            unlink( p_ctx->path );
+            app_adv_capture_writer_open( &p_ctx->writer, p_ctx->path );
+            p_ctx->file_records = 0;
+            bench_resume();
+        }
+        addr[0] = (uint8_t)( ( n * 97U ) % BENCH_CAPTURE_DEVICES );
+        p_ctx->adv[BENCH_CAPTURE_ADV_LEN - 1] = (uint8_t)n;
+        p_ctx->ts_ns += BENCH_CAPTURE_STEP_NS;
+        app_adv_capture_append( &p_ctx->writer, p_ctx->ts_ns, addr, 1, 0, (int8_t)-67,
+                                p_ctx->adv, BENCH_CAPTURE_ADV_LEN );
+    }
+}
+
+static void bench_capture_read_fn( void *p_arg, uint64_t iters )
+{
+    bench_capture_ctx_t *p_ctx = (bench_capture_ctx_t *)p_arg;
+    app_adv_capture_record_t record;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        if ( app_adv_capture_next( &p_ctx->reader, &record ) != APP_ADV_CAPTURE_SUCCESS )
+        {
+            bench_pause();
+            app_adv_capture_seek( &p_ctx->reader, 0 );
+            bench_resume();
+            continue;
+        }
+        BENCH_KEEP( record.p_adv[0] + record.adv_len );
+    }
+}
+
+/******************************************************************************
+ * Function Name: bench_capture_run()
+ ******************************************************************************
+ * Summary:
+ *   Report capture suite entry point
+ *
+ *****************************************************************************/
+void bench_capture_run( const bench_opts_t *p_opts )
+{
+    static bench_capture_ctx_t ctx;
+    const char *p_dir = getenv( "TMPDIR" );
+    uint32_t i;
+
+    memset( &ctx, 0, sizeof( ctx ) );
+    for ( i = 0; i < BENCH_CAPTURE_ADV_LEN; i++ )
+    {
+        ctx.adv[i] = (uint8_t)( i * 5U );
+    }
+    snprintf( ctx.path, sizeof( ctx.path ), "%s/wakeonle_bench_%ld.cap", ( p_dir != NULL ) ? p_dir : "/tmp",
+              (long)getpid() );
+    if ( app_adv_capture_writer_open( &ctx.writer, ctx.path ) != APP_ADV_CAPTURE_SUCCESS )
+    {
+        fprintf( stderr, "open %s failed\n", ctx.path );
+        return;
+    }
+    bench_run( p_opts, "capture", "append/31", bench_capture_append_fn, &ctx );
+    app_adv_capture_writer_close( &ctx.writer );
+
+    unlink( ctx.path );
+    if ( app_adv_capture_writer_open( &ctx.writer, ctx.path ) != APP_ADV_CAPTURE_SUCCESS )
+    {
+        fprintf( stderr, "open %s failed\n", ctx.path );
+        return;
+    }
+    ctx.file_records = 0;
+    bench_capture_append_fn( &ctx, BENCH_CAPTURE_READ_RECORDS );
+    app_adv_capture_writer_close( &ctx.writer );
+
+    if ( app_adv_capture_reader_open( &ctx.reader, ctx.path ) == APP_ADV_CAPTURE_SUCCESS )
+    {
+        bench_run( p_opts, "capture", "read/31", bench_capture_read_fn, &ctx );
+        app_adv_capture_reader_close( &ctx.reader );
+    }
+    unlink( ctx.path );
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,176 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: bench_device_table.c
+ *
+ * Description: This is the source file for the device table benchmarks:
+ *              updates of known devices, lookups that hit and miss, and
+ *              inserts into a full table, which evict on every call.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include "bench.h"
+#include "app_device_table.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define BENCH_DEVICES                       ( 50000U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    app_device_table_t  table;
+    uint32_t            next;       /* next never seen device number */
+} bench_device_ctx_t;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/* random static address derived from a device number */
+static void bench_device_addr( uint32_t n, uint8_t *p_addr )
+{
+    uint32_t h = n * 0x9E3779B1U;
+
+    p_addr[0] = (uint8_t)h;
+    p_addr[1] = (uint8_t)( h >> 8 );
+    p_addr[2] = (uint8_t)( h >> 16 );
+    p_addr[3] = (uint8_t)( h >> 24 );
+    p_addr[4] = (uint8_t)n;
+    p_addr[5] = 0xC0 | (uint8_t)( ( n >> 8 ) & 0x3F );
+}
+
+static void bench_device_update_fn( void *p_arg, uint64_t iters )
+{
+    bench_device_ctx_t *p_ctx = (bench_device_ctx_t *)p_arg;
+    uint8_t addr[6];
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        bench_device_addr( (uint32_t)( n % BENCH_DEVICES ), addr );
+        app_device_table_update( &p_ctx->table, addr, 1, (int8_t)-60, 0xFF, n );
+    }
+}
+
+static void bench_device_lookup_hit_fn( void *p_arg, uint64_t iters )
+{
+    bench_device_ctx_t *p_ctx = (bench_device_ctx_t *)p_arg;
+    uint8_t addr[6];
+    uint64_t n, sum = 0;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        bench_device_addr( (uint32_t)( ( n * 7919U ) % BENCH_DEVICES ), addr );
+        sum += (uint64_t)app_device_table_lookup( &p_ctx->table, addr, NULL );
+    }
+    BENCH_KEEP( sum );
+}
+
+static void bench_device_lookup_miss_fn( void *p_arg, uint64_t iters )
+{
+    bench_device_ctx_t *p_ctx = (bench_device_ctx_t *)p_arg;
+    uint8_t addr[6];
+    uint64_t n, sum = 0;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        bench_device_addr( (uint32_t)( BENCH_DEVICES * 4U + ( n % BENCH_DEVICES ) ), addr );
+        sum += (uint64_t)app_device_table_lookup( &p_ctx->table, addr, NULL );
+    }
+    BENCH_KEEP( sum );
+}
+
+static void bench_device_evict_fn( void *p_arg, uint64_t iters )
+{
+    bench_device_ctx_t *p_ctx = (bench_device_ctx_t *)p_arg;
+    uint8_t addr[6];
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        bench_device_addr( p_ctx->next++, addr );
+        app_device_table_update( &p_ctx->table, addr, 1, (int8_t)-60, 0xFF, n );
+    }
+}
+
+/******************************************************************************
+ * Function Name: bench_device_table_run()
+ ******************************************************************************
+ * Summary:
+ *   Device table suite entry point
+ *
+ *****************************************************************************/
+void bench_device_table_run( const bench_opts_t *p_opts )
+{
+    static bench_device_ctx_t ctx;
+    uint8_t addr[6];
+    uint32_t i;
+
+    if ( app_device_table_init( &ctx.table, BENCH_DEVICES ) != APP_DEVICE_TABLE_SUCCESS )
+    {
+        fprintf( stderr, "device table init failed\n" );
+        return;
+    }
+    for ( i = 0; i < BENCH_DEVICES; i++ )
+    {
+        bench_device_addr( i, addr );
+        app_device_table_update( &ctx.table, addr, 1, (int8_t)-60, 0xFF, i );
+    }
+
+    bench_run( p_opts, "devices", "update/known/50k", bench_device_update_fn, &ctx );
+    bench_run( p_opts, "devices", "lookup/hit/50k", bench_device_lookup_hit_fn, &ctx );
+    bench_run( p_opts, "devices", "lookup/miss/50k", bench_device_lookup_miss_fn, &ctx );
+    /* the update run above reused the same addresses, start past them */
+    ctx.next = BENCH_DEVICES * 8U;
+    bench_run( p_opts, "devices", "update/evict/50k", bench_device_evict_fn, &ctx );
+
+    if ( !p_opts->json )
+    {
+        fprintf( p_bench_out, "%-10s %-34s %10zu bytes\n", "devices", "footprint/50k",
+                 app_device_table_footprint( BENCH_DEVICES ) );
+    }
+    app_device_table_deinit( &ctx.table );
+}
+
+/* [] END OF FILE */
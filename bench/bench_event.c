@@ -0,0 +1,181 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: bench_event.c
+ *
+ * Description: This is the source file for the event path benchmarks: a
+ *              scan report published to the shared memory event ring,
+ *              alone and read back by one reader, and the report formatted
+ *              as a JSON line, alone and written to /dev/null as
+ *              --json does.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "app_event_ring.h"
+#include "app_event_json.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define BENCH_EVENT_SLOTS                   ( 1024U )
+#define BENCH_EVENT_ADV_LEN                 ( 31U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    app_event_t             event;
+    app_event_t             out;
+    app_event_ring_reader_t reader;
+    char                    line[APP_EVENT_JSON_LINE_MAX];
+} bench_event_ctx_t;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static void bench_event_publish_fn( void *p_arg, uint64_t iters )
+{
+    bench_event_ctx_t *p_ctx = (bench_event_ctx_t *)p_arg;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->event.timestamp_ns = n + 1;
+        app_event_ring_publish( &p_ctx->event );
+    }
+}
+
+static void bench_event_publish_poll_fn( void *p_arg, uint64_t iters )
+{
+    bench_event_ctx_t *p_ctx = (bench_event_ctx_t *)p_arg;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->event.timestamp_ns = n + 1;
+        app_event_ring_publish( &p_ctx->event );
+        BENCH_KEEP( app_event_ring_reader_poll( &p_ctx->reader, &p_ctx->out ) );
+    }
+}
+
+static void bench_event_json_format_fn( void *p_arg, uint64_t iters )
+{
+    bench_event_ctx_t *p_ctx = (bench_event_ctx_t *)p_arg;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->event.timestamp_ns = n + 1;
+        BENCH_KEEP( app_event_json_format( &p_ctx->event, p_ctx->line ) );
+    }
+}
+
+static void bench_event_json_write_fn( void *p_arg, uint64_t iters )
+{
+    bench_event_ctx_t *p_ctx = (bench_event_ctx_t *)p_arg;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->event.timestamp_ns = n + 1;
+        app_event_json_write( &p_ctx->event );
+    }
+}
+
+/******************************************************************************
+ * Function Name: bench_event_run()
+ ******************************************************************************
+ * Summary:
+ *   Event path suite entry point
+ *
+ *****************************************************************************/
+void bench_event_run( const bench_opts_t *p_opts )
+{
+    static bench_event_ctx_t ctx;
+    char name[64];
+    uint32_t i;
+
+    memset( &ctx, 0, sizeof( ctx ) );
+    ctx.event.type = APP_EVENT_SCAN_REPORT;
+    ctx.event.filter_idx = APP_EVENT_FILTER_IDX_NONE;
+    ctx.event.addr_type = 1;
+    memcpy( ctx.event.addr, "\xC4\x5A\x21\x80\x9B\xE3", 6 );
+    ctx.event.rssi = (int8_t)-67;
+    ctx.event.adv_len = BENCH_EVENT_ADV_LEN;
+    for ( i = 0; i < BENCH_EVENT_ADV_LEN; i++ )
+    {
+        ctx.event.adv_data[i] = (uint8_t)( i * 7U );
+    }
+
+    /* per process name, so a running application's ring is not touched */
+    snprintf( name, sizeof( name ), "/wakeonle_bench_%ld", (long)getpid() );
+    if ( app_event_ring_create( name, BENCH_EVENT_SLOTS ) != APP_EVENT_RING_SUCCESS )
+    {
+        fprintf( stderr, "event ring create failed\n" );
+        return;
+    }
+    if ( app_event_ring_reader_open( &ctx.reader, name ) != APP_EVENT_RING_SUCCESS )
+    {
+        fprintf( stderr, "event ring reader open failed\n" );
+        app_event_ring_destroy();
+        return;
+    }
+    bench_run( p_opts, "event", "ring/publish", bench_event_publish_fn, &ctx );
+    /* skip what the publish run left behind */
+    ctx.reader.next = ctx.reader.p_hdr->head;
+    bench_run( p_opts, "event", "ring/publish+poll", bench_event_publish_poll_fn, &ctx );
+    app_event_ring_reader_close( &ctx.reader );
+    app_event_ring_destroy();
+
+    bench_run( p_opts, "event", "json/format", bench_event_json_format_fn, &ctx );
+    if ( app_event_json_open( "/dev/null" ) == APP_EVENT_JSON_SUCCESS )
+    {
+        bench_run( p_opts, "event", "json/write", bench_event_json_write_fn, &ctx );
+        app_event_json_close();
+    }
+}
+
+/* [] END OF FILE */
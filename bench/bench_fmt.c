@@ -0,0 +1,301 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: bench_fmt.c
+ *
+ * Description: This is the source file for the formatting benchmarks: the
+ *              lookup table encoders of app_fmt against the printf based
+ *              code they replace in print_bd_address() and print_array(),
+ *              and a name table against a switch. The "print" benchmarks
+ *              write to /dev/null through stdio, as the console does.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "app_fmt.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define BENCH_FMT_PAYLOAD_MAX               ( 255U )
+#define BENCH_FMT_NAMES                     ( 34U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    FILE        *p_null;
+    uint8_t     addr[6];
+    uint8_t     data[BENCH_FMT_PAYLOAD_MAX];
+    uint32_t    len;
+} bench_fmt_ctx_t;
+
+/* stand in for wiced_bt_management_evt_t, same number of values */
+typedef enum
+{
+    BENCH_EVT_0, BENCH_EVT_1, BENCH_EVT_2, BENCH_EVT_3, BENCH_EVT_4, BENCH_EVT_5, BENCH_EVT_6,
+    BENCH_EVT_7, BENCH_EVT_8, BENCH_EVT_9, BENCH_EVT_10, BENCH_EVT_11, BENCH_EVT_12, BENCH_EVT_13,
+    BENCH_EVT_14, BENCH_EVT_15, BENCH_EVT_16, BENCH_EVT_17, BENCH_EVT_18, BENCH_EVT_19, BENCH_EVT_20,
+    BENCH_EVT_21, BENCH_EVT_22, BENCH_EVT_23, BENCH_EVT_24, BENCH_EVT_25, BENCH_EVT_26, BENCH_EVT_27,
+    BENCH_EVT_28, BENCH_EVT_29, BENCH_EVT_30, BENCH_EVT_31, BENCH_EVT_32, BENCH_EVT_33
+} bench_evt_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static const char *const bench_evt_names[] =
+{
+    APP_FMT_NAME( BENCH_EVT_0 ) APP_FMT_NAME( BENCH_EVT_1 ) APP_FMT_NAME( BENCH_EVT_2 )
+    APP_FMT_NAME( BENCH_EVT_3 ) APP_FMT_NAME( BENCH_EVT_4 ) APP_FMT_NAME( BENCH_EVT_5 )
+    APP_FMT_NAME( BENCH_EVT_6 ) APP_FMT_NAME( BENCH_EVT_7 ) APP_FMT_NAME( BENCH_EVT_8 )
+    APP_FMT_NAME( BENCH_EVT_9 ) APP_FMT_NAME( BENCH_EVT_10 ) APP_FMT_NAME( BENCH_EVT_11 )
+    APP_FMT_NAME( BENCH_EVT_12 ) APP_FMT_NAME( BENCH_EVT_13 ) APP_FMT_NAME( BENCH_EVT_14 )
+    APP_FMT_NAME( BENCH_EVT_15 ) APP_FMT_NAME( BENCH_EVT_16 ) APP_FMT_NAME( BENCH_EVT_17 )
+    APP_FMT_NAME( BENCH_EVT_18 ) APP_FMT_NAME( BENCH_EVT_19 ) APP_FMT_NAME( BENCH_EVT_20 )
+    APP_FMT_NAME( BENCH_EVT_21 ) APP_FMT_NAME( BENCH_EVT_22 ) APP_FMT_NAME( BENCH_EVT_23 )
+    APP_FMT_NAME( BENCH_EVT_24 ) APP_FMT_NAME( BENCH_EVT_25 ) APP_FMT_NAME( BENCH_EVT_26 )
+    APP_FMT_NAME( BENCH_EVT_27 ) APP_FMT_NAME( BENCH_EVT_28 ) APP_FMT_NAME( BENCH_EVT_29 )
+    APP_FMT_NAME( BENCH_EVT_30 ) APP_FMT_NAME( BENCH_EVT_31 ) APP_FMT_NAME( BENCH_EVT_32 )
+    APP_FMT_NAME( BENCH_EVT_33 )
+};
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+#define BENCH_CASE( c ) case c: return #c;
+
+/* the switch form of the get_bt_*_name() functions before app_fmt */
+static const char *bench_evt_switch( int evt )
+{
+    switch ( evt )
+    {
+    BENCH_CASE( BENCH_EVT_0 ) BENCH_CASE( BENCH_EVT_1 ) BENCH_CASE( BENCH_EVT_2 )
+    BENCH_CASE( BENCH_EVT_3 ) BENCH_CASE( BENCH_EVT_4 ) BENCH_CASE( BENCH_EVT_5 )
+    BENCH_CASE( BENCH_EVT_6 ) BENCH_CASE( BENCH_EVT_7 ) BENCH_CASE( BENCH_EVT_8 )
+    BENCH_CASE( BENCH_EVT_9 ) BENCH_CASE( BENCH_EVT_10 ) BENCH_CASE( BENCH_EVT_11 )
+    BENCH_CASE( BENCH_EVT_12 ) BENCH_CASE( BENCH_EVT_13 ) BENCH_CASE( BENCH_EVT_14 )
+    BENCH_CASE( BENCH_EVT_15 ) BENCH_CASE( BENCH_EVT_16 ) BENCH_CASE( BENCH_EVT_17 )
+    BENCH_CASE( BENCH_EVT_18 ) BENCH_CASE( BENCH_EVT_19 ) BENCH_CASE( BENCH_EVT_20 )
+    BENCH_CASE( BENCH_EVT_21 ) BENCH_CASE( BENCH_EVT_22 ) BENCH_CASE( BENCH_EVT_23 )
+    BENCH_CASE( BENCH_EVT_24 ) BENCH_CASE( BENCH_EVT_25 ) BENCH_CASE( BENCH_EVT_26 )
+    BENCH_CASE( BENCH_EVT_27 ) BENCH_CASE( BENCH_EVT_28 ) BENCH_CASE( BENCH_EVT_29 )
+    BENCH_CASE( BENCH_EVT_30 ) BENCH_CASE( BENCH_EVT_31 ) BENCH_CASE( BENCH_EVT_32 )
+    BENCH_CASE( BENCH_EVT_33 )
+    default: break;
+    }
+    return "UNKNOWN_EVENT";
+}
+
+#undef BENCH_CASE
+
+static void bench_fmt_bdaddr_snprintf_fn( void *p_arg, uint64_t iters )
+{
+    bench_fmt_ctx_t *p_ctx = (bench_fmt_ctx_t *)p_arg;
+    char line[APP_FMT_BDADDR_LEN];
+    const uint8_t *a = p_ctx->addr;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->addr[5] = (uint8_t)n;
+        snprintf( line, sizeof( line ), "%02X:%02X:%02X:%02X:%02X:%02X", a[0], a[1], a[2], a[3], a[4], a[5] );
+        BENCH_KEEP( line[16] );
+    }
+}
+
+static void bench_fmt_bdaddr_lut_fn( void *p_arg, uint64_t iters )
+{
+    bench_fmt_ctx_t *p_ctx = (bench_fmt_ctx_t *)p_arg;
+    char line[APP_FMT_BDADDR_LEN];
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->addr[5] = (uint8_t)n;
+        app_fmt_bdaddr( line, p_ctx->addr );
+        BENCH_KEEP( line[16] );
+    }
+}
+
+static void bench_fmt_hex_snprintf_fn( void *p_arg, uint64_t iters )
+{
+    bench_fmt_ctx_t *p_ctx = (bench_fmt_ctx_t *)p_arg;
+    char line[2 * BENCH_FMT_PAYLOAD_MAX + 1];
+    uint64_t n;
+    uint32_t i;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->data[0] = (uint8_t)n;
+        for ( i = 0; i < p_ctx->len; i++ )
+        {
+            snprintf( &line[2 * i], 3, "%02X", p_ctx->data[i] );
+        }
+        BENCH_KEEP( line[0] );
+    }
+}
+
+static void bench_fmt_hex_lut_fn( void *p_arg, uint64_t iters )
+{
+    bench_fmt_ctx_t *p_ctx = (bench_fmt_ctx_t *)p_arg;
+    char line[2 * BENCH_FMT_PAYLOAD_MAX + 1];
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p_ctx->data[0] = (uint8_t)n;
+        app_fmt_hex( line, p_ctx->data, p_ctx->len );
+        BENCH_KEEP( line[0] );
+    }
+}
+
+/* print_array() before app_fmt: one printf per byte */
+static void bench_fmt_print_printf_fn( void *p_arg, uint64_t iters )
+{
+    bench_fmt_ctx_t *p_ctx = (bench_fmt_ctx_t *)p_arg;
+    uint64_t n;
+    uint32_t i;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        for ( i = 0; i < p_ctx->len; i++ )
+        {
+            if ( 0 == i % 16 )
+            {
+                fprintf( p_ctx->p_null, "\n" );
+            }
+            fprintf( p_ctx->p_null, "%02X ", p_ctx->data[i] );
+        }
+        fprintf( p_ctx->p_null, "\n" );
+    }
+}
+
+static void bench_fmt_print_lut_fn( void *p_arg, uint64_t iters )
+{
+    bench_fmt_ctx_t *p_ctx = (bench_fmt_ctx_t *)p_arg;
+    char line[APP_FMT_HEX_DUMP_LEN( BENCH_FMT_PAYLOAD_MAX ) + 1];
+    size_t len;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        len = app_fmt_hex_dump( line, p_ctx->data, p_ctx->len, 0 );
+        line[len++] = '\n';
+        fwrite( line, 1, len, p_ctx->p_null );
+    }
+}
+
+static void bench_fmt_name_switch_fn( void *p_arg, uint64_t iters )
+{
+    uint64_t n, sum = 0;
+
+    (void)p_arg;
+    for ( n = 0; n < iters; n++ )
+    {
+        sum += (uintptr_t)bench_evt_switch( (int)( ( n * 7U ) % ( BENCH_FMT_NAMES + 2U ) ) );
+    }
+    BENCH_KEEP( sum );
+}
+
+static void bench_fmt_name_table_fn( void *p_arg, uint64_t iters )
+{
+    const char *p_name;
+    uint64_t n, sum = 0;
+
+    (void)p_arg;
+    for ( n = 0; n < iters; n++ )
+    {
+        p_name = app_fmt_name( bench_evt_names, APP_FMT_NAMES_COUNT( bench_evt_names ),
+                               (unsigned int)( ( n * 7U ) % ( BENCH_FMT_NAMES + 2U ) ) );
+        sum += (uintptr_t)( p_name != NULL ? p_name : "UNKNOWN_EVENT" );
+    }
+    BENCH_KEEP( sum );
+}
+
+/******************************************************************************
+ * Function Name: bench_fmt_run()
+ ******************************************************************************
+ * Summary:
+ *   Formatting suite entry point
+ *
+ *****************************************************************************/
+void bench_fmt_run( const bench_opts_t *p_opts )
+{
+    static const uint32_t lens[] = { 31U, BENCH_FMT_PAYLOAD_MAX };
+    static bench_fmt_ctx_t ctx;
+    char name[64];
+    uint32_t i;
+
+    ctx.p_null = fopen( "/dev/null", "w" );
+    if ( ctx.p_null == NULL )
+    {
+        fprintf( stderr, "open /dev/null failed\n" );
+        return;
+    }
+    memcpy( ctx.addr, "\x00\xA0\x50\x12\x34\x56", sizeof( ctx.addr ) );
+    for ( i = 0; i < BENCH_FMT_PAYLOAD_MAX; i++ )
+    {
+        ctx.data[i] = (uint8_t)( i * 37U + 11U );
+    }
+
+    bench_run( p_opts, "fmt", "bdaddr/snprintf", bench_fmt_bdaddr_snprintf_fn, &ctx );
+    bench_run( p_opts, "fmt", "bdaddr/lut", bench_fmt_bdaddr_lut_fn, &ctx );
+    for ( i = 0; i < sizeof( lens ) / sizeof( lens[0] ); i++ )
+    {
+        ctx.len = lens[i];
+        snprintf( name, sizeof( name ), "hex/snprintf/%u", (unsigned)lens[i] );
+        bench_run( p_opts, "fmt", name, bench_fmt_hex_snprintf_fn, &ctx );
+        snprintf( name, sizeof( name ), "hex/lut/%u", (unsigned)lens[i] );
+        bench_run( p_opts, "fmt", name, bench_fmt_hex_lut_fn, &ctx );
+        snprintf( name, sizeof( name ), "print_array/printf/%u", (unsigned)lens[i] );
+        bench_run( p_opts, "fmt", name, bench_fmt_print_printf_fn, &ctx );
+        snprintf( name, sizeof( name ), "print_array/lut/%u", (unsigned)lens[i] );
+        bench_run( p_opts, "fmt", name, bench_fmt_print_lut_fn, &ctx );
+    }
+    bench_run( p_opts, "fmt", "name/switch", bench_fmt_name_switch_fn, &ctx );
+    bench_run( p_opts, "fmt", "name/table", bench_fmt_name_table_fn, &ctx );
+
+    fclose( ctx.p_null );
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,158 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: bench_main.c
+ *
+ * Description: This is the entry point of wakeonle_bench.
+ *
+ *              Usage: wakeonle_bench [--filter <text>] [--time <ms>]
+ *                                    [--adv-file <path>] [--samples <n>]
+ *                                    [--json]
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static const bench_suite_t bench_suites[] =
+{
+    { "adv",     bench_adv_run },
+    { "devices", bench_device_table_run },
+    { "fmt",     bench_fmt_run },
+    { "event",   bench_event_run },
+    { "trace",   bench_trace_run },
+    { "capture", bench_capture_run },
+    { "slab",    bench_slab_run },
+};
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: bench_usage()
+ ******************************************************************************
+ * Summary:
+ *   Print the command line help
+ *
+ *****************************************************************************/
+static void bench_usage( const char *p_prog )
+{
+    printf( "Usage: %s [--filter <text>] [--time <ms>] [--adv-file <path>] [--samples <n>] [--json]\n"
+            "  --filter <text>    run benchmarks whose suite or name contains text\n"
+            "  --time <ms>        measuring time per benchmark, default %u\n"
+            "  --adv-file <path>  recorded advertising payloads, one hex string per line\n"
+            "  --samples <n>      samples per benchmark, default %u, at most %u\n"
+            "  --json             print one JSON document instead of text\n",
+            p_prog, BENCH_MIN_TIME_MS_DEFAULT, BENCH_SAMPLES, BENCH_SAMPLES_MAX );
+}
+
+/******************************************************************************
+ * Function Name: main()
+ ******************************************************************************
+ * Summary:
+ *   Parse the options and run every suite
+ *
+ *****************************************************************************/
+int main( int argc, char *argv[] )
+{
+    bench_opts_t opts = { NULL, NULL, BENCH_MIN_TIME_MS_DEFAULT, BENCH_SAMPLES, 0 };
+    uint32_t i;
+    int a;
+
+    for ( a = 1; a < argc; a++ )
+    {
+        if ( ( strcmp( argv[a], "--filter" ) == 0 ) && ( a + 1 < argc ) )
+        {
+            opts.p_filter = argv[++a];
+        }
+        else if ( ( strcmp( argv[a], "--time" ) == 0 ) && ( a + 1 < argc ) )
+        {
+            opts.min_time_ms = (uint32_t)strtoul( argv[++a], NULL, 0 );
+        }
+        else if ( ( strcmp( argv[a], "--adv-file" ) == 0 ) && ( a + 1 < argc ) )
+        {
+            opts.p_adv_file = argv[++a];
+        }
+        else if ( ( strcmp( argv[a], "--samples" ) == 0 ) && ( a + 1 < argc ) )
+        {
+            opts.samples = (uint32_t)strtoul( argv[++a], NULL, 0 );
+        }
+        else if ( strcmp( argv[a], "--json" ) == 0 )
+        {
+            opts.json = 1;
+        }
+        else
+        {
+            bench_usage( argv[0] );
+            return ( strcmp( argv[a], "--help" ) == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ( opts.min_time_ms == 0 )
+    {
+        opts.min_time_ms = BENCH_MIN_TIME_MS_DEFAULT;
+    }
+    if ( ( opts.samples == 0 ) || ( opts.samples > BENCH_SAMPLES_MAX ) )
+    {
+        opts.samples = BENCH_SAMPLES;
+    }
+
+    /* a stream of its own, the trace suite points stdout at /dev/null */
+    p_bench_out = fdopen( dup( STDOUT_FILENO ), "w" );
+    if ( p_bench_out == NULL )
+    {
+        p_bench_out = stdout;
+    }
+
+    bench_report_begin( &opts );
+    for ( i = 0; i < sizeof( bench_suites ) / sizeof( bench_suites[0] ); i++ )
+    {
+        bench_suites[i].run( &opts );
+    }
+    bench_report_end( &opts );
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
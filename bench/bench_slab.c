@@ -0,0 +1,278 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: bench_slab.c
+ *
+ * Description: This is the source file for the buffer pool benchmarks: the
+ *              app_slab pool behind app_alloc_buffer() against malloc/free,
+ *              one buffer at a time, in bursts that keep a queue's worth
+ *              of buffers in flight, and handed to a second thread that
+ *              frees them, as the stack callback and the scan worker do.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "bench.h"
+#include "app_slab.h"
+#include "app_spsc_ring.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define BENCH_SLAB_LEGACY                   ( 31U )
+#define BENCH_SLAB_EXTENDED                 ( 255U )
+#define BENCH_SLAB_BURST                    ( 64U )
+#define BENCH_SLAB_HANDOFF_DEPTH            ( 32U )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    app_slab_pool_t pool;
+    uint32_t        len;
+    void            *p_burst[BENCH_SLAB_BURST];
+    /* handoff */
+    app_spsc_ring_t ring;
+    int             use_slab;
+    volatile int    stop;
+} bench_slab_ctx_t;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static void bench_slab_one_slab_fn( void *p_arg, uint64_t iters )
+{
+    bench_slab_ctx_t *p_ctx = (bench_slab_ctx_t *)p_arg;
+    uint8_t *p;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p = (uint8_t *)app_slab_alloc( &p_ctx->pool, p_ctx->len );
+        p[0] = (uint8_t)n;
+        BENCH_KEEP( (uintptr_t)p + p[0] );
+        app_slab_free( &p_ctx->pool, p );
+    }
+}
+
+static void bench_slab_one_malloc_fn( void *p_arg, uint64_t iters )
+{
+    bench_slab_ctx_t *p_ctx = (bench_slab_ctx_t *)p_arg;
+    uint8_t *p;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        p = (uint8_t *)malloc( p_ctx->len );
+        p[0] = (uint8_t)n;
+        BENCH_KEEP( (uintptr_t)p + p[0] );
+        free( p );
+    }
+}
+
+/* one iteration allocates and frees BENCH_SLAB_BURST buffers */
+static void bench_slab_burst_slab_fn( void *p_arg, uint64_t iters )
+{
+    bench_slab_ctx_t *p_ctx = (bench_slab_ctx_t *)p_arg;
+    uint64_t n;
+    uint32_t i;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        for ( i = 0; i < BENCH_SLAB_BURST; i++ )
+        {
+            p_ctx->p_burst[i] = app_slab_alloc( &p_ctx->pool, ( i & 3U ) ? BENCH_SLAB_LEGACY : BENCH_SLAB_EXTENDED );
+        }
+        BENCH_KEEP( p_ctx->p_burst[n % BENCH_SLAB_BURST] != NULL );
+        for ( i = 0; i < BENCH_SLAB_BURST; i++ )
+        {
+            app_slab_free( &p_ctx->pool, p_ctx->p_burst[i] );
+        }
+    }
+}
+
+static void bench_slab_burst_malloc_fn( void *p_arg, uint64_t iters )
+{
+    bench_slab_ctx_t *p_ctx = (bench_slab_ctx_t *)p_arg;
+    uint64_t n;
+    uint32_t i;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        for ( i = 0; i < BENCH_SLAB_BURST; i++ )
+        {
+            p_ctx->p_burst[i] = malloc( ( i & 3U ) ? BENCH_SLAB_LEGACY : BENCH_SLAB_EXTENDED );
+        }
+        BENCH_KEEP( p_ctx->p_burst[n % BENCH_SLAB_BURST] != NULL );
+        for ( i = 0; i < BENCH_SLAB_BURST; i++ )
+        {
+            free( p_ctx->p_burst[i] );
+        }
+    }
+}
+
+/* consumer thread of the handoff benchmarks */
+static void *bench_slab_free_thread( void *p_arg )
+{
+    bench_slab_ctx_t *p_ctx = (bench_slab_ctx_t *)p_arg;
+    void **pp_slot;
+
+    while ( !p_ctx->stop )
+    {
+        pp_slot = (void **)app_spsc_ring_peek( &p_ctx->ring );
+        if ( pp_slot == NULL )
+        {
+            sched_yield();
+            continue;
+        }
+        if ( p_ctx->use_slab )
+        {
+            app_slab_free( &p_ctx->pool, *pp_slot );
+        }
+        else
+        {
+            free( *pp_slot );
+        }
+        app_spsc_ring_release( &p_ctx->ring );
+    }
+    return NULL;
+}
+
+/* allocate here, free on the consumer thread */
+static void bench_slab_handoff_fn( void *p_arg, uint64_t iters )
+{
+    bench_slab_ctx_t *p_ctx = (bench_slab_ctx_t *)p_arg;
+    void **pp_slot;
+    void *p;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        while ( ( p = p_ctx->use_slab ? app_slab_alloc( &p_ctx->pool, BENCH_SLAB_LEGACY ) : malloc( BENCH_SLAB_LEGACY ) ) == NULL )
+        {
+            sched_yield();
+        }
+        while ( ( pp_slot = (void **)app_spsc_ring_reserve( &p_ctx->ring ) ) == NULL )
+        {
+            sched_yield();
+        }
+        *pp_slot = p;
+        app_spsc_ring_commit( &p_ctx->ring );
+    }
+}
+
+static void bench_slab_handoff( const bench_opts_t *p_opts, bench_slab_ctx_t *p_ctx, int use_slab, const char *p_name )
+{
+    pthread_t consumer;
+    void **pp_slot;
+
+    p_ctx->use_slab = use_slab;
+    p_ctx->stop = 0;
+    if ( pthread_create( &consumer, NULL, bench_slab_free_thread, p_ctx ) != 0 )
+    {
+        fprintf( stderr, "create consumer thread failed\n" );
+        return;
+    }
+    bench_run( p_opts, "slab", p_name, bench_slab_handoff_fn, p_ctx );
+    p_ctx->stop = 1;
+    pthread_join( consumer, NULL );
+
+    /* drain what the consumer left behind */
+    while ( ( pp_slot = (void **)app_spsc_ring_peek( &p_ctx->ring ) ) != NULL )
+    {
+        if ( use_slab )
+        {
+            app_slab_free( &p_ctx->pool, *pp_slot );
+        }
+        else
+        {
+            free( *pp_slot );
+        }
+        app_spsc_ring_release( &p_ctx->ring );
+    }
+}
+
+/******************************************************************************
+ * Function Name: bench_slab_run()
+ ******************************************************************************
+ * Summary:
+ *   Buffer pool suite entry point
+ *
+ *****************************************************************************/
+void bench_slab_run( const bench_opts_t *p_opts )
+{
+    static const uint32_t sizes[] = { BENCH_SLAB_LEGACY, BENCH_SLAB_EXTENDED };
+    static const uint32_t counts[] = { BENCH_SLAB_BURST, BENCH_SLAB_BURST };
+    static const uint32_t lens[] = { BENCH_SLAB_LEGACY, BENCH_SLAB_EXTENDED };
+    static bench_slab_ctx_t ctx;
+    char name[64];
+    uint32_t i;
+
+    if ( ( app_slab_init( &ctx.pool, sizes, counts, 2, APP_SLAB_EXHAUST_NEXT_CLASS ) != APP_SLAB_SUCCESS ) ||
+         ( app_spsc_ring_init( &ctx.ring, sizeof( void * ), BENCH_SLAB_HANDOFF_DEPTH ) != APP_SPSC_RING_SUCCESS ) )
+    {
+        fprintf( stderr, "slab init failed\n" );
+        app_slab_deinit( &ctx.pool );
+        return;
+    }
+
+    for ( i = 0; i < sizeof( lens ) / sizeof( lens[0] ); i++ )
+    {
+        ctx.len = lens[i];
+        snprintf( name, sizeof( name ), "one/slab/%u", (unsigned)lens[i] );
+        bench_run( p_opts, "slab", name, bench_slab_one_slab_fn, &ctx );
+        snprintf( name, sizeof( name ), "one/malloc/%u", (unsigned)lens[i] );
+        bench_run( p_opts, "slab", name, bench_slab_one_malloc_fn, &ctx );
+    }
+    bench_run( p_opts, "slab", "burst64/slab", bench_slab_burst_slab_fn, &ctx );
+    bench_run( p_opts, "slab", "burst64/malloc", bench_slab_burst_malloc_fn, &ctx );
+    bench_slab_handoff( p_opts, &ctx, 1, "handoff/slab" );
+    bench_slab_handoff( p_opts, &ctx, 0, "handoff/malloc" );
+
+    app_spsc_ring_deinit( &ctx.ring );
+    app_slab_deinit( &ctx.pool );
+}
+
+/* [] END OF FILE */
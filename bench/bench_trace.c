@@ -0,0 +1,144 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: bench_trace.c
+ *
+ * Description: This is the source file for the log record emission
+ *              benchmarks: a TRACE_* call queued to the asynchronous
+ *              logger, with numbers only and with a string argument, and
+ *              the same call formatted and written on the calling thread,
+ *              as before app_trace_start(). stdout points at /dev/null
+ *              while the suite runs. The queued benchmarks wait for the
+ *              formatter every half ring, outside the measured time, so
+ *              they measure the caller's cost and no record is dropped.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench.h"
+#include "app_time.h"
+#include "app_trace.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define TAG                                 "[BENCH]"
+#define BENCH_TRACE_BATCH                   ( APP_TRACE_RING_DEPTH / 2 )
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static void bench_trace_int_fn( void *p_arg, uint64_t iters )
+{
+    uint64_t n;
+
+    (void)p_arg;
+    for ( n = 0; n < iters; n++ )
+    {
+        if ( ( n % BENCH_TRACE_BATCH ) == BENCH_TRACE_BATCH - 1 )
+        {
+            bench_pause();
+            app_trace_flush();
+            bench_resume();
+        }
+        APP_TRACE( APP_TRACE_KIND_LOG, "report %u rssi %d filter %d\n", (unsigned)n, -67, 3 );
+    }
+}
+
+static void bench_trace_str_fn( void *p_arg, uint64_t iters )
+{
+    const char *p_addr = (const char *)p_arg;
+    uint64_t n;
+
+    for ( n = 0; n < iters; n++ )
+    {
+        if ( ( n % BENCH_TRACE_BATCH ) == BENCH_TRACE_BATCH - 1 )
+        {
+            bench_pause();
+            app_trace_flush();
+            bench_resume();
+        }
+        APP_TRACE( APP_TRACE_KIND_LOG, "Got ADV from:%s\n", p_addr );
+    }
+}
+
+/******************************************************************************
+ * Function Name: bench_trace_run()
+ ******************************************************************************
+ * Summary:
+ *   Log emission suite entry point
+ *
+ *****************************************************************************/
+void bench_trace_run( const bench_opts_t *p_opts )
+{
+    static char addr[] = "C4:5A:21:80:9B:E3";
+    int saved_fd, null_fd;
+
+    null_fd = open( "/dev/null", O_WRONLY | O_CLOEXEC );
+    fflush( stdout );
+    saved_fd = dup( STDOUT_FILENO );
+    if ( ( null_fd < 0 ) || ( saved_fd < 0 ) || ( dup2( null_fd, STDOUT_FILENO ) < 0 ) )
+    {
+        fprintf( stderr, "redirect stdout failed\n" );
+        return;
+    }
+    close( null_fd );
+
+    app_time_init();
+    app_trace_level = APP_TRACE_LEVEL_DEBUG;
+    if ( app_trace_start() == APP_TRACE_SUCCESS )
+    {
+        bench_run( p_opts, "trace", "queue/3int", bench_trace_int_fn, NULL );
+        bench_run( p_opts, "trace", "queue/str", bench_trace_str_fn, addr );
+        app_trace_stop();
+    }
+    /* stopped: formatted and written by the caller */
+    bench_run( p_opts, "trace", "sync/3int", bench_trace_int_fn, NULL );
+    bench_run( p_opts, "trace", "sync/str", bench_trace_str_fn, addr );
+
+    fflush( stdout );
+    dup2( saved_fd, STDOUT_FILENO );
+    close( saved_fd );
+}
+
+/* [] END OF FILE */
@@ -42,20 +42,62 @@
 #define __LOG_H__
 
 #define TAG ""
+
+#include <stdio.h>
+#include "app_trace.h"
+
+/* Trace levels, TRACE_MSG (console interaction) is never filtered */
+#define TRACE_LEVEL_NONE    APP_TRACE_LEVEL_NONE
+#define TRACE_LEVEL_ERR     APP_TRACE_LEVEL_ERR
+#define TRACE_LEVEL_INFO    APP_TRACE_LEVEL_INFO
+#define TRACE_LEVEL_DEBUG   APP_TRACE_LEVEL_DEBUG
+
+/* Compile time level, set from CMake: WAKEONLE_TRACE_LEVEL for every file,
+ * WAKEONLE_TRACE_LEVEL_<MODULE> for the files of one TAG. Calls above it
+ * expand to dead code: arguments are type checked, never evaluated, and no
+ * code or call site data is emitted. */
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_DEBUG
+#endif
+#ifndef TRACE_MODULE_LEVEL
+#define TRACE_MODULE_LEVEL TRACE_LEVEL
+#endif
+
+/* runtime level (--log-level), one predictable branch per compiled in call */
+#define TRACE_ON(lvl_) __builtin_expect((lvl_) <= app_trace_level, 1)
+#define TRACE_NOP(f_, ...) do { if (0) { printf((f_), ##__VA_ARGS__); } } while (0)
+
+/* TRACE_LOG / TRACE_ERR / TRACE_DBG lines start with the CLOCK_MONOTONIC
+ * time of the call, "[sec.nsec]" */
+#if defined(APP_TRACE_ASYNC) && APP_TRACE_ASYNC
+/* TRACE_LOG / TRACE_ERR queue a binary record, see app_trace.h.
+ * TRACE_MSG is console interaction: it waits for queued records, then prints. */
+#define TRACE_MSG(f_, ...) app_trace_flush(), printf((f_), ##__VA_ARGS__), printf("\n")
+#define TRACE_EMIT_LOG(f_, ...) APP_TRACE(APP_TRACE_KIND_LOG, f_, ##__VA_ARGS__)
+#define TRACE_EMIT_ERR(f_, ...) APP_TRACE(APP_TRACE_KIND_ERR, f_, ##__VA_ARGS__)
+#else
 #define TRACE_MSG(f_, ...) printf((f_), ##__VA_ARGS__), printf("\n")
-#define TRACE_LOG(f_, ...) printf("%s", TAG), printf("[%s]:", __func__), printf((f_), ##__VA_ARGS__), printf("\n")
-#define TRACE_ERR(f_, ...) printf("%s[ERROR]", TAG), printf("[%s]:", __func__), printf((f_), ##__VA_ARGS__), printf("\n")
-
-#if 0
-#define TRACE_LOG_TIME(f_, ...) printf("%s ", timestamp()), printf("%s", TAG), printf("[%s]:", __func__), printf((f_), ##__VA_ARGS__), printf("\n")
-#define TRACE_ERR_TIME(f_, ...) printf("%s ", timestamp()), printf("%s[ERROR]", TAG), printf("[%s]:", __func__), printf((f_), ##__VA_ARGS__), printf("\n")
-char * timestamp();
-char * timestamp(){
-    time_t now = time(NULL);
-    char * time = asctime(gmtime(&now));
-    time[strlen(time)-1] = '\0';
-    return time;
-}
+#define TRACE_EMIT_LOG(f_, ...) app_trace_stamp(), printf("%s", TAG), printf("[%s]:", __func__), printf((f_), ##__VA_ARGS__), printf("\n")
+#define TRACE_EMIT_ERR(f_, ...) app_trace_stamp(), printf("%s[ERROR]", TAG), printf("[%s]:", __func__), printf((f_), ##__VA_ARGS__), printf("\n")
+#endif
+
+#if TRACE_MODULE_LEVEL >= TRACE_LEVEL_ERR
+#define TRACE_ERR(f_, ...) do { if (TRACE_ON(TRACE_LEVEL_ERR)) { TRACE_EMIT_ERR(f_, ##__VA_ARGS__); } } while (0)
+#else
+#define TRACE_ERR(f_, ...) TRACE_NOP(f_, ##__VA_ARGS__)
+#endif
+
+#if TRACE_MODULE_LEVEL >= TRACE_LEVEL_INFO
+#define TRACE_LOG(f_, ...) do { if (TRACE_ON(TRACE_LEVEL_INFO)) { TRACE_EMIT_LOG(f_, ##__VA_ARGS__); } } while (0)
+#else
+#define TRACE_LOG(f_, ...) TRACE_NOP(f_, ##__VA_ARGS__)
+#endif
+
+/* function entry and per report traces */
+#if TRACE_MODULE_LEVEL >= TRACE_LEVEL_DEBUG
+#define TRACE_DBG(f_, ...) do { if (TRACE_ON(TRACE_LEVEL_DEBUG)) { TRACE_EMIT_LOG(f_, ##__VA_ARGS__); } } while (0)
+#else
+#define TRACE_DBG(f_, ...) TRACE_NOP(f_, ##__VA_ARGS__)
 #endif
 
 
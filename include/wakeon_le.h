@@ -43,17 +43,50 @@
 #ifndef __APP_WAKEON_LE_H__
 #define __APP_WAKEON_LE_H__
 
+#include "wiced_bt_dev.h"
+#include "wiced_bt_cfg.h"
+#include "platform_linux.h"
+#include "data_types.h"
+
 /******************************************************************************
 *       MACRO
 ******************************************************************************/
 #define LE_PCF_MANUFACTURE_DATA_LEN_MAX            29U
 #define LE_PCF_COMANY_ID_LEN                       2U
 #define LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX    27U
+/* host side pattern limit with extended scanning, see --scan-phy; the
+ * controller filter gets the first LE_PCF_MANUFACTURE_DATA_PATTERN_LEN_MAX */
+#define LE_EXT_MANUFACTURE_DATA_PATTERN_LEN_MAX    251U
 #define COMPANY_ID				   0x0009
 
 /******************************************************************************
 *       TYPEDEF 
 ******************************************************************************/
+/* State of the controller this process drives. The BT stack and the porting
+ * layer serve one HCI transport per process, so a gateway with several
+ * radios runs one process per radio (see wakeon_le_radio.h), each with its
+ * own context, GPIO pair, APCF filters and sleep state machine. */
+typedef struct
+{
+    /* local address set on BTM_ENABLED_EVT, from -a or the default */
+    wiced_bt_device_address_t       bd_addr;
+    /* Autobaud, DEV-WAKE and HOST-WAKE GPIO configuration */
+    cybt_controller_gpio_config_t   gpio_cfg;
+    /* controller armed and in UART sleep mode */
+    BOOL32                          in_sleep;
+    /* wake rule: service UUID plus optional manufacturer data */
+    tBT_UUID                        uuid;
+    uint16_t                        company_id;
+    uint16_t                        company_id_mask;
+    uint32_t                        data_len;
+    uint8_t                         pattern[LE_EXT_MANUFACTURE_DATA_PATTERN_LEN_MAX];
+    uint8_t                         pattern_mask[LE_EXT_MANUFACTURE_DATA_PATTERN_LEN_MAX];
+    uint8_t                         apcf_filter_idx;
+    /* start of the current arm sequence, for the arm latency histogram */
+    uint64_t                        arm_start_ns;
+    /* time of the last HOST-WAKE, 0 before the first */
+    uint64_t                        wake_ns;
+} wakeon_le_ctrl_t;
 
 /******************************************************************************
 *       FUNCTION PROTOTYPE
@@ -63,6 +96,17 @@ void app_disable_wake_on_le();
 void app_enable_wake_on_le();
 void app_enable_wake_on_le_uuid();
 void app_enable_wake_on_le_uuid_manu();
+BOOL32 app_enable_wake_on_le_rule(const char* p_rule);
+void* app_alloc_buffer(int len);
+void app_free_buffer(uint8_t *p_event_data);
+void app_print_startup(void);
+void app_start_replay(void);
+
+/* the controller of this process */
+extern wakeon_le_ctrl_t wakeon_le_ctrl;
+
+/* low duty scan settings, adjusted by --scan-interval and --scan-window */
+extern wiced_bt_cfg_ble_scan_settings_t cy_bt_cfg_scan_settings;
 
 /* BT LE configuration settings */     
 extern const  wiced_bt_cfg_settings_t wiced_bt_cfg_settings;
@@ -0,0 +1,67 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: wakeon_le_heap.h
+ *
+ * Description: This is the header file for the BT stack heap accounting.
+ *              Heaps created through wakeon_le_heap_create() are exported
+ *              with the application metrics, and a calibration mode
+ *              recommends a --heap-size from the observed high-water mark.
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+ *****************************************************************************/
+
+#ifndef __APP_WAKEON_LE_HEAP_H__
+#define __APP_WAKEON_LE_HEAP_H__
+
+#include "wiced_memory.h"
+#include "data_types.h"
+
+/******************************************************************************
+*       MACRO
+******************************************************************************/
+#define WAKEON_LE_HEAP_MAX                  4U
+/* heap size while calibrating, large enough not to be the limit */
+#define WAKEON_LE_HEAP_CALIBRATE_SIZE       (256U * 1024U)
+
+/******************************************************************************
+*       FUNCTION PROTOTYPE
+******************************************************************************/
+wiced_bt_heap_t* wakeon_le_heap_create(const char* name, uint32_t size, wiced_bool_t make_default);
+uint32_t wakeon_le_heap_recommend(const wiced_bt_heap_statistics_t* p_stats);
+BOOL32 wakeon_le_heap_calibrate_start(wiced_bt_heap_t* p_heap, uint32_t interval_s);
+
+#endif /* __APP_WAKEON_LE_HEAP_H__ */
@@ -0,0 +1,74 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: wakeon_le_replay.h
+ *
+ * Description: This is the header file for the advertising trace replay.
+ *              A btsnoop or --capture file is replayed into a report
+ *              callback, with each report's data length, at its recorded pace, a multiple of it, or as fast as
+ *              possible, and the throughput, latency and drops of the host
+ *              report path are printed when it ends.
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+ *****************************************************************************/
+
+#ifndef __APP_WAKEON_LE_REPLAY_H__
+#define __APP_WAKEON_LE_REPLAY_H__
+
+#include "wiced_bt_ble.h"
+#include "data_types.h"
+
+/******************************************************************************
+*       MACRO
+******************************************************************************/
+/* --replay-speed 0: no pacing */
+#define WAKEON_LE_REPLAY_SPEED_MAX          0U
+
+/******************************************************************************
+*       TYPE DEFINITIONS
+******************************************************************************/
+/* takes a replayed report and the length of its AD data, eg: wakeon_le_scan_submit() */
+typedef void (wakeon_le_replay_cback_t)(const wiced_bt_ble_scan_results_t* p_scan_result,
+                                        const uint8_t* p_adv_data, uint16_t adv_len);
+
+/******************************************************************************
+*       FUNCTION PROTOTYPE
+******************************************************************************/
+BOOL32 wakeon_le_replay_start(const char* path, uint32_t speed, uint32_t loops,
+                              wakeon_le_replay_cback_t* p_cback);
+BOOL32 wakeon_le_replay_running(void);
+void wakeon_le_replay_stop(void);
+
+#endif /* __APP_WAKEON_LE_REPLAY_H__ */
@@ -0,0 +1,102 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: wakeon_le_scan.h
+ *
+ * Description: This is the header file for the advertising report pipeline.
+ *              The stack callback only copies each report into a
+ *              preallocated SPSC ring; a worker thread does the parsing,
+ *              filtering and output.
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+ *****************************************************************************/
+
+#ifndef __APP_WAKEON_LE_SCAN_H__
+#define __APP_WAKEON_LE_SCAN_H__
+
+#include "wiced_bt_ble.h"
+#include "data_types.h"
+#include "app_adv_match.h"
+#include "app_device_table.h"
+
+/******************************************************************************
+*       MACRO
+******************************************************************************/
+/* legacy advertising data, the stack reports scan responses separately */
+#define WAKEON_LE_SCAN_ADV_DATA_MAX         31U
+/* extended advertising data kept per report, with --scan-phy or --replay */
+#define WAKEON_LE_SCAN_EXT_ADV_DATA_MAX     255U
+/* report latency histogram: exact below 4 ns, then 4 buckets per power of 2
+ * up to about 8 s */
+#define WAKEON_LE_SCAN_LATENCY_BUCKETS      128U
+
+/******************************************************************************
+*       TYPEDEF
+******************************************************************************/
+/* one queued advertising report */
+typedef struct
+{
+    wiced_bt_ble_scan_results_t result;
+    uint64_t                    rx_ticks;   /* app_time_ticks() when the stack callback ran */
+    uint16_t                    adv_len;
+    /* app_alloc_buffer() buffer, returned by the worker */
+    uint8_t*                    p_adv_data;
+} wakeon_le_scan_report_t;
+
+/* running totals of the report path, see wakeon_le_scan_get_stats() */
+typedef struct
+{
+    uint64_t    processed;                  /* reports the worker finished */
+    uint64_t    dropped;                    /* reports lost to a full ring or buffer pool */
+    uint64_t    ignored;                    /* live reports ignored during a replay */
+    uint64_t    latency[WAKEON_LE_SCAN_LATENCY_BUCKETS];    /* submit to processed */
+} wakeon_le_scan_stats_t;
+
+/******************************************************************************
+*       FUNCTION PROTOTYPE
+******************************************************************************/
+BOOL32 wakeon_le_scan_start(uint32_t queue_depth, uint32_t max_devices, uint16_t adv_data_max);
+void wakeon_le_scan_stop(void);
+void wakeon_le_scan_submit(const wiced_bt_ble_scan_results_t *p_scan_result, const uint8_t *p_adv_data, uint16_t adv_len);
+void wakeon_le_scan_set_rules(const app_adv_rule_t* p_rules, uint32_t count);
+app_device_table_t* wakeon_le_scan_devices(void);
+uint32_t wakeon_le_scan_rule_count(void);
+void wakeon_le_scan_get_stats(wakeon_le_scan_stats_t* p_stats);
+uint64_t wakeon_le_scan_latency_bucket_ns(uint32_t bucket);
+void wakeon_le_scan_replay_claim(BOOL32 claim);
+BOOL32 wakeon_le_scan_capture_open(const char* path);
+void wakeon_le_scan_capture_close(void);
+
+#endif /* __APP_WAKEON_LE_SCAN_H__ */
@@ -0,0 +1,64 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: wakeon_le_sched.h
+ *
+ * Description: This is the header file for the wake path scheduling.
+ *              --rt-hci and --rt-gpio give the HCI RX thread and the
+ *              HOST-WAKE GPIO thread a SCHED_FIFO priority and CPUs,
+ *              --mlock locks the process memory, and --rt-probe measures
+ *              the scheduling latency those threads see.
+ *
+ ******************************************************************************
+* $ Copyright 2022-YEAR Cypress Semiconductor $
+ *****************************************************************************/
+
+#ifndef __APP_WAKEON_LE_SCHED_H__
+#define __APP_WAKEON_LE_SCHED_H__
+
+#include "data_types.h"
+
+/******************************************************************************
+*       FUNCTION PROTOTYPE
+******************************************************************************/
+BOOL32 wakeon_le_sched_mlock_prepare(void);
+BOOL32 wakeon_le_sched_setup(void);
+void wakeon_le_sched_hci_thread(void);
+void wakeon_le_sched_gpio_begin(void);
+void wakeon_le_sched_gpio_end(void);
+void wakeon_le_sched_gpio_check(void);
+void wakeon_le_sched_stop(void);
+
+#endif /* __APP_WAKEON_LE_SCHED_H__ */
@@ -0,0 +1,360 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: test_adv_capture.c
+ *
+ * Description: Writer to reader round trip of the report capture format.
+ *              Records are written through app_adv_capture_append() and
+ *              read back with app_adv_capture_next() and _seek(), and every
+ *              field must come back as written. The record stream is built
+ *              to cross block boundaries, to overflow the per block address
+ *              dictionary, to carry timestamp gaps that need the longest
+ *              delta varints, and to be appended to after a reopen. Time
+ *              window seeks are checked in the first and the last block and
+ *              at every record.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "app_adv_capture.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define TEST_RECORDS_MAX                    ( 40000U )
+#define TEST_ADDR_POOL                      ( 97U )
+#define TEST_NS_PER_US                      ( 1000U )
+
+#define TEST_FAIL( ... )                    do { fprintf( stderr, __VA_ARGS__ ); test_failures++; } while ( 0 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    uint64_t    ts_ns;                      /* as the reader reports it */
+    uint8_t     addr[6];
+    uint8_t     addr_type;
+    uint8_t     evt_type;
+    int8_t      rssi;
+    uint16_t    adv_len;
+    uint32_t    adv_off;                    /* into test_adv */
+} test_record_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static test_record_t    test_records[TEST_RECORDS_MAX];
+static uint32_t         test_count;
+static uint8_t          test_adv[APP_ADV_CAPTURE_ADV_MAX * 4U];
+static uint32_t         test_seed = 0x6C8E9CF5U;
+static uint32_t         test_failures;
+/* the writer stores the time of a block's first record in ns and the
+ * others as us deltas */
+static uint32_t         test_block_first;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint32_t test_rand( void )
+{
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+    return test_seed;
+}
+
+/******************************************************************************
+ * Function Name: test_append()
+ ******************************************************************************
+ * Summary:
+ *   Write one record and remember what the reader must return for it
+ *
+ *****************************************************************************/
+static void test_append( app_adv_capture_writer_t *p_writer, uint64_t mono_ns, uint32_t addr_id, uint16_t adv_len )
+{
+    const app_adv_capture_block_header_t *p_header = p_writer->p_header;
+    uint32_t block_before = (uint32_t)p_writer->block_off;
+    test_record_t *p_rec = &test_records[test_count];
+    uint64_t ts_ns = mono_ns + (uint64_t)p_writer->realtime_offset_ns;
+
+    if ( test_count >= TEST_RECORDS_MAX )
+    {
+        TEST_FAIL( "too many records\n" );
+        return;
+    }
+    p_rec->addr[0] = (uint8_t)addr_id;
+    p_rec->addr[1] = (uint8_t)( addr_id >> 8 );
+    p_rec->addr[2] = (uint8_t)( addr_id >> 16 );
+    p_rec->addr[3] = 0xA5;
+    p_rec->addr[4] = 0x5A;
+    p_rec->addr[5] = (uint8_t)( addr_id * 7U );
+    p_rec->addr_type = (uint8_t)( test_rand() & APP_ADV_CAPTURE_HEAD_TYPE_MASK );
+    p_rec->evt_type = (uint8_t)( test_rand() & APP_ADV_CAPTURE_HEAD_EVT_MASK );
+    p_rec->rssi = (int8_t)( -(int)( test_rand() % 128U ) );
+    p_rec->adv_len = adv_len;
+    p_rec->adv_off = test_rand() % ( sizeof( test_adv ) - APP_ADV_CAPTURE_ADV_MAX );
+
+    if ( app_adv_capture_append( p_writer, mono_ns, p_rec->addr, p_rec->addr_type, p_rec->evt_type, p_rec->rssi,
+                                 &test_adv[p_rec->adv_off], adv_len ) != APP_ADV_CAPTURE_SUCCESS )
+    {
+        TEST_FAIL( "append %u failed\n", test_count );
+        return;
+    }
+    test_block_first = ( p_header->records == 1 ) || ( (uint32_t)p_writer->block_off != block_before );
+    p_rec->ts_ns = test_block_first ? ts_ns : ( ts_ns / TEST_NS_PER_US ) * TEST_NS_PER_US;
+    test_count++;
+}
+
+/******************************************************************************
+ * Function Name: test_check_record()
+ ******************************************************************************/
+static void test_check_record( const app_adv_capture_record_t *p_record, uint32_t idx, const char *p_what )
+{
+    const test_record_t *p_rec = &test_records[idx];
+
+    if ( ( p_record->ts_ns != p_rec->ts_ns ) || ( memcmp( p_record->p_addr, p_rec->addr, 6 ) != 0 ) ||
+         ( p_record->addr_type != p_rec->addr_type ) || ( p_record->evt_type != p_rec->evt_type ) ||
+         ( p_record->rssi != p_rec->rssi ) || ( p_record->adv_len != p_rec->adv_len ) ||
+         ( memcmp( p_record->p_adv, &test_adv[p_rec->adv_off], p_rec->adv_len ) != 0 ) )
+    {
+        TEST_FAIL( "%s: record %u differs: ts %llu/%llu len %u/%u\n", p_what, idx,
+                   (unsigned long long)p_record->ts_ns, (unsigned long long)p_rec->ts_ns,
+                   p_record->adv_len, p_rec->adv_len );
+    }
+}
+
+/******************************************************************************
+ * Function Name: test_window()
+ ******************************************************************************
+ * Summary:
+ *   Read [from, to] as adv_capture_dump does: seek, then read until past
+ *   the end. Must return exactly the records in the window, in order.
+ *
+ *****************************************************************************/
+static void test_window( app_adv_capture_reader_t *p_reader, uint64_t from_ns, uint64_t to_ns, const char *p_what )
+{
+    app_adv_capture_record_t record;
+    uint32_t idx = 0;
+    int seek;
+
+    while ( ( idx < test_count ) && ( test_records[idx].ts_ns < from_ns ) )
+    {
+        idx++;
+    }
+    seek = app_adv_capture_seek( p_reader, from_ns );
+    if ( ( seek == APP_ADV_CAPTURE_END ) != ( idx == test_count ) )
+    {
+        TEST_FAIL( "%s: seek returned %d with %u records left\n", p_what, seek, test_count - idx );
+        return;
+    }
+    while ( ( seek == APP_ADV_CAPTURE_SUCCESS ) && ( app_adv_capture_next( p_reader, &record ) == APP_ADV_CAPTURE_SUCCESS ) )
+    {
+        if ( record.ts_ns > to_ns )
+        {
+            break;
+        }
+        if ( idx >= test_count )
+        {
+            TEST_FAIL( "%s: record past the end\n", p_what );
+            return;
+        }
+        test_check_record( &record, idx++, p_what );
+    }
+    while ( ( idx < test_count ) && ( test_records[idx].ts_ns <= to_ns ) )
+    {
+        TEST_FAIL( "%s: record %u missing\n", p_what, idx++ );
+    }
+}
+
+int main( void )
+{
+    char path[] = "/tmp/test_adv_capture.XXXXXX";
+    app_adv_capture_writer_t writer;
+    app_adv_capture_reader_t reader;
+    app_adv_capture_record_t record;
+    const app_adv_capture_block_header_t *p_header;
+    uint32_t i, n, first_block_end = 0, last_block_start = 0, dict_full_blocks = 0, max_delta_bytes = 0;
+    uint64_t mono_ns = 1000000000ULL, first_ns, last_ns, gap_ns;
+    int fd;
+
+    for ( i = 0; i < sizeof( test_adv ); i++ )
+    {
+        test_adv[i] = (uint8_t)test_rand();
+    }
+    fd = mkstemp( path );
+    if ( ( fd < 0 ) || ( app_adv_capture_writer_open( &writer, path ) != APP_ADV_CAPTURE_SUCCESS ) )
+    {
+        perror( path );
+        return EXIT_FAILURE;
+    }
+    close( fd );
+
+    /* a few addresses, payloads up to the extended maximum: blocks fill up
+     * on size, and their dictionaries restart at each boundary */
+    for ( n = 0; n < 6000; n++ )
+    {
+        mono_ns += 1000U + test_rand() % 5000000U;
+        test_append( &writer, mono_ns, test_rand() % TEST_ADDR_POOL,
+                     ( test_rand() % 64U == 0 ) ? (uint16_t)( test_rand() % ( APP_ADV_CAPTURE_ADV_MAX + 1U ) )
+                                                : (uint16_t)( test_rand() % 256U ) );
+    }
+    /* many new addresses with little data: blocks close on a full dictionary */
+    for ( n = 0; n < 3U * APP_ADV_CAPTURE_DICT_MAX; n++ )
+    {
+        mono_ns += 1000U + test_rand() % 1000U;
+        test_append( &writer, mono_ns, 0x10000U + n, (uint16_t)( test_rand() % 4U ) );
+    }
+    /* gaps that need 5 to 8 byte delta varints, the longest a 64 bit ns
+     * time can produce */
+    for ( n = 0; n < 40; n++ )
+    {
+        gap_ns = ( 1ULL << ( 32U + ( n % 30U ) ) ) + test_rand();
+        mono_ns += gap_ns;
+        test_append( &writer, mono_ns, test_rand() % TEST_ADDR_POOL, (uint16_t)( test_rand() % 32U ) );
+        mono_ns += 1000U;
+        test_append( &writer, mono_ns, test_rand() % TEST_ADDR_POOL, 0 );
+    }
+    app_adv_capture_writer_close( &writer );
+
+    /* appending after a reopen starts a new block */
+    if ( app_adv_capture_writer_open( &writer, path ) != APP_ADV_CAPTURE_SUCCESS )
+    {
+        TEST_FAIL( "reopen failed\n" );
+        return EXIT_FAILURE;
+    }
+    for ( n = 0; n < 500; n++ )
+    {
+        mono_ns += 1000U + test_rand() % 100000U;
+        test_append( &writer, mono_ns, test_rand() % TEST_ADDR_POOL, (uint16_t)( test_rand() % 64U ) );
+    }
+    app_adv_capture_writer_close( &writer );
+
+    if ( app_adv_capture_reader_open( &reader, path ) != APP_ADV_CAPTURE_SUCCESS )
+    {
+        TEST_FAIL( "reader open failed\n" );
+        return EXIT_FAILURE;
+    }
+
+    /* the stream must have exercised what it was built for */
+    for ( i = 0; i < reader.num_blocks; i++ )
+    {
+        p_header = (const app_adv_capture_block_header_t *)( reader.p_map + APP_ADV_CAPTURE_FILE_HEADER_LEN +
+                                                             (size_t)i * reader.block_size );
+        dict_full_blocks += ( p_header->addrs == APP_ADV_CAPTURE_DICT_MAX );
+    }
+    for ( i = 1; i < test_count; i++ )
+    {
+        uint64_t d = ( test_records[i].ts_ns - test_records[i - 1].ts_ns ) / TEST_NS_PER_US;
+        uint32_t bytes = 1;
+
+        while ( d >= 0x80U )
+        {
+            d >>= 7;
+            bytes++;
+        }
+        max_delta_bytes = ( bytes > max_delta_bytes ) ? bytes : max_delta_bytes;
+    }
+    if ( ( reader.num_blocks < 4U ) || ( dict_full_blocks < 2U ) || ( max_delta_bytes < 8U ) )
+    {
+        TEST_FAIL( "stream too tame: %u blocks, %u with a full dictionary, %u byte deltas\n",
+                   reader.num_blocks, dict_full_blocks, max_delta_bytes );
+    }
+
+    /* everything, in order */
+    for ( n = 0; app_adv_capture_next( &reader, &record ) == APP_ADV_CAPTURE_SUCCESS; n++ )
+    {
+        if ( n < test_count )
+        {
+            test_check_record( &record, n, "sequential" );
+        }
+        if ( reader.block == 0 )
+        {
+            first_block_end = n + 1U;
+        }
+        if ( ( last_block_start == 0 ) && ( reader.block + 1U == reader.num_blocks ) )
+        {
+            last_block_start = n;
+        }
+    }
+    if ( n != test_count )
+    {
+        TEST_FAIL( "read %u of %u records\n", n, test_count );
+    }
+    if ( ( app_adv_capture_span( &reader, &first_ns, &last_ns ) != APP_ADV_CAPTURE_SUCCESS ) ||
+         ( first_ns != test_records[0].ts_ns ) || ( last_ns / TEST_NS_PER_US != test_records[test_count - 1].ts_ns / TEST_NS_PER_US ) )
+    {
+        TEST_FAIL( "span does not cover the records\n" );
+    }
+
+    /* windows at the capture ends and in the first and last block */
+    test_window( &reader, 0, UINT64_MAX, "all" );
+    test_window( &reader, 0, test_records[0].ts_ns, "first record" );
+    test_window( &reader, test_records[0].ts_ns + 1U, test_records[first_block_end / 2U].ts_ns, "first block" );
+    test_window( &reader, test_records[first_block_end - 1U].ts_ns, test_records[first_block_end].ts_ns, "first boundary" );
+    test_window( &reader, test_records[last_block_start - 1U].ts_ns + 1U, test_records[last_block_start].ts_ns, "last boundary" );
+    test_window( &reader, test_records[last_block_start + 3U].ts_ns, test_records[test_count - 2U].ts_ns, "last block" );
+    test_window( &reader, test_records[test_count - 1U].ts_ns, UINT64_MAX, "last record" );
+    test_window( &reader, test_records[test_count - 1U].ts_ns + 1U, UINT64_MAX, "after the end" );
+
+    /* a seek to every record time, and into the gap before it */
+    for ( i = 0; ( i < test_count ) && ( test_failures == 0 ); i++ )
+    {
+        if ( ( i == 0 ) || ( test_records[i].ts_ns != test_records[i - 1].ts_ns ) )
+        {
+            test_window( &reader, test_records[i].ts_ns, test_records[i].ts_ns, "seek" );
+        }
+        if ( ( i > 0 ) && ( test_records[i].ts_ns - test_records[i - 1].ts_ns > 1U ) )
+        {
+            test_window( &reader, test_records[i - 1].ts_ns + 1U, test_records[i].ts_ns, "seek into gap" );
+        }
+    }
+
+    printf( "%u records in %u blocks (%u with a full dictionary, deltas up to %u bytes): %s\n", test_count,
+            reader.num_blocks, dict_full_blocks, max_delta_bytes, ( test_failures == 0 ) ? "ok" : "FAILED" );
+    app_adv_capture_reader_close( &reader );
+    unlink( path );
+    return ( test_failures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
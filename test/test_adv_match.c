@@ -0,0 +1,395 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: test_adv_match.c
+ *
+ * Description: Differential test of the wake rule matcher. Random rule sets
+ *              and random, partly malformed, advertising payloads are run
+ *              through the vector UUID lookups, the scalar ones and a
+ *              straightforward reference written here; all three must
+ *              agree. Every payload ends at a page boundary followed by an
+ *              inaccessible page, so any read past the payload length by
+ *              the AD parser or the matcher faults.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "app_adv_parser.h"
+#include "app_adv_match.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define TEST_ITERATIONS                     ( 200000U )
+#define TEST_PAYLOADS_PER_SET               ( 64U )
+#define TEST_ADV_LEN_MAX                    ( 255U )
+
+#define TEST_FAIL( ... )                    do { fprintf( stderr, __VA_ARGS__ ); test_failures++; } while ( 0 )
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static app_adv_rule_set_t   test_set;
+static app_adv_rule_set_t   test_set_scalar;
+static app_adv_rule_t       test_rules[APP_ADV_MATCH_RULES_MAX];
+static uint32_t             test_num_rules;
+static uint32_t             test_seed = 0x9E3779B9U;
+static uint32_t             test_failures;
+/* last TEST_ADV_LEN_MAX bytes before the guard page */
+static uint8_t              *p_test_page_end;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint32_t test_rand( void )
+{
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+    return test_seed;
+}
+
+/******************************************************************************
+ * Function Name: test_guard_init()
+ ******************************************************************************
+ * Summary:
+ *   Map a page followed by a PROT_NONE page
+ *
+ *****************************************************************************/
+static int test_guard_init( void )
+{
+    long page = sysconf( _SC_PAGESIZE );
+    uint8_t *p_map = mmap( NULL, (size_t)page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if ( ( p_map == MAP_FAILED ) || ( mprotect( p_map + page, (size_t)page, PROT_NONE ) != 0 ) )
+    {
+        perror( "guard page" );
+        return -1;
+    }
+    p_test_page_end = p_map + page;
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: test_gen_rules()
+ ******************************************************************************
+ * Summary:
+ *   A random rule set: 1 to 64 rules of every UUID width, few distinct
+ *   values so several rules share a UUID, some with a manufacturer pattern
+ *
+ *****************************************************************************/
+static void test_gen_rules( void )
+{
+    static const uint8_t widths[] = { 0, 2, 4, 16 };
+    app_adv_rule_t *p_rule;
+    uint32_t i, j;
+
+    test_num_rules = 1U + test_rand() % APP_ADV_MATCH_RULES_MAX;
+    for ( i = 0; i < test_num_rules; i++ )
+    {
+        p_rule = &test_rules[i];
+        memset( p_rule, 0, sizeof( *p_rule ) );
+        p_rule->uuid_len = widths[test_rand() % sizeof( widths )];
+        for ( j = 0; j < p_rule->uuid_len; j++ )
+        {
+            p_rule->uuid[j] = (uint8_t)( test_rand() % 3U );
+        }
+        p_rule->has_manu = ( p_rule->uuid_len == 0 ) || ( test_rand() % 3U == 0 );
+        if ( p_rule->has_manu )
+        {
+            p_rule->company_id = (uint16_t)( test_rand() % 3U );
+            p_rule->company_id_mask = ( test_rand() & 1U ) ? 0xFFFFU : 0x00FFU;
+            p_rule->pattern_len = (uint8_t)( test_rand() % 8U );
+            if ( test_rand() % 16U == 0 )
+            {
+                p_rule->pattern_len = (uint8_t)( test_rand() % ( APP_ADV_MATCH_PATTERN_MAX + 1U ) );
+            }
+            for ( j = 0; j < p_rule->pattern_len; j++ )
+            {
+                p_rule->pattern[j] = (uint8_t)( test_rand() % 3U );
+                p_rule->pattern_mask[j] = ( test_rand() % 4U == 0 ) ? 0x0FU : 0xFFU;
+            }
+        }
+        p_rule->filter_idx = (uint8_t)i;
+    }
+
+    app_adv_rule_set_init( &test_set );
+    for ( i = 0; i < test_num_rules; i++ )
+    {
+        if ( app_adv_rule_set_add( &test_set, &test_rules[i] ) != APP_ADV_MATCH_SUCCESS )
+        {
+            TEST_FAIL( "rule %u rejected\n", i );
+        }
+    }
+    test_set_scalar = test_set;
+    test_set_scalar.scalar_only = 1;
+}
+
+/******************************************************************************
+ * Function Name: test_gen_payload()
+ ******************************************************************************
+ * Summary:
+ *   A random payload of up to 255 bytes: well formed AD structures whose
+ *   values come from the same small alphabet as the rules, so they match,
+ *   mixed with zero length bytes, oversized length bytes and raw noise
+ *
+ *****************************************************************************/
+static uint16_t test_gen_payload( uint8_t *p_out )
+{
+    static const uint8_t types[] = { APP_AD_TYPE_UUID16_PARTIAL, APP_AD_TYPE_UUID16_COMPLETE,
+                                     APP_AD_TYPE_UUID32_PARTIAL, APP_AD_TYPE_UUID32_COMPLETE,
+                                     APP_AD_TYPE_UUID128_PARTIAL, APP_AD_TYPE_UUID128_COMPLETE,
+                                     APP_AD_TYPE_MANUFACTURER, APP_AD_TYPE_MANUFACTURER,
+                                     APP_AD_TYPE_FLAGS, APP_AD_TYPE_NAME_COMPLETE };
+    uint16_t len_max = ( test_rand() & 1U ) ? 31U : (uint16_t)( test_rand() % ( TEST_ADV_LEN_MAX + 1U ) );
+    uint16_t len = 0;
+    uint32_t vlen, i, kind;
+
+    while ( len < len_max )
+    {
+        kind = test_rand() % 16U;
+        if ( kind == 0 )
+        {
+            /* noise, including zero and oversized length bytes */
+            p_out[len++] = (uint8_t)test_rand();
+            continue;
+        }
+        if ( kind == 1 )
+        {
+            /* structure claiming more bytes than are left */
+            p_out[len] = (uint8_t)( len_max - len + test_rand() % 4U );
+            len++;
+            continue;
+        }
+        vlen = test_rand() % 24U;
+        if ( len + 2U + vlen > len_max )
+        {
+            vlen = ( len + 2U <= len_max ) ? len_max - len - 2U : 0U;
+            if ( len + 2U > len_max )
+            {
+                p_out[len++] = (uint8_t)test_rand();
+                continue;
+            }
+        }
+        p_out[len] = (uint8_t)( vlen + 1U );
+        p_out[len + 1] = types[test_rand() % sizeof( types )];
+        for ( i = 0; i < vlen; i++ )
+        {
+            p_out[len + 2 + i] = (uint8_t)( test_rand() % 3U );
+        }
+        len = (uint16_t)( len + 2U + vlen );
+    }
+    return len;
+}
+
+/******************************************************************************
+ * Function Name: test_ref_match()
+ ******************************************************************************
+ * Summary:
+ *   Reference matcher, rule by rule over raw bytes: a rule matches when its
+ *   UUID is in a service UUID list of its width (or it has none) and, if it
+ *   carries a pattern, the first manufacturer data field matches it
+ *
+ *****************************************************************************/
+static int test_ref_match( const uint8_t *p_data, uint16_t len )
+{
+    const uint8_t *p_manu = NULL;
+    uint32_t manu_len = 0, r, off, flen, i, width;
+    const app_adv_rule_t *p_rule;
+    int uuid_ok, manu_ok;
+    uint8_t type;
+
+    for ( off = 0; ( off < len ) && ( p_data[off] != 0 ); off += 1U + flen )
+    {
+        flen = p_data[off];
+        if ( off + 1U + flen > len )
+        {
+            break;
+        }
+        if ( ( p_data[off + 1] == APP_AD_TYPE_MANUFACTURER ) && ( p_manu == NULL ) )
+        {
+            p_manu = &p_data[off + 2];
+            manu_len = flen - 1U;
+        }
+    }
+
+    for ( r = 0; r < test_num_rules; r++ )
+    {
+        p_rule = &test_rules[r];
+        uuid_ok = ( p_rule->uuid_len == 0 );
+        for ( off = 0; !uuid_ok && ( off < len ) && ( p_data[off] != 0 ); off += 1U + flen )
+        {
+            flen = p_data[off];
+            if ( off + 1U + flen > len )
+            {
+                break;
+            }
+            type = p_data[off + 1];
+            width = ( ( type == APP_AD_TYPE_UUID16_PARTIAL ) || ( type == APP_AD_TYPE_UUID16_COMPLETE ) ) ? 2U :
+                    ( ( type == APP_AD_TYPE_UUID32_PARTIAL ) || ( type == APP_AD_TYPE_UUID32_COMPLETE ) ) ? 4U :
+                    ( ( type == APP_AD_TYPE_UUID128_PARTIAL ) || ( type == APP_AD_TYPE_UUID128_COMPLETE ) ) ? 16U : 0U;
+            if ( width != p_rule->uuid_len )
+            {
+                continue;
+            }
+            for ( i = 0; !uuid_ok && ( i + width <= flen - 1U ); i += width )
+            {
+                uuid_ok = ( memcmp( &p_data[off + 2 + i], p_rule->uuid, width ) == 0 );
+            }
+        }
+        if ( !uuid_ok )
+        {
+            continue;
+        }
+
+        manu_ok = !p_rule->has_manu;
+        if ( !manu_ok && ( p_manu != NULL ) && ( manu_len >= 2U + p_rule->pattern_len ) &&
+             ( ( ( p_manu[0] | ( p_manu[1] << 8 ) ) & p_rule->company_id_mask ) == ( p_rule->company_id & p_rule->company_id_mask ) ) )
+        {
+            manu_ok = 1;
+            for ( i = 0; i < p_rule->pattern_len; i++ )
+            {
+                if ( ( p_manu[2 + i] ^ p_rule->pattern[i] ) & p_rule->pattern_mask[i] )
+                {
+                    manu_ok = 0;
+                    break;
+                }
+            }
+        }
+        if ( manu_ok )
+        {
+            return (int)r;
+        }
+    }
+    return APP_ADV_MATCH_NONE;
+}
+
+/******************************************************************************
+ * Function Name: test_parser()
+ ******************************************************************************
+ * Summary:
+ *   Every field the iterator returns lies inside the payload, and the
+ *   significant length and app_ad_find agree with it
+ *
+ *****************************************************************************/
+static void test_parser( const uint8_t *p_data, uint16_t len )
+{
+    app_ad_iter_t iter;
+    app_ad_field_t field, found;
+    uint16_t total = 0;
+    int first_manu = 1;
+
+    app_ad_iter_init( &iter, p_data, len );
+    while ( app_ad_iter_next( &iter, &field ) )
+    {
+        if ( ( field.p_value < p_data + 2 ) || ( field.p_value + field.len > p_data + len ) )
+        {
+            TEST_FAIL( "field type 0x%02X len %u outside the %u byte payload\n", field.type, field.len, len );
+        }
+        total = (uint16_t)( field.p_value + field.len - p_data );
+        if ( ( field.type == APP_AD_TYPE_MANUFACTURER ) && first_manu )
+        {
+            first_manu = 0;
+            if ( !app_ad_find( p_data, len, APP_AD_TYPE_MANUFACTURER, &found ) || ( found.p_value != field.p_value ) )
+            {
+                TEST_FAIL( "app_ad_find disagrees with the iterator\n" );
+            }
+        }
+    }
+    if ( app_ad_total_len( p_data, len ) != total )
+    {
+        TEST_FAIL( "app_ad_total_len %u, iterator %u\n", app_ad_total_len( p_data, len ), total );
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    uint8_t payload[TEST_ADV_LEN_MAX];
+    uint32_t iterations = ( argc > 1 ) ? (uint32_t)strtoul( argv[1], NULL, 0 ) : TEST_ITERATIONS;
+    uint32_t n, hits = 0;
+    const uint8_t *p_data;
+    uint16_t len;
+    int vec, sca, ref;
+
+    if ( test_guard_init() != 0 )
+    {
+        return EXIT_FAILURE;
+    }
+
+    /* empty and NULL payloads */
+    test_gen_rules();
+    if ( ( app_adv_rule_set_match( &test_set, p_test_page_end, 0 ) != test_ref_match( p_test_page_end, 0 ) ) ||
+         ( app_adv_rule_set_match( &test_set, NULL, 0 ) != test_ref_match( p_test_page_end, 0 ) ) ||
+         ( app_ad_total_len( NULL, 0 ) != 0 ) )
+    {
+        TEST_FAIL( "empty payload\n" );
+    }
+
+    for ( n = 0; ( n < iterations ) && ( test_failures == 0 ); n++ )
+    {
+        if ( n % TEST_PAYLOADS_PER_SET == 0 )
+        {
+            test_gen_rules();
+        }
+        len = test_gen_payload( payload );
+        p_data = p_test_page_end - len;
+        memcpy( (uint8_t *)p_data, payload, len );
+
+        test_parser( p_data, len );
+        vec = app_adv_rule_set_match( &test_set, p_data, len );
+        sca = app_adv_rule_set_match( &test_set_scalar, p_data, len );
+        ref = test_ref_match( p_data, len );
+        if ( ( vec != ref ) || ( sca != ref ) )
+        {
+            TEST_FAIL( "iteration %u: %s %d, scalar %d, reference %d\n", n, app_adv_match_impl(), vec, sca, ref );
+        }
+        hits += ( ref != APP_ADV_MATCH_NONE );
+    }
+
+    printf( "%u payloads, %u matched, %s lookups: %s\n", n, hits, app_adv_match_impl(),
+            ( test_failures == 0 ) ? "ok" : "FAILED" );
+    return ( test_failures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,375 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: test_device_table.c
+ *
+ * Description: Randomized test of the device table against a plain
+ *              reference model. Random updates and removes of an address
+ *              pool larger than the table fill it, evict the least recently
+ *              seen device and delete from the middle of probe clusters.
+ *              Most of the pool is picked to share a few home positions of
+ *              the index, across its wrap around, so clusters are long and
+ *              every delete shifts entries back. After every operation the
+ *              lookups of the whole pool must agree with the model, the
+ *              index must reach each entry from its home position without
+ *              a gap, and the LRU list must be in the model's order.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_device_table.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define TEST_POOL_MAX                       ( 4096U )
+#define TEST_NIL                            ( 0xFFFFFFFFU )
+
+#define TEST_FAIL( ... )                    do { fprintf( stderr, __VA_ARGS__ ); test_failures++; } while ( 0 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+/* reference model of one device */
+typedef struct
+{
+    uint8_t     addr[6];
+    uint8_t     present;
+    uint8_t     addr_type;
+    uint8_t     filter_idx;
+    int8_t      rssi_last;
+    int16_t     rssi_avg_q4;
+    uint32_t    count;
+    uint64_t    last_seen_ns;
+    uint64_t    touched;                    /* recency, larger is more recent */
+} test_device_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static test_device_t    test_pool[TEST_POOL_MAX];
+static uint32_t         test_pool_size;
+static uint32_t         test_count;
+static uint64_t         test_evictions;
+static uint64_t         test_clock;
+static uint32_t         test_seed = 0x2545F491U;
+static uint32_t         test_failures;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint32_t test_rand( void )
+{
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+    return test_seed;
+}
+
+/* same mix as app_device_hash(), to place addresses and check the index */
+static uint32_t test_hash( const uint8_t *p_addr )
+{
+    uint64_t k = (uint64_t)p_addr[0] | ( (uint64_t)p_addr[1] << 8 ) | ( (uint64_t)p_addr[2] << 16 ) |
+                 ( (uint64_t)p_addr[3] << 24 ) | ( (uint64_t)p_addr[4] << 32 ) | ( (uint64_t)p_addr[5] << 40 );
+
+    return (uint32_t)( ( k * 0x9E3779B97F4A7C15ULL ) >> 32 );
+}
+
+/******************************************************************************
+ * Function Name: test_make_pool()
+ ******************************************************************************
+ * Summary:
+ *   Distinct addresses; all but a few have a home position within
+ *   hot_span of the last index slot, so their clusters cross the wrap
+ *
+ *****************************************************************************/
+static void test_make_pool( uint32_t size, uint32_t index_mask, uint32_t hot_span )
+{
+    uint8_t addr[6];
+    uint32_t i, j, home;
+
+    memset( test_pool, 0, sizeof( test_pool ) );
+    test_pool_size = 0;
+    while ( test_pool_size < size )
+    {
+        for ( i = 0; i < 6; i++ )
+        {
+            addr[i] = (uint8_t)test_rand();
+        }
+        home = test_hash( addr ) & index_mask;
+        if ( ( test_pool_size % 8U != 0 ) && ( ( ( home + hot_span / 2U ) & index_mask ) >= hot_span ) )
+        {
+            continue;
+        }
+        for ( j = 0; ( j < test_pool_size ) && ( memcmp( test_pool[j].addr, addr, 6 ) != 0 ); j++ )
+        {
+        }
+        if ( j == test_pool_size )
+        {
+            memcpy( test_pool[test_pool_size++].addr, addr, 6 );
+        }
+    }
+    test_count = 0;
+    test_evictions = 0;
+}
+
+/******************************************************************************
+ * Function Name: test_update()
+ ******************************************************************************
+ * Summary:
+ *   One report in the table and in the model
+ *
+ *****************************************************************************/
+static void test_update( app_device_table_t *p_table, uint32_t d )
+{
+    test_device_t *p_dev = &test_pool[d];
+    int8_t rssi = (int8_t)( -20 - (int)( test_rand() % 80U ) );
+    uint8_t addr_type = (uint8_t)( test_rand() % 4U );
+    uint8_t filter_idx = ( test_rand() % 4U == 0 ) ? (uint8_t)( test_rand() % 16U ) : APP_DEVICE_FILTER_NONE;
+    uint32_t i, oldest = TEST_NIL;
+    int ret;
+
+    test_clock += 1U + test_rand() % 1000U;
+    ret = app_device_table_update( p_table, p_dev->addr, addr_type, rssi, filter_idx, test_clock );
+
+    if ( !p_dev->present )
+    {
+        if ( test_count == p_table->max_devices )
+        {
+            for ( i = 0; i < test_pool_size; i++ )
+            {
+                if ( test_pool[i].present && ( ( oldest == TEST_NIL ) || ( test_pool[i].touched < test_pool[oldest].touched ) ) )
+                {
+                    oldest = i;
+                }
+            }
+            test_pool[oldest].present = 0;
+            test_count--;
+            test_evictions++;
+        }
+        p_dev->present = 1;
+        p_dev->count = 0;
+        p_dev->filter_idx = APP_DEVICE_FILTER_NONE;
+        p_dev->rssi_avg_q4 = (int16_t)( rssi * 16 );
+        test_count++;
+        if ( ret != 1 )
+        {
+            TEST_FAIL( "update of new device %u returned %d\n", d, ret );
+        }
+    }
+    else
+    {
+        p_dev->rssi_avg_q4 = (int16_t)( p_dev->rssi_avg_q4 + ( ( ( rssi * 16 ) - p_dev->rssi_avg_q4 ) >> 3 ) );
+        if ( ret != 0 )
+        {
+            TEST_FAIL( "update of known device %u returned %d\n", d, ret );
+        }
+    }
+    p_dev->addr_type = addr_type;
+    p_dev->rssi_last = rssi;
+    p_dev->last_seen_ns = test_clock;
+    p_dev->count++;
+    p_dev->filter_idx = ( filter_idx != APP_DEVICE_FILTER_NONE ) ? filter_idx : p_dev->filter_idx;
+    p_dev->touched = test_clock;
+}
+
+static void test_remove( app_device_table_t *p_table, uint32_t d )
+{
+    int ret = app_device_table_remove( p_table, test_pool[d].addr );
+
+    if ( ret != test_pool[d].present )
+    {
+        TEST_FAIL( "remove of device %u returned %d, present %u\n", d, ret, test_pool[d].present );
+    }
+    test_count -= test_pool[d].present;
+    test_pool[d].present = 0;
+}
+
+/******************************************************************************
+ * Function Name: test_check()
+ ******************************************************************************
+ * Summary:
+ *   Compare the whole table with the model
+ *
+ *****************************************************************************/
+static void test_check( app_device_table_t *p_table, uint32_t op )
+{
+    const uint32_t mask = p_table->index_mask;
+    const app_device_entry_t *p_entry;
+    const test_device_t *p_dev;
+    app_device_info_t info;
+    uint32_t i, pos, slot, e, hash, home, n, prev, start, run;
+    uint64_t touched;
+
+    /* lookups agree with the model */
+    for ( i = 0; i < test_pool_size; i++ )
+    {
+        p_dev = &test_pool[i];
+        if ( app_device_table_lookup( p_table, p_dev->addr, &info ) != p_dev->present )
+        {
+            TEST_FAIL( "op %u: device %u lookup disagrees, present %u\n", op, i, p_dev->present );
+            continue;
+        }
+        if ( p_dev->present &&
+             ( ( memcmp( info.addr, p_dev->addr, 6 ) != 0 ) || ( info.addr_type != p_dev->addr_type ) ||
+               ( info.filter_idx != p_dev->filter_idx ) || ( info.rssi_last != p_dev->rssi_last ) ||
+               ( info.rssi_avg != (int8_t)( ( p_dev->rssi_avg_q4 + 8 ) >> 4 ) ) || ( info.count != p_dev->count ) ||
+               ( info.last_seen_ns != p_dev->last_seen_ns ) ) )
+        {
+            TEST_FAIL( "op %u: device %u fields differ: count %u/%u\n", op, i, info.count, p_dev->count );
+        }
+    }
+    if ( ( app_device_table_count( p_table ) != test_count ) || ( p_table->evictions != test_evictions ) )
+    {
+        TEST_FAIL( "op %u: %u devices, %llu evictions, model %u, %llu\n", op, app_device_table_count( p_table ),
+                   (unsigned long long)p_table->evictions, test_count, (unsigned long long)test_evictions );
+    }
+
+    /* every index entry is reachable from its home without crossing an empty
+     * slot: it is no further from home than the run of used slots ending at
+     * it. The index is at most half full, so a walk from an empty slot sees
+     * every run whole. */
+    for ( start = 0; p_table->p_index[start] != 0; start++ )
+    {
+    }
+    for ( i = 1, n = 0, run = 0; i <= mask + 1U; i++ )
+    {
+        pos = ( start + i ) & mask;
+        slot = p_table->p_index[pos];
+        if ( slot == 0 )
+        {
+            run = 0;
+            continue;
+        }
+        run++;
+        n++;
+        e = ( slot & 0x00FFFFFFU ) - 1U;
+        hash = test_hash( p_table->p_entries[e].addr );
+        home = hash & mask;
+        if ( ( slot >> 24 ) != ( hash >> 24 ) )
+        {
+            TEST_FAIL( "op %u: index slot %u has a wrong tag\n", op, pos );
+        }
+        if ( ( ( pos - home ) & mask ) >= run )
+        {
+            TEST_FAIL( "op %u: entry at %u unreachable from its home %u\n", op, pos, home );
+        }
+    }
+    if ( n != test_count )
+    {
+        TEST_FAIL( "op %u: %u index slots used for %u devices\n", op, n, test_count );
+    }
+
+    /* the LRU list runs from the most to the least recently seen */
+    touched = UINT64_MAX;
+    prev = TEST_NIL;
+    for ( e = p_table->lru_head, n = 0; ( e != TEST_NIL ) && ( n <= test_count ); e = p_entry->lru_next, n++ )
+    {
+        p_entry = &p_table->p_entries[e];
+        if ( ( p_entry->lru_prev != prev ) || ( p_entry->last_seen_ns >= touched ) )
+        {
+            TEST_FAIL( "op %u: LRU list out of order at entry %u\n", op, e );
+            break;
+        }
+        touched = p_entry->last_seen_ns;
+        prev = e;
+    }
+    if ( ( n != test_count ) || ( p_table->lru_tail != prev ) )
+    {
+        TEST_FAIL( "op %u: LRU list holds %u of %u devices\n", op, n, test_count );
+    }
+}
+
+/******************************************************************************
+ * Function Name: test_run()
+ ******************************************************************************
+ * Summary:
+ *   Random operations on a table of max_devices, checked every check_every
+ *   operations
+ *
+ *****************************************************************************/
+static void test_run( uint32_t max_devices, uint32_t pool_size, uint32_t hot_span, uint32_t ops, uint32_t check_every )
+{
+    app_device_table_t table;
+    uint32_t op, r;
+
+    if ( app_device_table_init( &table, max_devices ) != APP_DEVICE_TABLE_SUCCESS )
+    {
+        TEST_FAIL( "init of %u devices failed\n", max_devices );
+        return;
+    }
+    test_make_pool( pool_size, table.index_mask, hot_span );
+    for ( op = 0; ( op < ops ) && ( test_failures < 10 ); op++ )
+    {
+        r = test_rand();
+        /* a hot subset is seen again and again, the rest comes and goes */
+        if ( r % 10U < 7U )
+        {
+            test_update( &table, ( ( r >> 8 ) % 2U == 0 ) ? ( r >> 12 ) % ( pool_size / 4U + 1U ) % pool_size
+                                                         : ( r >> 12 ) % pool_size );
+        }
+        else
+        {
+            test_remove( &table, ( r >> 12 ) % pool_size );
+        }
+        if ( ( op % check_every == 0 ) || ( op + 1U == ops ) )
+        {
+            test_check( &table, op );
+        }
+    }
+    printf( "%u devices, %u addresses: %llu inserts, %llu evictions\n", max_devices, pool_size,
+            (unsigned long long)table.inserts, (unsigned long long)table.evictions );
+    app_device_table_deinit( &table );
+}
+
+int main( void )
+{
+    test_run( 1, 4, 2, 2000, 1 );
+    test_run( 3, 16, 2, 20000, 1 );
+    test_run( 64, 200, 8, 100000, 1 );
+    test_run( 1000, 3000, 1024, 200000, 97 );
+
+    printf( "%s\n", ( test_failures == 0 ) ? "ok" : "FAILED" );
+    return ( test_failures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,368 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: test_event_ring.c
+ *
+ * Description: Producer against reader test of the shared memory event
+ *              ring. Every field of a record, the AD payload included, is
+ *              derived from a token in latency_ns, so a record torn between
+ *              two publishes does not check out. A reader that is lapped
+ *              must skip to a record still in the ring, count exactly the
+ *              records it skipped as lost, and otherwise read consecutive
+ *              sequence numbers. The ring is small and the reader pauses
+ *              now and then, so it is lapped many times. A slot whose
+ *              sequence lock is set by hand to "being written" must not be
+ *              returned until the lock is released.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "app_event_ring.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define TEST_SLOTS                          ( 64U )
+#define TEST_RECORDS                        ( 2000000U )
+#define TEST_PRODUCERS                      ( 2U )
+
+#define TEST_FAIL( ... )                    do { fprintf( stderr, __VA_ARGS__ ); test_failures++; } while ( 0 )
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static uint32_t         test_failures;
+static uint32_t         test_producers_done;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/******************************************************************************
+ * Function Name: test_fill()
+ ******************************************************************************
+ * Summary:
+ *   Record contents for a token
+ *
+ *****************************************************************************/
+static void test_fill( app_event_t *p_event, uint64_t token )
+{
+    uint32_t i;
+
+    memset( p_event, 0, sizeof( *p_event ) );
+    p_event->timestamp_ns = token + 1U;
+    p_event->latency_ns = token;
+    p_event->type = (uint16_t)( 1U + token % 4U );
+    p_event->filter_idx = (uint8_t)( token * 3U );
+    p_event->addr_type = (uint8_t)( token & 1U );
+    for ( i = 0; i < 6; i++ )
+    {
+        p_event->addr[i] = (uint8_t)( token >> ( 8U * i ) );
+    }
+    p_event->rssi = (int8_t)( -(int)( token % 100U ) );
+    p_event->evt_type = (uint8_t)( token % 5U );
+    p_event->adv_len = (uint16_t)( ( token * 7U ) % ( APP_EVENT_ADV_DATA_MAX + 1U ) );
+    for ( i = 0; i < p_event->adv_len; i++ )
+    {
+        p_event->adv_data[i] = (uint8_t)( token * 31U + i );
+    }
+}
+
+/******************************************************************************
+ * Function Name: test_check()
+ ******************************************************************************
+ * Summary:
+ *   A record read back must be exactly what was published for its token
+ *
+ *****************************************************************************/
+static int test_check( const app_event_t *p_event )
+{
+    app_event_t expected;
+
+    test_fill( &expected, p_event->latency_ns );
+    expected.seq = p_event->seq;
+    if ( ( memcmp( p_event, &expected, offsetof( app_event_t, adv_data ) ) != 0 ) ||
+         ( memcmp( p_event->adv_data, expected.adv_data, expected.adv_len ) != 0 ) )
+    {
+        TEST_FAIL( "record %llu torn: token %llu, ts %llu, adv_len %u\n", (unsigned long long)p_event->seq,
+                   (unsigned long long)p_event->latency_ns, (unsigned long long)p_event->timestamp_ns,
+                   p_event->adv_len );
+        return 0;
+    }
+    return 1;
+}
+
+static void *test_producer_main( void *p_arg )
+{
+    uint64_t token = (uint64_t)(uintptr_t)p_arg;
+    app_event_t event;
+
+    /* tokens interleave between the producers */
+    for ( ; token < TEST_RECORDS; token += TEST_PRODUCERS )
+    {
+        test_fill( &event, token );
+        app_event_ring_publish( &event );
+    }
+    __atomic_add_fetch( &test_producers_done, 1, __ATOMIC_RELEASE );
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: test_read()
+ ******************************************************************************
+ * Summary:
+ *   Read until the producers are done and the ring is drained, checking
+ *   each record and the sequence continuity
+ *
+ *****************************************************************************/
+static void test_read( app_event_ring_reader_t *p_reader, uint64_t *p_read, uint32_t *p_laps )
+{
+    app_event_t event;
+    uint64_t expected = p_reader->next, lost = p_reader->lost;
+    uint32_t n = 0;
+
+    for ( ;; )
+    {
+        if ( !app_event_ring_reader_poll( p_reader, &event ) )
+        {
+            if ( __atomic_load_n( &test_producers_done, __ATOMIC_ACQUIRE ) == TEST_PRODUCERS )
+            {
+                /* one more poll: the last publish may have landed after the empty poll */
+                if ( !app_event_ring_reader_poll( p_reader, &event ) )
+                {
+                    break;
+                }
+            }
+            else
+            {
+                sched_yield();
+                continue;
+            }
+        }
+        /* a gap must be counted as lost, record for record */
+        if ( event.seq != expected + ( p_reader->lost - lost ) )
+        {
+            TEST_FAIL( "read seq %llu, expected %llu with %llu lost\n", (unsigned long long)event.seq,
+                       (unsigned long long)expected, (unsigned long long)( p_reader->lost - lost ) );
+        }
+        *p_laps += ( p_reader->lost != lost );
+        test_check( &event );
+        expected = event.seq + 1U;
+        lost = p_reader->lost;
+        (*p_read)++;
+        /* let the producers lap the reader */
+        if ( ( ++n % 4096U ) == 0 )
+        {
+            usleep( 200 );
+        }
+        if ( test_failures > 10 )
+        {
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: test_slot_lock()
+ ******************************************************************************
+ * Summary:
+ *   Sequence lock of a slot, through a writable mapping of the ring; the
+ *   lock is the first word of each slot
+ *
+ *****************************************************************************/
+static uint64_t *test_slot_lock( uint8_t *p_map, uint64_t seq )
+{
+    const app_event_ring_hdr_t *p_hdr = (const app_event_ring_hdr_t *)p_map;
+
+    return (uint64_t *)( p_map + sizeof( app_event_ring_hdr_t ) + ( seq & ( p_hdr->slot_count - 1U ) ) * p_hdr->slot_size );
+}
+
+/******************************************************************************
+ * Function Name: test_lock_states()
+ ******************************************************************************
+ * Summary:
+ *   A record being written is not returned until it is complete
+ *
+ *****************************************************************************/
+static void test_lock_states( app_event_ring_reader_t *p_reader, const char *name )
+{
+    size_t size = sizeof( app_event_ring_hdr_t ) + (size_t)p_reader->p_hdr->slot_count * p_reader->p_hdr->slot_size;
+    uint64_t seq = p_reader->next;
+    app_event_t event;
+    uint64_t *p_lock;
+    uint8_t *p_map;
+    int fd;
+
+    fd = shm_open( name, O_RDWR, 0 );
+    p_map = ( fd < 0 ) ? MAP_FAILED : (uint8_t *)mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if ( fd >= 0 )
+    {
+        close( fd );
+    }
+    if ( p_map == MAP_FAILED )
+    {
+        TEST_FAIL( "writable mapping of %s failed\n", name );
+        return;
+    }
+
+    test_fill( &event, seq );
+    app_event_ring_publish( &event );
+    p_lock = test_slot_lock( p_map, seq );
+    __atomic_store_n( p_lock, 2U * seq + 1U, __ATOMIC_RELEASE );
+    if ( app_event_ring_reader_poll( p_reader, &event ) )
+    {
+        TEST_FAIL( "record %llu returned while being written\n", (unsigned long long)seq );
+    }
+    __atomic_store_n( p_lock, 2U * seq + 2U, __ATOMIC_RELEASE );
+    if ( !app_event_ring_reader_poll( p_reader, &event ) || ( event.seq != seq ) || !test_check( &event ) )
+    {
+        TEST_FAIL( "record %llu not returned once written\n", (unsigned long long)seq );
+    }
+
+    munmap( p_map, size );
+}
+
+int main( void )
+{
+    char name[64];
+    app_event_ring_reader_t reader;
+    pthread_t producers[TEST_PRODUCERS];
+    app_event_t event;
+    uint64_t read = 0, i;
+    uint32_t laps = 0, p;
+
+    snprintf( name, sizeof( name ), "/wakeonle_test_event_ring.%d", (int)getpid() );
+    if ( ( app_event_ring_create( name, TEST_SLOTS ) != APP_EVENT_RING_SUCCESS ) ||
+         ( app_event_ring_reader_open( &reader, name ) != APP_EVENT_RING_SUCCESS ) )
+    {
+        fprintf( stderr, "event ring %s: create or open failed\n", name );
+        return EXIT_FAILURE;
+    }
+
+    /* in order, then lapped while idle: the oldest record still in the ring
+     * comes next, and everything before it is lost */
+    for ( i = 0; i < TEST_SLOTS / 2U; i++ )
+    {
+        test_fill( &event, i );
+        app_event_ring_publish( &event );
+    }
+    for ( i = 0; i < TEST_SLOTS / 2U; i++ )
+    {
+        if ( !app_event_ring_reader_poll( &reader, &event ) || ( event.seq != i ) || !test_check( &event ) )
+        {
+            TEST_FAIL( "in order read of record %llu failed\n", (unsigned long long)i );
+        }
+    }
+    if ( app_event_ring_reader_poll( &reader, &event ) )
+    {
+        TEST_FAIL( "record read from an empty ring\n" );
+    }
+    for ( i = TEST_SLOTS / 2U; i < 4U * TEST_SLOTS; i++ )
+    {
+        test_fill( &event, i );
+        app_event_ring_publish( &event );
+    }
+    if ( !app_event_ring_reader_poll( &reader, &event ) || ( event.seq != 3U * TEST_SLOTS + 1U ) ||
+         ( reader.lost != 3U * TEST_SLOTS + 1U - TEST_SLOTS / 2U ) || !test_check( &event ) )
+    {
+        TEST_FAIL( "lapped reader resumed at %llu with %llu lost\n", (unsigned long long)event.seq,
+                   (unsigned long long)reader.lost );
+    }
+    while ( app_event_ring_reader_poll( &reader, &event ) )
+    {
+        test_check( &event );
+    }
+    if ( reader.next != 4U * TEST_SLOTS )
+    {
+        TEST_FAIL( "reader stopped at %llu of %u\n", (unsigned long long)reader.next, 4U * TEST_SLOTS );
+    }
+    test_lock_states( &reader, name );
+    app_event_ring_destroy();
+    app_event_ring_reader_close( &reader );
+
+    /* producers against the reader; tokens no longer follow seq */
+    if ( ( app_event_ring_create( name, TEST_SLOTS ) != APP_EVENT_RING_SUCCESS ) ||
+         ( app_event_ring_reader_open( &reader, name ) != APP_EVENT_RING_SUCCESS ) )
+    {
+        fprintf( stderr, "event ring %s: create or open failed\n", name );
+        return EXIT_FAILURE;
+    }
+    for ( p = 0; p < TEST_PRODUCERS; p++ )
+    {
+        if ( pthread_create( &producers[p], NULL, test_producer_main, (void *)(uintptr_t)p ) != 0 )
+        {
+            fprintf( stderr, "thread create failed\n" );
+            return EXIT_FAILURE;
+        }
+    }
+    test_read( &reader, &read, &laps );
+    for ( p = 0; p < TEST_PRODUCERS; p++ )
+    {
+        pthread_join( producers[p], NULL );
+    }
+    while ( app_event_ring_reader_poll( &reader, &event ) )
+    {
+        test_check( &event );
+        read++;
+    }
+    if ( ( test_failures == 0 ) && ( ( read + reader.lost != TEST_RECORDS ) || ( reader.next != TEST_RECORDS ) ) )
+    {
+        TEST_FAIL( "%llu read + %llu lost is not %u\n", (unsigned long long)read, (unsigned long long)reader.lost,
+                   TEST_RECORDS );
+    }
+    if ( ( laps == 0 ) || ( read == 0 ) )
+    {
+        TEST_FAIL( "run too tame: %llu read, lapped %u times\n", (unsigned long long)read, laps );
+    }
+    app_event_ring_destroy();
+    app_event_ring_reader_close( &reader );
+
+    printf( "%u records, %llu read, %llu lost in %u laps: %s\n", TEST_RECORDS, (unsigned long long)read,
+            (unsigned long long)reader.lost, laps, ( test_failures == 0 ) ? "ok" : "FAILED" );
+    return ( test_failures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,427 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: test_slab.c
+ *
+ * Description: Concurrency test of the slab pool. Threads allocate and free
+ *              blocks of random sizes at random, holding up to more blocks
+ *              than the small class has, so it runs empty and requests
+ *              fall back to the large class. Every block handed out is
+ *              claimed in an owner table and stamped with its owner; a
+ *              block handed out twice finds the claim taken or the stamp
+ *              overwritten. When the threads stop, the in use counts must
+ *              match the blocks held, and after everything is freed every
+ *              block must be allocatable exactly once. Double frees, a
+ *              racing pair of frees included, and foreign pointers must be
+ *              refused.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "app_slab.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define TEST_THREADS                        ( 8U )
+#define TEST_ITERATIONS                     ( 200000U )
+/* per thread; TEST_THREADS * TEST_HELD_MAX is above the small class count */
+#define TEST_HELD_MAX                       ( 48U )
+#define TEST_SMALL_SIZE                     ( 64U )
+#define TEST_SMALL_COUNT                    ( 256U )
+#define TEST_LARGE_SIZE                     ( 256U )
+#define TEST_LARGE_COUNT                    ( 64U )
+#define TEST_DOUBLE_FREE_ROUNDS             ( 2000U )
+
+#define TEST_FAIL( ... )                    do { fprintf( stderr, __VA_ARGS__ ); __atomic_add_fetch( &test_failures, 1, __ATOMIC_RELAXED ); } while ( 0 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    uint32_t    id;                         /* 1 based, 0 marks a free block */
+    uint32_t    seed;
+    uint32_t    held;
+    void        *p_blocks[TEST_HELD_MAX];
+    uint32_t    lens[TEST_HELD_MAX];
+    uint32_t    held_class[2];
+    uint64_t    fallbacks;                  /* small requests served by the large class */
+    uint64_t    failed;                     /* requests that got NULL */
+} test_thread_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static app_slab_pool_t  test_pool;
+static uint32_t         test_owner[2][TEST_SMALL_COUNT];
+static test_thread_t    test_threads[TEST_THREADS];
+static uint32_t         test_failures;
+static void             *p_test_shared;
+static pthread_barrier_t test_barrier;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint32_t test_rand( uint32_t *p_seed )
+{
+    *p_seed ^= *p_seed << 13;
+    *p_seed ^= *p_seed >> 17;
+    *p_seed ^= *p_seed << 5;
+    return *p_seed;
+}
+
+/******************************************************************************
+ * Function Name: test_locate()
+ ******************************************************************************
+ * Summary:
+ *   Class and index of a block, from the pool's arenas
+ *
+ *****************************************************************************/
+static int test_locate( const void *p_block, uint32_t *p_class, uint32_t *p_idx )
+{
+    const uint8_t *p = (const uint8_t *)p_block;
+    const app_slab_class_t *p_cls;
+    uint32_t c;
+
+    for ( c = 0; c < test_pool.num_classes; c++ )
+    {
+        p_cls = &test_pool.classes[c];
+        if ( ( p >= p_cls->p_base ) && ( p < p_cls->p_base + (size_t)p_cls->block_size * p_cls->count ) &&
+             ( ( p - p_cls->p_base ) % p_cls->block_size == 0 ) )
+        {
+            *p_class = c;
+            *p_idx = (uint32_t)( ( p - p_cls->p_base ) / p_cls->block_size );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: test_alloc()
+ ******************************************************************************
+ * Summary:
+ *   Allocate, claim and stamp a block of len bytes
+ *
+ *****************************************************************************/
+static void test_alloc( test_thread_t *p_thread, uint32_t len )
+{
+    uint8_t *p_block = (uint8_t *)app_slab_alloc( &test_pool, len );
+    uint32_t c, idx, owner;
+
+    if ( p_block == NULL )
+    {
+        p_thread->failed++;
+        return;
+    }
+    if ( !test_locate( p_block, &c, &idx ) )
+    {
+        TEST_FAIL( "thread %u: block %p is not from the pool\n", p_thread->id, (void *)p_block );
+        return;
+    }
+    if ( test_pool.classes[c].block_size < len )
+    {
+        TEST_FAIL( "thread %u: %u byte block for %u bytes\n", p_thread->id, test_pool.classes[c].block_size, len );
+    }
+    owner = __atomic_exchange_n( &test_owner[c][idx], p_thread->id, __ATOMIC_ACQ_REL );
+    if ( owner != 0 )
+    {
+        TEST_FAIL( "thread %u: class %u block %u handed out while thread %u holds it\n", p_thread->id, c, idx, owner );
+    }
+    p_thread->fallbacks += ( len <= TEST_SMALL_SIZE ) && ( c == 1 );
+    memset( p_block, (int)p_thread->id, len );
+
+    p_thread->p_blocks[p_thread->held] = p_block;
+    p_thread->lens[p_thread->held] = len;
+    p_thread->held_class[c]++;
+    p_thread->held++;
+}
+
+/******************************************************************************
+ * Function Name: test_free()
+ ******************************************************************************
+ * Summary:
+ *   Check the stamp and the claim of a held block, then free it
+ *
+ *****************************************************************************/
+static void test_free( test_thread_t *p_thread, uint32_t slot )
+{
+    const uint8_t *p_block = (const uint8_t *)p_thread->p_blocks[slot];
+    uint32_t len = p_thread->lens[slot];
+    uint32_t c = 0, idx = 0, i, owner;
+
+    test_locate( p_block, &c, &idx );
+    for ( i = 0; i < len; i++ )
+    {
+        if ( p_block[i] != (uint8_t)p_thread->id )
+        {
+            TEST_FAIL( "thread %u: class %u block %u overwritten at byte %u\n", p_thread->id, c, idx, i );
+            break;
+        }
+    }
+    owner = __atomic_exchange_n( &test_owner[c][idx], 0, __ATOMIC_ACQ_REL );
+    if ( owner != p_thread->id )
+    {
+        TEST_FAIL( "thread %u: class %u block %u claimed by thread %u\n", p_thread->id, c, idx, owner );
+    }
+    if ( app_slab_free( &test_pool, p_thread->p_blocks[slot] ) != APP_SLAB_SUCCESS )
+    {
+        TEST_FAIL( "thread %u: free of class %u block %u refused\n", p_thread->id, c, idx );
+    }
+
+    p_thread->held_class[c]--;
+    p_thread->held--;
+    p_thread->p_blocks[slot] = p_thread->p_blocks[p_thread->held];
+    p_thread->lens[slot] = p_thread->lens[p_thread->held];
+}
+
+static void *test_thread_main( void *p_arg )
+{
+    test_thread_t *p_thread = (test_thread_t *)p_arg;
+    uint32_t n, r;
+
+    for ( n = 0; n < TEST_ITERATIONS; n++ )
+    {
+        r = test_rand( &p_thread->seed );
+        /* allocate a little more often than free, so the pool stays near empty */
+        if ( ( p_thread->held < TEST_HELD_MAX ) && ( ( p_thread->held == 0 ) || ( r % 16U < 9U ) ) )
+        {
+            /* mostly small requests, which fall back when the class is empty */
+            test_alloc( p_thread, ( r >> 8 ) % 8U == 0 ? 1U + ( r >> 12 ) % TEST_LARGE_SIZE
+                                                      : 1U + ( r >> 12 ) % TEST_SMALL_SIZE );
+        }
+        else
+        {
+            test_free( p_thread, ( r >> 8 ) % p_thread->held );
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: test_double_free_main()
+ ******************************************************************************
+ * Summary:
+ *   Free the shared block on two threads at once; exactly one may succeed
+ *
+ *****************************************************************************/
+static void *test_double_free_main( void *p_arg )
+{
+    uint32_t *p_succeeded = (uint32_t *)p_arg;
+    uint32_t n;
+
+    for ( n = 0; n < TEST_DOUBLE_FREE_ROUNDS; n++ )
+    {
+        pthread_barrier_wait( &test_barrier );
+        if ( app_slab_free( &test_pool, p_test_shared ) == APP_SLAB_SUCCESS )
+        {
+            __atomic_add_fetch( p_succeeded, 1, __ATOMIC_RELAXED );
+        }
+        pthread_barrier_wait( &test_barrier );
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: test_drain()
+ ******************************************************************************
+ * Summary:
+ *   With nothing held, every block of every class must be allocatable once,
+ *   then the pool is empty
+ *
+ *****************************************************************************/
+static void test_drain( const char *p_what )
+{
+    static void *p_all[TEST_SMALL_COUNT + TEST_LARGE_COUNT];
+    uint32_t c, i, idx, n = 0;
+
+    memset( test_owner, 0, sizeof( test_owner ) );
+    while ( ( n < TEST_SMALL_COUNT + TEST_LARGE_COUNT ) && ( ( p_all[n] = app_slab_alloc( &test_pool, 1 ) ) != NULL ) )
+    {
+        if ( !test_locate( p_all[n], &c, &idx ) || ( test_owner[c][idx]++ != 0 ) )
+        {
+            TEST_FAIL( "%s: block %p handed out twice or foreign\n", p_what, p_all[n] );
+        }
+        n++;
+    }
+    if ( ( n != TEST_SMALL_COUNT + TEST_LARGE_COUNT ) || ( app_slab_alloc( &test_pool, 1 ) != NULL ) )
+    {
+        TEST_FAIL( "%s: %u of %u blocks allocatable\n", p_what, n, TEST_SMALL_COUNT + TEST_LARGE_COUNT );
+    }
+    for ( c = 0; c < 2; c++ )
+    {
+        if ( app_slab_in_use( &test_pool.classes[c] ) != test_pool.classes[c].count )
+        {
+            TEST_FAIL( "%s: class %u has %u in use when empty\n", p_what, c, app_slab_in_use( &test_pool.classes[c] ) );
+        }
+    }
+    for ( i = 0; i < n; i++ )
+    {
+        app_slab_free( &test_pool, p_all[i] );
+    }
+    memset( test_owner, 0, sizeof( test_owner ) );
+}
+
+int main( void )
+{
+    const uint32_t sizes[2] = { TEST_SMALL_SIZE, TEST_LARGE_SIZE };
+    const uint32_t counts[2] = { TEST_SMALL_COUNT, TEST_LARGE_COUNT };
+    pthread_t threads[TEST_THREADS];
+    uint32_t held[2] = { 0, 0 };
+    uint32_t i, c, succeeded = 0;
+    uint64_t fallbacks = 0, failed = 0;
+    uint8_t *p_block;
+
+    if ( app_slab_init( &test_pool, sizes, counts, 2, APP_SLAB_EXHAUST_NEXT_CLASS ) != APP_SLAB_SUCCESS )
+    {
+        fprintf( stderr, "pool init failed\n" );
+        return EXIT_FAILURE;
+    }
+
+    for ( i = 0; i < TEST_THREADS; i++ )
+    {
+        test_threads[i].id = i + 1U;
+        test_threads[i].seed = 0x9E3779B9U * ( i + 1U );
+        if ( pthread_create( &threads[i], NULL, test_thread_main, &test_threads[i] ) != 0 )
+        {
+            fprintf( stderr, "thread create failed\n" );
+            return EXIT_FAILURE;
+        }
+    }
+    for ( i = 0; i < TEST_THREADS; i++ )
+    {
+        pthread_join( threads[i], NULL );
+        held[0] += test_threads[i].held_class[0];
+        held[1] += test_threads[i].held_class[1];
+        fallbacks += test_threads[i].fallbacks;
+        failed += test_threads[i].failed;
+    }
+
+    /* the in use counts balance with what the threads still hold */
+    for ( c = 0; c < 2; c++ )
+    {
+        if ( app_slab_in_use( &test_pool.classes[c] ) != held[c] )
+        {
+            TEST_FAIL( "class %u: %u in use, %u held\n", c, app_slab_in_use( &test_pool.classes[c] ), held[c] );
+        }
+        if ( test_pool.classes[c].high_water > test_pool.classes[c].count )
+        {
+            TEST_FAIL( "class %u: high water %u above %u\n", c, test_pool.classes[c].high_water, test_pool.classes[c].count );
+        }
+    }
+    if ( ( fallbacks == 0 ) || ( failed == 0 ) || ( test_pool.classes[0].exhausted == 0 ) )
+    {
+        TEST_FAIL( "run too tame: %llu fallbacks, %llu failed requests\n", (unsigned long long)fallbacks,
+                   (unsigned long long)failed );
+    }
+    for ( i = 0; i < TEST_THREADS; i++ )
+    {
+        while ( test_threads[i].held > 0 )
+        {
+            test_free( &test_threads[i], 0 );
+        }
+    }
+    for ( c = 0; c < 2; c++ )
+    {
+        if ( app_slab_in_use( &test_pool.classes[c] ) != 0 )
+        {
+            TEST_FAIL( "class %u: %u in use after every free\n", c, app_slab_in_use( &test_pool.classes[c] ) );
+        }
+    }
+    test_drain( "after the threads" );
+
+    /* double frees and foreign pointers are refused and change nothing */
+    p_block = (uint8_t *)app_slab_alloc( &test_pool, 1 );
+    if ( ( app_slab_free( &test_pool, p_block ) != APP_SLAB_SUCCESS ) ||
+         ( app_slab_free( &test_pool, p_block ) != APP_SLAB_ERROR ) ||
+         ( app_slab_free( &test_pool, p_block + 1 ) != APP_SLAB_ERROR ) ||
+         ( app_slab_free( &test_pool, &succeeded ) != APP_SLAB_ERROR ) ||
+         ( app_slab_in_use( &test_pool.classes[0] ) != 0 ) )
+    {
+        TEST_FAIL( "double or foreign free accepted\n" );
+    }
+    pthread_barrier_init( &test_barrier, NULL, 2 );
+    pthread_create( &threads[0], NULL, test_double_free_main, &succeeded );
+    for ( i = 0; i < TEST_DOUBLE_FREE_ROUNDS; i++ )
+    {
+        p_test_shared = app_slab_alloc( &test_pool, 1 );
+        pthread_barrier_wait( &test_barrier );
+        if ( app_slab_free( &test_pool, p_test_shared ) == APP_SLAB_SUCCESS )
+        {
+            __atomic_add_fetch( &succeeded, 1, __ATOMIC_RELAXED );
+        }
+        pthread_barrier_wait( &test_barrier );
+    }
+    pthread_join( threads[0], NULL );
+    pthread_barrier_destroy( &test_barrier );
+    if ( succeeded != TEST_DOUBLE_FREE_ROUNDS )
+    {
+        TEST_FAIL( "%u of %u racing double frees succeeded once\n", succeeded, TEST_DOUBLE_FREE_ROUNDS );
+    }
+    test_drain( "after the double frees" );
+    app_slab_deinit( &test_pool );
+
+    /* without the fallback, an empty small class fails even with large blocks free */
+    if ( app_slab_init( &test_pool, sizes, counts, 2, APP_SLAB_EXHAUST_FAIL ) != APP_SLAB_SUCCESS )
+    {
+        fprintf( stderr, "pool init failed\n" );
+        return EXIT_FAILURE;
+    }
+    for ( i = 0; i < TEST_SMALL_COUNT; i++ )
+    {
+        app_slab_alloc( &test_pool, TEST_SMALL_SIZE );
+    }
+    if ( ( app_slab_alloc( &test_pool, TEST_SMALL_SIZE ) != NULL ) || ( app_slab_in_use( &test_pool.classes[1] ) != 0 ) ||
+         ( test_pool.classes[0].exhausted != 1 ) || ( app_slab_alloc( &test_pool, TEST_SMALL_SIZE + 1U ) == NULL ) )
+    {
+        TEST_FAIL( "exhaust fail policy took a large block\n" );
+    }
+    app_slab_deinit( &test_pool );
+
+    printf( "%u threads x %u operations, %llu fallbacks, %llu failed requests: %s\n", TEST_THREADS, TEST_ITERATIONS,
+            (unsigned long long)fallbacks, (unsigned long long)failed, ( test_failures == 0 ) ? "ok" : "FAILED" );
+    return ( test_failures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
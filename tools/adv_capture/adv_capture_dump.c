@@ -0,0 +1,221 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: adv_capture_dump.c
+ *
+ * Description: Prints the advertising reports of a --capture file, or only
+ *              their count, in a time window found with the capture's block
+ *              index, optionally for one address.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_adv_capture.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define DUMP_NS_PER_SEC                     ( 1000000000U )
+
+/******************************************************************************
+ * Function Name: dump_usage()
+ ******************************************************************************/
+static void dump_usage( const char *p_name )
+{
+    fprintf( stderr,
+             "usage: %s [options] <capture>\n"
+             "  --from <s>       first report time, seconds since the epoch (default: start)\n"
+             "  --to <s>         last report time, seconds since the epoch (default: end)\n"
+             "  --addr <bdaddr>  only reports from xx:xx:xx:xx:xx:xx\n"
+             "  --count          print the totals only\n",
+             p_name );
+}
+
+/******************************************************************************
+ * Function Name: dump_parse_addr()
+ ******************************************************************************
+ * Summary:
+ *   Parse xx:xx:xx:xx:xx:xx, in the order the application prints and the
+ *   capture stores addresses
+ *
+ *****************************************************************************/
+static int dump_parse_addr( const char *p_str, uint8_t *p_addr )
+{
+    unsigned int b[6];
+    int i;
+
+    if ( sscanf( p_str, "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5] ) != 6 )
+    {
+        return -1;
+    }
+    for ( i = 0; i < 6; i++ )
+    {
+        p_addr[i] = (uint8_t)b[i];
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: dump_parse_time()
+ ******************************************************************************
+ * Summary:
+ *   Parse seconds since the epoch, with an optional fraction, into ns
+ *
+ *****************************************************************************/
+static int dump_parse_time( const char *p_str, uint64_t *p_ns )
+{
+    char *p_end;
+    double sec = strtod( p_str, &p_end );
+
+    if ( ( p_end == p_str ) || ( *p_end != '\0' ) || ( sec < 0 ) )
+    {
+        return -1;
+    }
+    *p_ns = (uint64_t)( sec * (double)DUMP_NS_PER_SEC );
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: dump_record()
+ ******************************************************************************/
+static void dump_record( const app_adv_capture_record_t *p_record )
+{
+    uint16_t i;
+
+    printf( "%" PRIu64 ".%06" PRIu64 " %02X:%02X:%02X:%02X:%02X:%02X type %u evt %u rssi %d len %u ",
+            p_record->ts_ns / DUMP_NS_PER_SEC, ( p_record->ts_ns % DUMP_NS_PER_SEC ) / 1000U,
+            p_record->p_addr[0], p_record->p_addr[1], p_record->p_addr[2],
+            p_record->p_addr[3], p_record->p_addr[4], p_record->p_addr[5],
+            p_record->addr_type, p_record->evt_type, p_record->rssi, p_record->adv_len );
+    for ( i = 0; i < p_record->adv_len; i++ )
+    {
+        printf( "%02X", p_record->p_adv[i] );
+    }
+    putchar( '\n' );
+}
+
+int main( int argc, char *argv[] )
+{
+    app_adv_capture_reader_t reader;
+    app_adv_capture_record_t record;
+    uint64_t from_ns = 0, to_ns = UINT64_MAX, first_ns, last_ns, records = 0, ad_bytes = 0;
+    const char *p_path = NULL;
+    uint8_t addr[6];
+    int use_addr = 0, count_only = 0, i;
+
+    for ( i = 1; i < argc; i++ )
+    {
+        const char *p_val = ( i + 1 < argc ) ? argv[i + 1] : NULL;
+
+        if ( strcmp( argv[i], "--count" ) == 0 )
+        {
+            count_only = 1;
+        }
+        else if ( ( strcmp( argv[i], "--from" ) == 0 ) && ( p_val != NULL ) && ( dump_parse_time( p_val, &from_ns ) == 0 ) )
+        {
+            i++;
+        }
+        else if ( ( strcmp( argv[i], "--to" ) == 0 ) && ( p_val != NULL ) && ( dump_parse_time( p_val, &to_ns ) == 0 ) )
+        {
+            i++;
+        }
+        else if ( ( strcmp( argv[i], "--addr" ) == 0 ) && ( p_val != NULL ) && ( dump_parse_addr( p_val, addr ) == 0 ) )
+        {
+            use_addr = 1;
+            i++;
+        }
+        else if ( ( argv[i][0] != '-' ) && ( p_path == NULL ) )
+        {
+            p_path = argv[i];
+        }
+        else
+        {
+            dump_usage( argv[0] );
+            return EXIT_FAILURE;
+        }
+    }
+    if ( p_path == NULL )
+    {
+        dump_usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+    if ( app_adv_capture_reader_open( &reader, p_path ) != APP_ADV_CAPTURE_SUCCESS )
+    {
+        fprintf( stderr, "%s is not a report capture\n", p_path );
+        return EXIT_FAILURE;
+    }
+
+    if ( app_adv_capture_seek( &reader, from_ns ) == APP_ADV_CAPTURE_SUCCESS )
+    {
+        while ( app_adv_capture_next( &reader, &record ) == APP_ADV_CAPTURE_SUCCESS )
+        {
+            if ( record.ts_ns > to_ns )
+            {
+                break;
+            }
+            if ( use_addr && ( memcmp( record.p_addr, addr, sizeof( addr ) ) != 0 ) )
+            {
+                continue;
+            }
+            records++;
+            ad_bytes += record.adv_len;
+            if ( !count_only )
+            {
+                dump_record( &record );
+            }
+        }
+    }
+
+    if ( app_adv_capture_span( &reader, &first_ns, &last_ns ) == APP_ADV_CAPTURE_SUCCESS )
+    {
+        fprintf( stderr, "%s: %u blocks, %zu bytes, %" PRIu64 ".%06" PRIu64 " to %" PRIu64 ".%06" PRIu64 "\n",
+                 p_path, reader.num_blocks, reader.map_len,
+                 first_ns / DUMP_NS_PER_SEC, ( first_ns % DUMP_NS_PER_SEC ) / 1000U,
+                 last_ns / DUMP_NS_PER_SEC, ( last_ns % DUMP_NS_PER_SEC ) / 1000U );
+    }
+    fprintf( stderr, "%" PRIu64 " reports, %" PRIu64 " bytes of advertising data\n", records, ad_bytes );
+    app_adv_capture_reader_close( &reader );
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
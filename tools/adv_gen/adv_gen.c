@@ -0,0 +1,971 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: adv_gen.c
+ *
+ * Description: A synthetic advertiser population for capacity planning.
+ *              Each device gets an address, a payload (16, 32 or 128 bit
+ *              service UUIDs or manufacturer data, in a chosen mix), a mean
+ *              RSSI and an advertising interval drawn from the configured
+ *              distributions. A fraction of the devices are targets that
+ *              carry the wake rule, and a fraction of the others collide
+ *              with it: they advertise the rule's UUID with different
+ *              manufacturer data, as other products of the same vendor do.
+ *
+ *              The advertising events of all devices over --duration are
+ *              merged in time order and:
+ *
+ *              - run through the host filter (app_adv_match.c and the
+ *                device table, as the scan worker does), timing its CPU
+ *                use per report, and counting the wakes a host that
+ *                re-arms --rearm seconds after each wake would see, true
+ *                when the waking device is a target and false otherwise
+ *              - optionally written to a --capture file for --replay
+ *              - optionally written as a wakeonle_hci_sim --adv-file,
+ *                one line per device
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "app_adv_capture.h"
+#include "app_adv_match.h"
+#include "app_device_table.h"
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define GEN_NS_PER_US                       ( 1000ULL )
+#define GEN_NS_PER_SEC                      ( 1000000000ULL )
+/* rule UUID and a full manufacturer pattern do not fit a legacy PDU */
+#define GEN_ADV_MAX                         ( 64U )
+#define GEN_LEGACY_MAX                      ( 31U )
+/* longest --pattern that still fits GEN_ADV_MAX with the rule UUID */
+#define GEN_PATTERN_MAX                     ( 27U )
+#define GEN_BATCH                           ( 1024U )
+/* advertising intervals are at least 20 ms, each event adds 0-10 ms advDelay */
+#define GEN_INTERVAL_MIN_US                 ( 20000U )
+#define GEN_ADV_DELAY_MAX_US                ( 10000U )
+/* report to report RSSI spread around a device's mean */
+#define GEN_RSSI_JITTER                     ( 3 )
+/* COMPANY_ID in wakeon_le.h */
+#define GEN_COMPANY_ID_DEFAULT              ( 0x0009U )
+
+/* wiced_bt_dev_ble_evt_type_t BTM_BLE_EVT_NON_CONNECTABLE_ADVERTISEMENT */
+#define GEN_EVT_NON_CONNECTABLE             ( 3U )
+
+#define GEN_AD_FLAGS                        ( 0x01U )
+#define GEN_AD_UUID16                       ( 0x03U )
+#define GEN_AD_UUID32                       ( 0x05U )
+#define GEN_AD_UUID128                      ( 0x07U )
+#define GEN_AD_MANU                         ( 0xFFU )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef enum
+{
+    GEN_KIND_UUID16 = 0,
+    GEN_KIND_UUID32,
+    GEN_KIND_UUID128,
+    GEN_KIND_MANU,
+    GEN_KIND_COUNT
+} gen_kind_t;
+
+typedef enum
+{
+    GEN_ROLE_OTHER = 0,
+    GEN_ROLE_TARGET,
+    GEN_ROLE_COLLIDE
+} gen_role_t;
+
+typedef enum
+{
+    GEN_DIST_FIXED = 0,
+    GEN_DIST_UNIFORM,
+    GEN_DIST_EXP
+} gen_dist_t;
+
+typedef struct
+{
+    uint8_t     addr[6];
+    uint8_t     addr_type;
+    uint8_t     role;                   /* gen_role_t */
+    int8_t      rssi;                   /* mean */
+    uint8_t     adv_len;
+    uint32_t    interval_us;
+    uint64_t    next_us;
+    uint8_t     adv[GEN_ADV_MAX];
+} gen_device_t;
+
+typedef struct
+{
+    uint32_t    device;
+    int8_t      rssi;
+    uint64_t    ts_us;
+} gen_report_t;
+
+typedef struct
+{
+    /* population */
+    uint32_t        num_devices;
+    double          match_fraction;
+    double          collide_fraction;
+    uint32_t        mix[GEN_KIND_COUNT];
+    uint32_t        mix_total;
+    gen_dist_t      dist;
+    double          interval_a_ms;
+    double          interval_b_ms;
+    double          rssi_mean;
+    double          rssi_sd;
+    double          duration_s;
+    double          rearm_s;
+    uint64_t        seed;
+    /* wake rule, as armed by menu options 3 to 5 */
+    app_adv_rule_t  rule;
+    /* outputs */
+    const char      *p_sim_path;
+    const char      *p_capture_path;
+    int             json;
+    /* state */
+    gen_device_t    *p_devices;
+    uint32_t        *p_heap;
+    uint64_t        rng;
+} gen_t;
+
+typedef struct
+{
+    uint64_t    reports;
+    uint64_t    matched_true;
+    uint64_t    matched_false;
+    uint64_t    missed;                 /* target reports the filter let through */
+    uint64_t    wakes_true;
+    uint64_t    wakes_false;
+    uint64_t    cpu_ns;
+    uint32_t    targets;
+    uint32_t    colliding;
+} gen_stats_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+static gen_t gen =
+{
+    .num_devices        = 1000,
+    .match_fraction     = 0.01,
+    .collide_fraction   = 0.0,
+    .mix                = { 4, 1, 2, 3 },
+    .mix_total          = 10,
+    .dist               = GEN_DIST_UNIFORM,
+    .interval_a_ms      = 100.0,
+    .interval_b_ms      = 1000.0,
+    .rssi_mean          = -75.0,
+    .rssi_sd            = 10.0,
+    .duration_s         = 10.0,
+    .rearm_s            = 5.0,
+    .seed               = 1,
+};
+
+static const char *const gen_kind_names[GEN_KIND_COUNT] = { "uuid16", "uuid32", "uuid128", "manu" };
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+/* xorshift64*, reproducible for a given --seed */
+static uint64_t gen_rand( void )
+{
+    gen.rng ^= gen.rng >> 12;
+    gen.rng ^= gen.rng << 25;
+    gen.rng ^= gen.rng >> 27;
+    return gen.rng * 0x2545F4914F6CDD1DULL;
+}
+
+/* uniform in [0, 1) */
+static double gen_uniform( void )
+{
+    return (double)( gen_rand() >> 11 ) / 9007199254740992.0;
+}
+
+static double gen_normal( double mean, double sd )
+{
+    double u = gen_uniform();
+
+    return mean + sd * sqrt( -2.0 * log( 1.0 - u ) ) * cos( 2.0 * M_PI * gen_uniform() );
+}
+
+static uint8_t gen_byte( void )
+{
+    return (uint8_t)( gen_rand() >> 56 );
+}
+
+/******************************************************************************
+ * Function Name: gen_draw_interval_us()
+ ******************************************************************************
+ * Summary:
+ *   A device's advertising interval from the configured distribution
+ *
+ *****************************************************************************/
+static uint32_t gen_draw_interval_us( void )
+{
+    double ms;
+
+    switch ( gen.dist )
+    {
+    case GEN_DIST_UNIFORM:
+        ms = gen.interval_a_ms + ( gen.interval_b_ms - gen.interval_a_ms ) * gen_uniform();
+        break;
+    case GEN_DIST_EXP:
+        ms = -gen.interval_a_ms * log( 1.0 - gen_uniform() );
+        break;
+    default:
+        ms = gen.interval_a_ms;
+        break;
+    }
+    if ( ms * 1000.0 < GEN_INTERVAL_MIN_US )
+    {
+        return GEN_INTERVAL_MIN_US;
+    }
+    return ( ms * 1000.0 > (double)UINT32_MAX ) ? UINT32_MAX : (uint32_t)( ms * 1000.0 );
+}
+
+static int8_t gen_clamp_rssi( double rssi )
+{
+    if ( rssi < -127.0 )
+    {
+        return -127;
+    }
+    return ( rssi > 20.0 ) ? 20 : (int8_t)lrint( rssi );
+}
+
+/******************************************************************************
+ * Function Name: gen_put_uuids()
+ ******************************************************************************
+ * Summary:
+ *   Append a complete service UUID list of one width. With p_rule_uuid,
+ *   the rule's UUID is one of the entries; random entries never equal it.
+ *
+ *****************************************************************************/
+static uint8_t *gen_put_uuids( uint8_t *p, uint8_t width, const uint8_t *p_rule_uuid )
+{
+    uint32_t count = ( width == 2 ) ? 1U + (uint32_t)( gen_rand() % 3U ) : ( width == 4 ) ? 1U + (uint32_t)( gen_rand() % 2U ) : 1U;
+    uint32_t with_rule = ( p_rule_uuid != NULL ) ? (uint32_t)( gen_rand() % count ) : count;
+    uint32_t i, j;
+
+    *p++ = (uint8_t)( 1U + count * width );
+    *p++ = ( width == 2 ) ? GEN_AD_UUID16 : ( width == 4 ) ? GEN_AD_UUID32 : GEN_AD_UUID128;
+    for ( i = 0; i < count; i++ )
+    {
+        if ( i == with_rule )
+        {
+            memcpy( p, p_rule_uuid, width );
+        }
+        else
+        {
+            for ( j = 0; j < width; j++ )
+            {
+                p[j] = gen_byte();
+            }
+            if ( ( gen.rule.uuid_len == width ) && ( memcmp( p, gen.rule.uuid, width ) == 0 ) )
+            {
+                p[0] ^= 0x01;
+            }
+        }
+        p += width;
+    }
+    return p;
+}
+
+/******************************************************************************
+ * Function Name: gen_put_manu()
+ ******************************************************************************
+ * Summary:
+ *   Append manufacturer data: the rule's company ID and pattern, the
+ *   pattern with its first byte changed (collide), or random data under
+ *   another company ID
+ *
+ *****************************************************************************/
+static uint8_t *gen_put_manu( uint8_t *p, gen_role_t role, uint32_t room )
+{
+    const app_adv_rule_t *p_rule = &gen.rule;
+    uint32_t len, i;
+    uint16_t cid;
+
+    if ( ( role != GEN_ROLE_OTHER ) && p_rule->has_manu )
+    {
+        len = p_rule->pattern_len;
+        cid = p_rule->company_id;
+    }
+    else
+    {
+        len = 4U + (uint32_t)( gen_rand() % 12U );
+        do
+        {
+            cid = (uint16_t)gen_rand();
+        } while ( p_rule->has_manu && ( cid == p_rule->company_id ) );
+    }
+    if ( len + 4U > room )
+    {
+        len = ( room > 4U ) ? room - 4U : 0;
+    }
+    *p++ = (uint8_t)( 3U + len );
+    *p++ = GEN_AD_MANU;
+    *p++ = (uint8_t)cid;
+    *p++ = (uint8_t)( cid >> 8 );
+    for ( i = 0; i < len; i++ )
+    {
+        p[i] = ( ( role != GEN_ROLE_OTHER ) && p_rule->has_manu ) ? p_rule->pattern[i] : gen_byte();
+    }
+    if ( ( role == GEN_ROLE_COLLIDE ) && ( len > 0 ) )
+    {
+        p[0] ^= 0xFF;
+    }
+    return p + len;
+}
+
+/******************************************************************************
+ * Function Name: gen_make_device()
+ ******************************************************************************
+ * Summary:
+ *   Draw one device: address, role, payload, RSSI and interval
+ *
+ *****************************************************************************/
+static void gen_make_device( gen_device_t *p_dev, uint32_t index, gen_role_t role )
+{
+    static const uint8_t widths[GEN_KIND_COUNT] = { 2, 4, 16, 0 };
+    uint8_t *p = p_dev->adv;
+    uint32_t pick, kind;
+
+    /* random static addresses, unique by construction */
+    p_dev->addr[0] = (uint8_t)( 0xC0U | ( gen_byte() & 0x3FU ) );
+    p_dev->addr[1] = gen_byte();
+    p_dev->addr[2] = (uint8_t)( index >> 24 );
+    p_dev->addr[3] = (uint8_t)( index >> 16 );
+    p_dev->addr[4] = (uint8_t)( index >> 8 );
+    p_dev->addr[5] = (uint8_t)index;
+    p_dev->addr_type = 1;
+    p_dev->role = (uint8_t)role;
+    p_dev->rssi = gen_clamp_rssi( gen_normal( gen.rssi_mean, gen.rssi_sd ) );
+    p_dev->interval_us = gen_draw_interval_us();
+    p_dev->next_us = gen_rand() % p_dev->interval_us;
+
+    *p++ = 2;
+    *p++ = GEN_AD_FLAGS;
+    *p++ = 0x06;
+    if ( role != GEN_ROLE_OTHER )
+    {
+        /* a rule with a UUID and manufacturer data needs both, as APCF AND logic does */
+        if ( gen.rule.uuid_len != 0 )
+        {
+            p = gen_put_uuids( p, gen.rule.uuid_len, gen.rule.uuid );
+        }
+        if ( gen.rule.has_manu || ( role == GEN_ROLE_COLLIDE ) )
+        {
+            p = gen_put_manu( p, role, (uint32_t)( p_dev->adv + GEN_ADV_MAX - p ) );
+        }
+    }
+    else
+    {
+        pick = (uint32_t)( gen_rand() % gen.mix_total );
+        for ( kind = 0; pick >= gen.mix[kind]; kind++ )
+        {
+            pick -= gen.mix[kind];
+        }
+        if ( kind == GEN_KIND_MANU )
+        {
+            p = gen_put_manu( p, role, GEN_LEGACY_MAX - 3U );
+        }
+        else
+        {
+            p = gen_put_uuids( p, widths[kind], NULL );
+        }
+    }
+    p_dev->adv_len = (uint8_t)( p - p_dev->adv );
+}
+
+/******************************************************************************
+ * Function Name: gen_heap_*()
+ ******************************************************************************
+ * Summary:
+ *   Min-heap of device indices by next advertising time
+ *
+ *****************************************************************************/
+static void gen_heap_down( uint32_t i, uint32_t n )
+{
+    uint32_t *p_heap = gen.p_heap;
+    uint32_t child, tmp;
+
+    for ( ;; )
+    {
+        child = 2U * i + 1U;
+        if ( child >= n )
+        {
+            break;
+        }
+        if ( ( child + 1U < n ) &&
+             ( gen.p_devices[p_heap[child + 1U]].next_us < gen.p_devices[p_heap[child]].next_us ) )
+        {
+            child++;
+        }
+        if ( gen.p_devices[p_heap[i]].next_us <= gen.p_devices[p_heap[child]].next_us )
+        {
+            break;
+        }
+        tmp = p_heap[i];
+        p_heap[i] = p_heap[child];
+        p_heap[child] = tmp;
+        i = child;
+    }
+}
+
+static void gen_heap_build( uint32_t n )
+{
+    uint32_t i;
+
+    for ( i = 0; i < n; i++ )
+    {
+        gen.p_heap[i] = i;
+    }
+    for ( i = n / 2U; i > 0; i-- )
+    {
+        gen_heap_down( i - 1U, n );
+    }
+}
+
+/******************************************************************************
+ * Function Name: gen_write_sim()
+ ******************************************************************************
+ * Summary:
+ *   Write the population as a wakeonle_hci_sim --adv-file. The simulator
+ *   reports each device at its mean RSSI and fixed interval.
+ *
+ *****************************************************************************/
+static int gen_write_sim( const char *p_path )
+{
+    const gen_device_t *p_dev;
+    FILE *fp = fopen( p_path, "w" );
+    uint32_t i, j;
+
+    if ( fp == NULL )
+    {
+        fprintf( stderr, "open %s failed\n", p_path );
+        return -1;
+    }
+    fprintf( fp, "# wakeonle_adv_gen --devices %u --seed %llu\n", gen.num_devices, (unsigned long long)gen.seed );
+    for ( i = 0; i < gen.num_devices; i++ )
+    {
+        p_dev = &gen.p_devices[i];
+        fprintf( fp, "%02X:%02X:%02X:%02X:%02X:%02X %d ", p_dev->addr[0], p_dev->addr[1], p_dev->addr[2],
+                 p_dev->addr[3], p_dev->addr[4], p_dev->addr[5], p_dev->rssi );
+        for ( j = 0; j < p_dev->adv_len; j++ )
+        {
+            fprintf( fp, "%02X", p_dev->adv[j] );
+        }
+        fprintf( fp, " interval=%u random%s\n", ( p_dev->interval_us + 500U ) / 1000U,
+                 ( p_dev->adv_len > GEN_LEGACY_MAX ) ? " ext" : "" );
+    }
+    if ( fclose( fp ) != 0 )
+    {
+        fprintf( stderr, "write %s failed\n", p_path );
+        return -1;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: gen_filter_batch()
+ ******************************************************************************
+ * Summary:
+ *   Run a batch of reports through the host filter, timing only the filter,
+ *   and classify the matches and wakes
+ *
+ *****************************************************************************/
+static void gen_filter_batch( const app_adv_rule_set_t *p_set, app_device_table_t *p_table,
+                              const gen_report_t *p_reports, uint32_t count, gen_stats_t *p_stats,
+                              uint64_t *p_awake_until_us )
+{
+    static int rules[GEN_BATCH];
+    const gen_device_t *p_dev;
+    struct timespec t0, t1;
+    uint32_t i;
+
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &t0 );
+    for ( i = 0; i < count; i++ )
+    {
+        p_dev = &gen.p_devices[p_reports[i].device];
+        rules[i] = app_adv_rule_set_match( p_set, p_dev->adv, p_dev->adv_len );
+        app_device_table_update( p_table, p_dev->addr, p_dev->addr_type, p_reports[i].rssi,
+                                 ( rules[i] != APP_ADV_MATCH_NONE ) ? gen.rule.filter_idx : 0xFFU,
+                                 p_reports[i].ts_us * GEN_NS_PER_US );
+    }
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &t1 );
+    p_stats->cpu_ns += (uint64_t)( t1.tv_sec - t0.tv_sec ) * GEN_NS_PER_SEC + (uint64_t)t1.tv_nsec - (uint64_t)t0.tv_nsec;
+
+    for ( i = 0; i < count; i++ )
+    {
+        p_dev = &gen.p_devices[p_reports[i].device];
+        if ( rules[i] == APP_ADV_MATCH_NONE )
+        {
+            p_stats->missed += ( p_dev->role == GEN_ROLE_TARGET );
+            continue;
+        }
+        if ( p_dev->role == GEN_ROLE_TARGET )
+        {
+            p_stats->matched_true++;
+        }
+        else
+        {
+            p_stats->matched_false++;
+        }
+        /* armed again: this report wakes the host */
+        if ( p_reports[i].ts_us >= *p_awake_until_us )
+        {
+            if ( p_dev->role == GEN_ROLE_TARGET )
+            {
+                p_stats->wakes_true++;
+            }
+            else
+            {
+                p_stats->wakes_false++;
+            }
+            *p_awake_until_us = p_reports[i].ts_us + (uint64_t)( gen.rearm_s * 1e6 );
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: gen_run()
+ ******************************************************************************
+ * Summary:
+ *   Generate the advertising events of --duration in time order
+ *
+ *****************************************************************************/
+static int gen_run( gen_stats_t *p_stats )
+{
+    static gen_report_t batch[GEN_BATCH];
+    static app_adv_rule_set_t set;
+    static app_device_table_t table;
+    app_adv_capture_writer_t writer;
+    uint64_t end_us = (uint64_t)( gen.duration_s * 1e6 ), awake_until_us = 0;
+    gen_device_t *p_dev;
+    uint32_t count = 0;
+    int capture = 0;
+
+    app_adv_rule_set_init( &set );
+    if ( ( app_adv_rule_set_add( &set, &gen.rule ) != APP_ADV_MATCH_SUCCESS ) ||
+         ( app_device_table_init( &table, gen.num_devices ) != APP_DEVICE_TABLE_SUCCESS ) )
+    {
+        fprintf( stderr, "host filter init failed\n" );
+        return -1;
+    }
+    if ( gen.p_capture_path != NULL )
+    {
+        if ( app_adv_capture_writer_open( &writer, gen.p_capture_path ) != APP_ADV_CAPTURE_SUCCESS )
+        {
+            fprintf( stderr, "open %s failed\n", gen.p_capture_path );
+            app_device_table_deinit( &table );
+            return -1;
+        }
+        capture = 1;
+    }
+
+    gen_heap_build( gen.num_devices );
+    for ( ;; )
+    {
+        p_dev = &gen.p_devices[gen.p_heap[0]];
+        if ( p_dev->next_us >= end_us )
+        {
+            break;
+        }
+        batch[count].device = gen.p_heap[0];
+        batch[count].ts_us = p_dev->next_us;
+        batch[count].rssi = gen_clamp_rssi( p_dev->rssi + (double)( (int)( gen_rand() % ( 2U * GEN_RSSI_JITTER + 1U ) ) - GEN_RSSI_JITTER ) );
+        if ( capture )
+        {
+            app_adv_capture_append( &writer, p_dev->next_us * GEN_NS_PER_US, p_dev->addr, p_dev->addr_type,
+                                    GEN_EVT_NON_CONNECTABLE, batch[count].rssi,
+                                    p_dev->adv, p_dev->adv_len );
+        }
+        if ( ++count == GEN_BATCH )
+        {
+            gen_filter_batch( &set, &table, batch, count, p_stats, &awake_until_us );
+            p_stats->reports += count;
+            count = 0;
+        }
+        p_dev->next_us += p_dev->interval_us + gen_rand() % ( GEN_ADV_DELAY_MAX_US + 1U );
+        gen_heap_down( 0, gen.num_devices );
+    }
+    gen_filter_batch( &set, &table, batch, count, p_stats, &awake_until_us );
+    p_stats->reports += count;
+
+    if ( capture )
+    {
+        app_adv_capture_writer_close( &writer );
+    }
+    app_device_table_deinit( &table );
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: gen_report()
+ ******************************************************************************
+ * Summary:
+ *   Print the results, as text or one JSON object
+ *
+ *****************************************************************************/
+static void gen_report( const gen_stats_t *p_stats )
+{
+    double rate = (double)p_stats->reports / gen.duration_s;
+    double ns_per_report = p_stats->reports ? (double)p_stats->cpu_ns / (double)p_stats->reports : 0.0;
+    double cpu_pct = ns_per_report * rate / 1e7;
+    uint64_t wakes = p_stats->wakes_true + p_stats->wakes_false;
+    double false_pct = wakes ? 100.0 * (double)p_stats->wakes_false / (double)wakes : 0.0;
+    double false_per_hour = (double)p_stats->wakes_false * 3600.0 / gen.duration_s;
+
+    if ( gen.json )
+    {
+        printf( "{\"devices\":%u,\"targets\":%u,\"colliding\":%u,\"duration_s\":%.3f,\"reports\":%llu,"
+                "\"reports_per_s\":%.1f,\"matched_true\":%llu,\"matched_false\":%llu,\"missed\":%llu,"
+                "\"wakes_true\":%llu,\"wakes_false\":%llu,\"false_wake_pct\":%.3f,\"false_wakes_per_hour\":%.1f,"
+                "\"filter_ns_per_report\":%.1f,\"filter_cpu_pct\":%.4f,\"impl\":\"%s\"}\n",
+                gen.num_devices, p_stats->targets, p_stats->colliding, gen.duration_s,
+                (unsigned long long)p_stats->reports, rate, (unsigned long long)p_stats->matched_true,
+                (unsigned long long)p_stats->matched_false, (unsigned long long)p_stats->missed,
+                (unsigned long long)p_stats->wakes_true, (unsigned long long)p_stats->wakes_false,
+                false_pct, false_per_hour, ns_per_report, cpu_pct, app_adv_match_impl() );
+        return;
+    }
+    printf( "devices %u (%u targets, %u colliding), %llu reports in %.1f s: %.0f reports/s\n",
+            gen.num_devices, p_stats->targets, p_stats->colliding, (unsigned long long)p_stats->reports,
+            gen.duration_s, rate );
+    printf( "matches: %llu from targets, %llu from other devices, %llu target reports missed\n",
+            (unsigned long long)p_stats->matched_true, (unsigned long long)p_stats->matched_false,
+            (unsigned long long)p_stats->missed );
+    printf( "wakes (re-armed after %.1f s): %llu true, %llu false (%.1f%%), %.1f false wakes/h\n",
+            gen.rearm_s, (unsigned long long)p_stats->wakes_true, (unsigned long long)p_stats->wakes_false,
+            false_pct, false_per_hour );
+    printf( "host filter (%s): %.1f ns/report, %.3f%% of one CPU at this density\n",
+            app_adv_match_impl(), ns_per_report, cpu_pct );
+}
+
+/******************************************************************************
+ * Function Name: gen_parse_hex()
+ ******************************************************************************
+ * Summary:
+ *   Parse a hex string of at most max bytes
+ *
+ * Return:
+ *  byte count, or -1
+ *
+ *****************************************************************************/
+static int gen_parse_hex( const char *p_str, uint8_t *p_out, uint32_t max )
+{
+    uint32_t len = 0;
+    unsigned int byte;
+
+    while ( ( p_str[0] != '\0' ) && ( p_str[1] != '\0' ) )
+    {
+        if ( ( len == max ) || ( sscanf( p_str, "%2x", &byte ) != 1 ) )
+        {
+            return -1;
+        }
+        p_out[len++] = (uint8_t)byte;
+        p_str += 2;
+    }
+    return ( p_str[0] == '\0' ) ? (int)len : -1;
+}
+
+/******************************************************************************
+ * Function Name: gen_parse_uuid()
+ ******************************************************************************
+ * Summary:
+ *   --uuid takes 4, 8 or 32 hex digits, most significant first as typed at
+ *   the menu, and is kept little endian as on air
+ *
+ *****************************************************************************/
+static int gen_parse_uuid( const char *p_str )
+{
+    uint8_t be[16];
+    int len = gen_parse_hex( p_str, be, sizeof( be ) );
+    int i;
+
+    if ( ( len != 2 ) && ( len != 4 ) && ( len != 16 ) )
+    {
+        return -1;
+    }
+    for ( i = 0; i < len; i++ )
+    {
+        gen.rule.uuid[i] = be[len - 1 - i];
+    }
+    gen.rule.uuid_len = (uint8_t)len;
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: gen_parse_mix()
+ ******************************************************************************
+ * Summary:
+ *   --payload-mix uuid16=<w>,uuid32=<w>,uuid128=<w>,manu=<w>, missing
+ *   kinds get weight 0
+ *
+ *****************************************************************************/
+static int gen_parse_mix( char *p_str )
+{
+    char *p_save = NULL, *p_tok, *p_eq;
+    uint32_t kind;
+
+    memset( gen.mix, 0, sizeof( gen.mix ) );
+    gen.mix_total = 0;
+    for ( p_tok = strtok_r( p_str, ",", &p_save ); p_tok != NULL; p_tok = strtok_r( NULL, ",", &p_save ) )
+    {
+        p_eq = strchr( p_tok, '=' );
+        if ( p_eq == NULL )
+        {
+            return -1;
+        }
+        *p_eq = '\0';
+        for ( kind = 0; ( kind < GEN_KIND_COUNT ) && ( strcmp( p_tok, gen_kind_names[kind] ) != 0 ); kind++ )
+        {
+        }
+        if ( kind == GEN_KIND_COUNT )
+        {
+            return -1;
+        }
+        gen.mix[kind] = (uint32_t)strtoul( p_eq + 1, NULL, 0 );
+        gen.mix_total += gen.mix[kind];
+    }
+    return ( gen.mix_total > 0 ) ? 0 : -1;
+}
+
+/******************************************************************************
+ * Function Name: gen_parse_interval()
+ ******************************************************************************
+ * Summary:
+ *   --interval fixed:<ms>, uniform:<min>:<max> or exp:<mean>
+ *
+ *****************************************************************************/
+static int gen_parse_interval( const char *p_str )
+{
+    if ( sscanf( p_str, "fixed:%lf", &gen.interval_a_ms ) == 1 )
+    {
+        gen.dist = GEN_DIST_FIXED;
+    }
+    else if ( sscanf( p_str, "uniform:%lf:%lf", &gen.interval_a_ms, &gen.interval_b_ms ) == 2 )
+    {
+        gen.dist = GEN_DIST_UNIFORM;
+        return ( gen.interval_b_ms >= gen.interval_a_ms ) ? 0 : -1;
+    }
+    else if ( sscanf( p_str, "exp:%lf", &gen.interval_a_ms ) == 1 )
+    {
+        gen.dist = GEN_DIST_EXP;
+    }
+    else
+    {
+        return -1;
+    }
+    return ( gen.interval_a_ms > 0 ) ? 0 : -1;
+}
+
+static void gen_usage( const char *p_name )
+{
+    fprintf( stderr,
+             "usage: %s [options]\n"
+             "  --devices <n>           advertisers (default 1000)\n"
+             "  --duration <s>          advertising time to generate (default 10)\n"
+             "  --interval <dist>       fixed:<ms>, uniform:<min>:<max> or exp:<mean> (default uniform:100:1000)\n"
+             "  --payload-mix <mix>     uuid16=<w>,uuid32=<w>,uuid128=<w>,manu=<w> (default 4,1,2,3)\n"
+             "  --rssi <mean>:<sd>      normal RSSI distribution of the devices (default -75:10)\n"
+             "  --match <fraction>      devices that carry the wake rule (default 0.01)\n"
+             "  --collide <fraction>    other devices with the rule UUID and other manufacturer data (default 0)\n"
+             "  --uuid <hex>            rule UUID, 4, 8 or 32 hex digits (default 1122)\n"
+             "  --pattern <hex>         rule manufacturer data pattern, up to 27 bytes (default none)\n"
+             "  --company <hex>         rule company ID (default 0009)\n"
+             "  --rearm <s>             host awake time after a wake (default 5)\n"
+             "  --seed <n>              random seed (default 1)\n"
+             "  --sim <path>            write a wakeonle_hci_sim --adv-file\n"
+             "  --capture <path>        write the reports as a --capture file\n"
+             "  --json                  print the results as JSON\n",
+             p_name );
+}
+
+int main( int argc, char *argv[] )
+{
+    gen_stats_t stats;
+    uint8_t pattern[GEN_PATTERN_MAX];
+    const char *p_uuid = "1122";
+    int pattern_len = 0, i, bad = 0;
+    uint32_t n, targets, colliding;
+    double value;
+
+    for ( i = 1; ( i < argc ) && !bad; i++ )
+    {
+        const char *p_opt = argv[i];
+        char *p_val = ( i + 1 < argc ) ? argv[i + 1] : NULL;
+
+        if ( strcmp( p_opt, "--json" ) == 0 )
+        {
+            gen.json = 1;
+            continue;
+        }
+        if ( p_val == NULL )
+        {
+            bad = 1;
+            break;
+        }
+        i++;
+        if ( strcmp( p_opt, "--devices" ) == 0 )
+        {
+            gen.num_devices = (uint32_t)strtoul( p_val, NULL, 0 );
+            bad = ( gen.num_devices == 0 );
+        }
+        else if ( strcmp( p_opt, "--duration" ) == 0 )
+        {
+            gen.duration_s = strtod( p_val, NULL );
+            bad = !( gen.duration_s > 0 );
+        }
+        else if ( strcmp( p_opt, "--interval" ) == 0 )
+        {
+            bad = ( gen_parse_interval( p_val ) != 0 );
+        }
+        else if ( strcmp( p_opt, "--payload-mix" ) == 0 )
+        {
+            bad = ( gen_parse_mix( p_val ) != 0 );
+        }
+        else if ( strcmp( p_opt, "--rssi" ) == 0 )
+        {
+            bad = ( sscanf( p_val, "%lf:%lf", &gen.rssi_mean, &gen.rssi_sd ) != 2 );
+        }
+        else if ( ( strcmp( p_opt, "--match" ) == 0 ) || ( strcmp( p_opt, "--collide" ) == 0 ) )
+        {
+            value = strtod( p_val, NULL );
+            bad = ( value < 0 ) || ( value > 1 );
+            *( ( p_opt[2] == 'm' ) ? &gen.match_fraction : &gen.collide_fraction ) = value;
+        }
+        else if ( strcmp( p_opt, "--uuid" ) == 0 )
+        {
+            p_uuid = p_val;
+        }
+        else if ( strcmp( p_opt, "--pattern" ) == 0 )
+        {
+            pattern_len = gen_parse_hex( p_val, pattern, sizeof( pattern ) );
+            bad = ( pattern_len <= 0 );
+        }
+        else if ( strcmp( p_opt, "--company" ) == 0 )
+        {
+            gen.rule.company_id = (uint16_t)strtoul( p_val, NULL, 16 );
+        }
+        else if ( strcmp( p_opt, "--rearm" ) == 0 )
+        {
+            gen.rearm_s = strtod( p_val, NULL );
+        }
+        else if ( strcmp( p_opt, "--seed" ) == 0 )
+        {
+            gen.seed = strtoull( p_val, NULL, 0 );
+        }
+        else if ( strcmp( p_opt, "--sim" ) == 0 )
+        {
+            gen.p_sim_path = p_val;
+        }
+        else if ( strcmp( p_opt, "--capture" ) == 0 )
+        {
+            gen.p_capture_path = p_val;
+        }
+        else
+        {
+            bad = 1;
+        }
+    }
+    if ( bad || ( gen_parse_uuid( p_uuid ) != 0 ) )
+    {
+        gen_usage( argv[0] );
+        return EXIT_FAILURE;
+    }
+    if ( pattern_len > 0 )
+    {
+        gen.rule.has_manu = 1;
+        gen.rule.company_id_mask = 0xFFFF;
+        if ( gen.rule.company_id == 0 )
+        {
+            gen.rule.company_id = GEN_COMPANY_ID_DEFAULT;
+        }
+        gen.rule.pattern_len = (uint8_t)pattern_len;
+        memcpy( gen.rule.pattern, pattern, (size_t)pattern_len );
+        memset( gen.rule.pattern_mask, 0xFF, (size_t)pattern_len );
+    }
+
+    gen.rng = gen.seed * 0x9E3779B97F4A7C15ULL + 1U;
+    gen.p_devices = malloc( (size_t)gen.num_devices * sizeof( *gen.p_devices ) );
+    gen.p_heap = malloc( (size_t)gen.num_devices * sizeof( *gen.p_heap ) );
+    if ( ( gen.p_devices == NULL ) || ( gen.p_heap == NULL ) )
+    {
+        fprintf( stderr, "out of memory for %u devices\n", gen.num_devices );
+        return EXIT_FAILURE;
+    }
+
+    memset( &stats, 0, sizeof( stats ) );
+    targets = (uint32_t)( gen.match_fraction * gen.num_devices + 0.5 );
+    colliding = (uint32_t)( gen.collide_fraction * ( gen.num_devices - targets ) + 0.5 );
+    for ( n = 0; n < gen.num_devices; n++ )
+    {
+        gen_make_device( &gen.p_devices[n], n,
+                         ( n < targets ) ? GEN_ROLE_TARGET : ( n < targets + colliding ) ? GEN_ROLE_COLLIDE : GEN_ROLE_OTHER );
+    }
+    stats.targets = targets;
+    stats.colliding = colliding;
+
+    if ( ( gen.p_sim_path != NULL ) && ( gen_write_sim( gen.p_sim_path ) != 0 ) )
+    {
+        return EXIT_FAILURE;
+    }
+    if ( gen_run( &stats ) != 0 )
+    {
+        return EXIT_FAILURE;
+    }
+    gen_report( &stats );
+    free( gen.p_heap );
+    free( gen.p_devices );
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,604 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+
+/******************************************************************************
+ * File Name: bench_compare.c
+ *
+ * Description: Compares wakeonle_bench --json results against a baseline
+ *              and fails when a benchmark got slower by more than a
+ *              tolerance, or the peak RSS grew by more than another.
+ *
+ *              Single medians are too noisy to gate on, so each benchmark
+ *              is judged on all of its samples, pooled over any number of
+ *              runs on each side: a regression needs both a median slowdown
+ *              past --tolerance and a one-sided Mann-Whitney U test that
+ *              rejects "no slower" at --alpha. --merge pools several runs
+ *              into one file, which is how baselines are made.
+ *
+ *              The reader understands the documents wakeonle_bench writes
+ *              and nothing more general. Other producers, eg: the arm and
+ *              wake latency run of tools/latency_gate.sh, are gated the
+ *              same way by writing results in that shape. A benchmark of
+ *              the baseline missing from the current results regresses.
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define CMP_NAME_MAX                        ( 96U )
+#define CMP_FILES_MAX                       ( 32U )
+#define CMP_TOLERANCE_DEFAULT               ( 10.0 )
+#define CMP_RSS_TOLERANCE_DEFAULT           ( 10.0 )
+#define CMP_ALPHA_DEFAULT                   ( 0.01 )
+/* fewer samples per side than this cannot reach a useful p-value */
+#define CMP_MIN_SAMPLES                     ( 3U )
+
+#define CMP_EXIT_OK                         ( 0 )
+#define CMP_EXIT_REGRESSED                  ( 1 )
+#define CMP_EXIT_ERROR                      ( 2 )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    char        suite[CMP_NAME_MAX];
+    char        name[CMP_NAME_MAX];
+    double      *p_samples;
+    uint32_t    count;
+    uint32_t    alloc;
+} cmp_entry_t;
+
+/* one side of the comparison, any number of runs pooled */
+typedef struct
+{
+    cmp_entry_t *p_entries;
+    uint32_t    count;
+    uint32_t    alloc;
+    double      rss_kb[CMP_FILES_MAX];
+    uint32_t    num_rss;
+    uint32_t    num_files;
+    char        machine[CMP_NAME_MAX];
+} cmp_set_t;
+
+typedef struct
+{
+    double      value;
+    uint32_t    current;            /* 1 for the current side */
+} cmp_rank_t;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static char *cmp_read_file( const char *p_path )
+{
+    FILE *fp = fopen( p_path, "rb" );
+    char *p_text = NULL;
+    long len;
+
+    if ( fp == NULL )
+    {
+        return NULL;
+    }
+    if ( ( fseek( fp, 0, SEEK_END ) == 0 ) && ( ( len = ftell( fp ) ) >= 0 ) && ( fseek( fp, 0, SEEK_SET ) == 0 ) )
+    {
+        p_text = malloc( (size_t)len + 1U );
+        if ( ( p_text != NULL ) && ( fread( p_text, 1, (size_t)len, fp ) != (size_t)len ) )
+        {
+            free( p_text );
+            p_text = NULL;
+        }
+        if ( p_text != NULL )
+        {
+            p_text[len] = '\0';
+        }
+    }
+    fclose( fp );
+    return p_text;
+}
+
+/******************************************************************************
+ * Function Name: cmp_find_key()
+ ******************************************************************************
+ * Summary:
+ *   Find "key": between p and p_end
+ *
+ * Return:
+ *  pointer past the colon, or NULL
+ *
+ *****************************************************************************/
+static const char *cmp_find_key( const char *p, const char *p_end, const char *p_key )
+{
+    size_t key_len = strlen( p_key );
+
+    for ( ; p + key_len + 2 < p_end; p++ )
+    {
+        if ( ( p[0] == '"' ) && ( strncmp( p + 1, p_key, key_len ) == 0 ) && ( p[key_len + 1] == '"' ) )
+        {
+            p += key_len + 2;
+            while ( ( p < p_end ) && ( ( *p == ' ' ) || ( *p == ':' ) ) )
+            {
+                p++;
+            }
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static int cmp_get_string( const char *p, const char *p_end, const char *p_key, char *p_out, size_t size )
+{
+    const char *p_close;
+
+    p = cmp_find_key( p, p_end, p_key );
+    if ( ( p == NULL ) || ( *p != '"' ) )
+    {
+        return -1;
+    }
+    p++;
+    p_close = memchr( p, '"', (size_t)( p_end - p ) );
+    if ( ( p_close == NULL ) || ( (size_t)( p_close - p ) >= size ) )
+    {
+        return -1;
+    }
+    memcpy( p_out, p, (size_t)( p_close - p ) );
+    p_out[p_close - p] = '\0';
+    return 0;
+}
+
+static cmp_entry_t *cmp_entry( cmp_set_t *p_set, const char *p_suite, const char *p_name )
+{
+    cmp_entry_t *p_entry;
+    uint32_t i;
+
+    for ( i = 0; i < p_set->count; i++ )
+    {
+        if ( ( strcmp( p_set->p_entries[i].suite, p_suite ) == 0 ) && ( strcmp( p_set->p_entries[i].name, p_name ) == 0 ) )
+        {
+            return &p_set->p_entries[i];
+        }
+    }
+    if ( p_set->count == p_set->alloc )
+    {
+        p_entry = realloc( p_set->p_entries, ( p_set->alloc * 2U + 16U ) * sizeof( *p_entry ) );
+        if ( p_entry == NULL )
+        {
+            return NULL;
+        }
+        p_set->p_entries = p_entry;
+        p_set->alloc = p_set->alloc * 2U + 16U;
+    }
+    p_entry = &p_set->p_entries[p_set->count++];
+    memset( p_entry, 0, sizeof( *p_entry ) );
+    snprintf( p_entry->suite, sizeof( p_entry->suite ), "%s", p_suite );
+    snprintf( p_entry->name, sizeof( p_entry->name ), "%s", p_name );
+    return p_entry;
+}
+
+static int cmp_add_sample( cmp_entry_t *p_entry, double value )
+{
+    double *p_samples;
+
+    if ( p_entry->count == p_entry->alloc )
+    {
+        p_samples = realloc( p_entry->p_samples, ( p_entry->alloc * 2U + 8U ) * sizeof( double ) );
+        if ( p_samples == NULL )
+        {
+            return -1;
+        }
+        p_entry->p_samples = p_samples;
+        p_entry->alloc = p_entry->alloc * 2U + 8U;
+    }
+    p_entry->p_samples[p_entry->count++] = value;
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: cmp_load()
+ ******************************************************************************
+ * Summary:
+ *   Add the results of one wakeonle_bench --json document to a set. Every
+ *   sample of samples_ns is used; documents without them give ns_per_op.
+ *
+ *****************************************************************************/
+static int cmp_load( cmp_set_t *p_set, const char *p_path )
+{
+    char suite[CMP_NAME_MAX], name[CMP_NAME_MAX];
+    const char *p, *p_obj, *p_obj_end, *p_end;
+    cmp_entry_t *p_entry;
+    char *p_text, *p_num_end;
+    double value;
+
+    p_text = cmp_read_file( p_path );
+    if ( p_text == NULL )
+    {
+        fprintf( stderr, "cannot read %s\n", p_path );
+        return -1;
+    }
+    p_end = p_text + strlen( p_text );
+    if ( p_set->machine[0] == '\0' )
+    {
+        cmp_get_string( p_text, p_end, "machine", p_set->machine, sizeof( p_set->machine ) );
+    }
+    p = cmp_find_key( p_text, p_end, "results" );
+    if ( ( p == NULL ) || ( *p != '[' ) )
+    {
+        fprintf( stderr, "%s has no results\n", p_path );
+        free( p_text );
+        return -1;
+    }
+
+    /* result objects hold no nested objects */
+    for ( p_obj = strchr( p, '{' ); p_obj != NULL; p_obj = strchr( p_obj_end, '{' ) )
+    {
+        p_obj_end = strchr( p_obj, '}' );
+        if ( p_obj_end == NULL )
+        {
+            break;
+        }
+        if ( ( cmp_get_string( p_obj, p_obj_end, "suite", suite, sizeof( suite ) ) != 0 ) ||
+             ( cmp_get_string( p_obj, p_obj_end, "name", name, sizeof( name ) ) != 0 ) ||
+             ( ( p_entry = cmp_entry( p_set, suite, name ) ) == NULL ) )
+        {
+            continue;
+        }
+        p = cmp_find_key( p_obj, p_obj_end, "samples_ns" );
+        if ( ( p != NULL ) && ( *p == '[' ) )
+        {
+            for ( p++; ( p < p_obj_end ) && ( *p != ']' ); p = p_num_end )
+            {
+                while ( ( *p == ' ' ) || ( *p == ',' ) || ( *p == '\n' ) )
+                {
+                    p++;
+                }
+                value = strtod( p, &p_num_end );
+                if ( p_num_end == p )
+                {
+                    break;
+                }
+                cmp_add_sample( p_entry, value );
+            }
+        }
+        else if ( ( p = cmp_find_key( p_obj, p_obj_end, "ns_per_op" ) ) != NULL )
+        {
+            cmp_add_sample( p_entry, strtod( p, NULL ) );
+        }
+    }
+
+    p = cmp_find_key( p_text, p_end, "max_rss_kb" );
+    if ( ( p != NULL ) && ( p_set->num_rss < CMP_FILES_MAX ) )
+    {
+        p_set->rss_kb[p_set->num_rss++] = strtod( p, NULL );
+    }
+    p_set->num_files++;
+    free( p_text );
+    return 0;
+}
+
+static int cmp_double( const void *p_a, const void *p_b )
+{
+    double a = *(const double *)p_a;
+    double b = *(const double *)p_b;
+
+    return ( a > b ) - ( a < b );
+}
+
+static double cmp_median( double *p_values, uint32_t count )
+{
+    qsort( p_values, count, sizeof( double ), cmp_double );
+    return ( count & 1U ) ? p_values[count / 2U] : 0.5 * ( p_values[count / 2U - 1U] + p_values[count / 2U] );
+}
+
+static int cmp_rank_order( const void *p_a, const void *p_b )
+{
+    return cmp_double( &( (const cmp_rank_t *)p_a )->value, &( (const cmp_rank_t *)p_b )->value );
+}
+
+/******************************************************************************
+ * Function Name: cmp_mann_whitney()
+ ******************************************************************************
+ * Summary:
+ *   One-sided Mann-Whitney U test that the current samples are larger
+ *   (slower) than the baseline ones, by the normal approximation with tie
+ *   and continuity corrections
+ *
+ * Return:
+ *  p-value
+ *
+ *****************************************************************************/
+static double cmp_mann_whitney( const cmp_entry_t *p_base, const cmp_entry_t *p_cur )
+{
+    uint32_t n1 = p_cur->count, n2 = p_base->count, n = n1 + n2;
+    double rank_sum = 0.0, ties = 0.0, u, mean, var, z, t;
+    cmp_rank_t *p_all;
+    uint32_t i, j, k;
+
+    p_all = malloc( n * sizeof( *p_all ) );
+    if ( p_all == NULL )
+    {
+        return 1.0;
+    }
+    for ( i = 0; i < n2; i++ )
+    {
+        p_all[i].value = p_base->p_samples[i];
+        p_all[i].current = 0;
+    }
+    for ( i = 0; i < n1; i++ )
+    {
+        p_all[n2 + i].value = p_cur->p_samples[i];
+        p_all[n2 + i].current = 1;
+    }
+    qsort( p_all, n, sizeof( *p_all ), cmp_rank_order );
+
+    for ( i = 0; i < n; i = j )
+    {
+        for ( j = i + 1U; ( j < n ) && ( p_all[j].value == p_all[i].value ); j++ )
+        {
+        }
+        /* ranks i+1 .. j share their average */
+        for ( k = i; k < j; k++ )
+        {
+            if ( p_all[k].current )
+            {
+                rank_sum += 0.5 * (double)( i + 1U + j );
+            }
+        }
+        t = (double)( j - i );
+        ties += t * t * t - t;
+    }
+    free( p_all );
+
+    u = rank_sum - 0.5 * (double)n1 * (double)( n1 + 1U );
+    mean = 0.5 * (double)n1 * (double)n2;
+    var = (double)n1 * (double)n2 / 12.0 * ( (double)( n + 1U ) - ties / ( (double)n * (double)( n - 1U ) ) );
+    if ( var <= 0.0 )
+    {
+        return 1.0;
+    }
+    z = ( u - mean - 0.5 ) / sqrt( var );
+    return 0.5 * erfc( z / sqrt( 2.0 ) );
+}
+
+/******************************************************************************
+ * Function Name: cmp_merge()
+ ******************************************************************************
+ * Summary:
+ *   Write a set as one document in the wakeonle_bench --json shape
+ *
+ *****************************************************************************/
+static int cmp_merge( cmp_set_t *p_set, const char *p_path )
+{
+    FILE *fp = ( strcmp( p_path, "-" ) == 0 ) ? stdout : fopen( p_path, "w" );
+    double rss = 0.0, median;
+    cmp_entry_t *p_entry;
+    uint32_t i, j;
+
+    if ( fp == NULL )
+    {
+        fprintf( stderr, "cannot write %s\n", p_path );
+        return -1;
+    }
+    fprintf( fp, "{\n  \"machine\": \"%s\",\n  \"runs\": %u,\n  \"results\": [", p_set->machine, p_set->num_files );
+    for ( i = 0; i < p_set->count; i++ )
+    {
+        p_entry = &p_set->p_entries[i];
+        fprintf( fp, "%s\n    { \"suite\": \"%s\", \"name\": \"%s\", ", ( i > 0 ) ? "," : "", p_entry->suite, p_entry->name );
+        median = ( p_entry->count > 0 ) ? cmp_median( p_entry->p_samples, p_entry->count ) : 0.0;
+        fprintf( fp, "\"ns_per_op\": %.3f,\n      \"samples_ns\": [", median );
+        for ( j = 0; j < p_entry->count; j++ )
+        {
+            fprintf( fp, "%s%.3f", ( j > 0 ) ? ", " : "", p_entry->p_samples[j] );
+        }
+        fprintf( fp, "] }" );
+    }
+    /* the worst run is the one to keep */
+    for ( i = 0; i < p_set->num_rss; i++ )
+    {
+        rss = ( p_set->rss_kb[i] > rss ) ? p_set->rss_kb[i] : rss;
+    }
+    fprintf( fp, "\n  ],\n  \"max_rss_kb\": %.0f\n}\n", rss );
+    if ( ( fp != stdout ) && ( fclose( fp ) != 0 ) )
+    {
+        fprintf( stderr, "cannot write %s\n", p_path );
+        return -1;
+    }
+    return 0;
+}
+
+static void cmp_usage( const char *p_name )
+{
+    fprintf( stderr,
+             "usage: %s [options] --baseline <json> [--baseline <json> ...] <json> ...\n"
+             "       %s --merge <out> <json> ...\n"
+             "  --tolerance <pct>      allowed median slowdown per benchmark (default %.0f)\n"
+             "  --rss-tolerance <pct>  allowed growth of the peak RSS (default %.0f)\n"
+             "  --alpha <p>            significance level of the U test (default %.2f)\n"
+             "  --filter <text>        compare benchmarks whose suite or name contains text\n"
+             "exit status: 0 no regression, 1 regression, 2 error\n",
+             p_name, p_name, CMP_TOLERANCE_DEFAULT, CMP_RSS_TOLERANCE_DEFAULT, CMP_ALPHA_DEFAULT );
+}
+
+int main( int argc, char *argv[] )
+{
+    static cmp_set_t base, cur;
+    const char *p_base_files[CMP_FILES_MAX];
+    const char *p_cur_files[CMP_FILES_MAX];
+    const char *p_merge = NULL, *p_filter = NULL, *p_verdict;
+    double tolerance = CMP_TOLERANCE_DEFAULT, rss_tolerance = CMP_RSS_TOLERANCE_DEFAULT, alpha = CMP_ALPHA_DEFAULT;
+    double mb, mc, change, p_value;
+    uint32_t num_base = 0, num_cur = 0, i, regressed = 0, compared = 0;
+    cmp_entry_t *p_base, *p_cur;
+    int a;
+
+    for ( a = 1; a < argc; a++ )
+    {
+        const char *p_val = ( a + 1 < argc ) ? argv[a + 1] : NULL;
+
+        if ( ( strcmp( argv[a], "--baseline" ) == 0 ) && ( p_val != NULL ) && ( num_base < CMP_FILES_MAX ) )
+        {
+            p_base_files[num_base++] = argv[++a];
+        }
+        else if ( ( strcmp( argv[a], "--merge" ) == 0 ) && ( p_val != NULL ) )
+        {
+            p_merge = argv[++a];
+        }
+        else if ( ( strcmp( argv[a], "--tolerance" ) == 0 ) && ( p_val != NULL ) )
+        {
+            tolerance = strtod( argv[++a], NULL );
+        }
+        else if ( ( strcmp( argv[a], "--rss-tolerance" ) == 0 ) && ( p_val != NULL ) )
+        {
+            rss_tolerance = strtod( argv[++a], NULL );
+        }
+        else if ( ( strcmp( argv[a], "--alpha" ) == 0 ) && ( p_val != NULL ) )
+        {
+            alpha = strtod( argv[++a], NULL );
+        }
+        else if ( ( strcmp( argv[a], "--filter" ) == 0 ) && ( p_val != NULL ) )
+        {
+            p_filter = argv[++a];
+        }
+        else if ( ( argv[a][0] != '-' ) && ( num_cur < CMP_FILES_MAX ) )
+        {
+            p_cur_files[num_cur++] = argv[a];
+        }
+        else
+        {
+            cmp_usage( argv[0] );
+            return CMP_EXIT_ERROR;
+        }
+    }
+    if ( ( num_cur == 0 ) || ( ( p_merge == NULL ) && ( num_base == 0 ) ) )
+    {
+        cmp_usage( argv[0] );
+        return CMP_EXIT_ERROR;
+    }
+
+    for ( i = 0; i < num_cur; i++ )
+    {
+        if ( cmp_load( &cur, p_cur_files[i] ) != 0 )
+        {
+            return CMP_EXIT_ERROR;
+        }
+    }
+    if ( p_merge != NULL )
+    {
+        return ( cmp_merge( &cur, p_merge ) == 0 ) ? CMP_EXIT_OK : CMP_EXIT_ERROR;
+    }
+    for ( i = 0; i < num_base; i++ )
+    {
+        if ( cmp_load( &base, p_base_files[i] ) != 0 )
+        {
+            return CMP_EXIT_ERROR;
+        }
+    }
+    if ( strcmp( base.machine, cur.machine ) != 0 )
+    {
+        fprintf( stderr, "warning: baseline from %s, current run on %s\n", base.machine, cur.machine );
+    }
+
+    printf( "%-10s %-34s %12s %12s %8s %9s  %s\n", "suite", "name", "base ns/op", "ns/op", "change", "p", "verdict" );
+    for ( i = 0; i < base.count; i++ )
+    {
+        p_base = &base.p_entries[i];
+        if ( ( p_filter != NULL ) && ( strstr( p_base->suite, p_filter ) == NULL ) && ( strstr( p_base->name, p_filter ) == NULL ) )
+        {
+            continue;
+        }
+        p_cur = cmp_entry( &cur, p_base->suite, p_base->name );
+        if ( ( p_cur == NULL ) || ( p_cur->count == 0 ) || ( p_base->count == 0 ) )
+        {
+            /* a benchmark that stopped running (or reporting) must not pass the gate */
+            printf( "%-10s %-34s %12s %12s %8s %9s  REGRESSED (missing)\n", p_base->suite, p_base->name, "", "", "", "" );
+            regressed++;
+            continue;
+        }
+        p_value = cmp_mann_whitney( p_base, p_cur );
+        mb = cmp_median( p_base->p_samples, p_base->count );
+        mc = cmp_median( p_cur->p_samples, p_cur->count );
+        change = ( mb > 0.0 ) ? 100.0 * ( mc / mb - 1.0 ) : 0.0;
+        compared++;
+
+        if ( change <= tolerance )
+        {
+            p_verdict = "ok";
+        }
+        else if ( ( p_cur->count < CMP_MIN_SAMPLES ) || ( p_base->count < CMP_MIN_SAMPLES ) )
+        {
+            /* nothing to test with, the tolerance alone decides */
+            p_verdict = "REGRESSED (too few samples for the U test)";
+            regressed++;
+        }
+        else if ( p_value < alpha )
+        {
+            p_verdict = "REGRESSED";
+            regressed++;
+        }
+        else
+        {
+            p_verdict = "noise";
+        }
+        printf( "%-10s %-34s %12.2f %12.2f %+7.1f%% %9.2g  %s\n", p_base->suite, p_base->name, mb, mc, change, p_value,
+                p_verdict );
+    }
+
+    if ( ( base.num_rss > 0 ) && ( cur.num_rss > 0 ) )
+    {
+        mb = cmp_median( base.rss_kb, base.num_rss );
+        mc = cmp_median( cur.rss_kb, cur.num_rss );
+        change = ( mb > 0.0 ) ? 100.0 * ( mc / mb - 1.0 ) : 0.0;
+        printf( "%-10s %-34s %12.0f %12.0f %+7.1f%% %9s  %s\n", "process", "max_rss_kb", mb, mc, change, "",
+                ( change > rss_tolerance ) ? "REGRESSED" : "ok" );
+        regressed += ( change > rss_tolerance );
+    }
+
+    printf( "%u benchmarks compared, %u regressed (tolerance %.1f%%, alpha %.3g, %u baseline and %u current runs)\n",
+            compared, regressed, tolerance, alpha, base.num_files, cur.num_files );
+    return ( regressed > 0 ) ? CMP_EXIT_REGRESSED : CMP_EXIT_OK;
+}
+
+/* [] END OF FILE */
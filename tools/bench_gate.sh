@@ -0,0 +1,107 @@
+#!/bin/bash
+#
+# Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#
+# File Name: bench_gate.sh
+#
+# Description: Performance regression gate. Runs wakeonle_bench several
+#              times and compares the pooled samples with a stored baseline
+#              using wakeonle_bench_compare, or with -w pools them into a
+#              new baseline. Used by the bench_regression CTest test and
+#              the bench_baseline target.
+#
+# Related Document: See README.md
+#
+
+set -u
+
+runs=3
+time_ms=200
+samples=10
+tolerance=10
+write=0
+
+usage()
+{
+    echo "Usage: $0 [-r <runs>] [-t <ms>] [-s <samples>] [-k <percent>] [-w] <wakeonle_bench> <wakeonle_bench_compare> <baseline> [-- <bench arguments>]"
+    echo "  -r  bench runs, each a separate process (default $runs)"
+    echo "  -t  measuring time per benchmark and run (default $time_ms)"
+    echo "  -s  samples per benchmark and run (default $samples)"
+    echo "  -k  allowed median slowdown and RSS growth in percent (default $tolerance)"
+    echo "  -w  write the baseline instead of comparing with it"
+    exit 2
+}
+
+while getopts "r:t:s:k:wh" opt; do
+    case $opt in
+        r) runs=$OPTARG ;;
+        t) time_ms=$OPTARG ;;
+        s) samples=$OPTARG ;;
+        k) tolerance=$OPTARG ;;
+        w) write=1 ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -ge 3 ] || usage
+bench=$1
+compare=$2
+baseline=$3
+shift 3
+[ $# -gt 0 ] && [ "$1" = "--" ] && shift
+
+if [ $write -eq 0 ] && [ ! -f "$baseline" ]; then
+    echo "no baseline $baseline, create it with -w" >&2
+    exit 2
+fi
+
+work=$(mktemp -d /tmp/wakeonle_bench_gate.XXXXXX)
+trap 'rm -rf "$work"' EXIT
+
+# separate processes, so that code and heap layout vary between runs
+results=()
+for run in $(seq 1 "$runs"); do
+    if ! "$bench" --json --time "$time_ms" --samples "$samples" "$@" > "$work/run$run.json"; then
+        echo "$bench failed in run $run" >&2
+        exit 2
+    fi
+    results+=("$work/run$run.json")
+done
+
+if [ $write -eq 1 ]; then
+    mkdir -p "$(dirname "$baseline")"
+    "$compare" --merge "$baseline" "${results[@]}" || exit 2
+    echo "baseline of $runs runs written to $baseline"
+    exit 0
+fi
+
+"$compare" --tolerance "$tolerance" --rss-tolerance "$tolerance" --baseline "$baseline" "${results[@]}"
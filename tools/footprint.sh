@@ -0,0 +1,140 @@
+#!/bin/bash
+#
+# Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#
+# File Name: footprint.sh
+#
+# Description: Measure the memory footprint of one or more wakeonle builds,
+#              for example the default and the scanner-only profile. Each
+#              binary is started against the controller with the same
+#              arguments, optionally fed menu input (to arm a rule), left
+#              to run, then measured: VmRSS, VmHWM, PSS and private dirty
+#              memory from /proc, and the BT stack heap statistics from the
+#              metrics socket. The application is then told to exit.
+#
+# Related Document: See README.md
+#
+
+set -u
+
+settle=10
+menu=""
+
+usage()
+{
+    echo "Usage: $0 [-t <seconds>] [-m <menu input>] <label>=<binary> [...] -- <application arguments>"
+    echo "  -t  seconds to run before measuring (default $settle)"
+    echo "  -m  menu input sent after start, eg: \$'3\\nAA BB\\n' to arm a 16-bit UUID rule"
+    exit 1
+}
+
+while getopts "t:m:h" opt; do
+    case $opt in
+        t) settle=$OPTARG ;;
+        m) menu=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+builds=()
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    case $1 in
+        *=*) builds+=("$1") ;;
+        *) usage ;;
+    esac
+    shift
+done
+[ $# -gt 0 ] && shift
+[ ${#builds[@]} -gt 0 ] || usage
+
+command -v curl > /dev/null || { echo "curl is required to read the metrics" >&2; exit 1; }
+
+work=$(mktemp -d /tmp/wakeonle_footprint.XXXXXX)
+trap 'rm -rf "$work"' EXIT
+
+# <field> from /proc/<pid>/<file>, in kB
+proc_kb()
+{
+    awk -v f="$3:" '$1 == f { print $2; exit }' "/proc/$1/$2" 2> /dev/null
+}
+
+# value of metric <name> with the default heap label
+heap_metric()
+{
+    awk -v m="$1{heap=\"default_heap\"}" '$1 == m { print $2; exit }' "$work/metrics"
+}
+
+printf "%-12s %10s %10s %10s %12s %12s %14s %14s\n" \
+    "profile" "rss_kB" "hwm_kB" "pss_kB" "private_kB" "heap_bytes" "heap_high_water" "heap_recommended"
+
+for build in "${builds[@]}"; do
+    label=${build%%=*}
+    binary=${build#*=}
+    sock="$work/$label.metrics"
+    fifo="$work/$label.stdin"
+
+    mkfifo "$fifo"
+    "$binary" --metrics "$sock" "$@" < "$fifo" > "$work/$label.log" 2>&1 &
+    pid=$!
+    # hold the menu's stdin open until the measurement is done
+    exec 3> "$fifo"
+    [ -n "$menu" ] && printf "%s" "$menu" >&3
+
+    sleep "$settle"
+    if ! kill -0 "$pid" 2> /dev/null; then
+        echo "$label: $binary exited early, see its output:" >&2
+        cat "$work/$label.log" >&2
+        exec 3>&-
+        continue
+    fi
+
+    rss=$(proc_kb "$pid" status VmRSS)
+    hwm=$(proc_kb "$pid" status VmHWM)
+    pss=$(proc_kb "$pid" smaps_rollup Pss)
+    priv=$(( $(proc_kb "$pid" smaps_rollup Private_Clean) + $(proc_kb "$pid" smaps_rollup Private_Dirty) ))
+    curl -s --max-time 5 --unix-socket "$sock" http://localhost/metrics > "$work/metrics"
+
+    printf "%-12s %10s %10s %10s %12s %12s %14s %14s\n" "$label" "$rss" "$hwm" "$pss" "$priv" \
+        "$(heap_metric wakeonle_heap_size_bytes)" "$(heap_metric wakeonle_heap_high_water_bytes)" \
+        "$(heap_metric wakeonle_heap_recommended_bytes)"
+
+    # menu entry 0 exits the application
+    printf "0\n" >&3
+    exec 3>&-
+    for _ in 1 2 3 4 5; do
+        kill -0 "$pid" 2> /dev/null || break
+        sleep 1
+    done
+    kill "$pid" 2> /dev/null
+    wait "$pid" 2> /dev/null
+done
@@ -0,0 +1,1791 @@
+/*
+* Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*/
+
+/******************************************************************************
+ * File Name: hci_sim.c
+ *
+ * Description: A software HCI controller for running the application
+ *              without hardware. It opens a pseudo-terminal whose slave the
+ *              application uses as its HCI port (-c), speaks H4 on it and
+ *              implements:
+ *
+ *              - the standard commands the stack sends at init and the
+ *                legacy and extended LE scan commands
+ *              - the vendor commands behind wiced_set_apcf_*() (0xFD57) and
+ *                wiced_set_sleep_mode_with_param() (0xFC27), and the patch
+ *                download and baud rate commands, which it accepts
+ *              - advertisers loaded from files or typed on stdin, reported
+ *                while the host scans and filtered by the APCF filters
+ *              - a HOST-WAKE line, asserted when a filter matches while
+ *                sleep mode is on, and released when sleep mode is turned
+ *                off. It can drive a gpio-sim line so the application sees
+ *                a real GPIO edge.
+ *              - per-command response latency and failure injection
+ *
+ * Related Document: See README.md
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *                                INCLUDES
+ *****************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+*                           MACROS
+*******************************************************************************/
+#define SIM_H4_CMD                          ( 0x01 )
+#define SIM_H4_ACL                          ( 0x02 )
+#define SIM_H4_EVT                          ( 0x04 )
+
+#define SIM_EVT_CMD_COMPLETE                ( 0x0E )
+#define SIM_EVT_LE_META                     ( 0x3E )
+#define SIM_LE_ADV_REPORT                   ( 0x02 )
+#define SIM_LE_EXT_ADV_REPORT               ( 0x0D )
+
+#define SIM_OP_RESET                        ( 0x0C03 )
+#define SIM_OP_LE_SET_SCAN_ENABLE           ( 0x200C )
+#define SIM_OP_LE_SET_EXT_SCAN_ENABLE       ( 0x2042 )
+#define SIM_OP_VSC_SLEEP_MODE               ( 0xFC27 )
+#define SIM_OP_VSC_APCF                     ( 0xFD57 )
+
+/* APCF sub-commands and actions, as sent by libwiced_exp */
+#define SIM_APCF_ENABLE                     ( 0x00 )
+#define SIM_APCF_FILTER_PARAM               ( 0x01 )
+#define SIM_APCF_BD_ADDR                    ( 0x02 )
+#define SIM_APCF_SRVC_UUID                  ( 0x03 )
+#define SIM_APCF_SOL_UUID                   ( 0x04 )
+#define SIM_APCF_LOCAL_NAME                 ( 0x05 )
+#define SIM_APCF_MANU_DATA                  ( 0x06 )
+#define SIM_APCF_SRVC_DATA                  ( 0x07 )
+#define SIM_APCF_SUBCMDS                    ( 0x08 )
+#define SIM_APCF_ACTION_ADD                 ( 0x00 )
+#define SIM_APCF_ACTION_DELETE              ( 0x01 )
+#define SIM_APCF_ACTION_CLEAR               ( 0x02 )
+
+#define SIM_APCF_FILTERS                    ( 32U )
+#define SIM_APCF_ENTRIES                    ( 64U )
+#define SIM_APCF_PATTERN_MAX                ( 29U )
+
+#define SIM_STATUS_SUCCESS                  ( 0x00 )
+#define SIM_STATUS_UNKNOWN_CMD              ( 0x01 )
+#define SIM_STATUS_INVALID_PARAMS           ( 0x12 )
+#define SIM_STATUS_MEMORY_FULL              ( 0x07 )
+/* failure injection: answer nothing */
+#define SIM_STATUS_DROP                     ( 0x100 )
+
+#define SIM_ADV_MAX                         ( 1650U )
+#define SIM_ADV_LEGACY_MAX                  ( 31U )
+#define SIM_EXT_REPORT_DATA_MAX             ( 229U )
+#define SIM_ADVERTISERS_MAX                 ( 65536U )
+#define SIM_RULES_MAX                       ( 64U )
+#define SIM_PENDING_MAX                     ( 64U )
+#define SIM_OUT_SIZE                        ( 256U * 1024U )
+#define SIM_LINE_MAX                        ( 4096U )
+
+#define SIM_NS_PER_MS                       ( 1000000ULL )
+
+/*******************************************************************************
+*                           STRUCTURES AND ENUMERATIONS
+*******************************************************************************/
+typedef struct
+{
+    uint8_t     feature;                    /* SIM_APCF_* sub-command */
+    uint8_t     filt_index;
+    uint8_t     len;
+    uint8_t     data[SIM_APCF_PATTERN_MAX];
+    uint8_t     mask[SIM_APCF_PATTERN_MAX];
+} sim_apcf_entry_t;
+
+typedef struct
+{
+    int         in_use;
+    uint16_t    feature_sel;
+    uint16_t    list_logic;                 /* per feature bit: 0 any entry, 1 every entry */
+    uint8_t     filt_logic;                 /* 0 any feature, 1 every feature */
+    int8_t      rssi_high;
+} sim_apcf_filter_t;
+
+typedef struct
+{
+    uint8_t     addr[6];                    /* as written, most significant first */
+    uint8_t     addr_type;
+    int8_t      rssi;
+    uint8_t     ext;                        /* report as an extended advertisement */
+    uint8_t     phy;                        /* 1 LE 1M, 3 LE Coded */
+    uint16_t    len;
+    uint8_t     data[SIM_ADV_MAX];
+    uint64_t    interval_ns;                /* 0: report once */
+    uint64_t    due_ns;
+    uint32_t    scan_gen;                   /* scan in which it was last reported */
+} sim_advertiser_t;
+
+/* per-opcode latency and failure injection */
+typedef struct
+{
+    uint16_t    opcode;
+    int16_t     subcmd;                     /* APCF sub-command, -1 for any */
+    uint32_t    latency_ms;
+    uint32_t    status;                     /* injected status, SIM_STATUS_DROP, or 0 */
+    uint32_t    count;                      /* failures left, 0 for every time */
+} sim_rule_t;
+
+typedef struct
+{
+    uint64_t    due_ns;
+    uint16_t    len;
+    uint8_t     pkt[260];
+} sim_pending_t;
+
+typedef struct
+{
+    uint16_t    opcode;
+    const char  *p_name;
+    uint8_t     ret_len;                    /* return parameters after the status */
+} sim_cmd_desc_t;
+
+/****************************************************************************
+ *                              GLOBAL VARIABLES
+ ***************************************************************************/
+/* commands answered with a Command Complete of ret_len zeroed bytes unless
+ * sim_fill_return() knows better; anything else gets a bare success */
+static const sim_cmd_desc_t sim_cmds[] =
+{
+    { 0x0C01, "Set_Event_Mask",                     0 },
+    { 0x0C03, "Reset",                              0 },
+    { 0x0C13, "Write_Local_Name",                   0 },
+    { 0x0C14, "Read_Local_Name",                    248 },
+    { 0x0C56, "Write_Simple_Pairing_Mode",          0 },
+    { 0x0C63, "Set_Event_Mask_Page_2",              0 },
+    { 0x0C6D, "Write_LE_Host_Support",              0 },
+    { 0x1001, "Read_Local_Version_Information",     8 },
+    { 0x1002, "Read_Local_Supported_Commands",      64 },
+    { 0x1003, "Read_Local_Supported_Features",      8 },
+    { 0x1004, "Read_Local_Extended_Features",       10 },
+    { 0x1005, "Read_Buffer_Size",                   7 },
+    { 0x1009, "Read_BD_ADDR",                       6 },
+    { 0x2001, "LE_Set_Event_Mask",                  0 },
+    { 0x2002, "LE_Read_Buffer_Size",                3 },
+    { 0x2003, "LE_Read_Local_Supported_Features",   8 },
+    { 0x2005, "LE_Set_Random_Address",              0 },
+    { 0x200B, "LE_Set_Scan_Parameters",             0 },
+    { 0x200C, "LE_Set_Scan_Enable",                 0 },
+    { 0x200F, "LE_Read_Filter_Accept_List_Size",    1 },
+    { 0x2010, "LE_Clear_Filter_Accept_List",        0 },
+    { 0x2018, "LE_Rand",                            8 },
+    { 0x201C, "LE_Read_Supported_States",           8 },
+    { 0x2023, "LE_Read_Suggested_Default_Data_Length", 4 },
+    { 0x2024, "LE_Write_Suggested_Default_Data_Length", 0 },
+    { 0x2029, "LE_Clear_Resolving_List",            0 },
+    { 0x202A, "LE_Read_Resolving_List_Size",        1 },
+    { 0x202D, "LE_Set_Address_Resolution_Enable",   0 },
+    { 0x202E, "LE_Set_RPA_Timeout",                 0 },
+    { 0x202F, "LE_Read_Maximum_Data_Length",        8 },
+    { 0x2031, "LE_Set_Default_PHY",                 0 },
+    { 0x203A, "LE_Read_Maximum_Advertising_Data_Length", 2 },
+    { 0x203B, "LE_Read_Number_of_Supported_Advertising_Sets", 1 },
+    { 0x2041, "LE_Set_Extended_Scan_Parameters",    0 },
+    { 0x2042, "LE_Set_Extended_Scan_Enable",        0 },
+    { 0x204A, "LE_Read_Periodic_Advertiser_List_Size", 1 },
+    { 0x204B, "LE_Read_Transmit_Power",             2 },
+    { 0xFC18, "VSC_Update_Baudrate",                0 },
+    { 0xFC27, "VSC_Write_Sleep_Mode",               0 },
+    { 0xFC2E, "VSC_Download_Minidriver",            0 },
+    { 0xFC4C, "VSC_Write_RAM",                      0 },
+    { 0xFC4E, "VSC_Launch_RAM",                     0 },
+    { 0xFC79, "VSC_Read_Verbose_Config_Version",    6 },
+    { 0xFD57, "VSC_APCF",                           0 },
+};
+
+static struct
+{
+    /* configuration */
+    int                 extended;           /* advertise the extended advertising feature */
+    uint8_t             bd_addr[6];
+    const char          *p_host_wake_path;  /* gpio-sim "pull" attribute */
+    int                 verbose;
+    /* pty */
+    int                 master_fd;
+    int                 slave_fd;
+    char                slave_path[64];
+    const char          *p_link_path;
+    uint8_t             in[SIM_LINE_MAX];
+    size_t              in_len;
+    uint8_t             *p_out;
+    size_t              out_head;
+    size_t              out_tail;
+    /* controller state */
+    int                 scanning;           /* 0 off, 1 legacy, 2 extended */
+    int                 scan_filter_dup;
+    uint32_t            scan_gen;
+    int                 apcf_enabled;
+    sim_apcf_filter_t   filters[SIM_APCF_FILTERS];
+    sim_apcf_entry_t    entries[SIM_APCF_ENTRIES];
+    uint32_t            num_entries;
+    int                 sleep_mode;
+    int                 host_wake_active_high;
+    int                 host_wake;
+    /* advertisers, a min-heap on due_ns */
+    sim_advertiser_t    **pp_adv;
+    uint32_t            num_adv;
+    /* injection */
+    sim_rule_t          rules[SIM_RULES_MAX];
+    uint32_t            num_rules;
+    sim_pending_t       pending[SIM_PENDING_MAX];
+    uint32_t            num_pending;
+    /* statistics */
+    uint64_t            commands;
+    uint64_t            reports;
+    uint64_t            filtered;
+    uint64_t            dropped;
+    uint64_t            wakes;
+} sim;
+
+static volatile sig_atomic_t sim_stop = 0;
+
+/****************************************************************************
+ *                              FUNCTION DEFINITIONS
+ ***************************************************************************/
+
+static uint64_t sim_now_ns( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sim_on_signal( int sig )
+{
+    (void)sig;
+    sim_stop = 1;
+}
+
+static const sim_cmd_desc_t *sim_cmd_find( uint16_t opcode )
+{
+    size_t i;
+
+    for ( i = 0; i < sizeof( sim_cmds ) / sizeof( sim_cmds[0] ); i++ )
+    {
+        if ( sim_cmds[i].opcode == opcode )
+        {
+            return &sim_cmds[i];
+        }
+    }
+    return NULL;
+}
+
+static int sim_hex_nibble( char c )
+{
+    if ( ( c >= '0' ) && ( c <= '9' ) )
+    {
+        return c - '0';
+    }
+    if ( ( c >= 'a' ) && ( c <= 'f' ) )
+    {
+        return c - 'a' + 10;
+    }
+    if ( ( c >= 'A' ) && ( c <= 'F' ) )
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/* hex string to bytes, ':' and '-' separators allowed; returns length or -1 */
+static int sim_parse_hex( const char *p_str, uint8_t *p_out, size_t max )
+{
+    size_t len = 0;
+    int hi, lo;
+
+    while ( *p_str != '\0' )
+    {
+        if ( ( *p_str == ':' ) || ( *p_str == '-' ) )
+        {
+            p_str++;
+            continue;
+        }
+        hi = sim_hex_nibble( p_str[0] );
+        lo = ( hi < 0 ) ? -1 : sim_hex_nibble( p_str[1] );
+        if ( ( lo < 0 ) || ( len >= max ) )
+        {
+            return -1;
+        }
+        p_out[len++] = (uint8_t)( ( hi << 4 ) | lo );
+        p_str += 2;
+    }
+    return (int)len;
+}
+
+/******************************************************************************
+ * Function Name: sim_out_put()
+ ******************************************************************************
+ * Summary:
+ *   Queue an H4 packet for the host. Advertising reports are dropped when
+ *   the host is not reading; command responses never are.
+ *
+ *****************************************************************************/
+static int sim_out_put( const uint8_t *p_pkt, size_t len, int droppable )
+{
+    size_t used = sim.out_head - sim.out_tail;
+    size_t i;
+
+    if ( ( SIM_OUT_SIZE - used < len ) || ( droppable && ( used > SIM_OUT_SIZE / 2 ) ) )
+    {
+        sim.dropped++;
+        return -1;
+    }
+    for ( i = 0; i < len; i++ )
+    {
+        sim.p_out[( sim.out_head + i ) % SIM_OUT_SIZE] = p_pkt[i];
+    }
+    sim.out_head += len;
+    return 0;
+}
+
+static void sim_out_flush( void )
+{
+    size_t off, chunk;
+    ssize_t n;
+
+    while ( sim.out_head != sim.out_tail )
+    {
+        off = sim.out_tail % SIM_OUT_SIZE;
+        chunk = sim.out_head - sim.out_tail;
+        if ( chunk > SIM_OUT_SIZE - off )
+        {
+            chunk = SIM_OUT_SIZE - off;
+        }
+        n = write( sim.master_fd, sim.p_out + off, chunk );
+        if ( n <= 0 )
+        {
+            return;
+        }
+        sim.out_tail += (size_t)n;
+    }
+}
+
+/******************************************************************************
+ * Function Name: sim_host_wake_set()
+ ******************************************************************************
+ * Summary:
+ *   Drive the simulated HOST-WAKE line and the gpio-sim line behind it
+ *
+ *****************************************************************************/
+static void sim_host_wake_set( int asserted )
+{
+    const char *p_level;
+    int level_high;
+    FILE *p_file;
+
+    if ( sim.host_wake == asserted )
+    {
+        return;
+    }
+    sim.host_wake = asserted;
+    if ( asserted )
+    {
+        sim.wakes++;
+    }
+    level_high = asserted ? sim.host_wake_active_high : !sim.host_wake_active_high;
+    p_level = level_high ? "pull-up" : "pull-down";
+    printf( "[sim] HOST-WAKE %s (line %s)\n", asserted ? "asserted" : "released", level_high ? "high" : "low" );
+    fflush( stdout );
+
+    if ( sim.p_host_wake_path != NULL )
+    {
+        p_file = fopen( sim.p_host_wake_path, "w" );
+        if ( ( p_file == NULL ) || ( fputs( p_level, p_file ) < 0 ) )
+        {
+            fprintf( stderr, "[sim] write %s to %s: %s\n", p_level, sim.p_host_wake_path, strerror( errno ) );
+        }
+        if ( p_file != NULL )
+        {
+            fclose( p_file );
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: sim_rule_find()
+ ******************************************************************************
+ * Summary:
+ *   Injection rule of a command, NULL if none
+ *
+ *****************************************************************************/
+static sim_rule_t *sim_rule_find( uint16_t opcode, int subcmd )
+{
+    uint32_t i;
+
+    for ( i = 0; i < sim.num_rules; i++ )
+    {
+        if ( ( sim.rules[i].opcode == opcode ) && ( ( sim.rules[i].subcmd < 0 ) || ( sim.rules[i].subcmd == subcmd ) ) )
+        {
+            return &sim.rules[i];
+        }
+    }
+    for ( i = 0; i < sim.num_rules; i++ )
+    {
+        if ( sim.rules[i].opcode == 0 )
+        {
+            return &sim.rules[i];
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * Function Name: sim_rule_parse()
+ ******************************************************************************
+ * Summary:
+ *   Parse "<opcode|all>[/<subcmd>]=<value>" into a latency or failure rule.
+ *   For failures the value is "<status|drop>[x<count>]".
+ *
+ *****************************************************************************/
+static int sim_rule_parse( const char *p_spec, int is_latency )
+{
+    sim_rule_t rule, *p_rule = NULL;
+    const char *p_eq = strchr( p_spec, '=' );
+    char *p_end;
+    uint32_t i;
+
+    memset( &rule, 0, sizeof( rule ) );
+    rule.subcmd = -1;
+    if ( p_eq == NULL )
+    {
+        return -1;
+    }
+    if ( strncmp( p_spec, "all", 3 ) != 0 )
+    {
+        rule.opcode = (uint16_t)strtoul( p_spec, &p_end, 16 );
+        if ( *p_end == '/' )
+        {
+            rule.subcmd = (int16_t)strtol( p_end + 1, &p_end, 0 );
+        }
+        if ( ( p_end != p_eq ) || ( rule.opcode == 0 ) )
+        {
+            return -1;
+        }
+    }
+
+    for ( i = 0; i < sim.num_rules; i++ )
+    {
+        if ( ( sim.rules[i].opcode == rule.opcode ) && ( sim.rules[i].subcmd == rule.subcmd ) )
+        {
+            p_rule = &sim.rules[i];
+        }
+    }
+    if ( p_rule == NULL )
+    {
+        if ( sim.num_rules >= SIM_RULES_MAX )
+        {
+            return -1;
+        }
+        p_rule = &sim.rules[sim.num_rules++];
+        *p_rule = rule;
+    }
+
+    if ( is_latency )
+    {
+        p_rule->latency_ms = (uint32_t)strtoul( p_eq + 1, &p_end, 0 );
+        return ( *p_end == '\0' ) ? 0 : -1;
+    }
+    if ( strncmp( p_eq + 1, "drop", 4 ) == 0 )
+    {
+        p_rule->status = SIM_STATUS_DROP;
+        p_end = (char *)p_eq + 5;
+    }
+    else
+    {
+        p_rule->status = (uint32_t)strtoul( p_eq + 1, &p_end, 0 );
+    }
+    p_rule->count = ( *p_end == 'x' ) ? (uint32_t)strtoul( p_end + 1, &p_end, 0 ) : 0;
+    return ( *p_end == '\0' ) ? 0 : -1;
+}
+
+/******************************************************************************
+ * Function Name: sim_respond()
+ ******************************************************************************
+ * Summary:
+ *   Send a Command Complete, after the configured latency
+ *
+ *****************************************************************************/
+static void sim_respond( uint16_t opcode, const uint8_t *p_ret, size_t ret_len, uint32_t latency_ms )
+{
+    sim_pending_t pkt;
+
+    pkt.pkt[0] = SIM_H4_EVT;
+    pkt.pkt[1] = SIM_EVT_CMD_COMPLETE;
+    pkt.pkt[2] = (uint8_t)( 3 + ret_len );
+    pkt.pkt[3] = 1;                          /* Num_HCI_Command_Packets */
+    pkt.pkt[4] = (uint8_t)opcode;
+    pkt.pkt[5] = (uint8_t)( opcode >> 8 );
+    memcpy( &pkt.pkt[6], p_ret, ret_len );
+    pkt.len = (uint16_t)( 6 + ret_len );
+
+    if ( ( latency_ms == 0 ) || ( sim.num_pending >= SIM_PENDING_MAX ) )
+    {
+        sim_out_put( pkt.pkt, pkt.len, 0 );
+        return;
+    }
+    pkt.due_ns = sim_now_ns() + (uint64_t)latency_ms * SIM_NS_PER_MS;
+    sim.pending[sim.num_pending++] = pkt;
+}
+
+/******************************************************************************
+ * Function Name: sim_fill_return()
+ ******************************************************************************
+ * Summary:
+ *   Return parameters of the read commands the stack cares about
+ *
+ *****************************************************************************/
+static void sim_fill_return( uint16_t opcode, uint8_t *p_ret )
+{
+    int i;
+
+    switch ( opcode )
+    {
+    case 0x0C14:                            /* Read_Local_Name */
+        strcpy( (char *)p_ret, "hci_sim" );
+        break;
+    case 0x1001:                            /* Read_Local_Version_Information */
+        p_ret[0] = 0x0B;                    /* HCI 5.2 */
+        p_ret[1] = 0x00; p_ret[2] = 0x01;
+        p_ret[3] = 0x0B;                    /* LMP 5.2 */
+        p_ret[4] = 0x31; p_ret[5] = 0x01;   /* Cypress Semiconductor */
+        p_ret[6] = 0x00; p_ret[7] = 0x22;
+        break;
+    case 0x1002:                            /* Read_Local_Supported_Commands */
+        memset( p_ret, 0xFF, 64 );
+        if ( !sim.extended )
+        {
+            p_ret[37] &= (uint8_t)~0xE0;    /* extended scan and create connection */
+        }
+        break;
+    case 0x1003:                            /* Read_Local_Supported_Features */
+        memcpy( p_ret, "\xBF\xFE\xCF\xFE\xDB\xFF\x7B\x87", 8 );
+        break;
+    case 0x1004:                            /* Read_Local_Extended_Features */
+        p_ret[1] = 1;
+        memcpy( &p_ret[2], "\xBF\xFE\xCF\xFE\xDB\xFF\x7B\x87", 8 );
+        break;
+    case 0x1005:                            /* Read_Buffer_Size */
+        p_ret[0] = 0xFD; p_ret[1] = 0x03;   /* 1021 byte ACL */
+        p_ret[2] = 64;
+        p_ret[3] = 8;
+        break;
+    case 0x1009:                            /* Read_BD_ADDR, little endian */
+        for ( i = 0; i < 6; i++ )
+        {
+            p_ret[i] = sim.bd_addr[5 - i];
+        }
+        break;
+    case 0x2002:                            /* LE_Read_Buffer_Size */
+        p_ret[0] = 251;
+        p_ret[2] = 8;
+        break;
+    case 0x2003:                            /* LE_Read_Local_Supported_Features */
+        p_ret[0] = 0xFF;
+        p_ret[1] = sim.extended ? 0x19 : 0x01;  /* 2M, and Coded and extended advertising */
+        break;
+    case 0x200F:
+    case 0x202A:
+    case 0x204A:
+        p_ret[0] = 8;
+        break;
+    case 0x2018:                            /* LE_Rand */
+        for ( i = 0; i < 8; i++ )
+        {
+            p_ret[i] = (uint8_t)rand();
+        }
+        break;
+    case 0x201C:                            /* LE_Read_Supported_States */
+        memset( p_ret, 0xFF, 8 );
+        break;
+    case 0x2023:                            /* LE_Read_Suggested_Default_Data_Length */
+        p_ret[0] = 27; p_ret[2] = 0x48;
+        break;
+    case 0x202F:                            /* LE_Read_Maximum_Data_Length */
+        p_ret[0] = 251; p_ret[2] = 0x48; p_ret[3] = 0x08;
+        p_ret[4] = 251; p_ret[6] = 0x48; p_ret[7] = 0x08;
+        break;
+    case 0x203A:                            /* LE_Read_Maximum_Advertising_Data_Length */
+        p_ret[0] = (uint8_t)SIM_ADV_MAX; p_ret[1] = (uint8_t)( SIM_ADV_MAX >> 8 );
+        break;
+    case 0x203B:
+        p_ret[0] = 4;
+        break;
+    case 0x204B:                            /* LE_Read_Transmit_Power */
+        p_ret[0] = (uint8_t)-20; p_ret[1] = 10;
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+ * Function Name: sim_reset()
+ ******************************************************************************
+ * Summary:
+ *   HCI_Reset: scanning, APCF and sleep mode off
+ *
+ *****************************************************************************/
+static void sim_reset( void )
+{
+    sim.scanning = 0;
+    sim.apcf_enabled = 0;
+    memset( sim.filters, 0, sizeof( sim.filters ) );
+    sim.num_entries = 0;
+    sim.sleep_mode = 0;
+    sim_host_wake_set( 0 );
+    sim.num_pending = 0;
+}
+
+/******************************************************************************
+ * Function Name: sim_apcf()
+ ******************************************************************************
+ * Summary:
+ *   The APCF vendor command; fills the return parameters after the status
+ *
+ * Return:
+ *  status
+ *
+ *****************************************************************************/
+static uint8_t sim_apcf( const uint8_t *p, uint8_t len, uint8_t *p_ret, size_t *p_ret_len )
+{
+    sim_apcf_filter_t *p_filter;
+    sim_apcf_entry_t *p_entry;
+    uint8_t subcmd, action, index, n;
+    uint32_t i, j;
+
+    if ( len < 2 )
+    {
+        return SIM_STATUS_INVALID_PARAMS;
+    }
+    subcmd = p[0];
+    action = p[1];
+    p_ret[0] = subcmd;
+    p_ret[1] = action;
+    *p_ret_len = 2;
+
+    if ( subcmd == SIM_APCF_ENABLE )
+    {
+        sim.apcf_enabled = action;
+        if ( sim.verbose )
+        {
+            printf( "[sim] APCF %s\n", action ? "enabled" : "disabled" );
+        }
+        return SIM_STATUS_SUCCESS;
+    }
+    if ( ( subcmd >= SIM_APCF_SUBCMDS ) || ( len < 3 ) || ( p[2] >= SIM_APCF_FILTERS ) )
+    {
+        return SIM_STATUS_INVALID_PARAMS;
+    }
+    index = p[2];
+    p_ret[2] = (uint8_t)( SIM_APCF_ENTRIES - sim.num_entries );
+    *p_ret_len = 3;
+
+    if ( subcmd == SIM_APCF_FILTER_PARAM )
+    {
+        p_filter = &sim.filters[index];
+        if ( action == SIM_APCF_ACTION_ADD )
+        {
+            if ( len < 10 )
+            {
+                return SIM_STATUS_INVALID_PARAMS;
+            }
+            p_filter->in_use = 1;
+            p_filter->feature_sel = (uint16_t)( p[3] | ( p[4] << 8 ) );
+            p_filter->list_logic = (uint16_t)( p[5] | ( p[6] << 8 ) );
+            p_filter->filt_logic = p[7];
+            p_filter->rssi_high = (int8_t)p[8];
+        }
+        else
+        {
+            memset( p_filter, 0, sizeof( *p_filter ) );
+            /* clearing a filter drops its entries too */
+            for ( i = 0, j = 0; i < sim.num_entries; i++ )
+            {
+                if ( ( action == SIM_APCF_ACTION_CLEAR ) || ( sim.entries[i].filt_index != index ) )
+                {
+                    sim.entries[j++] = sim.entries[i];
+                }
+            }
+            if ( action == SIM_APCF_ACTION_CLEAR )
+            {
+                memset( sim.filters, 0, sizeof( sim.filters ) );
+                j = 0;
+            }
+            sim.num_entries = j;
+        }
+        if ( sim.verbose )
+        {
+            printf( "[sim] APCF filter %u action %u features 0x%04X logic %u rssi %d\n", index, action,
+                    p_filter->feature_sel, p_filter->filt_logic, p_filter->rssi_high );
+        }
+        p_ret[2] = (uint8_t)( SIM_APCF_ENTRIES - sim.num_entries );
+        return SIM_STATUS_SUCCESS;
+    }
+
+    /* feature entries: remove the filter's entries of this feature first on clear */
+    if ( action != SIM_APCF_ACTION_ADD )
+    {
+        for ( i = 0, j = 0; i < sim.num_entries; i++ )
+        {
+            if ( ( sim.entries[i].filt_index != index ) || ( sim.entries[i].feature != subcmd ) )
+            {
+                sim.entries[j++] = sim.entries[i];
+            }
+        }
+        sim.num_entries = j;
+        p_ret[2] = (uint8_t)( SIM_APCF_ENTRIES - sim.num_entries );
+        return SIM_STATUS_SUCCESS;
+    }
+    if ( sim.num_entries >= SIM_APCF_ENTRIES )
+    {
+        return SIM_STATUS_MEMORY_FULL;
+    }
+    p_entry = &sim.entries[sim.num_entries];
+    memset( p_entry, 0, sizeof( *p_entry ) );
+    p_entry->feature = subcmd;
+    p_entry->filt_index = index;
+    n = (uint8_t)( len - 3 );
+    switch ( subcmd )
+    {
+    case SIM_APCF_BD_ADDR:
+        /* address little endian, then its type */
+        if ( n < 6 )
+        {
+            return SIM_STATUS_INVALID_PARAMS;
+        }
+        p_entry->len = 6;
+        memcpy( p_entry->data, &p[3], 6 );
+        memset( p_entry->mask, 0xFF, 6 );
+        break;
+    case SIM_APCF_LOCAL_NAME:
+        p_entry->len = ( n > SIM_APCF_PATTERN_MAX ) ? SIM_APCF_PATTERN_MAX : n;
+        memcpy( p_entry->data, &p[3], p_entry->len );
+        memset( p_entry->mask, 0xFF, p_entry->len );
+        break;
+    default:
+        /* pattern, then a mask of the same length; without a mask every bit counts */
+        if ( ( ( n & 1U ) == 0 ) && ( n / 2U <= SIM_APCF_PATTERN_MAX ) )
+        {
+            p_entry->len = (uint8_t)( n / 2U );
+            memcpy( p_entry->data, &p[3], p_entry->len );
+            memcpy( p_entry->mask, &p[3 + p_entry->len], p_entry->len );
+        }
+        else
+        {
+            p_entry->len = ( n > SIM_APCF_PATTERN_MAX ) ? SIM_APCF_PATTERN_MAX : n;
+            memcpy( p_entry->data, &p[3], p_entry->len );
+            memset( p_entry->mask, 0xFF, p_entry->len );
+        }
+        break;
+    }
+    sim.num_entries++;
+    if ( sim.verbose )
+    {
+        printf( "[sim] APCF filter %u add feature %u, %u bytes\n", index, subcmd, p_entry->len );
+    }
+    p_ret[2] = (uint8_t)( SIM_APCF_ENTRIES - sim.num_entries );
+    return SIM_STATUS_SUCCESS;
+}
+
+static int sim_masked_eq( const uint8_t *p_a, const uint8_t *p_b, const uint8_t *p_mask, uint8_t len )
+{
+    uint8_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        if ( ( p_a[i] & p_mask[i] ) != ( p_b[i] & p_mask[i] ) )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * Function Name: sim_entry_match()
+ ******************************************************************************
+ * Summary:
+ *   Test one APCF entry against an advertisement, walking its AD structures
+ *
+ *****************************************************************************/
+static int sim_entry_match( const sim_apcf_entry_t *p_entry, const sim_advertiser_t *p_adv )
+{
+    const uint8_t *p = p_adv->data, *p_end = p_adv->data + p_adv->len;
+    uint8_t ad_len, ad_type, uuid_len, i;
+    uint8_t addr_le[6];
+
+    if ( p_entry->feature == SIM_APCF_BD_ADDR )
+    {
+        for ( i = 0; i < 6; i++ )
+        {
+            addr_le[i] = p_adv->addr[5 - i];
+        }
+        return memcmp( addr_le, p_entry->data, 6 ) == 0;
+    }
+
+    while ( p + 1 < p_end )
+    {
+        ad_len = p[0];
+        if ( ( ad_len == 0 ) || ( p + 1 + ad_len > p_end ) )
+        {
+            break;
+        }
+        ad_type = p[1];
+        switch ( p_entry->feature )
+        {
+        case SIM_APCF_SRVC_UUID:
+        case SIM_APCF_SOL_UUID:
+            if ( p_entry->feature == SIM_APCF_SRVC_UUID )
+            {
+                uuid_len = ( ad_type == 0x02 || ad_type == 0x03 ) ? 2 : ( ad_type == 0x04 || ad_type == 0x05 ) ? 4 :
+                           ( ad_type == 0x06 || ad_type == 0x07 ) ? 16 : 0;
+            }
+            else
+            {
+                uuid_len = ( ad_type == 0x14 ) ? 2 : ( ad_type == 0x1F ) ? 4 : ( ad_type == 0x15 ) ? 16 : 0;
+            }
+            if ( uuid_len == p_entry->len )
+            {
+                for ( i = 2; i + uuid_len <= ad_len + 1; i = (uint8_t)( i + uuid_len ) )
+                {
+                    if ( sim_masked_eq( &p[i], p_entry->data, p_entry->mask, uuid_len ) )
+                    {
+                        return 1;
+                    }
+                }
+            }
+            break;
+        case SIM_APCF_LOCAL_NAME:
+            if ( ( ( ad_type == 0x08 ) || ( ad_type == 0x09 ) ) && ( ad_len - 1 >= p_entry->len ) &&
+                 ( memcmp( &p[2], p_entry->data, p_entry->len ) == 0 ) )
+            {
+                return 1;
+            }
+            break;
+        case SIM_APCF_MANU_DATA:
+        case SIM_APCF_SRVC_DATA:
+            if ( ( ( ( p_entry->feature == SIM_APCF_MANU_DATA ) && ( ad_type == 0xFF ) ) ||
+                   ( ( p_entry->feature == SIM_APCF_SRVC_DATA ) && ( ad_type == 0x16 || ad_type == 0x20 || ad_type == 0x21 ) ) ) &&
+                 ( ad_len - 1 >= p_entry->len ) && sim_masked_eq( &p[2], p_entry->data, p_entry->mask, p_entry->len ) )
+            {
+                return 1;
+            }
+            break;
+        default:
+            break;
+        }
+        p += 1 + ad_len;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Function Name: sim_apcf_match()
+ ******************************************************************************
+ * Summary:
+ *   Test an advertisement against the enabled filters
+ *
+ * Return:
+ *  index of the first matching filter, -1 if none matches
+ *
+ *****************************************************************************/
+static int sim_apcf_match( const sim_advertiser_t *p_adv )
+{
+    static const uint8_t features[] = { SIM_APCF_BD_ADDR, SIM_APCF_SRVC_UUID, SIM_APCF_SOL_UUID,
+                                        SIM_APCF_LOCAL_NAME, SIM_APCF_MANU_DATA, SIM_APCF_SRVC_DATA };
+    static const uint16_t bits[] = { 0x01, 0x04, 0x08, 0x10, 0x20, 0x40 };
+    const sim_apcf_filter_t *p_filter;
+    int any, all, feature_ok, found, every, selected;
+    uint32_t f, k, i;
+
+    for ( f = 0; f < SIM_APCF_FILTERS; f++ )
+    {
+        p_filter = &sim.filters[f];
+        if ( !p_filter->in_use || ( p_adv->rssi < p_filter->rssi_high ) )
+        {
+            continue;
+        }
+        any = 0;
+        all = 1;
+        selected = 0;
+        for ( k = 0; k < sizeof( features ); k++ )
+        {
+            if ( !( p_filter->feature_sel & bits[k] ) )
+            {
+                continue;
+            }
+            selected = 1;
+            found = 0;
+            every = 1;
+            for ( i = 0; i < sim.num_entries; i++ )
+            {
+                if ( ( sim.entries[i].filt_index != f ) || ( sim.entries[i].feature != features[k] ) )
+                {
+                    continue;
+                }
+                if ( sim_entry_match( &sim.entries[i], p_adv ) )
+                {
+                    found = 1;
+                }
+                else
+                {
+                    every = 0;
+                }
+            }
+            feature_ok = ( p_filter->list_logic & bits[k] ) ? ( found && every ) : found;
+            any |= feature_ok;
+            all &= feature_ok;
+        }
+        if ( !selected || ( p_filter->filt_logic ? all : any ) )
+        {
+            return (int)f;
+        }
+    }
+    return -1;
+}
+
+/******************************************************************************
+ * Function Name: sim_report()
+ ******************************************************************************
+ * Summary:
+ *   Report one advertisement to a scanning host, in the format the host
+ *   enabled scanning with; extended data above 229 bytes is fragmented
+ *
+ *****************************************************************************/
+static void sim_report( sim_advertiser_t *p_adv )
+{
+    uint8_t pkt[260];
+    uint16_t evt_type, off = 0, chunk;
+    int filter = -1, i;
+
+    if ( !sim.scanning || ( sim.scan_filter_dup && ( p_adv->scan_gen == sim.scan_gen ) ) )
+    {
+        return;
+    }
+    if ( sim.apcf_enabled )
+    {
+        filter = sim_apcf_match( p_adv );
+        if ( filter < 0 )
+        {
+            sim.filtered++;
+            return;
+        }
+        if ( sim.sleep_mode && !sim.host_wake )
+        {
+            printf( "[sim] APCF filter %d matched %02X:%02X:%02X:%02X:%02X:%02X\n", filter, p_adv->addr[0],
+                    p_adv->addr[1], p_adv->addr[2], p_adv->addr[3], p_adv->addr[4], p_adv->addr[5] );
+            sim_host_wake_set( 1 );
+        }
+    }
+
+    if ( sim.scanning == 1 )
+    {
+        /* legacy reports carry legacy advertisements only */
+        if ( p_adv->ext || ( p_adv->len > SIM_ADV_LEGACY_MAX ) )
+        {
+            sim.filtered++;
+            return;
+        }
+        pkt[0] = SIM_H4_EVT;
+        pkt[1] = SIM_EVT_LE_META;
+        pkt[2] = (uint8_t)( 12 + p_adv->len );
+        pkt[3] = SIM_LE_ADV_REPORT;
+        pkt[4] = 1;
+        pkt[5] = 0x03;                       /* ADV_NONCONN_IND */
+        pkt[6] = p_adv->addr_type;
+        for ( i = 0; i < 6; i++ )
+        {
+            pkt[7 + i] = p_adv->addr[5 - i];
+        }
+        pkt[13] = (uint8_t)p_adv->len;
+        memcpy( &pkt[14], p_adv->data, p_adv->len );
+        pkt[14 + p_adv->len] = (uint8_t)p_adv->rssi;
+        if ( sim_out_put( pkt, 15U + p_adv->len, 1 ) == 0 )
+        {
+            p_adv->scan_gen = sim.scan_gen;
+            sim.reports++;
+        }
+        return;
+    }
+
+    do
+    {
+        chunk = (uint16_t)( p_adv->len - off );
+        if ( chunk > SIM_EXT_REPORT_DATA_MAX )
+        {
+            chunk = SIM_EXT_REPORT_DATA_MAX;
+        }
+        /* legacy ADV_NONCONN_IND, or extended non-connectable non-scannable; data status in bits 5-6 */
+        evt_type = p_adv->ext ? 0x0000 : 0x0010;
+        if ( off + chunk < p_adv->len )
+        {
+            evt_type |= 0x0020;
+        }
+        pkt[0] = SIM_H4_EVT;
+        pkt[1] = SIM_EVT_LE_META;
+        pkt[2] = (uint8_t)( 26 + chunk );
+        pkt[3] = SIM_LE_EXT_ADV_REPORT;
+        pkt[4] = 1;
+        pkt[5] = (uint8_t)evt_type;
+        pkt[6] = (uint8_t)( evt_type >> 8 );
+        pkt[7] = p_adv->addr_type;
+        for ( i = 0; i < 6; i++ )
+        {
+            pkt[8 + i] = p_adv->addr[5 - i];
+        }
+        pkt[14] = p_adv->ext ? p_adv->phy : 1;   /* primary PHY */
+        pkt[15] = p_adv->ext ? p_adv->phy : 0;   /* secondary PHY */
+        pkt[16] = 0xFF;                          /* no ADI */
+        pkt[17] = 0x7F;                          /* TX power not available */
+        pkt[18] = (uint8_t)p_adv->rssi;
+        pkt[19] = 0;
+        pkt[20] = 0;
+        memset( &pkt[21], 0, 7 );
+        pkt[28] = (uint8_t)chunk;
+        memcpy( &pkt[29], p_adv->data + off, chunk );
+        if ( sim_out_put( pkt, 29U + chunk, 1 ) != 0 )
+        {
+            return;
+        }
+        off = (uint16_t)( off + chunk );
+    } while ( off < p_adv->len );
+    p_adv->scan_gen = sim.scan_gen;
+    sim.reports++;
+}
+
+/******************************************************************************
+ * Function Name: sim_command()
+ ******************************************************************************
+ * Summary:
+ *   Handle one HCI command
+ *
+ *****************************************************************************/
+static void sim_command( uint16_t opcode, const uint8_t *p, uint8_t len )
+{
+    const sim_cmd_desc_t *p_desc = sim_cmd_find( opcode );
+    uint8_t ret[256];
+    size_t ret_len = 0;
+    sim_rule_t *p_rule;
+    uint8_t status = SIM_STATUS_SUCCESS;
+    uint32_t inject = 0;
+    int subcmd = ( ( opcode == SIM_OP_VSC_APCF ) && ( len > 0 ) ) ? p[0] : -1;
+
+    sim.commands++;
+    if ( sim.verbose )
+    {
+        printf( "[sim] < 0x%04X %s (%u bytes)\n", opcode, p_desc ? p_desc->p_name : "unknown", len );
+    }
+    else if ( p_desc == NULL )
+    {
+        printf( "[sim] unknown command 0x%04X, answered with success\n", opcode );
+    }
+
+    memset( ret, 0, sizeof( ret ) );
+    p_rule = sim_rule_find( opcode, subcmd );
+    if ( ( p_rule != NULL ) && ( p_rule->status != 0 ) )
+    {
+        inject = p_rule->status;
+        /* a counted failure disarms itself after its last use */
+        if ( ( p_rule->count > 0 ) && ( --p_rule->count == 0 ) )
+        {
+            p_rule->status = 0;
+        }
+        if ( inject == SIM_STATUS_DROP )
+        {
+            printf( "[sim] dropping 0x%04X\n", opcode );
+            return;
+        }
+    }
+
+    if ( inject != 0 )
+    {
+        /* a rejected command changes nothing; the return parameters stay zeroed */
+        printf( "[sim] failing 0x%04X with status 0x%02X\n", opcode, (uint8_t)inject );
+        ret[0] = (uint8_t)inject;
+        ret[1] = (uint8_t)( ( subcmd < 0 ) ? 0 : subcmd );
+        ret_len = ( subcmd >= 0 ) ? 2 : ( p_desc ? p_desc->ret_len : 0 );
+        sim_respond( opcode, ret, ret_len + 1, p_rule->latency_ms );
+        return;
+    }
+
+    switch ( opcode )
+    {
+    case SIM_OP_RESET:
+        sim_reset();
+        break;
+    case SIM_OP_LE_SET_SCAN_ENABLE:
+        sim.scanning = ( len > 0 && p[0] ) ? 1 : 0;
+        sim.scan_filter_dup = ( len > 1 ) ? p[1] : 0;
+        sim.scan_gen++;
+        printf( "[sim] scan %s\n", sim.scanning ? "on" : "off" );
+        break;
+    case SIM_OP_LE_SET_EXT_SCAN_ENABLE:
+        sim.scanning = ( len > 0 && p[0] ) ? 2 : 0;
+        sim.scan_filter_dup = ( len > 1 ) ? p[1] : 0;
+        sim.scan_gen++;
+        printf( "[sim] extended scan %s\n", sim.scanning ? "on" : "off" );
+        break;
+    case SIM_OP_VSC_SLEEP_MODE:
+        if ( len < 5 )
+        {
+            status = SIM_STATUS_INVALID_PARAMS;
+            break;
+        }
+        sim.sleep_mode = p[0];
+        sim.host_wake_active_high = p[4];
+        printf( "[sim] sleep mode %u, HOST-WAKE active %s\n", p[0], p[4] ? "high" : "low" );
+        if ( !sim.sleep_mode )
+        {
+            sim_host_wake_set( 0 );
+        }
+        break;
+    case SIM_OP_VSC_APCF:
+        status = sim_apcf( p, len, ret + 1, &ret_len );
+        break;
+    default:
+        if ( p_desc != NULL )
+        {
+            ret_len = p_desc->ret_len;
+            sim_fill_return( opcode, ret + 1 );
+        }
+        break;
+    }
+
+    ret[0] = status;
+    sim_respond( opcode, ret, ret_len + 1, p_rule ? p_rule->latency_ms : 0 );
+}
+
+/******************************************************************************
+ * Function Name: sim_adv_sift_down()
+ ******************************************************************************
+ * Summary:
+ *   Restore the advertiser heap below a slot after its due time grew
+ *
+ *****************************************************************************/
+static void sim_adv_sift_down( uint32_t i )
+{
+    sim_advertiser_t *p_tmp;
+    uint32_t child;
+
+    while ( ( child = 2U * i + 1U ) < sim.num_adv )
+    {
+        if ( ( child + 1U < sim.num_adv ) && ( sim.pp_adv[child + 1U]->due_ns < sim.pp_adv[child]->due_ns ) )
+        {
+            child++;
+        }
+        if ( sim.pp_adv[i]->due_ns <= sim.pp_adv[child]->due_ns )
+        {
+            break;
+        }
+        p_tmp = sim.pp_adv[i];
+        sim.pp_adv[i] = sim.pp_adv[child];
+        sim.pp_adv[child] = p_tmp;
+        i = child;
+    }
+}
+
+static void sim_adv_push( sim_advertiser_t *p_adv )
+{
+    sim_advertiser_t *p_tmp;
+    uint32_t i = sim.num_adv++, parent;
+
+    sim.pp_adv[i] = p_adv;
+    while ( i > 0 )
+    {
+        parent = ( i - 1U ) / 2U;
+        if ( sim.pp_adv[parent]->due_ns <= sim.pp_adv[i]->due_ns )
+        {
+            break;
+        }
+        p_tmp = sim.pp_adv[i];
+        sim.pp_adv[i] = sim.pp_adv[parent];
+        sim.pp_adv[parent] = p_tmp;
+        i = parent;
+    }
+}
+
+static void sim_adv_clear( void )
+{
+    while ( sim.num_adv > 0 )
+    {
+        free( sim.pp_adv[--sim.num_adv] );
+    }
+}
+
+/******************************************************************************
+ * Function Name: sim_adv_run()
+ ******************************************************************************
+ * Summary:
+ *   Report every advertiser that is due and reschedule the periodic ones
+ *
+ * Return:
+ *  nanoseconds until the next one is due, or -1 if there is none
+ *
+ *****************************************************************************/
+static int64_t sim_adv_run( uint64_t now )
+{
+    sim_advertiser_t *p_adv;
+
+    while ( ( sim.num_adv > 0 ) && ( sim.pp_adv[0]->due_ns <= now ) )
+    {
+        p_adv = sim.pp_adv[0];
+        sim_report( p_adv );
+        if ( p_adv->interval_ns == 0 )
+        {
+            sim.pp_adv[0] = sim.pp_adv[--sim.num_adv];
+            free( p_adv );
+        }
+        else
+        {
+            /* do not burst to catch up after a stall */
+            p_adv->due_ns += p_adv->interval_ns;
+            if ( p_adv->due_ns <= now )
+            {
+                p_adv->due_ns = now + p_adv->interval_ns;
+            }
+        }
+        sim_adv_sift_down( 0 );
+    }
+    return ( sim.num_adv > 0 ) ? (int64_t)( sim.pp_adv[0]->due_ns - now ) : -1;
+}
+
+/******************************************************************************
+ * Function Name: sim_adv_parse()
+ ******************************************************************************
+ * Summary:
+ *   Add an advertiser from a line of the form
+ *   <addr> <rssi> <hex data> [interval=<ms>] [ext] [phy=coded] [random]
+ *   Without an interval the advertisement is reported once.
+ *
+ * Return:
+ *  0 on success, -1 on a malformed line
+ *
+ *****************************************************************************/
+static int sim_adv_parse( char *p_line )
+{
+    sim_advertiser_t *p_adv;
+    char *p_tok, *p_save = NULL, *p_end;
+    int field = 0, len;
+
+    if ( sim.num_adv >= SIM_ADVERTISERS_MAX )
+    {
+        return -1;
+    }
+    p_adv = calloc( 1, sizeof( *p_adv ) );
+    if ( p_adv == NULL )
+    {
+        return -1;
+    }
+    p_adv->phy = 1;
+
+    for ( p_tok = strtok_r( p_line, " \t\r\n", &p_save ); p_tok != NULL; p_tok = strtok_r( NULL, " \t\r\n", &p_save ) )
+    {
+        if ( field == 0 )
+        {
+            len = sim_parse_hex( p_tok, p_adv->addr, sizeof( p_adv->addr ) );
+            if ( len != 6 )
+            {
+                break;
+            }
+        }
+        else if ( field == 1 )
+        {
+            p_adv->rssi = (int8_t)strtol( p_tok, &p_end, 10 );
+            if ( *p_end != '\0' )
+            {
+                break;
+            }
+        }
+        else if ( field == 2 )
+        {
+            len = sim_parse_hex( p_tok, p_adv->data, sizeof( p_adv->data ) );
+            if ( len < 0 )
+            {
+                break;
+            }
+            p_adv->len = (uint16_t)len;
+        }
+        else if ( strncmp( p_tok, "interval=", 9 ) == 0 )
+        {
+            p_adv->interval_ns = strtoull( p_tok + 9, NULL, 10 ) * SIM_NS_PER_MS;
+        }
+        else if ( strcmp( p_tok, "ext" ) == 0 )
+        {
+            p_adv->ext = 1;
+        }
+        else if ( strcmp( p_tok, "phy=coded" ) == 0 )
+        {
+            p_adv->ext = 1;
+            p_adv->phy = 3;
+        }
+        else if ( strcmp( p_tok, "random" ) == 0 )
+        {
+            p_adv->addr_type = 1;
+        }
+        else
+        {
+            break;
+        }
+        field++;
+    }
+
+    if ( ( p_tok != NULL ) || ( field < 3 ) )
+    {
+        free( p_adv );
+        return -1;
+    }
+    /* spread periodic advertisers over their first interval */
+    p_adv->due_ns = sim_now_ns();
+    if ( p_adv->interval_ns > 0 )
+    {
+        p_adv->due_ns += (uint64_t)rand() % p_adv->interval_ns;
+    }
+    sim_adv_push( p_adv );
+    return 0;
+}
+
+static int sim_adv_load( const char *p_path )
+{
+    char line[SIM_LINE_MAX];
+    FILE *p_file = fopen( p_path, "r" );
+    unsigned line_no = 0, loaded = 0;
+    char *p;
+
+    if ( p_file == NULL )
+    {
+        fprintf( stderr, "[sim] %s: %s\n", p_path, strerror( errno ) );
+        return -1;
+    }
+    while ( fgets( line, sizeof( line ), p_file ) != NULL )
+    {
+        line_no++;
+        for ( p = line; ( *p == ' ' ) || ( *p == '\t' ); p++ )
+        {
+        }
+        if ( ( *p == '#' ) || ( *p == '\n' ) || ( *p == '\0' ) )
+        {
+            continue;
+        }
+        if ( sim_adv_parse( p ) != 0 )
+        {
+            fprintf( stderr, "[sim] %s:%u: bad advertiser\n", p_path, line_no );
+            continue;
+        }
+        loaded++;
+    }
+    fclose( p_file );
+    printf( "[sim] %u advertisers loaded from %s\n", loaded, p_path );
+    return 0;
+}
+
+static void sim_print_status( void )
+{
+    uint32_t i, filters = 0;
+
+    for ( i = 0; i < SIM_APCF_FILTERS; i++ )
+    {
+        filters += sim.filters[i].in_use ? 1U : 0U;
+    }
+    printf( "[sim] scan %s, APCF %s (%u filters, %u entries), sleep mode %d, HOST-WAKE %s\n",
+            ( sim.scanning == 2 ) ? "extended" : sim.scanning ? "legacy" : "off", sim.apcf_enabled ? "on" : "off",
+            filters, sim.num_entries, sim.sleep_mode, sim.host_wake ? "asserted" : "released" );
+    printf( "[sim] %u advertisers, %llu commands, %llu reports, %llu filtered, %llu dropped, %llu wakes\n",
+            sim.num_adv, (unsigned long long)sim.commands, (unsigned long long)sim.reports,
+            (unsigned long long)sim.filtered, (unsigned long long)sim.dropped, (unsigned long long)sim.wakes );
+    fflush( stdout );
+}
+
+/******************************************************************************
+ * Function Name: sim_control()
+ ******************************************************************************
+ * Summary:
+ *   Handle a command typed on stdin
+ *
+ *****************************************************************************/
+static void sim_control( char *p_line )
+{
+    char *p_arg;
+
+    p_line[strcspn( p_line, "\r\n" )] = '\0';
+    p_arg = strchr( p_line, ' ' );
+    if ( p_arg != NULL )
+    {
+        *p_arg++ = '\0';
+    }
+
+    if ( ( strcmp( p_line, "adv" ) == 0 ) && ( p_arg != NULL ) )
+    {
+        if ( sim_adv_parse( p_arg ) != 0 )
+        {
+            printf( "[sim] bad advertiser\n" );
+        }
+    }
+    else if ( ( strcmp( p_line, "load" ) == 0 ) && ( p_arg != NULL ) )
+    {
+        sim_adv_load( p_arg );
+    }
+    else if ( strcmp( p_line, "clear" ) == 0 )
+    {
+        sim_adv_clear();
+    }
+    else if ( strcmp( p_line, "wake" ) == 0 )
+    {
+        sim_host_wake_set( 1 );
+    }
+    else if ( strcmp( p_line, "release" ) == 0 )
+    {
+        sim_host_wake_set( 0 );
+    }
+    else if ( ( strcmp( p_line, "fail" ) == 0 ) && ( p_arg != NULL ) )
+    {
+        if ( sim_rule_parse( p_arg, 0 ) != 0 )
+        {
+            printf( "[sim] bad rule\n" );
+        }
+    }
+    else if ( ( strcmp( p_line, "latency" ) == 0 ) && ( p_arg != NULL ) )
+    {
+        if ( sim_rule_parse( p_arg, 1 ) != 0 )
+        {
+            printf( "[sim] bad rule\n" );
+        }
+    }
+    else if ( strcmp( p_line, "status" ) == 0 )
+    {
+        sim_print_status();
+    }
+    else if ( strcmp( p_line, "quit" ) == 0 )
+    {
+        sim_stop = 1;
+    }
+    else if ( p_line[0] != '\0' )
+    {
+        printf( "[sim] commands: adv <advertiser>, load <file>, clear, wake, release, "
+                "fail <rule>, latency <rule>, status, quit\n" );
+    }
+    fflush( stdout );
+}
+
+/******************************************************************************
+ * Function Name: sim_host_input()
+ ******************************************************************************
+ * Summary:
+ *   Parse H4 packets from the host. ACL data is discarded; the application
+ *   only scans.
+ *
+ *****************************************************************************/
+static void sim_host_input( void )
+{
+    size_t used = 0, need;
+    uint8_t *p;
+    ssize_t n;
+
+    n = read( sim.master_fd, sim.in + sim.in_len, sizeof( sim.in ) - sim.in_len );
+    if ( n <= 0 )
+    {
+        return;
+    }
+    sim.in_len += (size_t)n;
+
+    while ( used < sim.in_len )
+    {
+        p = sim.in + used;
+        if ( p[0] == SIM_H4_CMD )
+        {
+            if ( sim.in_len - used < 4 )
+            {
+                break;
+            }
+            need = 4U + p[3];
+            if ( sim.in_len - used < need )
+            {
+                break;
+            }
+            sim_command( (uint16_t)( p[1] | ( p[2] << 8 ) ), &p[4], p[3] );
+        }
+        else if ( p[0] == SIM_H4_ACL )
+        {
+            if ( sim.in_len - used < 5 )
+            {
+                break;
+            }
+            need = 5U + (size_t)( p[3] | ( p[4] << 8 ) );
+            if ( sim.in_len - used < need )
+            {
+                break;
+            }
+        }
+        else
+        {
+            /* resynchronise on garbage, e.g. bytes sent at the wrong baud rate */
+            need = 1;
+        }
+        used += need;
+    }
+    memmove( sim.in, sim.in + used, sim.in_len - used );
+    sim.in_len -= used;
+}
+
+/******************************************************************************
+ * Function Name: sim_pty_open()
+ ******************************************************************************
+ * Summary:
+ *   Create the pseudo-terminal. The slave stays open here as well so the
+ *   application can close and reopen it, e.g. across a baud rate change.
+ *
+ *****************************************************************************/
+static int sim_pty_open( void )
+{
+    struct termios tio;
+    const char *p_name;
+
+    sim.master_fd = posix_openpt( O_RDWR | O_NOCTTY );
+    if ( ( sim.master_fd < 0 ) || ( grantpt( sim.master_fd ) != 0 ) || ( unlockpt( sim.master_fd ) != 0 ) )
+    {
+        perror( "[sim] posix_openpt" );
+        return -1;
+    }
+    p_name = ptsname( sim.master_fd );
+    if ( p_name == NULL )
+    {
+        perror( "[sim] ptsname" );
+        return -1;
+    }
+    snprintf( sim.slave_path, sizeof( sim.slave_path ), "%s", p_name );
+    sim.slave_fd = open( sim.slave_path, O_RDWR | O_NOCTTY );
+    if ( sim.slave_fd < 0 )
+    {
+        perror( "[sim] open slave" );
+        return -1;
+    }
+    if ( tcgetattr( sim.slave_fd, &tio ) == 0 )
+    {
+        cfmakeraw( &tio );
+        tcsetattr( sim.slave_fd, TCSANOW, &tio );
+    }
+    fcntl( sim.master_fd, F_SETFL, fcntl( sim.master_fd, F_GETFL ) | O_NONBLOCK );
+
+    if ( sim.p_link_path != NULL )
+    {
+        unlink( sim.p_link_path );
+        if ( symlink( sim.slave_path, sim.p_link_path ) != 0 )
+        {
+            fprintf( stderr, "[sim] symlink %s: %s\n", sim.p_link_path, strerror( errno ) );
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void sim_usage( const char *p_prog )
+{
+    printf( "Usage: %s [options]\n"
+            "  --adv-file <file>      advertisers, one per line:\n"
+            "                         <addr> <rssi> <hex data> [interval=<ms>] [ext] [phy=coded] [random]\n"
+            "  --link <path>          symlink to the pty slave, for a stable -c argument\n"
+            "  --host-wake <path>     gpio-sim pull attribute driven as HOST-WAKE\n"
+            "  --bd-addr <addr>       controller address (default 20:81:9A:00:00:01)\n"
+            "  --extended             advertise extended advertising and LE Coded\n"
+            "  --latency <rule>       <opcode|all>[/<subcmd>]=<ms> response latency\n"
+            "  --fail <rule>          <opcode|all>[/<subcmd>]=<status|drop>[x<count>]\n"
+            "  --seed <n>             random seed for advertiser phases\n"
+            "  --verbose              log every command\n", p_prog );
+}
+
+int main( int argc, char *argv[] )
+{
+    const char *p_adv_files[16];
+    uint32_t num_adv_files = 0, i, j;
+    struct pollfd fds[2];
+    char line[SIM_LINE_MAX];
+    int64_t adv_ns;
+    uint64_t now;
+    int timeout_ms, stdin_open = 1;
+
+    memcpy( sim.bd_addr, "\x20\x81\x9A\x00\x00\x01", 6 );
+    srand( (unsigned)time( NULL ) );
+
+    for ( i = 1; i < (uint32_t)argc; i++ )
+    {
+        const char *p_opt = argv[i];
+        const char *p_val = ( i + 1 < (uint32_t)argc ) ? argv[i + 1] : NULL;
+
+        if ( strcmp( p_opt, "--extended" ) == 0 )
+        {
+            sim.extended = 1;
+            continue;
+        }
+        if ( strcmp( p_opt, "--verbose" ) == 0 )
+        {
+            sim.verbose = 1;
+            continue;
+        }
+        if ( ( p_val == NULL ) || ( strncmp( p_opt, "--", 2 ) != 0 ) )
+        {
+            sim_usage( argv[0] );
+            return EXIT_FAILURE;
+        }
+        i++;
+        if ( ( strcmp( p_opt, "--adv-file" ) == 0 ) && ( num_adv_files < 16 ) )
+        {
+            p_adv_files[num_adv_files++] = p_val;
+        }
+        else if ( strcmp( p_opt, "--link" ) == 0 )
+        {
+            sim.p_link_path = p_val;
+        }
+        else if ( strcmp( p_opt, "--host-wake" ) == 0 )
+        {
+            sim.p_host_wake_path = p_val;
+        }
+        else if ( ( strcmp( p_opt, "--bd-addr" ) == 0 ) && ( sim_parse_hex( p_val, sim.bd_addr, 6 ) == 6 ) )
+        {
+        }
+        else if ( ( strcmp( p_opt, "--latency" ) == 0 ) && ( sim_rule_parse( p_val, 1 ) == 0 ) )
+        {
+        }
+        else if ( ( strcmp( p_opt, "--fail" ) == 0 ) && ( sim_rule_parse( p_val, 0 ) == 0 ) )
+        {
+        }
+        else if ( strcmp( p_opt, "--seed" ) == 0 )
+        {
+            srand( (unsigned)strtoul( p_val, NULL, 0 ) );
+        }
+        else
+        {
+            fprintf( stderr, "%s: bad option %s %s\n", argv[0], p_opt, p_val );
+            sim_usage( argv[0] );
+            return EXIT_FAILURE;
+        }
+    }
+
+    sim.p_out = malloc( SIM_OUT_SIZE );
+    sim.pp_adv = malloc( SIM_ADVERTISERS_MAX * sizeof( *sim.pp_adv ) );
+    if ( ( sim.p_out == NULL ) || ( sim.pp_adv == NULL ) || ( sim_pty_open() != 0 ) )
+    {
+        return EXIT_FAILURE;
+    }
+    for ( i = 0; i < num_adv_files; i++ )
+    {
+        sim_adv_load( p_adv_files[i] );
+    }
+    signal( SIGINT, sim_on_signal );
+    signal( SIGTERM, sim_on_signal );
+    signal( SIGPIPE, SIG_IGN );
+    /* released HOST-WAKE level until the host says otherwise */
+    if ( sim.p_host_wake_path != NULL )
+    {
+        sim.host_wake = 1;
+        sim_host_wake_set( 0 );
+    }
+
+    printf( "[sim] controller on %s%s%s\n", sim.slave_path, sim.p_link_path ? " -> " : "",
+            sim.p_link_path ? sim.p_link_path : "" );
+    fflush( stdout );
+
+    while ( !sim_stop )
+    {
+        now = sim_now_ns();
+        adv_ns = sim_adv_run( now );
+
+        /* delayed command responses */
+        for ( i = 0, j = 0; i < sim.num_pending; i++ )
+        {
+            if ( sim.pending[i].due_ns <= now )
+            {
+                sim_out_put( sim.pending[i].pkt, sim.pending[i].len, 0 );
+                continue;
+            }
+            if ( ( adv_ns < 0 ) || ( (int64_t)( sim.pending[i].due_ns - now ) < adv_ns ) )
+            {
+                adv_ns = (int64_t)( sim.pending[i].due_ns - now );
+            }
+            sim.pending[j++] = sim.pending[i];
+        }
+        sim.num_pending = j;
+        sim_out_flush();
+
+        timeout_ms = ( adv_ns < 0 ) ? -1 : (int)( ( (uint64_t)adv_ns + SIM_NS_PER_MS - 1U ) / SIM_NS_PER_MS );
+        fds[0].fd = sim.master_fd;
+        fds[0].events = POLLIN | ( ( sim.out_head != sim.out_tail ) ? POLLOUT : 0 );
+        fds[1].fd = stdin_open ? STDIN_FILENO : -1;
+        fds[1].events = POLLIN;
+        if ( poll( fds, 2, timeout_ms ) < 0 )
+        {
+            continue;
+        }
+        if ( fds[0].revents & POLLIN )
+        {
+            sim_host_input();
+        }
+        if ( fds[1].revents & ( POLLIN | POLLHUP ) )
+        {
+            if ( fgets( line, sizeof( line ), stdin ) != NULL )
+            {
+                sim_control( line );
+            }
+            else
+            {
+                stdin_open = 0;
+            }
+        }
+    }
+
+    sim_print_status();
+    if ( sim.p_link_path != NULL )
+    {
+        unlink( sim.p_link_path );
+    }
+    sim_adv_clear();
+    free( sim.pp_adv );
+    free( sim.p_out );
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,232 @@
+#!/bin/bash
+#
+# Copyright 2023, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#
+# File Name: latency_gate.sh
+#
+# Description: Arm and wake latency regression gate. Runs the application
+#              against the wakeonle_hci_sim controller simulator with a
+#              gpio-sim chip as HOST-WAKE and DEV-WAKE, arms a 16-bit UUID
+#              rule from the menu, lets a simulated advertiser wake it and
+#              repeats. Each cycle's arm and wake latency is the growth of
+#              the matching histogram sum on the metrics socket. The
+#              samples are written in the wakeonle_bench JSON shape and
+#              compared with a stored baseline using wakeonle_bench_compare,
+#              or with -w written as a new baseline. Used by the
+#              latency_regression CTest test and the latency_baseline
+#              target.
+#
+#              Without -g a gpio-sim chip is created through configfs,
+#              which needs root and the gpio-sim module. -g names a chip
+#              set up beforehand, with HOST-WAKE on line 0 and DEV-WAKE on
+#              line 1.
+#
+# Related Document: See README.md
+#
+
+set -u
+
+cycles=30
+tolerance=20
+write=0
+chip=""
+uuid="AA BB"
+timeout_s=10
+
+usage()
+{
+    echo "Usage: $0 [-n <cycles>] [-k <percent>] [-g <gpiochip>] [-w] <application> <wakeonle_hci_sim> <wakeonle_bench_compare> <baseline> [-- <application arguments>]"
+    echo "  -n  arm and wake cycles (default $cycles)"
+    echo "  -k  allowed median slowdown in percent (default $tolerance)"
+    echo "  -g  existing gpio-sim chip, HOST-WAKE on line 0 and DEV-WAKE on line 1"
+    echo "  -w  write the baseline instead of comparing with it"
+    exit 2
+}
+
+while getopts "n:k:g:wh" opt; do
+    case $opt in
+        n) cycles=$OPTARG ;;
+        k) tolerance=$OPTARG ;;
+        g) chip=$OPTARG ;;
+        w) write=1 ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -ge 4 ] || usage
+app=$1
+sim=$2
+compare=$3
+baseline=$4
+shift 4
+[ $# -gt 0 ] && [ "$1" = "--" ] && shift
+
+if [ $write -eq 0 ] && [ ! -f "$baseline" ]; then
+    echo "no baseline $baseline, create it with -w" >&2
+    exit 2
+fi
+command -v curl > /dev/null || { echo "curl is required to read the metrics" >&2; exit 2; }
+
+work=$(mktemp -d /tmp/wakeonle_latency_gate.XXXXXX)
+configfs=""
+app_pid=""
+sim_pid=""
+
+cleanup()
+{
+    exec 3>&- 4>&-
+    [ -n "$app_pid" ] && kill "$app_pid" 2> /dev/null
+    [ -n "$sim_pid" ] && kill "$sim_pid" 2> /dev/null
+    wait 2> /dev/null
+    if [ -n "$configfs" ]; then
+        echo 0 > "$configfs/live"
+        rmdir "$configfs/bank0" "$configfs"
+    fi
+    rm -rf "$work"
+}
+trap cleanup EXIT
+
+fail()
+{
+    echo "$1" >&2
+    for log in "$work/sim.log" "$work/app.log"; do
+        [ -f "$log" ] && { echo "--- $log" >&2; tail -n 20 "$log" >&2; }
+    done
+    exit 2
+}
+
+if [ -z "$chip" ]; then
+    configfs=/sys/kernel/config/gpio-sim/wakeonle_latency_$$
+    if ! mkdir "$configfs" 2> /dev/null; then
+        configfs=""
+        fail "cannot create a gpio-sim chip (needs root, configfs and the gpio-sim module), or pass -g <gpiochip>"
+    fi
+    mkdir "$configfs/bank0"
+    echo 2 > "$configfs/bank0/num_lines"
+    echo 1 > "$configfs/live" || fail "gpio-sim chip did not go live"
+    chip=$(cat "$configfs/bank0/chip_name")
+fi
+pull=/sys/bus/gpio/devices/$chip/sim_gpio0/pull
+[ -w "$pull" ] || fail "$pull is not writable, is $chip a gpio-sim chip?"
+
+# value of metric <name> from the last scrape
+metric()
+{
+    awk -v m="$1" '$1 == m { print $2; exit }' "$work/metrics"
+}
+
+scrape()
+{
+    curl -s --max-time 5 --unix-socket "$work/metrics.sock" http://localhost/metrics > "$work/metrics"
+}
+
+# wait until histogram <name> has <count> observations
+wait_count()
+{
+    local deadline=$(( $(date +%s) + timeout_s ))
+
+    while :; do
+        kill -0 "$app_pid" 2> /dev/null || fail "$app exited"
+        scrape
+        [ "$(metric "$2_count")" = "$1" ] && return 0
+        [ "$(date +%s)" -ge "$deadline" ] && fail "timed out waiting for $2_count $1"
+        sleep 0.01
+    done
+}
+
+mkfifo "$work/sim.stdin" "$work/app.stdin"
+"$sim" --link "$work/hci" --host-wake "$pull" < "$work/sim.stdin" > "$work/sim.log" 2>&1 &
+sim_pid=$!
+exec 4> "$work/sim.stdin"
+for _ in $(seq 1 100); do
+    [ -e "$work/hci" ] && break
+    sleep 0.05
+done
+[ -e "$work/hci" ] || fail "$sim did not create $work/hci"
+
+"$app" -c "$work/hci" -h "$chip" 0 -w "$chip" 1 --metrics "$work/metrics.sock" "$@" \
+    < "$work/app.stdin" > "$work/app.log" 2>&1 &
+app_pid=$!
+exec 3> "$work/app.stdin"
+for _ in $(seq 1 $(( timeout_s * 10 ))); do
+    [ -S "$work/metrics.sock" ] && break
+    sleep 0.1
+done
+[ -S "$work/metrics.sock" ] || fail "$app did not start its metrics server"
+# let the stack finish its init before the first arm
+sleep 2
+
+# the rule's UUID as it appears on air, little endian
+ad_uuid=$(echo "$uuid" | awk '{ print $2 $1 }')
+arm=()
+wake=()
+for cycle in $(seq 1 "$cycles"); do
+    scrape
+    arm_sum=$(metric wakeonle_arm_latency_seconds_sum)
+    wake_sum=$(metric wakeonle_wake_latency_seconds_sum)
+
+    # menu entry 3 arms a 16-bit UUID rule
+    printf "3\n%s\n" "$uuid" >&3
+    wait_count "$cycle" wakeonle_arm_latency_seconds
+    arm+=("$(awk -v a="$arm_sum" -v b="$(metric wakeonle_arm_latency_seconds_sum)" 'BEGIN { printf "%.0f", (b - a) * 1e9 }')")
+
+    # a matching advertiser wakes the host, which disarms
+    printf "adv 00:11:22:33:44:%02X -50 0201060303%s interval=20\n" "$cycle" "$ad_uuid" >&4
+    wait_count "$cycle" wakeonle_wake_latency_seconds
+    wake+=("$(awk -v a="$wake_sum" -v b="$(metric wakeonle_wake_latency_seconds_sum)" 'BEGIN { printf "%.0f", (b - a) * 1e9 }')")
+    echo "clear" >&4
+done
+
+# same shape as wakeonle_bench --json, samples in run order
+samples()
+{
+    local IFS=,
+    echo "$*"
+}
+cat > "$work/latency.json" <<JSON
+{
+  "machine": "$(uname -m)",
+  "results": [
+    { "suite": "latency", "name": "arm", "samples_ns": [$(samples "${arm[@]}")] },
+    { "suite": "latency", "name": "wake", "samples_ns": [$(samples "${wake[@]}")] }
+  ]
+}
+JSON
+
+if [ $write -eq 1 ]; then
+    mkdir -p "$(dirname "$baseline")"
+    "$compare" --merge "$baseline" "$work/latency.json" || exit 2
+    echo "baseline of $cycles cycles written to $baseline"
+    exit 0
+fi
+
+"$compare" --tolerance "$tolerance" --baseline "$baseline" "$work/latency.json"